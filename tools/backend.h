@@ -31,12 +31,24 @@
 # include <gtk/gtk.h>
 # include <System.h>
 # include <Devel/Asm.h>
+# include "callgraph.h"
 # include "common.h"
+# include "debug.h"
 
 
 /* types */
 typedef struct _DebuggerBackend DebuggerBackend;
 
+/* as found in the file analysed, for core files */
+typedef struct _DebuggerBackendThread
+{
+	uint64_t id;
+	/* the signal which stopped it, or 0 */
+	unsigned int signal;
+	DebuggerDebugRegister const * registers;
+	size_t registers_cnt;
+} DebuggerBackendThread;
+
 typedef struct _DebuggerBackendHelper
 {
 	Debugger * debugger;
@@ -44,6 +56,14 @@ typedef struct _DebuggerBackendHelper
 	void (*set_registers)(Debugger * debugger,
 			AsmArchRegister const * registers,
 			size_t registers_cnt);
+	void (*set_sections)(Debugger * debugger,
+			AsmSection const * sections, size_t sections_cnt);
+	void (*set_functions)(Debugger * debugger,
+			AsmFunction const * functions, size_t functions_cnt);
+	void (*set_call_graph)(Debugger * debugger, CallGraph const * graph);
+	void (*set_threads)(Debugger * debugger,
+			DebuggerBackendThread const * threads,
+			size_t threads_cnt);
 } DebuggerBackendHelper;
 
 typedef const struct _DebuggerBackendDefinition
@@ -60,6 +80,12 @@ typedef const struct _DebuggerBackendDefinition
 	int (*close)(DebuggerBackend * backend);
 	char const * (*arch_get_name)(DebuggerBackend * backend);
 	char const * (*format_get_name)(DebuggerBackend * backend);
+	int (*decode)(DebuggerBackend * backend, off_t offset, size_t size,
+			off_t base, AsmArchInstructionCall ** calls,
+			size_t * calls_cnt);
+	/* the memory image of the file if any, or NULL */
+	ssize_t (*read_memory)(DebuggerBackend * backend, uint64_t address,
+			void * buf, size_t size);
 } DebuggerBackendDefinition;
 
 #endif /* !CODER_DEBUGGER_BACKEND_H */
@@ -33,6 +33,8 @@
 #include <Desktop.h>
 #include <Devel/Asm.h>
 #include "../backend.h"
+#include "../cache.h"
+#include "../callgraph.h"
 #include "../debugger.h"
 #include "../../config.h"
 #define _(string) gettext(string)
@@ -49,13 +51,43 @@
 /* private */
 typedef struct _DebuggerBackend AsmBackend;
 
+typedef struct _AsmBackendJob
+{
+	AsmBackend * backend;
+	GThread * thread;
+
+	/* owned by the thread until it completes */
+	Asm * a;
+	AsmCode * code;
+	Cache * cache;
+	char * arch;
+	char * format;
+	char * filename;
+	char * key;
+	char * error;
+} AsmBackendJob;
+
 struct _DebuggerBackend
 {
 	DebuggerBackendHelper const * helper;
 	Asm * a;
 	AsmCode * code;
 
+	/* decode cache */
+	Cache * cache;
+
+	/* the calls decoded so far, as displayed */
+	AsmFunction * functions;
+	size_t functions_cnt;
+	GArray * calls;
+	GHashTable * scanned;
+	CallGraph * graph;
 	guint source;
+
+	/* decoding in progress */
+	AsmBackendJob * job;
+	/* including the jobs cancelled but still running */
+	GSList * jobs;
 };
 
 
@@ -70,6 +102,14 @@ static char * _asm_open_dialog(AsmBackend * backend, GtkWidget * window,
 static int _asm_close(AsmBackend * backend);
 static char const * _asm_arch_get_name(AsmBackend * backend);
 static char const * _asm_format_get_name(AsmBackend * backend);
+static int _asm_decode(AsmBackend * backend, off_t offset, size_t size,
+		off_t base, AsmArchInstructionCall ** calls,
+		size_t * calls_cnt);
+
+/* job */
+static AsmBackendJob * _asm_job_new(AsmBackend * backend, Asm * a,
+		char const * arch, char const * format, char const * filename);
+static void _asm_job_delete(AsmBackendJob * job);
 
 
 /* constants */
@@ -84,7 +124,9 @@ DebuggerBackendDefinition backend =
 	_asm_open_dialog,
 	_asm_close,
 	_asm_arch_get_name,
-	_asm_format_get_name
+	_asm_format_get_name,
+	_asm_decode,
+	NULL
 };
 
 
@@ -101,7 +143,16 @@ static AsmBackend * _asm_init(DebuggerBackendHelper const * helper)
 	backend->helper = helper;
 	backend->a = NULL;
 	backend->code = NULL;
+	backend->cache = NULL;
+	backend->functions = NULL;
+	backend->functions_cnt = 0;
+	backend->calls = g_array_new(FALSE, FALSE,
+			sizeof(AsmArchInstructionCall));
+	backend->scanned = g_hash_table_new(g_direct_hash, g_direct_equal);
+	backend->graph = NULL;
 	backend->source = 0;
+	backend->job = NULL;
+	backend->jobs = NULL;
 	return backend;
 }
 
@@ -109,45 +160,124 @@ static AsmBackend * _asm_init(DebuggerBackendHelper const * helper)
 /* asm_destroy */
 static void _asm_destroy(AsmBackend * backend)
 {
+	AsmBackendJob * job;
+
 	_asm_close(backend);
+	/* the plug-in is about to be unloaded: wait for the threads */
+	while(backend->jobs != NULL)
+	{
+		job = backend->jobs->data;
+		backend->jobs = g_slist_remove(backend->jobs, job);
+		g_thread_join(job->thread);
+		g_idle_remove_by_data(job);
+		_asm_job_delete(job);
+	}
+	g_array_free(backend->calls, TRUE);
+	g_hash_table_destroy(backend->scanned);
 	object_delete(backend);
 }
 
 
 /* asm_open */
+static gpointer _open_thread(gpointer data);
 /* callbacks */
 static gboolean _open_on_idle(gpointer data);
 
 static int _asm_open(AsmBackend * backend, char const * arch,
 		char const * format, char const * filename)
 {
+	Asm * a;
+
 	if(_asm_close(backend) != 0)
 		return -1;
-	if((backend->a = asm_new(arch, format)) == NULL)
+	if((a = asm_new(arch, format)) == NULL)
 		return -1;
-	if((backend->code = asm_open_deassemble(backend->a, filename, TRUE))
+	/* decode in the background */
+	if((backend->job = _asm_job_new(backend, a, arch, format, filename))
 			== NULL)
 	{
-		asm_delete(backend->a);
-		backend->a = NULL;
+		asm_delete(a);
 		return -1;
 	}
-	else
-		backend->source = g_idle_add(_open_on_idle, backend);
 	return 0;
 }
 
+static gpointer _open_thread(gpointer data)
+{
+	AsmBackendJob * job = data;
+
+	/* look for this file in the decode cache first */
+	if((job->key = cache_get_key(job->filename, job->arch, job->format))
+			!= NULL && (job->cache = cache_open(job->key)) != NULL)
+		;
+	/* the error is only reported from the main loop */
+	else if((job->code = asm_open_deassemble(job->a, job->filename, TRUE))
+			== NULL)
+		job->error = g_strdup(error_get(NULL));
+	/* hand the result over to the main loop */
+	g_idle_add(_open_on_idle, job);
+	return NULL;
+}
+
 static gboolean _open_on_idle(gpointer data)
 {
-	AsmBackend * backend = data;
+	AsmBackendJob * job = data;
+	AsmBackend * backend = job->backend;
 	AsmArchRegister const * registers;
-	size_t cnt = 0;
+	AsmSection * sections;
+	size_t sections_cnt;
+	size_t cnt;
 
-	backend->source = 0;
-	if((registers = asmcode_get_arch_registers(backend->code)) != NULL)
-		for(cnt = 0; registers[cnt].name != NULL; cnt++);
+	g_thread_join(job->thread);
+	backend->jobs = g_slist_remove(backend->jobs, job);
+	if(job != backend->job)
+	{
+		/* the file was closed in the meantime */
+		_asm_job_delete(job);
+		return FALSE;
+	}
+	backend->job = NULL;
+	if(job->cache == NULL && job->code == NULL)
+	{
+		error_set_code(1, "%s", (job->error != NULL) ? job->error
+				: _("Could not open the file"));
+		backend->helper->error(backend->helper->debugger, 1, "%s",
+				error_get(NULL));
+		_asm_job_delete(job);
+		return FALSE;
+	}
+	/* take ownership of the result */
+	backend->cache = job->cache;
+	if(job->cache == NULL)
+	{
+		backend->a = job->a;
+		backend->code = job->code;
+		job->a = NULL;
+		job->code = NULL;
+	}
+	job->cache = NULL;
+	_asm_job_delete(job);
+	if(backend->cache != NULL)
+	{
+		registers = cache_get_arch_registers(backend->cache);
+		cache_get_sections(backend->cache, &sections, &sections_cnt);
+		cache_get_functions(backend->cache, &backend->functions,
+				&backend->functions_cnt);
+	}
+	else
+	{
+		registers = asmcode_get_arch_registers(backend->code);
+		asmcode_get_sections(backend->code, &sections, &sections_cnt);
+		asmcode_get_functions(backend->code, &backend->functions,
+				&backend->functions_cnt);
+	}
+	for(cnt = 0; registers != NULL && registers[cnt].name != NULL; cnt++);
 	backend->helper->set_registers(backend->helper->debugger, registers,
 			cnt);
+	backend->helper->set_sections(backend->helper->debugger, sections,
+			sections_cnt);
+	backend->helper->set_functions(backend->helper->debugger,
+			backend->functions, backend->functions_cnt);
 	return FALSE;
 }
 
@@ -327,9 +457,22 @@ static void _open_dialog_type(GtkWidget * combobox, char const * type,
 /* asm_close */
 static int _asm_close(AsmBackend * backend)
 {
+	/* decoding cannot be interrupted: the result is discarded instead */
+	backend->job = NULL;
 	if(backend->source != 0)
 		g_source_remove(backend->source);
 	backend->source = 0;
+	backend->functions = NULL;
+	backend->functions_cnt = 0;
+	g_array_set_size(backend->calls, 0);
+	g_hash_table_remove_all(backend->scanned);
+	if(backend->graph != NULL)
+		callgraph_delete(backend->graph);
+	backend->graph = NULL;
+	if(backend->cache != NULL)
+		cache_close(backend->cache);
+	backend->cache = NULL;
+	backend->code = NULL;
 	if(backend->a != NULL)
 		asm_delete(backend->a);
 	backend->a = NULL;
@@ -340,6 +483,10 @@ static int _asm_close(AsmBackend * backend)
 /* asm_arch_get_name */
 static char const * _asm_arch_get_name(AsmBackend * backend)
 {
+	if(backend->cache != NULL)
+		return cache_get_arch(backend->cache);
+	if(backend->code == NULL)
+		return NULL;
 	return asmcode_get_arch(backend->code);
 }
 
@@ -347,5 +494,141 @@ static char const * _asm_arch_get_name(AsmBackend * backend)
 /* asm_format_get_name */
 static char const * _asm_format_get_name(AsmBackend * backend)
 {
+	if(backend->cache != NULL)
+		return cache_get_format(backend->cache);
+	if(backend->code == NULL)
+		return NULL;
 	return asmcode_get_format(backend->code);
 }
+
+
+/* asm_decode */
+static void _decode_scan(AsmBackend * backend,
+		AsmArchInstructionCall const * calls, size_t calls_cnt);
+/* callbacks */
+static gboolean _decode_on_idle(gpointer data);
+
+static int _asm_decode(AsmBackend * backend, off_t offset, size_t size,
+		off_t base, AsmArchInstructionCall ** calls,
+		size_t * calls_cnt)
+{
+	int ret;
+
+	/* the addresses are already known to the cache */
+	if(backend->cache != NULL)
+		ret = cache_decode_at(backend->cache, offset, size, calls,
+				calls_cnt);
+	else if(backend->code == NULL)
+		return -error_set_code(1, "%s", _("No file is being debugged"));
+	else
+		ret = asmcode_decode_at(backend->code, offset, size, base,
+				calls, calls_cnt);
+	if(ret == 0)
+		_decode_scan(backend, *calls, *calls_cnt);
+	return ret;
+}
+
+static void _decode_scan(AsmBackend * backend,
+		AsmArchInstructionCall const * calls, size_t calls_cnt)
+{
+	size_t len = backend->calls->len;
+	size_t i;
+	uint32_t j;
+	AsmArchOperand const * ao;
+	gpointer key;
+
+	/* keep the calls to functions, as they are displayed */
+	for(i = 0; i < calls_cnt; i++)
+		for(j = 0; j < calls[i].operands_cnt; j++)
+		{
+			ao = &calls[i].operands[j];
+			if(AO_GET_TYPE(ao->definition) != AOT_IMMEDIATE
+					|| AO_GET_VALUE(ao->definition)
+					!= AOI_REFERS_FUNCTION)
+				continue;
+			key = GSIZE_TO_POINTER(calls[i].offset + 1);
+			if(g_hash_table_lookup(backend->scanned, key) == NULL)
+			{
+				g_hash_table_insert(backend->scanned, key, key);
+				g_array_append_val(backend->calls, calls[i]);
+			}
+			break;
+		}
+	/* update the call graph once the display is done */
+	if(backend->calls->len > len && backend->source == 0)
+		backend->source = g_idle_add(_decode_on_idle, backend);
+}
+
+static gboolean _decode_on_idle(gpointer data)
+{
+	AsmBackend * backend = data;
+	CallGraph * graph;
+
+	backend->source = 0;
+	if((graph = callgraph_new(backend->functions,
+					backend->functions_cnt)) == NULL)
+		return FALSE;
+	if(callgraph_append(graph, (AsmArchInstructionCall *)
+				backend->calls->data, backend->calls->len) != 0
+			|| callgraph_build(graph) != 0)
+	{
+		callgraph_delete(graph);
+		return FALSE;
+	}
+	/* replace the previous one */
+	backend->helper->set_call_graph(backend->helper->debugger, graph);
+	if(backend->graph != NULL)
+		callgraph_delete(backend->graph);
+	backend->graph = graph;
+	return FALSE;
+}
+
+
+/* job */
+/* asm_job_new */
+static AsmBackendJob * _asm_job_new(AsmBackend * backend, Asm * a,
+		char const * arch, char const * format, char const * filename)
+{
+	AsmBackendJob * job;
+	GError * error = NULL;
+
+	if((job = object_new(sizeof(*job))) == NULL)
+		return NULL;
+	job->backend = backend;
+	job->a = a;
+	job->code = NULL;
+	job->cache = NULL;
+	job->arch = g_strdup(arch);
+	job->format = g_strdup(format);
+	job->filename = g_strdup(filename);
+	job->key = NULL;
+	job->error = NULL;
+	if((job->thread = g_thread_try_new("asm", _open_thread, job, &error))
+			== NULL)
+	{
+		error_set_code(1, "%s", error->message);
+		g_error_free(error);
+		/* the caller still owns the Asm object */
+		job->a = NULL;
+		_asm_job_delete(job);
+		return NULL;
+	}
+	backend->jobs = g_slist_prepend(backend->jobs, job);
+	return job;
+}
+
+
+/* asm_job_delete */
+static void _asm_job_delete(AsmBackendJob * job)
+{
+	if(job->cache != NULL)
+		cache_close(job->cache);
+	if(job->a != NULL)
+		asm_delete(job->a);
+	g_free(job->arch);
+	g_free(job->format);
+	g_free(job->filename);
+	g_free(job->key);
+	g_free(job->error);
+	object_delete(job);
+}
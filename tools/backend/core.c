@@ -0,0 +1,726 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+
+#include <sys/types.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <string.h>
+#include <elf.h>
+#include <libintl.h>
+#include <gtk/gtk.h>
+#include <System.h>
+#include <Devel/Asm.h>
+#include "../backend.h"
+#define _(string) gettext(string)
+
+#ifndef NT_PRSTATUS
+# define NT_PRSTATUS	1
+#endif
+#ifndef PN_XNUM
+# define PN_XNUM	0xffff
+#endif
+
+
+/* core */
+/* private */
+typedef struct _DebuggerBackend CoreBackend;
+
+/* where struct elf_prstatus keeps what is needed, by ELF class */
+typedef struct _CoreLayout
+{
+	size_t cursig;
+	size_t pid;
+	size_t reg;
+	/* of each register saved */
+	size_t word;
+} CoreLayout;
+
+typedef struct _CoreRegister
+{
+	char const * name;
+	/* in words from pr_reg */
+	size_t index;
+} CoreRegister;
+
+typedef struct _CoreArch
+{
+	unsigned int machine;
+	char const * name;
+	/* in the order displayed */
+	CoreRegister const * registers;
+	size_t registers_cnt;
+} CoreArch;
+
+typedef struct _CoreSegment
+{
+	uint64_t address;
+	/* only what was dumped to the file */
+	uint64_t size;
+	uint64_t offset;
+	unsigned int flags;
+} CoreSegment;
+
+struct _DebuggerBackend
+{
+	DebuggerBackendHelper const * helper;
+	GMappedFile * mapped;
+	unsigned char const * data;
+	size_t size;
+	CoreLayout const * layout;
+	CoreArch const * arch;
+	char * name;
+
+	/* decoding, straight from the mapping */
+	Asm * a;
+
+	/* PT_LOAD segments, by address */
+	GArray * segments;
+	/* the executable ones, for the disassembly */
+	AsmSection * sections;
+	size_t sections_cnt;
+	gchar ** names;
+
+	/* from the NT_PRSTATUS notes */
+	AsmArchRegister * registers;
+	GArray * threads;
+	GArray * values;
+};
+
+
+/* constants */
+static const CoreLayout _core_layout32 = { 12, 24, 72, 4 };
+static const CoreLayout _core_layout64 = { 12, 32, 112, 8 };
+
+static const CoreRegister _core_registers_amd64[] =
+{
+	{ "rax", 10 }, { "rbx", 5 }, { "rcx", 11 }, { "rdx", 12 },
+	{ "rsi", 13 }, { "rdi", 14 }, { "rbp", 4 }, { "rsp", 19 },
+	{ "r8", 9 }, { "r9", 8 }, { "r10", 7 }, { "r11", 6 },
+	{ "r12", 3 }, { "r13", 2 }, { "r14", 1 }, { "r15", 0 },
+	{ "rip", 16 }, { "eflags", 18 }, { "cs", 17 }, { "ss", 20 },
+	{ "ds", 23 }, { "es", 24 }, { "fs", 25 }, { "gs", 26 },
+	{ "fs_base", 21 }, { "gs_base", 22 }
+};
+
+static const CoreRegister _core_registers_arm[] =
+{
+	{ "r0", 0 }, { "r1", 1 }, { "r2", 2 }, { "r3", 3 },
+	{ "r4", 4 }, { "r5", 5 }, { "r6", 6 }, { "r7", 7 },
+	{ "r8", 8 }, { "r9", 9 }, { "r10", 10 }, { "r11", 11 },
+	{ "r12", 12 }, { "sp", 13 }, { "lr", 14 }, { "pc", 15 },
+	{ "cpsr", 16 }
+};
+
+static const CoreRegister _core_registers_i386[] =
+{
+	{ "eax", 6 }, { "ebx", 0 }, { "ecx", 1 }, { "edx", 2 },
+	{ "esi", 3 }, { "edi", 4 }, { "ebp", 5 }, { "esp", 15 },
+	{ "eip", 12 }, { "eflags", 14 }, { "cs", 13 }, { "ss", 16 },
+	{ "ds", 7 }, { "es", 8 }, { "fs", 9 }, { "gs", 10 }
+};
+
+#define CORE_REGISTERS(registers) registers, \
+	sizeof(registers) / sizeof(*registers)
+static const CoreArch _core_archs[] =
+{
+	{ EM_386, "i386", CORE_REGISTERS(_core_registers_i386) },
+	{ EM_ARM, "arm", CORE_REGISTERS(_core_registers_arm) },
+	{ EM_X86_64, "amd64", CORE_REGISTERS(_core_registers_amd64) }
+};
+#undef CORE_REGISTERS
+
+
+/* prototypes */
+/* plug-in */
+static CoreBackend * _core_init(DebuggerBackendHelper const * helper);
+static void _core_destroy(CoreBackend * backend);
+static int _core_open(CoreBackend * backend, char const * arch,
+		char const * format, char const * filename);
+static char * _core_open_dialog(CoreBackend * backend, GtkWidget * window,
+		char const * arch, char const * format);
+static int _core_close(CoreBackend * backend);
+static char const * _core_arch_get_name(CoreBackend * backend);
+static char const * _core_format_get_name(CoreBackend * backend);
+static int _core_decode(CoreBackend * backend, off_t offset, size_t size,
+		off_t base, AsmArchInstructionCall ** calls,
+		size_t * calls_cnt);
+static ssize_t _core_read_memory(CoreBackend * backend, uint64_t address,
+		void * buf, size_t size);
+
+
+/* constants */
+DebuggerBackendDefinition backend =
+{
+	"core",
+	"ELF core files",
+	LICENSE_BSD3_FLAGS,
+	_core_init,
+	_core_destroy,
+	_core_open,
+	_core_open_dialog,
+	_core_close,
+	_core_arch_get_name,
+	_core_format_get_name,
+	_core_decode,
+	_core_read_memory
+};
+
+
+/* protected */
+/* functions */
+/* plug-in */
+/* core_init */
+static CoreBackend * _core_init(DebuggerBackendHelper const * helper)
+{
+	CoreBackend * backend;
+
+	if((backend = object_new(sizeof(*backend))) == NULL)
+		return NULL;
+	backend->helper = helper;
+	backend->mapped = NULL;
+	backend->data = NULL;
+	backend->size = 0;
+	backend->layout = NULL;
+	backend->arch = NULL;
+	backend->name = NULL;
+	backend->a = NULL;
+	backend->segments = g_array_new(FALSE, FALSE, sizeof(CoreSegment));
+	backend->sections = NULL;
+	backend->sections_cnt = 0;
+	backend->names = NULL;
+	backend->registers = NULL;
+	backend->threads = g_array_new(FALSE, FALSE,
+			sizeof(DebuggerBackendThread));
+	backend->values = g_array_new(FALSE, FALSE,
+			sizeof(DebuggerDebugRegister));
+	return backend;
+}
+
+
+/* core_destroy */
+static void _core_destroy(CoreBackend * backend)
+{
+	_core_close(backend);
+	g_array_free(backend->segments, TRUE);
+	g_array_free(backend->threads, TRUE);
+	g_array_free(backend->values, TRUE);
+	object_delete(backend);
+}
+
+
+/* core_open */
+static int _open_headers(CoreBackend * backend);
+static void _open_notes(CoreBackend * backend, uint64_t offset,
+		uint64_t size);
+static void _open_prstatus(CoreBackend * backend,
+		unsigned char const * desc, size_t size);
+static void _open_report(CoreBackend * backend);
+static void _open_sections(CoreBackend * backend);
+/* callbacks */
+static int _open_on_segments_compare(gconstpointer a, gconstpointer b);
+
+static int _core_open(CoreBackend * backend, char const * arch,
+		char const * format, char const * filename)
+{
+	GError * error = NULL;
+	(void) format;
+
+	if(_core_close(backend) != 0)
+		return -1;
+	/* only the pages accessed are ever read */
+	if((backend->mapped = g_mapped_file_new(filename, FALSE, &error))
+			== NULL)
+	{
+		error_set_code(1, "%s: %s", filename, error->message);
+		g_error_free(error);
+		return -1;
+	}
+	backend->data = (unsigned char const *)g_mapped_file_get_contents(
+			backend->mapped);
+	backend->size = g_mapped_file_get_length(backend->mapped);
+	if(_open_headers(backend) != 0)
+	{
+		_core_close(backend);
+		return -1;
+	}
+	if(arch != NULL)
+		backend->name = g_strdup(arch);
+	else if(backend->arch != NULL)
+		backend->name = g_strdup(backend->arch->name);
+	/* nothing is decoded until displayed */
+	if(backend->name != NULL)
+		backend->a = asm_new(backend->name, "flat");
+	_open_report(backend);
+	return 0;
+}
+
+static int _open_headers(CoreBackend * backend)
+{
+	unsigned char const * ident = backend->data;
+	Elf32_Ehdr ehdr32;
+	Elf64_Ehdr ehdr64;
+	Elf32_Phdr phdr32;
+	Elf64_Phdr phdr64;
+	Elf32_Shdr shdr32;
+	Elf64_Shdr shdr64;
+	unsigned int machine;
+	uint64_t phoff;
+	size_t phentsize;
+	size_t phnum;
+	uint64_t shoff;
+	size_t shentsize;
+	size_t phdrsize;
+	size_t i;
+	unsigned char const * p;
+	CoreSegment segment;
+	uint32_t type;
+
+	if(backend->size < EI_NIDENT || memcmp(ident, ELFMAG, SELFMAG) != 0)
+		return -error_set_code(1, "%s", _("Not an ELF file"));
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+	if(ident[EI_DATA] != ELFDATA2LSB)
+#else
+	if(ident[EI_DATA] != ELFDATA2MSB)
+#endif
+		return -error_set_code(1, "%s",
+				_("Unsupported byte order"));
+	if(ident[EI_CLASS] == ELFCLASS32 && backend->size >= sizeof(ehdr32))
+	{
+		memcpy(&ehdr32, ident, sizeof(ehdr32));
+		if(ehdr32.e_type != ET_CORE)
+			return -error_set_code(1, "%s", _("Not a core file"));
+		backend->layout = &_core_layout32;
+		machine = ehdr32.e_machine;
+		phoff = ehdr32.e_phoff;
+		phentsize = ehdr32.e_phentsize;
+		phnum = ehdr32.e_phnum;
+		shoff = ehdr32.e_shoff;
+		shentsize = ehdr32.e_shentsize;
+		phdrsize = sizeof(phdr32);
+	}
+	else if(ident[EI_CLASS] == ELFCLASS64
+			&& backend->size >= sizeof(ehdr64))
+	{
+		memcpy(&ehdr64, ident, sizeof(ehdr64));
+		if(ehdr64.e_type != ET_CORE)
+			return -error_set_code(1, "%s", _("Not a core file"));
+		backend->layout = &_core_layout64;
+		machine = ehdr64.e_machine;
+		phoff = ehdr64.e_phoff;
+		phentsize = ehdr64.e_phentsize;
+		phnum = ehdr64.e_phnum;
+		shoff = ehdr64.e_shoff;
+		shentsize = ehdr64.e_shentsize;
+		phdrsize = sizeof(phdr64);
+	}
+	else
+		return -error_set_code(1, "%s", _("Unsupported ELF class"));
+	for(i = 0; i < sizeof(_core_archs) / sizeof(*_core_archs); i++)
+		if(_core_archs[i].machine == machine)
+			backend->arch = &_core_archs[i];
+	/* too many program headers: the count is in the first section */
+	if(phnum == PN_XNUM)
+	{
+		if(shoff > backend->size || shentsize > backend->size - shoff)
+			return -error_set_code(1, "%s",
+					_("Truncated section headers"));
+		p = &backend->data[shoff];
+		if(backend->layout == &_core_layout32
+				&& shentsize >= sizeof(shdr32))
+		{
+			memcpy(&shdr32, p, sizeof(shdr32));
+			phnum = shdr32.sh_info;
+		}
+		else if(backend->layout == &_core_layout64
+				&& shentsize >= sizeof(shdr64))
+		{
+			memcpy(&shdr64, p, sizeof(shdr64));
+			phnum = shdr64.sh_info;
+		}
+		else
+			return -error_set_code(1, "%s",
+					_("Truncated section headers"));
+	}
+	if(phnum > 0 && (phentsize < phdrsize || phoff > backend->size
+				|| phnum > (backend->size - phoff) / phentsize))
+		return -error_set_code(1, "%s",
+				_("Truncated program headers"));
+	for(i = 0; i < phnum; i++)
+	{
+		p = &backend->data[phoff + i * phentsize];
+		if(backend->layout == &_core_layout32)
+		{
+			memcpy(&phdr32, p, sizeof(phdr32));
+			type = phdr32.p_type;
+			segment.address = phdr32.p_vaddr;
+			segment.size = phdr32.p_filesz;
+			segment.offset = phdr32.p_offset;
+			segment.flags = phdr32.p_flags;
+		}
+		else
+		{
+			memcpy(&phdr64, p, sizeof(phdr64));
+			type = phdr64.p_type;
+			segment.address = phdr64.p_vaddr;
+			segment.size = phdr64.p_filesz;
+			segment.offset = phdr64.p_offset;
+			segment.flags = phdr64.p_flags;
+		}
+		/* cores are often truncated */
+		if(segment.offset >= backend->size)
+			continue;
+		segment.size = MIN(segment.size, backend->size
+				- segment.offset);
+		if(type == PT_NOTE)
+			_open_notes(backend, segment.offset, segment.size);
+		/* the pages not dumped cannot be read */
+		else if(type == PT_LOAD && segment.size > 0)
+			g_array_append_val(backend->segments, segment);
+	}
+	g_array_sort(backend->segments, _open_on_segments_compare);
+	_open_sections(backend);
+	return 0;
+}
+
+static void _open_notes(CoreBackend * backend, uint64_t offset,
+		uint64_t size)
+{
+	unsigned char const * p = &backend->data[offset];
+	uint32_t header[3];
+	size_t namesz;
+	size_t descsz;
+
+	/* name and description are each aligned on 4 bytes */
+	while(size >= sizeof(header))
+	{
+		memcpy(header, p, sizeof(header));
+		namesz = (header[0] + 3) & ~3;
+		descsz = (header[1] + 3) & ~3;
+		p += sizeof(header);
+		size -= sizeof(header);
+		if(namesz > size || header[1] > size - namesz)
+			break;
+		if(header[2] == NT_PRSTATUS && header[0] == sizeof("CORE")
+				&& memcmp(p, "CORE", sizeof("CORE")) == 0)
+			_open_prstatus(backend, p + namesz, header[1]);
+		if(descsz > size - namesz)
+			break;
+		p += namesz + descsz;
+		size -= namesz + descsz;
+	}
+}
+
+static void _open_prstatus(CoreBackend * backend,
+		unsigned char const * desc, size_t size)
+{
+	CoreLayout const * layout = backend->layout;
+	DebuggerBackendThread thread;
+	DebuggerDebugRegister reg;
+	CoreRegister const * r;
+	int16_t cursig;
+	int32_t pid;
+	uint32_t u32;
+	uint64_t u64;
+	size_t i;
+
+	if(size < layout->reg)
+		return;
+	memcpy(&cursig, &desc[layout->cursig], sizeof(cursig));
+	memcpy(&pid, &desc[layout->pid], sizeof(pid));
+	thread.id = pid;
+	thread.signal = (cursig > 0) ? cursig : 0;
+	/* the registers are set once all are known */
+	thread.registers = NULL;
+	thread.registers_cnt = 0;
+	for(i = 0; backend->arch != NULL && i < backend->arch->registers_cnt;
+			i++)
+	{
+		r = &backend->arch->registers[i];
+		if((r->index + 1) * layout->word > size - layout->reg)
+			break;
+		reg.name = r->name;
+		if(layout->word == sizeof(u32))
+		{
+			memcpy(&u32, &desc[layout->reg + r->index
+					* layout->word], sizeof(u32));
+			reg.value = u32;
+		}
+		else
+		{
+			memcpy(&u64, &desc[layout->reg + r->index
+					* layout->word], sizeof(u64));
+			reg.value = u64;
+		}
+		g_array_append_val(backend->values, reg);
+		thread.registers_cnt++;
+	}
+	g_array_append_val(backend->threads, thread);
+}
+
+static void _open_report(CoreBackend * backend)
+{
+	DebuggerBackendHelper const * helper = backend->helper;
+	DebuggerBackendThread * thread;
+	size_t i;
+	size_t j;
+
+	if(backend->arch != NULL)
+	{
+		backend->registers = g_new0(AsmArchRegister,
+				backend->arch->registers_cnt + 1);
+		for(i = 0; i < backend->arch->registers_cnt; i++)
+		{
+			backend->registers[i].name
+				= backend->arch->registers[i].name;
+			backend->registers[i].size = backend->layout->word * 8;
+			backend->registers[i].id = i;
+		}
+		helper->set_registers(helper->debugger, backend->registers,
+				backend->arch->registers_cnt);
+	}
+	helper->set_sections(helper->debugger, backend->sections,
+			backend->sections_cnt);
+	helper->set_functions(helper->debugger, NULL, 0);
+	/* the values do not move anymore */
+	for(i = 0, j = 0; i < backend->threads->len; i++)
+	{
+		thread = &g_array_index(backend->threads,
+				DebuggerBackendThread, i);
+		thread->registers = &g_array_index(backend->values,
+				DebuggerDebugRegister, j);
+		j += thread->registers_cnt;
+	}
+	helper->set_threads(helper->debugger,
+			(DebuggerBackendThread *)backend->threads->data,
+			backend->threads->len);
+}
+
+static void _open_sections(CoreBackend * backend)
+{
+	CoreSegment const * segment;
+	AsmSection * section;
+	size_t i;
+
+	backend->sections = g_new0(AsmSection, backend->segments->len + 1);
+	backend->names = g_new0(gchar *, backend->segments->len + 1);
+	for(i = 0; i < backend->segments->len; i++)
+	{
+		segment = &g_array_index(backend->segments, CoreSegment, i);
+		if((segment->flags & PF_X) == 0)
+			continue;
+		section = &backend->sections[backend->sections_cnt];
+		backend->names[backend->sections_cnt] = g_strdup_printf(
+				"load%lu", (unsigned long)i);
+		section->id = backend->sections_cnt;
+		section->name = backend->names[backend->sections_cnt++];
+		section->offset = segment->offset;
+		section->size = segment->size;
+		section->base = segment->address;
+	}
+}
+
+static int _open_on_segments_compare(gconstpointer a, gconstpointer b)
+{
+	CoreSegment const * sa = a;
+	CoreSegment const * sb = b;
+
+	if(sa->address < sb->address)
+		return -1;
+	return (sa->address > sb->address) ? 1 : 0;
+}
+
+
+/* core_open_dialog */
+static char * _core_open_dialog(CoreBackend * backend, GtkWidget * window,
+		char const * arch, char const * format)
+{
+	GtkWidget * dialog;
+	GtkFileFilter * filter;
+	char * filename = NULL;
+	(void) backend;
+	(void) arch;
+	(void) format;
+
+	dialog = gtk_file_chooser_dialog_new(_("Open core file..."),
+			(window != NULL) ? GTK_WINDOW(window) : NULL,
+			GTK_FILE_CHOOSER_ACTION_OPEN,
+			GTK_STOCK_CANCEL, GTK_RESPONSE_CANCEL,
+			GTK_STOCK_OPEN, GTK_RESPONSE_ACCEPT, NULL);
+	/* core files */
+	filter = gtk_file_filter_new();
+	gtk_file_filter_set_name(filter, _("Core files"));
+	gtk_file_filter_add_mime_type(filter, "application/x-core");
+	gtk_file_chooser_add_filter(GTK_FILE_CHOOSER(dialog), filter);
+	gtk_file_chooser_set_filter(GTK_FILE_CHOOSER(dialog), filter);
+	/* all files */
+	filter = gtk_file_filter_new();
+	gtk_file_filter_set_name(filter, _("All files"));
+	gtk_file_filter_add_pattern(filter, "*");
+	gtk_file_chooser_add_filter(GTK_FILE_CHOOSER(dialog), filter);
+	if(gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT)
+		filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(
+					dialog));
+	gtk_widget_destroy(dialog);
+	return filename;
+}
+
+
+/* core_close */
+static int _core_close(CoreBackend * backend)
+{
+	g_array_set_size(backend->threads, 0);
+	g_array_set_size(backend->values, 0);
+	g_free(backend->registers);
+	backend->registers = NULL;
+	g_strfreev(backend->names);
+	backend->names = NULL;
+	g_free(backend->sections);
+	backend->sections = NULL;
+	backend->sections_cnt = 0;
+	g_array_set_size(backend->segments, 0);
+	if(backend->a != NULL)
+		asm_delete(backend->a);
+	backend->a = NULL;
+	g_free(backend->name);
+	backend->name = NULL;
+	backend->arch = NULL;
+	backend->layout = NULL;
+	if(backend->mapped != NULL)
+#if GLIB_CHECK_VERSION(2, 22, 0)
+		g_mapped_file_unref(backend->mapped);
+#else
+		g_mapped_file_free(backend->mapped);
+#endif
+	backend->mapped = NULL;
+	backend->data = NULL;
+	backend->size = 0;
+	return 0;
+}
+
+
+/* core_arch_get_name */
+static char const * _core_arch_get_name(CoreBackend * backend)
+{
+	return backend->name;
+}
+
+
+/* core_format_get_name */
+static char const * _core_format_get_name(CoreBackend * backend)
+{
+	return (backend->mapped != NULL) ? "elf" : NULL;
+}
+
+
+/* core_decode */
+static int _core_decode(CoreBackend * backend, off_t offset, size_t size,
+		off_t base, AsmArchInstructionCall ** calls,
+		size_t * calls_cnt)
+{
+	AsmSection const * section;
+	size_t i;
+
+	if(backend->mapped == NULL)
+		return -error_set_code(1, "%s", _("No file is being debugged"));
+	if(backend->a == NULL)
+		return -error_set_code(1, "%s",
+				_("Unknown architecture for this core file"));
+	/* only the executable segments are decoded, as requested */
+	for(i = 0; i < backend->sections_cnt; i++)
+	{
+		section = &backend->sections[i];
+		if(offset >= section->offset
+				&& (size_t)(offset - section->offset)
+				< section->size)
+			break;
+	}
+	if(i == backend->sections_cnt)
+		return -error_set_code(1, "%s",
+				_("Not an executable segment"));
+	size = MIN(size, section->offset + section->size - offset);
+	if(asm_deassemble(backend->a, (char const *)&backend->data[offset],
+				size, calls, calls_cnt) == NULL)
+		return -1;
+	/* the buffer was decoded as if found at the start */
+	for(i = 0; i < *calls_cnt; i++)
+	{
+		(*calls)[i].offset += offset;
+		(*calls)[i].base += base;
+	}
+	return 0;
+}
+
+
+/* core_read_memory */
+static CoreSegment const * _read_memory_segment(CoreBackend * backend,
+		uint64_t address);
+
+static ssize_t _core_read_memory(CoreBackend * backend, uint64_t address,
+		void * buf, size_t size)
+{
+	unsigned char * b = buf;
+	size_t cnt = 0;
+	CoreSegment const * segment;
+	uint64_t offset;
+	size_t n;
+
+	/* possibly across adjacent segments */
+	while(cnt < size && (segment = _read_memory_segment(backend,
+					address + cnt)) != NULL)
+	{
+		offset = address + cnt - segment->address;
+		n = MIN(segment->size - offset, size - cnt);
+		memcpy(&b[cnt], &backend->data[segment->offset + offset], n);
+		cnt += n;
+	}
+	if(cnt == 0 && size > 0)
+		return -error_set_code(1, "%s",
+				_("This address is not in the core file"));
+	return cnt;
+}
+
+static CoreSegment const * _read_memory_segment(CoreBackend * backend,
+		uint64_t address)
+{
+	size_t lo = 0;
+	size_t hi = backend->segments->len;
+	size_t i;
+	CoreSegment const * segment;
+
+	while(lo < hi)
+	{
+		i = lo + (hi - lo) / 2;
+		segment = &g_array_index(backend->segments, CoreSegment, i);
+		if(address < segment->address)
+			hi = i;
+		else if(address - segment->address >= segment->size)
+			lo = i + 1;
+		else
+			return segment;
+	}
+	return NULL;
+}
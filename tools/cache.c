@@ -0,0 +1,1186 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <libintl.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <System.h>
+#include "cache.h"
+#include "../config.h"
+#define _(string) gettext(string)
+
+/* the version of Asm is part of the cache key */
+#ifndef ASM_VERSION
+# define ASM_VERSION	"unknown"
+#endif
+
+
+/* Cache */
+/* private */
+/* types */
+/* on-disk format, in host byte order */
+typedef struct _CacheHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t arch;
+	uint32_t arch_description;
+	uint32_t format;
+	uint32_t format_description;
+	uint32_t registers_cnt;
+	uint32_t instructions_cnt;
+	uint32_t sections_cnt;
+	uint32_t functions_cnt;
+	uint32_t strings_cnt;
+	uint32_t anchors_cnt;
+	uint64_t calls_size;
+	uint64_t pool_size;
+} CacheHeader;
+
+typedef struct _CacheRegister
+{
+	uint32_t name;
+	uint32_t size;
+	uint32_t id;
+	uint32_t flags;
+} CacheRegister;
+
+typedef struct _CacheInstruction
+{
+	uint32_t name;
+	uint32_t padding;
+} CacheInstruction;
+
+typedef struct _CacheSection
+{
+	uint32_t name;
+	uint32_t flags;
+	int64_t offset;
+	uint64_t size;
+	int64_t base;
+	uint32_t anchors_first;
+	uint32_t anchors_cnt;
+	/* where the calls of the section end */
+	uint64_t calls_end;
+} CacheSection;
+
+typedef struct _CacheFunction
+{
+	uint32_t name;
+	uint32_t padding;
+	int64_t offset;
+	int64_t size;
+} CacheFunction;
+
+typedef struct _CacheString
+{
+	uint32_t name;
+	uint32_t padding;
+	int64_t offset;
+	int64_t length;
+} CacheString;
+
+/* where to start reading consecutive calls */
+typedef struct _CacheAnchor
+{
+	int64_t offset;
+	int64_t base;
+	uint64_t position;
+} CacheAnchor;
+
+struct _Cache
+{
+	GMappedFile * mapped;
+	CacheHeader header;
+	CacheSection const * csections;
+	CacheAnchor const * anchors;
+	unsigned char const * calls;
+	char const * pool;
+
+	AsmArchRegister * registers;
+	AsmArchInstruction * instructions;
+	AsmSection * sections;
+	AsmFunction * functions;
+	AsmString * strings;
+};
+
+/* files in the cache directory */
+typedef struct _CacheEntry
+{
+	gchar * path;
+	time_t used;
+	off_t size;
+} CacheEntry;
+
+struct _CacheWriter
+{
+	char * key;
+	AsmCode * code;
+	CacheHeader header;
+
+	/* sections, in order */
+	AsmSection * sections;
+	CacheSection * csections;
+	size_t sections_cnt;
+	size_t current;
+	off_t next;
+	size_t anchor;
+
+	GByteArray * pool;
+	GHashTable * offsets;
+	GByteArray * calls;
+	GArray * anchors;
+};
+
+
+/* constants */
+#define CACHE_MAGIC		"CoDC"
+#define CACHE_VERSION		1
+/* calls between two anchors */
+#define CACHE_ANCHOR		64
+/* NULL strings */
+#define CACHE_NONE		0xffffffff
+/* bounds of the cache directory, evicting the least recently used */
+#define CACHE_FILES_MAX		64
+#define CACHE_SIZE_MAX		(256 * 1024 * 1024)
+
+/* call flags */
+#define CACHE_CALL_PREFIX	0x01000000
+
+
+/* prototypes */
+static int _cache_decode(Cache * cache, CacheSection const * section,
+		off_t offset, off_t end, GArray * calls);
+static void _cache_evict(char const * dirname, char const * key);
+static char * _cache_get_path(char const * key);
+static int _cache_get_size(char const * key, uint64_t * size);
+static char const * _cache_string(Cache * cache, uint32_t name);
+
+static void _cache_writer_call(CacheWriter * writer,
+		AsmArchInstructionCall const * call);
+static void _cache_writer_operand(CacheWriter * writer,
+		AsmArchOperand const * ao);
+static void _cache_writer_section(CacheWriter * writer, size_t section);
+static uint32_t _cache_writer_string(CacheWriter * writer,
+		char const * string);
+static void _cache_writer_word(GByteArray * buffer, uint32_t word);
+static void _cache_writer_words(GByteArray * buffer, uint64_t value);
+
+
+/* public */
+/* functions */
+/* cache_get_key */
+static uint64_t _get_key_hash(unsigned char const * data, size_t size,
+		uint64_t hash);
+
+char * cache_get_key(char const * filename, char const * arch,
+		char const * format)
+{
+	GMappedFile * mapped;
+	GError * error = NULL;
+	uint64_t hash;
+	uint64_t size;
+	gchar * options;
+	char * ret;
+
+	if((mapped = g_mapped_file_new(filename, FALSE, &error)) == NULL)
+	{
+		error_set_code(1, "%s", error->message);
+		g_error_free(error);
+		return NULL;
+	}
+	size = g_mapped_file_get_length(mapped);
+	hash = _get_key_hash((unsigned char const *)g_mapped_file_get_contents(
+				mapped), size, size);
+#if GLIB_CHECK_VERSION(2, 22, 0)
+	g_mapped_file_unref(mapped);
+#else
+	g_mapped_file_free(mapped);
+#endif
+	/* the size of the file is kept to validate the offsets cached */
+	options = g_strdup_printf("%s/%s/%s", (arch != NULL) ? arch : "",
+			(format != NULL) ? format : "", ASM_VERSION);
+	ret = g_strdup_printf("%016" PRIx64 "-%" PRIx64 "-%08" PRIx32, hash,
+			size, (uint32_t)_get_key_hash(
+				(unsigned char const *)options,
+				strlen(options), 0));
+	g_free(options);
+	return ret;
+}
+
+static uint64_t _get_key_hash(unsigned char const * data, size_t size,
+		uint64_t hash)
+{
+	const uint64_t multiplier = 0x9e3779b97f4a7c15ULL;
+	uint64_t word;
+	size_t i;
+
+	/* not cryptographic, but fast enough for large files */
+	for(i = 0; i + sizeof(word) <= size; i += sizeof(word))
+	{
+		memcpy(&word, &data[i], sizeof(word));
+		hash = (hash ^ word) * multiplier;
+		hash ^= hash >> 29;
+	}
+	for(; i < size; i++)
+	{
+		hash = (hash ^ data[i]) * multiplier;
+		hash ^= hash >> 29;
+	}
+	hash ^= hash >> 32;
+	return hash * multiplier;
+}
+
+
+/* cache_open */
+static int _open_check(Cache * cache, size_t size, uint64_t filesize);
+static int _open_check_anchors(CacheSection const * section,
+		CacheAnchor const * anchors, uint64_t * calls);
+static int _open_check_offset(int64_t offset, int64_t size,
+		uint64_t filesize);
+
+Cache * cache_open(char const * key)
+{
+	Cache * cache;
+	char * path;
+	uint64_t filesize;
+	char const * data;
+	size_t size;
+	size_t pos;
+	size_t i;
+	CacheRegister const * cr;
+	CacheInstruction const * ci;
+	CacheFunction const * cf;
+	CacheString const * cs;
+
+	if(_cache_get_size(key, &filesize) != 0
+			|| (path = _cache_get_path(key)) == NULL)
+		return NULL;
+	if((cache = object_new(sizeof(*cache))) == NULL)
+	{
+		g_free(path);
+		return NULL;
+	}
+	memset(cache, 0, sizeof(*cache));
+	if((cache->mapped = g_mapped_file_new(path, FALSE, NULL)) == NULL)
+	{
+		/* not cached yet */
+		g_free(path);
+		object_delete(cache);
+		return NULL;
+	}
+	data = g_mapped_file_get_contents(cache->mapped);
+	size = g_mapped_file_get_length(cache->mapped);
+	if(size >= sizeof(cache->header))
+		memcpy(&cache->header, data, sizeof(cache->header));
+	if(size < sizeof(cache->header)
+			|| _open_check(cache, size, filesize) != 0)
+	{
+		/* drop this cache for good */
+		cache_close(cache);
+		g_unlink(path);
+		g_free(path);
+		return NULL;
+	}
+	/* keep track of its use for the eviction */
+	g_utime(path, NULL);
+	g_free(path);
+	/* locate every table */
+	pos = sizeof(cache->header);
+	cr = (CacheRegister const *)&data[pos];
+	pos += sizeof(*cr) * cache->header.registers_cnt;
+	ci = (CacheInstruction const *)&data[pos];
+	pos += sizeof(*ci) * cache->header.instructions_cnt;
+	cache->csections = (CacheSection const *)&data[pos];
+	pos += sizeof(*cache->csections) * cache->header.sections_cnt;
+	cf = (CacheFunction const *)&data[pos];
+	pos += sizeof(*cf) * cache->header.functions_cnt;
+	cs = (CacheString const *)&data[pos];
+	pos += sizeof(*cs) * cache->header.strings_cnt;
+	cache->anchors = (CacheAnchor const *)&data[pos];
+	pos += sizeof(*cache->anchors) * cache->header.anchors_cnt;
+	cache->calls = (unsigned char const *)&data[pos];
+	pos += (cache->header.calls_size + 7) & ~7;
+	cache->pool = &data[pos];
+	/* the tables handed out; strings point to the pool */
+	cache->registers = g_new0(AsmArchRegister,
+			cache->header.registers_cnt + 1);
+	for(i = 0; i < cache->header.registers_cnt; i++)
+	{
+		cache->registers[i].name = _cache_string(cache, cr[i].name);
+		cache->registers[i].size = cr[i].size;
+		cache->registers[i].id = cr[i].id;
+		cache->registers[i].flags = cr[i].flags;
+	}
+	cache->instructions = g_new0(AsmArchInstruction,
+			cache->header.instructions_cnt + 1);
+	for(i = 0; i < cache->header.instructions_cnt; i++)
+		cache->instructions[i].name = _cache_string(cache, ci[i].name);
+	cache->sections = g_new0(AsmSection, cache->header.sections_cnt + 1);
+	for(i = 0; i < cache->header.sections_cnt; i++)
+	{
+		cache->sections[i].id = i;
+		cache->sections[i].name = _cache_string(cache,
+				cache->csections[i].name);
+		cache->sections[i].flags = cache->csections[i].flags;
+		cache->sections[i].offset = cache->csections[i].offset;
+		cache->sections[i].size = cache->csections[i].size;
+		cache->sections[i].base = cache->csections[i].base;
+	}
+	cache->functions = g_new0(AsmFunction,
+			cache->header.functions_cnt + 1);
+	for(i = 0; i < cache->header.functions_cnt; i++)
+	{
+		cache->functions[i].id = i;
+		cache->functions[i].name = _cache_string(cache, cf[i].name);
+		cache->functions[i].offset = cf[i].offset;
+		cache->functions[i].size = cf[i].size;
+	}
+	cache->strings = g_new0(AsmString, cache->header.strings_cnt + 1);
+	for(i = 0; i < cache->header.strings_cnt; i++)
+	{
+		cache->strings[i].id = i;
+		cache->strings[i].name = _cache_string(cache, cs[i].name);
+		cache->strings[i].offset = cs[i].offset;
+		cache->strings[i].length = cs[i].length;
+	}
+	return cache;
+}
+
+static int _open_check(Cache * cache, size_t size, uint64_t filesize)
+{
+	CacheHeader const * header = &cache->header;
+	uint64_t total;
+	char const * data;
+	CacheSection const * sections;
+	CacheFunction const * functions;
+	CacheString const * strings;
+	CacheAnchor const * anchors;
+	uint64_t calls = 0;
+	size_t i;
+
+	if(memcmp(header->magic, CACHE_MAGIC, sizeof(header->magic)) != 0
+			|| header->version != CACHE_VERSION)
+		return -1;
+	total = sizeof(*header)
+		+ sizeof(CacheRegister) * (uint64_t)header->registers_cnt
+		+ sizeof(CacheInstruction) * (uint64_t)header->instructions_cnt
+		+ sizeof(CacheSection) * (uint64_t)header->sections_cnt
+		+ sizeof(CacheFunction) * (uint64_t)header->functions_cnt
+		+ sizeof(CacheString) * (uint64_t)header->strings_cnt
+		+ sizeof(CacheAnchor) * (uint64_t)header->anchors_cnt;
+	if(header->calls_size > UINT64_MAX / 2 || header->pool_size == 0
+			|| header->pool_size > UINT64_MAX / 2)
+		return -1;
+	total += ((header->calls_size + 7) & ~7) + header->pool_size;
+	if(total != size)
+		return -1;
+	/* every string in the pool must be terminated */
+	data = g_mapped_file_get_contents(cache->mapped);
+	if(data[size - 1] != '\0')
+		return -1;
+	data += sizeof(*header)
+		+ sizeof(CacheRegister) * header->registers_cnt
+		+ sizeof(CacheInstruction) * header->instructions_cnt;
+	sections = (CacheSection const *)data;
+	functions = (CacheFunction const *)&sections[header->sections_cnt];
+	strings = (CacheString const *)&functions[header->functions_cnt];
+	anchors = (CacheAnchor const *)&strings[header->strings_cnt];
+	/* every offset must be within the file */
+	for(i = 0; i < header->functions_cnt; i++)
+		if(functions[i].offset >= 0 && _open_check_offset(
+					functions[i].offset,
+					MAX(functions[i].size, 0), filesize) != 0)
+			return -1;
+	for(i = 0; i < header->strings_cnt; i++)
+		if(strings[i].offset >= 0 && _open_check_offset(
+					strings[i].offset,
+					MAX(strings[i].length, 0), filesize) != 0)
+			return -1;
+	/* the sections must refer to valid anchors and calls, in order */
+	for(i = 0; i < header->sections_cnt; i++)
+	{
+		if(sections[i].size > INT64_MAX
+				|| _open_check_offset(sections[i].offset,
+					sections[i].size, filesize) != 0
+				|| (uint64_t)sections[i].anchors_first
+				+ sections[i].anchors_cnt > header->anchors_cnt
+				|| sections[i].calls_end < calls
+				|| sections[i].calls_end > header->calls_size
+				|| _open_check_anchors(&sections[i], anchors,
+					&calls) != 0)
+			return -1;
+		calls = sections[i].calls_end;
+	}
+	return 0;
+}
+
+static int _open_check_anchors(CacheSection const * section,
+		CacheAnchor const * anchors, uint64_t * calls)
+{
+	CacheAnchor const * anchor;
+	int64_t offset = section->offset;
+	uint32_t i;
+
+	/* the anchors follow each other within the section and its calls */
+	for(i = 0; i < section->anchors_cnt; i++)
+	{
+		anchor = &anchors[section->anchors_first + i];
+		if(anchor->offset < offset || (uint64_t)(anchor->offset
+					- section->offset) >= section->size
+				|| anchor->position < *calls
+				|| anchor->position >= section->calls_end)
+			return -1;
+		offset = anchor->offset;
+		*calls = anchor->position;
+	}
+	return 0;
+}
+
+static int _open_check_offset(int64_t offset, int64_t size,
+		uint64_t filesize)
+{
+	if(offset < 0 || size < 0 || (uint64_t)offset > filesize
+			|| (uint64_t)size > filesize - offset)
+		return -1;
+	return 0;
+}
+
+
+/* cache_close */
+void cache_close(Cache * cache)
+{
+	g_free(cache->registers);
+	g_free(cache->instructions);
+	g_free(cache->sections);
+	g_free(cache->functions);
+	g_free(cache->strings);
+#if GLIB_CHECK_VERSION(2, 22, 0)
+	g_mapped_file_unref(cache->mapped);
+#else
+	g_mapped_file_free(cache->mapped);
+#endif
+	object_delete(cache);
+}
+
+
+/* accessors */
+/* cache_get_arch */
+char const * cache_get_arch(Cache * cache)
+{
+	return _cache_string(cache, cache->header.arch);
+}
+
+
+/* cache_get_arch_description */
+char const * cache_get_arch_description(Cache * cache)
+{
+	return _cache_string(cache, cache->header.arch_description);
+}
+
+
+/* cache_get_arch_instructions */
+AsmArchInstruction const * cache_get_arch_instructions(Cache * cache)
+{
+	return cache->instructions;
+}
+
+
+/* cache_get_arch_registers */
+AsmArchRegister const * cache_get_arch_registers(Cache * cache)
+{
+	return cache->registers;
+}
+
+
+/* cache_get_format */
+char const * cache_get_format(Cache * cache)
+{
+	return _cache_string(cache, cache->header.format);
+}
+
+
+/* cache_get_format_description */
+char const * cache_get_format_description(Cache * cache)
+{
+	return _cache_string(cache, cache->header.format_description);
+}
+
+
+/* cache_get_functions */
+void cache_get_functions(Cache * cache, AsmFunction ** functions,
+		size_t * functions_cnt)
+{
+	*functions = cache->functions;
+	*functions_cnt = cache->header.functions_cnt;
+}
+
+
+/* cache_get_sections */
+void cache_get_sections(Cache * cache, AsmSection ** sections,
+		size_t * sections_cnt)
+{
+	*sections = cache->sections;
+	*sections_cnt = cache->header.sections_cnt;
+}
+
+
+/* cache_get_strings */
+void cache_get_strings(Cache * cache, AsmString ** strings,
+		size_t * strings_cnt)
+{
+	*strings = cache->strings;
+	*strings_cnt = cache->header.strings_cnt;
+}
+
+
+/* useful */
+/* cache_decode_at */
+int cache_decode_at(Cache * cache, off_t offset, size_t size,
+		AsmArchInstructionCall ** calls, size_t * calls_cnt)
+{
+	CacheSection const * section;
+	GArray * array;
+	size_t i;
+
+	for(i = 0; i < cache->header.sections_cnt; i++)
+	{
+		section = &cache->csections[i];
+		if(offset >= section->offset
+				&& (uint64_t)(offset - section->offset)
+				< section->size)
+			break;
+	}
+	if(i == cache->header.sections_cnt)
+		return -error_set_code(1, "%s", _("No code at this offset"));
+	array = g_array_new(FALSE, FALSE, sizeof(**calls));
+	if(_cache_decode(cache, section, offset, offset + size, array) != 0)
+	{
+		g_array_free(array, TRUE);
+		return -1;
+	}
+	*calls_cnt = array->len;
+	*calls = (AsmArchInstructionCall *)g_array_free(array, FALSE);
+	return 0;
+}
+
+
+/* cache_decode_section */
+int cache_decode_section(Cache * cache, AsmSection const * section,
+		AsmArchInstructionCall ** calls, size_t * calls_cnt)
+{
+	CacheSection const * cs;
+	GArray * array;
+
+	if(section < cache->sections
+			|| section >= &cache->sections[
+			cache->header.sections_cnt])
+		return -error_set_code(1, "%s", _("Unknown section"));
+	cs = &cache->csections[section - cache->sections];
+	array = g_array_new(FALSE, FALSE, sizeof(**calls));
+	if(_cache_decode(cache, cs, cs->offset, cs->offset + cs->size, array)
+			!= 0)
+	{
+		g_array_free(array, TRUE);
+		return -1;
+	}
+	*calls_cnt = array->len;
+	*calls = (AsmArchInstructionCall *)g_array_free(array, FALSE);
+	return 0;
+}
+
+
+/* CacheWriter */
+/* public */
+/* functions */
+/* cache_writer_new */
+CacheWriter * cache_writer_new(char const * key, AsmCode * code)
+{
+	CacheWriter * writer;
+	CacheHeader * header;
+
+	if((writer = object_new(sizeof(*writer))) == NULL)
+		return NULL;
+	writer->key = g_strdup(key);
+	writer->code = code;
+	asmcode_get_sections(code, &writer->sections, &writer->sections_cnt);
+	writer->csections = g_new0(CacheSection, writer->sections_cnt + 1);
+	writer->current = 0;
+	writer->next = -1;
+	writer->anchor = 0;
+	writer->pool = g_byte_array_new();
+	writer->offsets = g_hash_table_new_full(g_str_hash, g_str_equal,
+			g_free, NULL);
+	writer->calls = g_byte_array_new();
+	writer->anchors = g_array_new(FALSE, FALSE, sizeof(CacheAnchor));
+	_cache_writer_section(writer, 0);
+	header = &writer->header;
+	memset(header, 0, sizeof(*header));
+	memcpy(header->magic, CACHE_MAGIC, sizeof(header->magic));
+	header->version = CACHE_VERSION;
+	header->arch = _cache_writer_string(writer, asmcode_get_arch(code));
+	header->arch_description = _cache_writer_string(writer,
+			asmcode_get_arch_description(code));
+	header->format = _cache_writer_string(writer, asmcode_get_format(code));
+	header->format_description = _cache_writer_string(writer,
+			asmcode_get_format_description(code));
+	return writer;
+}
+
+
+/* cache_writer_delete */
+void cache_writer_delete(CacheWriter * writer)
+{
+	g_free(writer->key);
+	g_free(writer->csections);
+	g_byte_array_free(writer->pool, TRUE);
+	g_hash_table_destroy(writer->offsets);
+	g_byte_array_free(writer->calls, TRUE);
+	g_array_free(writer->anchors, TRUE);
+	object_delete(writer);
+}
+
+
+/* useful */
+/* cache_writer_append */
+int cache_writer_append(CacheWriter * writer, AsmSection const * section,
+		AsmArchInstructionCall const * calls, size_t calls_cnt)
+{
+	CacheAnchor ca;
+	size_t i;
+
+	if(section < &writer->sections[writer->current]
+			|| section >= &writer->sections[writer->sections_cnt])
+		return -error_set_code(1, "%s", _("Unknown section"));
+	while(section != &writer->sections[writer->current])
+		_cache_writer_section(writer, writer->current + 1);
+	for(i = 0; i < calls_cnt; i++)
+	{
+		/* anchor regularly and wherever the stream jumps */
+		if(writer->anchor++ % CACHE_ANCHOR == 0
+				|| (off_t)calls[i].offset != writer->next)
+		{
+			ca.offset = calls[i].offset;
+			ca.base = calls[i].base;
+			ca.position = writer->calls->len;
+			g_array_append_val(writer->anchors, ca);
+			writer->anchor = 1;
+		}
+		_cache_writer_call(writer, &calls[i]);
+		writer->next = calls[i].offset + calls[i].size;
+	}
+	return 0;
+}
+
+/* cache_writer_save */
+int cache_writer_save(CacheWriter * writer)
+{
+	int ret;
+	CacheHeader header;
+	GByteArray * out;
+	AsmArchRegister const * registers;
+	AsmArchInstruction const * instructions;
+	AsmFunction * functions;
+	AsmString * strings;
+	size_t functions_cnt;
+	size_t strings_cnt;
+	CacheRegister cr;
+	CacheInstruction ci;
+	CacheFunction cf;
+	CacheString cs;
+	size_t i;
+	char * path;
+	gchar * dirname;
+	GError * error = NULL;
+
+	if((path = _cache_get_path(writer->key)) == NULL)
+		return -error_set_code(1, "%s", _("Invalid cache key"));
+	/* close every section left */
+	while(writer->current < writer->sections_cnt)
+		_cache_writer_section(writer, writer->current + 1);
+	header = writer->header;
+	out = g_byte_array_new();
+	g_byte_array_append(out, (guint8 *)&header, sizeof(header));
+	/* registers */
+	if((registers = asmcode_get_arch_registers(writer->code)) != NULL)
+		for(i = 0; registers[i].name != NULL; i++)
+		{
+			cr.name = _cache_writer_string(writer,
+					registers[i].name);
+			cr.size = registers[i].size;
+			cr.id = registers[i].id;
+			cr.flags = registers[i].flags;
+			g_byte_array_append(out, (guint8 *)&cr, sizeof(cr));
+			header.registers_cnt++;
+		}
+	/* instructions */
+	memset(&ci, 0, sizeof(ci));
+	if((instructions = asmcode_get_arch_instructions(writer->code))
+			!= NULL)
+		for(i = 0; instructions[i].name != NULL; i++)
+		{
+			ci.name = _cache_writer_string(writer,
+					instructions[i].name);
+			g_byte_array_append(out, (guint8 *)&ci, sizeof(ci));
+			header.instructions_cnt++;
+		}
+	/* sections */
+	header.sections_cnt = writer->sections_cnt;
+	g_byte_array_append(out, (guint8 *)writer->csections,
+			sizeof(*writer->csections) * writer->sections_cnt);
+	/* functions */
+	asmcode_get_functions(writer->code, &functions, &functions_cnt);
+	header.functions_cnt = functions_cnt;
+	memset(&cf, 0, sizeof(cf));
+	for(i = 0; i < functions_cnt; i++)
+	{
+		cf.name = _cache_writer_string(writer, functions[i].name);
+		cf.offset = functions[i].offset;
+		cf.size = functions[i].size;
+		g_byte_array_append(out, (guint8 *)&cf, sizeof(cf));
+	}
+	/* strings */
+	asmcode_get_strings(writer->code, &strings, &strings_cnt);
+	header.strings_cnt = strings_cnt;
+	memset(&cs, 0, sizeof(cs));
+	for(i = 0; i < strings_cnt; i++)
+	{
+		cs.name = _cache_writer_string(writer, strings[i].name);
+		cs.offset = strings[i].offset;
+		cs.length = strings[i].length;
+		g_byte_array_append(out, (guint8 *)&cs, sizeof(cs));
+	}
+	/* anchors, calls and the strings they refer to */
+	header.anchors_cnt = writer->anchors->len;
+	g_byte_array_append(out, (guint8 *)writer->anchors->data,
+			sizeof(CacheAnchor) * writer->anchors->len);
+	header.calls_size = writer->calls->len;
+	g_byte_array_append(out, writer->calls->data, writer->calls->len);
+	while(out->len % 8 != 0)
+		g_byte_array_append(out, (guint8 *)"", 1);
+	if(writer->pool->len == 0)
+		g_byte_array_append(writer->pool, (guint8 *)"", 1);
+	header.pool_size = writer->pool->len;
+	g_byte_array_append(out, writer->pool->data, writer->pool->len);
+	memcpy(out->data, &header, sizeof(header));
+	/* write atomically */
+	dirname = g_path_get_dirname(path);
+	if(g_mkdir_with_parents(dirname, 0700) != 0)
+		ret = -error_set_code(1, "%s: %s", dirname, g_strerror(errno));
+	else if(g_file_set_contents(path, (gchar *)out->data, out->len,
+				&error) != TRUE)
+	{
+		ret = -error_set_code(1, "%s", error->message);
+		g_error_free(error);
+	}
+	else
+	{
+		_cache_evict(dirname, writer->key);
+		ret = 0;
+	}
+	g_free(dirname);
+	g_byte_array_free(out, TRUE);
+	g_free(path);
+	return ret;
+}
+
+
+/* private */
+/* functions */
+/* cache_decode */
+static int _decode_call(Cache * cache, uint64_t * position, uint64_t end,
+		AsmArchInstructionCall * call);
+static int _decode_operand(Cache * cache, uint64_t * position, uint64_t end,
+		AsmArchOperand * ao);
+static int _decode_word(Cache * cache, uint64_t * position, uint64_t end,
+		uint32_t * word);
+static int _decode_words(Cache * cache, uint64_t * position, uint64_t end,
+		uint64_t * value);
+
+static int _cache_decode(Cache * cache, CacheSection const * section,
+		off_t offset, off_t end, GArray * calls)
+{
+	CacheAnchor const * anchors = &cache->anchors[section->anchors_first];
+	size_t lo = 0;
+	size_t hi = section->anchors_cnt;
+	size_t mid;
+	uint64_t position;
+	uint64_t limit;
+	AsmArchInstructionCall call;
+
+	if(section->anchors_cnt == 0)
+		return 0;
+	/* find the last anchor before the offset */
+	while(hi - lo > 1)
+	{
+		mid = lo + (hi - lo) / 2;
+		if(anchors[mid].offset <= offset)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	for(; lo < section->anchors_cnt && anchors[lo].offset < end; lo++)
+	{
+		position = anchors[lo].position;
+		limit = (lo + 1 < section->anchors_cnt)
+			? anchors[lo + 1].position : section->calls_end;
+		call.offset = anchors[lo].offset;
+		call.base = anchors[lo].base;
+		while(position < limit && (off_t)call.offset < end)
+		{
+			if(_decode_call(cache, &position, limit, &call) != 0)
+				return -1;
+			if((off_t)call.offset >= offset)
+				g_array_append_val(calls, call);
+			call.offset += call.size;
+			call.base += call.size;
+		}
+	}
+	return 0;
+}
+
+static int _decode_call(Cache * cache, uint64_t * position, uint64_t end,
+		AsmArchInstructionCall * call)
+{
+	off_t base = call->base;
+	size_t offset = call->offset;
+	uint32_t word;
+	uint32_t i;
+
+	memset(call, 0, sizeof(*call));
+	call->base = base;
+	call->offset = offset;
+	if(_decode_word(cache, position, end, &word) != 0)
+		return -1;
+	call->name = _cache_string(cache, word);
+	if(_decode_word(cache, position, end, &word) != 0)
+		return -1;
+	call->size = word & 0xffff;
+	call->operands_cnt = (word >> 16) & 0xff;
+	if(call->operands_cnt > sizeof(call->operands)
+			/ sizeof(*call->operands))
+		return -error_set_code(1, "%s", _("Corrupted cache"));
+	if(word & CACHE_CALL_PREFIX)
+	{
+		if(_decode_word(cache, position, end, &word) != 0)
+			return -1;
+		call->prefix = _cache_string(cache, word);
+	}
+	for(i = 0; i < call->operands_cnt; i++)
+		if(_decode_operand(cache, position, end, &call->operands[i])
+				!= 0)
+			return -1;
+	return 0;
+}
+
+static int _decode_operand(Cache * cache, uint64_t * position, uint64_t end,
+		AsmArchOperand * ao)
+{
+	uint32_t word;
+	uint64_t value;
+
+	if(_decode_word(cache, position, end, &ao->definition) != 0
+			|| _decode_word(cache, position, end, &word) != 0)
+		return -1;
+	switch(AO_GET_TYPE(ao->definition))
+	{
+		case AOT_REGISTER:
+			ao->value._register.name = _cache_string(cache, word);
+			break;
+		case AOT_DREGISTER:
+			ao->value.dregister.name = _cache_string(cache, word);
+			if(_decode_words(cache, position, end, &value) != 0)
+				return -1;
+			ao->value.dregister.offset = value;
+			break;
+		case AOT_DREGISTER2:
+			ao->value.dregister2.name = _cache_string(cache, word);
+			if(_decode_word(cache, position, end, &word) != 0)
+				return -1;
+			ao->value.dregister2.name2 = _cache_string(cache,
+					word);
+			break;
+		default:
+			ao->value.immediate.name = _cache_string(cache, word);
+			if(_decode_words(cache, position, end, &value) != 0
+					|| _decode_word(cache, position, end,
+						&word) != 0)
+				return -1;
+			ao->value.immediate.value = value;
+			ao->value.immediate.negative = word;
+			break;
+	}
+	return 0;
+}
+
+static int _decode_word(Cache * cache, uint64_t * position, uint64_t end,
+		uint32_t * word)
+{
+	if(*position + sizeof(*word) > end)
+		return -error_set_code(1, "%s", _("Corrupted cache"));
+	memcpy(word, &cache->calls[*position], sizeof(*word));
+	*position += sizeof(*word);
+	return 0;
+}
+
+static int _decode_words(Cache * cache, uint64_t * position, uint64_t end,
+		uint64_t * value)
+{
+	if(*position + sizeof(*value) > end)
+		return -error_set_code(1, "%s", _("Corrupted cache"));
+	memcpy(value, &cache->calls[*position], sizeof(*value));
+	*position += sizeof(*value);
+	return 0;
+}
+
+
+/* cache_evict */
+static int _evict_on_compare(void const * a, void const * b);
+
+static void _cache_evict(char const * dirname, char const * key)
+{
+	GDir * dir;
+	char const * name;
+	GArray * entries;
+	CacheEntry entry;
+	struct stat st;
+	uint64_t total = 0;
+	size_t kept = 0;
+	size_t i;
+
+	if((dir = g_dir_open(dirname, 0, NULL)) == NULL)
+		return;
+	entries = g_array_new(FALSE, FALSE, sizeof(entry));
+	while((name = g_dir_read_name(dir)) != NULL)
+	{
+		entry.path = g_build_filename(dirname, name, NULL);
+		if(g_lstat(entry.path, &st) != 0 || !S_ISREG(st.st_mode))
+		{
+			g_free(entry.path);
+			continue;
+		}
+		total += st.st_size;
+		/* never remove the new one */
+		if(strcmp(name, key) == 0)
+		{
+			g_free(entry.path);
+			kept++;
+			continue;
+		}
+		entry.used = st.st_mtime;
+		entry.size = st.st_size;
+		g_array_append_val(entries, entry);
+	}
+	g_dir_close(dir);
+	/* remove the least recently used first */
+	qsort(entries->data, entries->len, sizeof(entry), _evict_on_compare);
+	for(i = 0; i < entries->len; i++)
+	{
+		entry = g_array_index(entries, CacheEntry, i);
+		if((entries->len - i + kept > CACHE_FILES_MAX
+					|| total > CACHE_SIZE_MAX)
+				&& g_unlink(entry.path) == 0)
+			total -= entry.size;
+		g_free(entry.path);
+	}
+	g_array_free(entries, TRUE);
+}
+
+static int _evict_on_compare(void const * a, void const * b)
+{
+	CacheEntry const * ea = a;
+	CacheEntry const * eb = b;
+
+	return (ea->used < eb->used) ? -1 : ((ea->used > eb->used) ? 1 : 0);
+}
+
+
+/* cache_get_path */
+static char * _cache_get_path(char const * key)
+{
+	char const * dir;
+
+	if(key == NULL || strchr(key, '/') != NULL
+			|| (dir = g_get_user_cache_dir()) == NULL)
+		return NULL;
+	return g_build_filename(dir, PACKAGE, "asm", key, NULL);
+}
+
+
+/* cache_get_size */
+static int _cache_get_size(char const * key, uint64_t * size)
+{
+	char const * p;
+	char * q;
+
+	/* the size of the file follows its hash in the key */
+	if(key == NULL || (p = strchr(key, '-')) == NULL)
+		return -1;
+	errno = 0;
+	*size = strtoull(++p, &q, 16);
+	if(errno != 0 || q == p || *q != '-')
+		return -1;
+	return 0;
+}
+
+
+/* cache_string */
+static char const * _cache_string(Cache * cache, uint32_t name)
+{
+	if(name == CACHE_NONE || name >= cache->header.pool_size)
+		return NULL;
+	return &cache->pool[name];
+}
+
+
+/* cache_writer_call */
+static void _cache_writer_call(CacheWriter * writer,
+		AsmArchInstructionCall const * call)
+{
+	GByteArray * buffer = writer->calls;
+	uint32_t i;
+
+	_cache_writer_word(buffer, _cache_writer_string(writer, call->name));
+	_cache_writer_word(buffer, (call->size & 0xffff)
+			| ((call->operands_cnt & 0xff) << 16)
+			| ((call->prefix != NULL) ? CACHE_CALL_PREFIX : 0));
+	if(call->prefix != NULL)
+		_cache_writer_word(buffer, _cache_writer_string(writer,
+					call->prefix));
+	for(i = 0; i < call->operands_cnt; i++)
+		_cache_writer_operand(writer, &call->operands[i]);
+}
+
+
+/* cache_writer_operand */
+static void _cache_writer_operand(CacheWriter * writer,
+		AsmArchOperand const * ao)
+{
+	GByteArray * buffer = writer->calls;
+	char const * name;
+
+	_cache_writer_word(buffer, ao->definition);
+	switch(AO_GET_TYPE(ao->definition))
+	{
+		case AOT_REGISTER:
+			name = ao->value._register.name;
+			_cache_writer_word(buffer, _cache_writer_string(writer,
+						name));
+			break;
+		case AOT_DREGISTER:
+			name = ao->value.dregister.name;
+			_cache_writer_word(buffer, _cache_writer_string(writer,
+						name));
+			_cache_writer_words(buffer, ao->value.dregister.offset);
+			break;
+		case AOT_DREGISTER2:
+			name = ao->value.dregister2.name;
+			_cache_writer_word(buffer, _cache_writer_string(writer,
+						name));
+			name = ao->value.dregister2.name2;
+			_cache_writer_word(buffer, _cache_writer_string(writer,
+						name));
+			break;
+		default:
+			name = ao->value.immediate.name;
+			_cache_writer_word(buffer, _cache_writer_string(writer,
+						name));
+			_cache_writer_words(buffer, ao->value.immediate.value);
+			_cache_writer_word(buffer,
+					ao->value.immediate.negative);
+			break;
+	}
+}
+
+
+/* cache_writer_section */
+static void _cache_writer_section(CacheWriter * writer, size_t section)
+{
+	CacheSection * cs;
+
+	/* close the current section */
+	if(writer->current < writer->sections_cnt)
+	{
+		cs = &writer->csections[writer->current];
+		cs->anchors_cnt = writer->anchors->len - cs->anchors_first;
+		cs->calls_end = writer->calls->len;
+	}
+	writer->current = section;
+	writer->next = -1;
+	writer->anchor = 0;
+	if(section >= writer->sections_cnt)
+		return;
+	cs = &writer->csections[section];
+	cs->name = _cache_writer_string(writer, writer->sections[section].name);
+	cs->flags = writer->sections[section].flags;
+	cs->offset = writer->sections[section].offset;
+	cs->size = writer->sections[section].size;
+	cs->base = writer->sections[section].base;
+	cs->anchors_first = writer->anchors->len;
+}
+
+
+/* cache_writer_string */
+static uint32_t _cache_writer_string(CacheWriter * writer,
+		char const * string)
+{
+	gpointer p;
+	uint32_t ret;
+
+	if(string == NULL)
+		return CACHE_NONE;
+	/* every string is only stored once */
+	if((p = g_hash_table_lookup(writer->offsets, string)) != NULL)
+		return GPOINTER_TO_UINT(p) - 1;
+	ret = writer->pool->len;
+	g_byte_array_append(writer->pool, (guint8 const *)string,
+			strlen(string) + 1);
+	g_hash_table_insert(writer->offsets, g_strdup(string),
+			GUINT_TO_POINTER(ret + 1));
+	return ret;
+}
+
+
+/* cache_writer_word */
+static void _cache_writer_word(GByteArray * buffer, uint32_t word)
+{
+	g_byte_array_append(buffer, (guint8 *)&word, sizeof(word));
+}
+
+
+/* cache_writer_words */
+static void _cache_writer_words(GByteArray * buffer, uint64_t value)
+{
+	g_byte_array_append(buffer, (guint8 *)&value, sizeof(value));
+}
@@ -0,0 +1,81 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+
+#ifndef CODER_CACHE_H
+# define CODER_CACHE_H
+
+# include <sys/types.h>
+# include <Devel/Asm.h>
+
+
+/* Cache */
+/* types */
+typedef struct _Cache Cache;
+typedef struct _CacheWriter CacheWriter;
+
+
+/* functions */
+char * cache_get_key(char const * filename, char const * arch,
+		char const * format);
+
+Cache * cache_open(char const * key);
+void cache_close(Cache * cache);
+
+/* accessors */
+char const * cache_get_arch(Cache * cache);
+char const * cache_get_arch_description(Cache * cache);
+AsmArchInstruction const * cache_get_arch_instructions(Cache * cache);
+AsmArchRegister const * cache_get_arch_registers(Cache * cache);
+char const * cache_get_format(Cache * cache);
+char const * cache_get_format_description(Cache * cache);
+void cache_get_functions(Cache * cache, AsmFunction ** functions,
+		size_t * functions_cnt);
+void cache_get_sections(Cache * cache, AsmSection ** sections,
+		size_t * sections_cnt);
+void cache_get_strings(Cache * cache, AsmString ** strings,
+		size_t * strings_cnt);
+
+/* useful */
+/* the names in the calls remain valid until the cache is closed */
+int cache_decode_at(Cache * cache, off_t offset, size_t size,
+		AsmArchInstructionCall ** calls, size_t * calls_cnt);
+int cache_decode_section(Cache * cache, AsmSection const * section,
+		AsmArchInstructionCall ** calls, size_t * calls_cnt);
+
+
+/* CacheWriter */
+/* functions */
+CacheWriter * cache_writer_new(char const * key, AsmCode * code);
+void cache_writer_delete(CacheWriter * writer);
+
+/* useful */
+/* the sections must be appended in order */
+int cache_writer_append(CacheWriter * writer, AsmSection const * section,
+		AsmArchInstructionCall const * calls, size_t calls_cnt);
+int cache_writer_save(CacheWriter * writer);
+
+#endif /* !CODER_CACHE_H */
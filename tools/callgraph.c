@@ -0,0 +1,347 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+#include <stdlib.h>
+#include <libintl.h>
+#include <glib.h>
+#include <System.h>
+#include "callgraph.h"
+#define _(string) gettext(string)
+
+
+/* CallGraph */
+/* private */
+/* types */
+struct _CallGraph
+{
+	AsmFunction const * functions;
+	size_t functions_cnt;
+
+	/* lookups: functions with an offset sorted by offset, names */
+	uint32_t * order;
+	size_t order_cnt;
+	GHashTable * names;
+
+	/* edges recorded, as (caller << 32) | callee */
+	GArray * edges;
+
+	/* compressed sparse rows, in both directions */
+	size_t * callees_index;
+	uint32_t * callees;
+	size_t * callers_index;
+	uint32_t * callers;
+	size_t edges_cnt;
+};
+
+
+/* prototypes */
+static size_t _callgraph_callee(CallGraph * graph,
+		AsmArchInstructionCall const * call);
+static size_t _callgraph_lookup(CallGraph const * graph, off_t offset,
+		int exact);
+
+/* callbacks */
+static int _callgraph_on_compare_edges(void const * a, void const * b);
+static int _callgraph_on_compare_order(void const * a, void const * b,
+		void * data);
+
+
+/* public */
+/* functions */
+/* callgraph_new */
+CallGraph * callgraph_new(AsmFunction const * functions, size_t functions_cnt)
+{
+	CallGraph * graph;
+	size_t i;
+
+	if(functions_cnt > UINT32_MAX)
+	{
+		error_set_code(1, "%s", _("Too many functions"));
+		return NULL;
+	}
+	if((graph = object_new(sizeof(*graph))) == NULL)
+		return NULL;
+	graph->functions = functions;
+	graph->functions_cnt = functions_cnt;
+	graph->order = g_new(uint32_t, functions_cnt + 1);
+	graph->order_cnt = 0;
+	graph->names = g_hash_table_new(g_str_hash, g_str_equal);
+	for(i = 0; i < functions_cnt; i++)
+	{
+		if(functions[i].offset >= 0)
+			graph->order[graph->order_cnt++] = i;
+		/* the first definition wins */
+		if(functions[i].name != NULL
+				&& g_hash_table_lookup(graph->names,
+					functions[i].name) == NULL)
+			g_hash_table_insert(graph->names,
+					(gpointer)functions[i].name,
+					GSIZE_TO_POINTER(i + 1));
+	}
+	g_qsort_with_data(graph->order, graph->order_cnt,
+			sizeof(*graph->order), _callgraph_on_compare_order,
+			graph);
+	graph->edges = g_array_new(FALSE, FALSE, sizeof(uint64_t));
+	graph->callees_index = NULL;
+	graph->callees = NULL;
+	graph->callers_index = NULL;
+	graph->callers = NULL;
+	graph->edges_cnt = 0;
+	return graph;
+}
+
+
+/* callgraph_delete */
+void callgraph_delete(CallGraph * graph)
+{
+	g_free(graph->order);
+	g_hash_table_destroy(graph->names);
+	if(graph->edges != NULL)
+		g_array_free(graph->edges, TRUE);
+	g_free(graph->callees_index);
+	g_free(graph->callees);
+	g_free(graph->callers_index);
+	g_free(graph->callers);
+	object_delete(graph);
+}
+
+
+/* accessors */
+/* callgraph_get_callees */
+size_t callgraph_get_callees(CallGraph const * graph, size_t function,
+		uint32_t const ** callees)
+{
+	if(graph->callees_index == NULL || function >= graph->functions_cnt)
+	{
+		*callees = NULL;
+		return 0;
+	}
+	*callees = &graph->callees[graph->callees_index[function]];
+	return graph->callees_index[function + 1]
+		- graph->callees_index[function];
+}
+
+
+/* callgraph_get_callers */
+size_t callgraph_get_callers(CallGraph const * graph, size_t function,
+		uint32_t const ** callers)
+{
+	if(graph->callers_index == NULL || function >= graph->functions_cnt)
+	{
+		*callers = NULL;
+		return 0;
+	}
+	*callers = &graph->callers[graph->callers_index[function]];
+	return graph->callers_index[function + 1]
+		- graph->callers_index[function];
+}
+
+
+/* callgraph_get_edges_count */
+size_t callgraph_get_edges_count(CallGraph const * graph)
+{
+	return graph->edges_cnt;
+}
+
+
+/* callgraph_get_function */
+size_t callgraph_get_function(CallGraph const * graph, off_t offset)
+{
+	return _callgraph_lookup(graph, offset, 0);
+}
+
+
+/* callgraph_get_function_by_name */
+size_t callgraph_get_function_by_name(CallGraph const * graph,
+		char const * name)
+{
+	gpointer p;
+
+	if((p = g_hash_table_lookup(graph->names, name)) == NULL)
+		return CALLGRAPH_NONE;
+	return GPOINTER_TO_SIZE(p) - 1;
+}
+
+
+/* useful */
+/* callgraph_append */
+int callgraph_append(CallGraph * graph, AsmArchInstructionCall const * calls,
+		size_t calls_cnt)
+{
+	size_t i;
+	size_t caller;
+	size_t callee;
+	uint64_t edge;
+
+	if(graph->edges == NULL)
+		return -error_set_code(1, "%s",
+				_("The graph is already built"));
+	for(i = 0; i < calls_cnt; i++)
+	{
+		if((callee = _callgraph_callee(graph, &calls[i]))
+				== CALLGRAPH_NONE)
+			continue;
+		if((caller = _callgraph_lookup(graph, calls[i].offset, 0))
+				== CALLGRAPH_NONE)
+			continue;
+		edge = ((uint64_t)caller << 32) | callee;
+		g_array_append_val(graph->edges, edge);
+	}
+	return 0;
+}
+
+
+/* callgraph_build */
+int callgraph_build(CallGraph * graph)
+{
+	uint64_t * edges;
+	size_t cnt;
+	size_t i;
+	size_t j;
+	size_t caller;
+	size_t callee;
+
+	if(graph->edges == NULL)
+		return -error_set_code(1, "%s",
+				_("The graph is already built"));
+	/* sort the edges by caller and remove the duplicates */
+	edges = (uint64_t *)graph->edges->data;
+	qsort(edges, graph->edges->len, sizeof(*edges),
+			_callgraph_on_compare_edges);
+	for(i = 0, cnt = 0; i < graph->edges->len; i++)
+		if(cnt == 0 || edges[i] != edges[cnt - 1])
+			edges[cnt++] = edges[i];
+	graph->edges_cnt = cnt;
+	graph->callees_index = g_new0(size_t, graph->functions_cnt + 1);
+	graph->callees = g_new(uint32_t, cnt + 1);
+	graph->callers_index = g_new0(size_t, graph->functions_cnt + 1);
+	graph->callers = g_new(uint32_t, cnt + 1);
+	/* count the degrees */
+	for(i = 0; i < cnt; i++)
+	{
+		graph->callees_index[(edges[i] >> 32) + 1]++;
+		graph->callers_index[(edges[i] & 0xffffffff) + 1]++;
+	}
+	for(i = 0; i < graph->functions_cnt; i++)
+	{
+		graph->callees_index[i + 1] += graph->callees_index[i];
+		graph->callers_index[i + 1] += graph->callers_index[i];
+	}
+	/* fill the rows: the callees are already in order */
+	for(i = 0; i < cnt; i++)
+	{
+		caller = edges[i] >> 32;
+		callee = edges[i] & 0xffffffff;
+		graph->callees[i] = callee;
+		j = graph->callers_index[callee]++;
+		graph->callers[j] = caller;
+	}
+	/* restore the start of the rows of callers */
+	for(i = graph->functions_cnt; i > 0; i--)
+		graph->callers_index[i] = graph->callers_index[i - 1];
+	graph->callers_index[0] = 0;
+	g_array_free(graph->edges, TRUE);
+	graph->edges = NULL;
+	return 0;
+}
+
+
+/* private */
+/* functions */
+/* callgraph_callee */
+static size_t _callgraph_callee(CallGraph * graph,
+		AsmArchInstructionCall const * call)
+{
+	size_t i;
+	AsmArchOperand const * ao;
+
+	for(i = 0; i < call->operands_cnt; i++)
+	{
+		ao = &call->operands[i];
+		if(AO_GET_TYPE(ao->definition) != AOT_IMMEDIATE
+				|| AO_GET_VALUE(ao->definition)
+				!= AOI_REFERS_FUNCTION)
+			continue;
+		if(ao->value.immediate.name != NULL)
+			return callgraph_get_function_by_name(graph,
+					ao->value.immediate.name);
+		return _callgraph_lookup(graph, ao->value.immediate.value, 1);
+	}
+	return CALLGRAPH_NONE;
+}
+
+
+/* callgraph_lookup */
+static size_t _callgraph_lookup(CallGraph const * graph, off_t offset,
+		int exact)
+{
+	size_t lo = 0;
+	size_t hi = graph->order_cnt;
+	size_t mid;
+	AsmFunction const * function;
+
+	/* look for the last function starting before this offset */
+	while(lo < hi)
+	{
+		mid = lo + (hi - lo) / 2;
+		if(graph->functions[graph->order[mid]].offset <= offset)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if(lo == 0)
+		return CALLGRAPH_NONE;
+	function = &graph->functions[graph->order[lo - 1]];
+	if(exact && function->offset != offset)
+		return CALLGRAPH_NONE;
+	/* past its end when known, as in the gaps between functions */
+	if(function->size > 0 && offset - function->offset >= function->size)
+		return CALLGRAPH_NONE;
+	return graph->order[lo - 1];
+}
+
+
+/* callbacks */
+/* callgraph_on_compare_edges */
+static int _callgraph_on_compare_edges(void const * a, void const * b)
+{
+	uint64_t const * ea = a;
+	uint64_t const * eb = b;
+
+	return (*ea < *eb) ? -1 : ((*ea > *eb) ? 1 : 0);
+}
+
+
+/* callgraph_on_compare_order */
+static int _callgraph_on_compare_order(void const * a, void const * b,
+		void * data)
+{
+	CallGraph * graph = data;
+	off_t oa = graph->functions[*(uint32_t const *)a].offset;
+	off_t ob = graph->functions[*(uint32_t const *)b].offset;
+
+	return (oa < ob) ? -1 : ((oa > ob) ? 1 : 0);
+}
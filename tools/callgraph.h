@@ -0,0 +1,67 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+
+#ifndef CODER_DEBUGGER_CALLGRAPH_H
+# define CODER_DEBUGGER_CALLGRAPH_H
+
+# include <stdint.h>
+# include <sys/types.h>
+# include <Devel/Asm.h>
+
+
+/* CallGraph */
+/* types */
+typedef struct _CallGraph CallGraph;
+
+
+/* constants */
+# define CALLGRAPH_NONE		((size_t)-1)
+
+
+/* functions */
+/* the functions must remain valid as long as the graph */
+CallGraph * callgraph_new(AsmFunction const * functions, size_t functions_cnt);
+void callgraph_delete(CallGraph * graph);
+
+/* accessors */
+/* the nodes are the indices of the functions */
+size_t callgraph_get_callees(CallGraph const * graph, size_t function,
+		uint32_t const ** callees);
+size_t callgraph_get_callers(CallGraph const * graph, size_t function,
+		uint32_t const ** callers);
+size_t callgraph_get_edges_count(CallGraph const * graph);
+size_t callgraph_get_function(CallGraph const * graph, off_t offset);
+size_t callgraph_get_function_by_name(CallGraph const * graph,
+		char const * name);
+
+/* useful */
+/* record the calls found, then build the graph once */
+int callgraph_append(CallGraph * graph, AsmArchInstructionCall const * calls,
+		size_t calls_cnt);
+int callgraph_build(CallGraph * graph);
+
+#endif /* !CODER_DEBUGGER_CALLGRAPH_H */
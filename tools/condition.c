@@ -0,0 +1,630 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <libintl.h>
+#include <glib.h>
+#include <System.h>
+#include "condition.h"
+#define _(string) gettext(string)
+
+
+/* Condition */
+/* private */
+/* types */
+typedef struct _ConditionOperator
+{
+	char const * name;
+	/* binding tighter as it grows */
+	unsigned int level;
+	DebuggerDebugOpcode opcode;
+} ConditionOperator;
+
+struct _Condition
+{
+	gchar * expression;
+	GArray * code;
+	GPtrArray * registers;
+	size_t depth;
+	DebuggerDebugCondition program;
+
+	/* parsing */
+	char const * position;
+	size_t stack;
+	unsigned int nesting;
+};
+
+
+/* constants */
+#define CONDITION_LEVELS	10
+/* parentheses and unary operators nested at most */
+#define CONDITION_NESTING_MAX	64
+
+
+/* variables */
+/* the longer of two operators starting alike comes first */
+static ConditionOperator const _condition_operators[] =
+{
+	{ "||",	0, DDO_LOR },
+	{ "&&",	1, DDO_LAND },
+	{ "==",	5, DDO_EQ },
+	{ "!=",	5, DDO_NE },
+	{ "<<",	7, DDO_SHL },
+	{ ">>",	7, DDO_SHR },
+	{ "<=",	6, DDO_LE },
+	{ ">=",	6, DDO_GE },
+	{ "|",	2, DDO_OR },
+	{ "^",	3, DDO_XOR },
+	{ "&",	4, DDO_AND },
+	{ "<",	6, DDO_LT },
+	{ ">",	6, DDO_GT },
+	{ "+",	8, DDO_ADD },
+	{ "-",	8, DDO_SUB },
+	{ "*",	9, DDO_MUL },
+	{ "/",	9, DDO_DIV },
+	{ "%",	9, DDO_MOD }
+};
+
+/* memory accesses by size, the default being the last one */
+static struct
+{
+	char const * name;
+	size_t size;
+} const _condition_sizes[] =
+{
+	{ "byte",	1 },
+	{ "word",	2 },
+	{ "dword",	4 },
+	{ "qword",	8 }
+};
+
+
+/* prototypes */
+static void _condition_emit(Condition * condition, DebuggerDebugOpcode opcode,
+		uint64_t operand);
+static int _condition_error(Condition * condition, char const * message);
+static int _condition_parse(Condition * condition, unsigned int level);
+static int _condition_parse_operand(Condition * condition);
+static void _condition_skip(Condition * condition);
+
+
+/* public */
+/* functions */
+/* condition_new */
+Condition * condition_new(char const * expression)
+{
+	Condition * condition;
+
+	if(expression == NULL)
+	{
+		error_set_code(1, "%s", strerror(EINVAL));
+		return NULL;
+	}
+	if((condition = object_new(sizeof(*condition))) == NULL)
+		return NULL;
+	condition->expression = g_strdup(expression);
+	condition->code = g_array_new(FALSE, FALSE,
+			sizeof(DebuggerDebugInstruction));
+	condition->registers = g_ptr_array_new_with_free_func(g_free);
+	condition->depth = 0;
+	condition->position = condition->expression;
+	condition->stack = 0;
+	condition->nesting = 0;
+	if(_condition_parse(condition, 0) != 0)
+	{
+		condition_delete(condition);
+		return NULL;
+	}
+	_condition_skip(condition);
+	if(*condition->position != '\0')
+	{
+		_condition_error(condition, _("Unexpected character"));
+		condition_delete(condition);
+		return NULL;
+	}
+	condition->program.code = (DebuggerDebugInstruction const *)
+		condition->code->data;
+	condition->program.code_cnt = condition->code->len;
+	condition->program.depth = condition->depth;
+	condition->program.registers = (char const * const *)
+		condition->registers->pdata;
+	condition->program.registers_cnt = condition->registers->len;
+	return condition;
+}
+
+
+/* condition_delete */
+void condition_delete(Condition * condition)
+{
+	g_ptr_array_free(condition->registers, TRUE);
+	g_array_free(condition->code, TRUE);
+	g_free(condition->expression);
+	object_delete(condition);
+}
+
+
+/* accessors */
+/* condition_get_code */
+DebuggerDebugCondition const * condition_get_code(Condition * condition)
+{
+	return &condition->program;
+}
+
+
+/* condition_get_expression */
+char const * condition_get_expression(Condition * condition)
+{
+	return condition->expression;
+}
+
+
+/* useful */
+/* condition_check */
+int condition_check(DebuggerDebugCondition const * condition)
+{
+	DebuggerDebugInstruction const * instruction;
+	size_t * depths;
+	size_t depth = 0;
+	size_t i;
+	int ret = -1;
+
+	/* the depth expected where jumps land, as they only go forward */
+	depths = g_new(size_t, condition->code_cnt + 1);
+	for(i = 0; i <= condition->code_cnt; i++)
+		depths[i] = (size_t)-1;
+	for(i = 0; i < condition->code_cnt; i++)
+	{
+		if(depths[i] != (size_t)-1 && depths[i] != depth)
+			break;
+		instruction = &condition->code[i];
+		if(instruction->opcode == DDO_REGISTER
+				&& instruction->operand
+				>= condition->registers_cnt)
+			break;
+		if(instruction->opcode == DDO_LOAD
+				&& instruction->operand != 1
+				&& instruction->operand != 2
+				&& instruction->operand != 4
+				&& instruction->operand != 8)
+			break;
+		if(instruction->opcode == DDO_PUSH
+				|| instruction->opcode == DDO_REGISTER
+				|| instruction->opcode == DDO_HITS)
+		{
+			if(++depth > condition->depth)
+				break;
+		}
+		else if(instruction->opcode == DDO_LOAD
+				|| instruction->opcode == DDO_NEG
+				|| instruction->opcode == DDO_NOT
+				|| instruction->opcode == DDO_COMPLEMENT
+				|| instruction->opcode == DDO_BOOL)
+		{
+			if(depth < 1)
+				break;
+		}
+		else if(instruction->opcode == DDO_LAND
+				|| instruction->opcode == DDO_LOR)
+		{
+			if(depth < 1 || instruction->operand <= i
+					|| instruction->operand
+					> condition->code_cnt)
+				break;
+			depths[instruction->operand] = depth--;
+		}
+		else if(instruction->opcode > DDO_LAST || depth-- < 2)
+			break;
+	}
+	if(i == condition->code_cnt && depth == 1
+			&& (depths[i] == (size_t)-1 || depths[i] == depth))
+		ret = 0;
+	g_free(depths);
+	return ret;
+}
+
+
+/* condition_evaluate */
+int condition_evaluate(DebuggerDebugInstruction const * code, size_t code_cnt,
+		uint64_t * stack, uint64_t hits, ConditionHelper const * helper)
+{
+	DebuggerDebugInstruction const * instruction;
+	size_t sp = 0;
+	size_t i;
+	uint64_t a;
+	uint64_t b;
+	union
+	{
+		uint8_t u8;
+		uint16_t u16;
+		uint32_t u32;
+		uint64_t u64;
+	} value;
+
+	/* see condition_check() */
+	for(i = 0; i < code_cnt; i++)
+	{
+		instruction = &code[i];
+		b = (sp > 0) ? stack[sp - 1] : 0;
+		switch(instruction->opcode)
+		{
+			case DDO_PUSH:
+				stack[sp++] = instruction->operand;
+				continue;
+			case DDO_REGISTER:
+				stack[sp++] = helper->get_register(helper->data,
+						instruction->operand);
+				continue;
+			case DDO_HITS:
+				stack[sp++] = hits;
+				continue;
+			case DDO_LOAD:
+				a = instruction->operand;
+				if(helper->read_memory(helper->data, b, &value, a)
+						!= (ssize_t)a)
+					return -1;
+				if(a == 1)
+					stack[sp - 1] = value.u8;
+				else if(a == 2)
+					stack[sp - 1] = value.u16;
+				else if(a == 4)
+					stack[sp - 1] = value.u32;
+				else
+					stack[sp - 1] = value.u64;
+				continue;
+			case DDO_NEG:
+				stack[sp - 1] = -b;
+				continue;
+			case DDO_NOT:
+				stack[sp - 1] = (b == 0) ? 1 : 0;
+				continue;
+			case DDO_COMPLEMENT:
+				stack[sp - 1] = ~b;
+				continue;
+			case DDO_BOOL:
+				stack[sp - 1] = (b != 0) ? 1 : 0;
+				continue;
+			case DDO_LAND:
+				if(b == 0)
+					i = instruction->operand - 1;
+				else
+					sp--;
+				continue;
+			case DDO_LOR:
+				if(b != 0)
+				{
+					stack[sp - 1] = 1;
+					i = instruction->operand - 1;
+				}
+				else
+					sp--;
+				continue;
+			default:
+				break;
+		}
+		/* binary operators */
+		a = stack[--sp - 1];
+		switch(instruction->opcode)
+		{
+			case DDO_MUL:
+				a *= b;
+				break;
+			case DDO_DIV:
+			case DDO_MOD:
+				if(b == 0)
+					return -1;
+				a = (instruction->opcode == DDO_DIV)
+					? a / b : a % b;
+				break;
+			case DDO_ADD:
+				a += b;
+				break;
+			case DDO_SUB:
+				a -= b;
+				break;
+			case DDO_SHL:
+				a = (b < 64) ? a << b : 0;
+				break;
+			case DDO_SHR:
+				a = (b < 64) ? a >> b : 0;
+				break;
+			case DDO_LT:
+				a = (a < b) ? 1 : 0;
+				break;
+			case DDO_LE:
+				a = (a <= b) ? 1 : 0;
+				break;
+			case DDO_GT:
+				a = (a > b) ? 1 : 0;
+				break;
+			case DDO_GE:
+				a = (a >= b) ? 1 : 0;
+				break;
+			case DDO_EQ:
+				a = (a == b) ? 1 : 0;
+				break;
+			case DDO_NE:
+				a = (a != b) ? 1 : 0;
+				break;
+			case DDO_AND:
+				a &= b;
+				break;
+			case DDO_XOR:
+				a ^= b;
+				break;
+			case DDO_OR:
+				a |= b;
+				break;
+			default:
+				return -1;
+		}
+		stack[sp - 1] = a;
+	}
+	return (stack[0] != 0) ? 1 : 0;
+}
+
+
+/* private */
+/* functions */
+/* condition_emit */
+static void _condition_emit(Condition * condition, DebuggerDebugOpcode opcode,
+		uint64_t operand)
+{
+	DebuggerDebugInstruction instruction;
+
+	instruction.opcode = opcode;
+	instruction.operand = operand;
+	g_array_append_val(condition->code, instruction);
+	/* keep track of the stack depth needed */
+	switch(opcode)
+	{
+		case DDO_PUSH:
+		case DDO_REGISTER:
+		case DDO_HITS:
+			if(++condition->stack > condition->depth)
+				condition->depth = condition->stack;
+			break;
+		case DDO_LOAD:
+		case DDO_NEG:
+		case DDO_NOT:
+		case DDO_COMPLEMENT:
+		case DDO_BOOL:
+			break;
+		default:
+			/* binary operators, and logical ones going on */
+			condition->stack--;
+			break;
+	}
+}
+
+
+/* condition_error */
+static int _condition_error(Condition * condition, char const * message)
+{
+	return -error_set_code(1, _("%s at offset %lu"), message,
+			(unsigned long)(condition->position
+				- condition->expression));
+}
+
+
+/* condition_parse */
+static int _parse_operator(Condition * condition, unsigned int level);
+
+static int _condition_parse(Condition * condition, unsigned int level)
+{
+	ConditionOperator const * operator;
+	int i;
+	guint jump;
+
+	if(level == CONDITION_LEVELS)
+		return _condition_parse_operand(condition);
+	if(_condition_parse(condition, level + 1) != 0)
+		return -1;
+	while((i = _parse_operator(condition, level)) >= 0)
+	{
+		operator = &_condition_operators[i];
+		condition->position += strlen(operator->name);
+		if(operator->opcode != DDO_LAND && operator->opcode != DDO_LOR)
+		{
+			if(_condition_parse(condition, level + 1) != 0)
+				return -1;
+			_condition_emit(condition, operator->opcode, 0);
+			continue;
+		}
+		/* skip the right operand when the left one decides */
+		jump = condition->code->len;
+		_condition_emit(condition, operator->opcode, 0);
+		if(_condition_parse(condition, level + 1) != 0)
+			return -1;
+		_condition_emit(condition, DDO_BOOL, 0);
+		g_array_index(condition->code, DebuggerDebugInstruction,
+				jump).operand = condition->code->len;
+	}
+	return 0;
+}
+
+static int _parse_operator(Condition * condition, unsigned int level)
+{
+	size_t i;
+	char const * name;
+
+	_condition_skip(condition);
+	for(i = 0; i < sizeof(_condition_operators)
+			/ sizeof(*_condition_operators); i++)
+	{
+		name = _condition_operators[i].name;
+		if(strncmp(condition->position, name, strlen(name)) == 0)
+			return (_condition_operators[i].level == level)
+				? (int)i : -1;
+	}
+	return -1;
+}
+
+
+/* condition_parse_operand */
+static int _parse_operand_load(Condition * condition, size_t size);
+static int _parse_operand_name(Condition * condition);
+static int _parse_operand_nested(Condition * condition, unsigned int level);
+static int _parse_operand_number(Condition * condition);
+
+static int _condition_parse_operand(Condition * condition)
+{
+	char c;
+	DebuggerDebugOpcode opcode;
+
+	_condition_skip(condition);
+	switch((c = *condition->position))
+	{
+		case '-':
+		case '!':
+		case '~':
+			opcode = (c == '-') ? DDO_NEG
+				: ((c == '!') ? DDO_NOT : DDO_COMPLEMENT);
+			condition->position++;
+			if(_parse_operand_nested(condition, CONDITION_LEVELS)
+					!= 0)
+				return -1;
+			_condition_emit(condition, opcode, 0);
+			return 0;
+		case '(':
+			condition->position++;
+			if(_parse_operand_nested(condition, 0) != 0)
+				return -1;
+			_condition_skip(condition);
+			if(*condition->position != ')')
+				return _condition_error(condition,
+						_("Expected \")\""));
+			condition->position++;
+			return 0;
+		case '[':
+			return _parse_operand_load(condition, sizeof(uint64_t));
+	}
+	if(isdigit((unsigned char)c))
+		return _parse_operand_number(condition);
+	if(isalpha((unsigned char)c) || c == '_' || c == '$' || c == '%')
+		return _parse_operand_name(condition);
+	return _condition_error(condition, _("Expected an operand"));
+}
+
+static int _parse_operand_load(Condition * condition, size_t size)
+{
+	_condition_skip(condition);
+	if(*condition->position != '[')
+		return _condition_error(condition, _("Expected \"[\""));
+	condition->position++;
+	if(_parse_operand_nested(condition, 0) != 0)
+		return -1;
+	_condition_skip(condition);
+	if(*condition->position != ']')
+		return _condition_error(condition, _("Expected \"]\""));
+	condition->position++;
+	_condition_emit(condition, DDO_LOAD, size);
+	return 0;
+}
+
+static int _parse_operand_name(Condition * condition)
+{
+	char const * p = condition->position;
+	gboolean keyword = TRUE;
+	size_t len;
+	size_t i;
+	gchar * name;
+
+	/* registers may be written as in either assembly syntax */
+	if(*p == '$' || *p == '%')
+	{
+		keyword = FALSE;
+		p++;
+	}
+	for(len = 0; isalnum((unsigned char)p[len]) || p[len] == '_'; len++);
+	if(len == 0)
+		return _condition_error(condition, _("Expected a register"));
+	name = g_ascii_strdown(p, len);
+	condition->position = p + len;
+	if(keyword && strcmp(name, "hits") == 0)
+	{
+		g_free(name);
+		_condition_emit(condition, DDO_HITS, 0);
+		return 0;
+	}
+	for(i = 0; keyword && i < sizeof(_condition_sizes)
+			/ sizeof(*_condition_sizes); i++)
+		if(strcmp(name, _condition_sizes[i].name) == 0)
+		{
+			g_free(name);
+			return _parse_operand_load(condition,
+					_condition_sizes[i].size);
+		}
+	for(i = 0; i < condition->registers->len; i++)
+		if(strcmp(name, g_ptr_array_index(condition->registers, i))
+				== 0)
+			break;
+	if(i == condition->registers->len)
+		g_ptr_array_add(condition->registers, name);
+	else
+		g_free(name);
+	_condition_emit(condition, DDO_REGISTER, i);
+	return 0;
+}
+
+static int _parse_operand_nested(Condition * condition, unsigned int level)
+{
+	int ret;
+
+	if(condition->nesting == CONDITION_NESTING_MAX)
+		return _condition_error(condition, _("Nested too deeply"));
+	condition->nesting++;
+	ret = _condition_parse(condition, level);
+	condition->nesting--;
+	return ret;
+}
+
+static int _parse_operand_number(Condition * condition)
+{
+	char * end;
+	unsigned long long value;
+
+	errno = 0;
+	value = strtoull(condition->position, &end, 0);
+	if(errno != 0 || isalnum((unsigned char)*end) || *end == '_')
+		return _condition_error(condition, _("Invalid number"));
+	condition->position = end;
+	_condition_emit(condition, DDO_PUSH, value);
+	return 0;
+}
+
+
+/* condition_skip */
+static void _condition_skip(Condition * condition)
+{
+	while(isspace((unsigned char)*condition->position))
+		condition->position++;
+}
@@ -0,0 +1,63 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+
+#ifndef CODER_DEBUGGER_CONDITION_H
+# define CODER_DEBUGGER_CONDITION_H
+
+# include <sys/types.h>
+# include "debug.h"
+
+
+/* Condition */
+/* types */
+typedef struct _Condition Condition;
+
+/* what the code evaluated needs from the debug plug-ins */
+typedef struct _ConditionHelper
+{
+	void * data;
+	/* by index in the registers of the condition */
+	uint64_t (*get_register)(void * data, size_t index);
+	ssize_t (*read_memory)(void * data, uint64_t address, void * buf,
+			size_t size);
+} ConditionHelper;
+
+
+/* functions */
+Condition * condition_new(char const * expression);
+void condition_delete(Condition * condition);
+
+/* accessors */
+DebuggerDebugCondition const * condition_get_code(Condition * condition);
+char const * condition_get_expression(Condition * condition);
+
+/* useful */
+int condition_check(DebuggerDebugCondition const * condition);
+int condition_evaluate(DebuggerDebugInstruction const * code, size_t code_cnt,
+		uint64_t * stack, uint64_t hits, ConditionHelper const * helper);
+
+#endif /* !CODER_DEBUGGER_CONDITION_H */
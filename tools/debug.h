@@ -28,6 +28,7 @@
 #ifndef CODER_DEBUGGER_DEBUG_H
 # define CODER_DEBUGGER_DEBUG_H
 
+# include <sys/types.h>
 # include <stdint.h>
 # include <System.h>
 # include "common.h"
@@ -37,12 +38,149 @@
 /* types */
 typedef struct _DebuggerDebug DebuggerDebug;
 
+/* breakpoint statistics */
+typedef struct _DebuggerDebugBreakpoint
+{
+	uint64_t address;
+	uint64_t hits;
+	/* hits where the condition held, if any */
+	uint64_t stops;
+	/* spent evaluating the condition, in nanoseconds */
+	uint64_t evaluation;
+} DebuggerDebugBreakpoint;
+
+/* breakpoint conditions, compiled for a stack machine over 64-bit values */
+typedef enum _DebuggerDebugOpcode
+{
+	/* push the operand */
+	DDO_PUSH = 0,
+	/* push the register at this index in the condition */
+	DDO_REGISTER,
+	/* replace the address on top by the operand bytes read there */
+	DDO_LOAD,
+	/* push the number of hits, this one included */
+	DDO_HITS,
+	/* replace the value on top */
+	DDO_NEG, DDO_NOT, DDO_COMPLEMENT,
+	/* replace the two values on top, the first operand lowest */
+	DDO_MUL, DDO_DIV, DDO_MOD, DDO_ADD, DDO_SUB, DDO_SHL, DDO_SHR,
+	DDO_LT, DDO_LE, DDO_GT, DDO_GE, DDO_EQ, DDO_NE, DDO_AND, DDO_XOR,
+	DDO_OR,
+	/* jump to the operand keeping 0 if zero, or drop the value on top */
+	DDO_LAND,
+	/* jump to the operand with 1 if not zero, or drop the value on top */
+	DDO_LOR,
+	/* replace the value on top by 0 or 1 */
+	DDO_BOOL
+} DebuggerDebugOpcode;
+# define DDO_LAST DDO_BOOL
+# define DDO_COUNT (DDO_LAST + 1)
+
+typedef struct _DebuggerDebugInstruction
+{
+	DebuggerDebugOpcode opcode;
+	uint64_t operand;
+} DebuggerDebugInstruction;
+
+/* holds if the value left on the stack is not zero */
+typedef struct _DebuggerDebugCondition
+{
+	DebuggerDebugInstruction const * code;
+	size_t code_cnt;
+	/* the stack never grows deeper */
+	size_t depth;
+	/* the registers used, by name */
+	char const * const * registers;
+	size_t registers_cnt;
+} DebuggerDebugCondition;
+
+typedef struct _DebuggerDebugRegister
+{
+	char const * name;
+	uint64_t value;
+} DebuggerDebugRegister;
+
+/* times a given address was found executing */
+typedef struct _DebuggerDebugSample
+{
+	uint64_t address;
+	uint64_t count;
+	/* return addresses, the innermost first */
+	uint64_t const * callers;
+	size_t callers_cnt;
+} DebuggerDebugSample;
+
+/* system calls by latency, in powers of two of nanoseconds */
+# define DEBUGGER_DEBUG_HISTOGRAM	32
+
+typedef struct _DebuggerDebugSyscall
+{
+	unsigned int number;
+	/* NULL if unknown */
+	char const * name;
+	uint64_t count;
+	/* from the entry to the exit, in nanoseconds */
+	uint64_t total;
+	uint64_t maximum;
+	/* calls below 2^(i + 1) nanoseconds, the last one for the rest */
+	uint64_t histogram[DEBUGGER_DEBUG_HISTOGRAM];
+} DebuggerDebugSyscall;
+
+/* recorded without stopping the program */
+typedef enum _DebuggerDebugTracepointStatus
+{
+	DDTS_PENDING = 0, DDTS_ACTIVE,
+	/* the code there cannot be patched */
+	DDTS_UNSUPPORTED, DDTS_UNREACHABLE, DDTS_FAILED
+} DebuggerDebugTracepointStatus;
+
+/* arguments passed in registers */
+# define DEBUGGER_DEBUG_ARGUMENTS	6
+
+typedef struct _DebuggerDebugTracepoint
+{
+	uint64_t address;
+	DebuggerDebugTracepointStatus status;
+	uint64_t count;
+	/* events lost as the program recorded them too fast */
+	uint64_t dropped;
+	/* as of the last event */
+	uint64_t thread;
+	uint64_t arguments[DEBUGGER_DEBUG_ARGUMENTS];
+} DebuggerDebugTracepoint;
+
+typedef enum _DebuggerDebugWatch
+{
+	DDW_WRITE = 0, DDW_ACCESS
+} DebuggerDebugWatch;
+
 typedef struct _DebuggerDebugHelper
 {
 	Debugger * debugger;
 	int (*error)(Debugger * debugger, int code, char const * format, ...);
+	/* where the program was loaded, relative to where it was linked */
+	void (*set_bias)(Debugger * debugger, uint64_t bias);
+	/* whether the checkpoint requested was made (0) or not (-1) */
+	void (*set_checkpoint)(Debugger * debugger, int checkpoint,
+			int result);
 	void (*set_register)(Debugger * debugger, char const * name,
 			uint64_t value);
+	void (*set_registers)(Debugger * debugger,
+			DebuggerDebugRegister const * registers,
+			size_t registers_cnt);
+	/* duration in microseconds */
+	void (*set_profile)(Debugger * debugger,
+			DebuggerDebugSample const * samples,
+			size_t samples_cnt, uint64_t duration);
+	void (*set_syscalls)(Debugger * debugger,
+			DebuggerDebugSyscall const * syscalls,
+			size_t syscalls_cnt);
+	void (*set_breakpoints)(Debugger * debugger,
+			DebuggerDebugBreakpoint const * breakpoints,
+			size_t breakpoints_cnt);
+	void (*set_tracepoints)(Debugger * debugger,
+			DebuggerDebugTracepoint const * tracepoints,
+			size_t tracepoints_cnt);
 } DebuggerDebugHelper;
 
 typedef const struct _DebuggerDebugDefinition
@@ -58,6 +196,36 @@ typedef const struct _DebuggerDebugDefinition
 	int (*_continue)(DebuggerDebug * backend);
 	int (*next)(DebuggerDebug * backend);
 	int (*step)(DebuggerDebug * backend);
+	/* return the number of bytes transferred, or -1 on errors */
+	ssize_t (*read_memory)(DebuggerDebug * backend, uint64_t address,
+			void * buf, size_t size);
+	ssize_t (*write_memory)(DebuggerDebug * backend, uint64_t address,
+			void const * buf, size_t size);
+	/* only stop when the condition holds, if not NULL */
+	int (*add_breakpoint)(DebuggerDebug * backend, uint64_t address,
+			DebuggerDebugCondition const * condition);
+	int (*remove_breakpoint)(DebuggerDebug * backend, uint64_t address);
+	int (*add_watchpoint)(DebuggerDebug * backend, uint64_t address,
+			size_t size, DebuggerDebugWatch watch);
+	int (*remove_watchpoint)(DebuggerDebug * backend, uint64_t address);
+	/* single-step until paused, logging every step to filename */
+	int (*record)(DebuggerDebug * backend, char const * filename,
+			int registers);
+	/* run while sampling frequency times per second, until paused */
+	int (*profile)(DebuggerDebug * backend, unsigned int frequency);
+	/* only stop on these system calls, by name or number, before start */
+	int (*trace_syscalls)(DebuggerDebug * backend,
+			char const ** syscalls, size_t syscalls_cnt);
+	/* snapshot the program while stopped, returning the checkpoint
+	 * before it is confirmed with set_checkpoint() */
+	int (*checkpoint)(DebuggerDebug * backend);
+	/* resume from a copy of the checkpoint, which is kept */
+	int (*restore)(DebuggerDebug * backend, int checkpoint);
+	int (*discard)(DebuggerDebug * backend, int checkpoint);
+	/* record the arguments at these addresses without stopping, from
+	 * the start */
+	int (*tracepoints)(DebuggerDebug * backend, uint64_t const * addresses,
+			size_t addresses_cnt);
 } DebuggerDebugDefinition;
 
 
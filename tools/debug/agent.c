@@ -0,0 +1,551 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+/* this agent is specific to Linux, and patches code for x86_64 */
+#if defined(__linux__) && defined(__x86_64__)
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "agent.h"
+
+
+/* Agent */
+/* private */
+/* constants */
+/* size of the jump patched in */
+#define AGENT_JUMP		5
+/* instructions displaced at most, the last one starting within the jump */
+#define AGENT_DISPLACED		(AGENT_JUMP - 1 + 15)
+/* size of a trampoline, aligned */
+#define AGENT_TRAMPOLINE	80
+/* looking for trampolines within reach, in steps of 16 MB up to 1 GB */
+#define AGENT_REACH_STEP	0x1000000
+#define AGENT_REACH_STEPS	64
+
+
+/* types */
+/* as saved by _agent_stub, the lowest address first */
+typedef struct _AgentFrame
+{
+	uint64_t rbx;
+	uint64_t r11;
+	uint64_t r10;
+	uint64_t r9;
+	uint64_t r8;
+	uint64_t rdi;
+	uint64_t rsi;
+	uint64_t rdx;
+	uint64_t rcx;
+	uint64_t rax;
+	uint64_t flags;
+	/* back into the trampoline */
+	uint64_t trampoline;
+	uint64_t tracepoint;
+	/* followed by the red zone, then the stack of the program */
+} AgentFrame;
+
+
+/* variables */
+static AgentBuffer * _agent_buffer = NULL;
+
+/* the thread recording, to ignore the tracepoints hit meanwhile */
+static __thread int _agent_busy
+	__attribute__((tls_model("initial-exec"))) = 0;
+static __thread uint32_t _agent_thread
+	__attribute__((tls_model("initial-exec"))) = 0;
+
+/* trampolines */
+static unsigned char * _agent_page = NULL;
+static size_t _agent_page_size = 0;
+static size_t _agent_page_used = 0;
+
+
+/* prototypes */
+static void _agent_init(void) __attribute__((constructor));
+
+static size_t _agent_decode(unsigned char const * code);
+static AgentStatus _agent_patch(AgentBuffer * buffer, uint32_t tracepoint);
+static int _agent_protection(uintptr_t start, uintptr_t end);
+static void _agent_record(AgentFrame const * frame) __attribute__((used));
+static unsigned char * _agent_trampoline(unsigned char const * address);
+
+/* callbacks */
+static void _agent_on_fork(void);
+
+
+/* agent_stub */
+/* saves the registers that calls may change, records the event and returns
+ * to the trampoline */
+__asm__(".text\n"
+		".p2align 4\n"
+		"_agent_stub:\n"
+		"\tendbr64\n"
+		"\tpushfq\n"
+		"\tpushq %rax\n"
+		"\tpushq %rcx\n"
+		"\tpushq %rdx\n"
+		"\tpushq %rsi\n"
+		"\tpushq %rdi\n"
+		"\tpushq %r8\n"
+		"\tpushq %r9\n"
+		"\tpushq %r10\n"
+		"\tpushq %r11\n"
+		"\tpushq %rbx\n"
+		"\tmovq %rsp, %rbx\n"
+		/* the vector registers too, as the program may be using them */
+		"\tandq $-64, %rsp\n"
+		"\tsubq $512, %rsp\n"
+		"\tfxsave64 (%rsp)\n"
+		"\tcld\n"
+		"\tmovq %rbx, %rdi\n"
+		"\tcall _agent_record\n"
+		"\tfxrstor64 (%rsp)\n"
+		"\tmovq %rbx, %rsp\n"
+		"\tpopq %rbx\n"
+		"\tpopq %r11\n"
+		"\tpopq %r10\n"
+		"\tpopq %r9\n"
+		"\tpopq %r8\n"
+		"\tpopq %rdi\n"
+		"\tpopq %rsi\n"
+		"\tpopq %rdx\n"
+		"\tpopq %rcx\n"
+		"\tpopq %rax\n"
+		"\tpopfq\n"
+		"\tret\n");
+extern char _agent_stub[];
+
+
+/* functions */
+/* agent_init */
+static void _agent_init(void)
+{
+	char const * name;
+	int fd;
+	AgentBuffer * buffer;
+	uint32_t i;
+
+	if((name = getenv(AGENT_ENVIRONMENT)) == NULL)
+		return;
+	fd = shm_open(name, O_RDWR, 0);
+	/* only the program started is traced, not the ones it runs */
+	shm_unlink(name);
+	unsetenv(AGENT_ENVIRONMENT);
+	if(fd < 0)
+		return;
+	buffer = mmap(NULL, sizeof(*buffer), PROT_READ | PROT_WRITE,
+			MAP_SHARED, fd, 0);
+	close(fd);
+	if(buffer == MAP_FAILED)
+		return;
+	if(buffer->magic != AGENT_MAGIC || buffer->version != AGENT_VERSION
+			|| buffer->tracepoints_cnt > AGENT_TRACEPOINTS)
+	{
+		munmap(buffer, sizeof(*buffer));
+		return;
+	}
+	_agent_buffer = buffer;
+	pthread_atfork(NULL, NULL, _agent_on_fork);
+	/* the program is not running yet, there is nothing to synchronize */
+	for(i = 0; i < buffer->tracepoints_cnt; i++)
+		buffer->tracepoints[i].status = _agent_patch(buffer, i);
+}
+
+
+/* agent_decode */
+/* returns the length of the instruction, or 0 if it cannot be moved as is */
+static size_t _agent_decode(unsigned char const * code)
+{
+	unsigned char const * p = code;
+	int operand16 = 0;
+	int rexw = 0;
+	int modrm = 0;
+	size_t immediate = 0;
+	unsigned char opcode;
+	unsigned char mod;
+	unsigned char rm;
+
+	/* prefixes */
+	for(;; p++)
+		if(*p == 0x66)
+			operand16 = 1;
+		else if(*p != 0x67 && *p != 0xf0 && *p != 0xf2 && *p != 0xf3
+				&& *p != 0x26 && *p != 0x2e && *p != 0x36
+				&& *p != 0x3e && *p != 0x64 && *p != 0x65)
+			break;
+	if((*p & 0xf0) == 0x40)
+		rexw = (*(p++) & 0x08) ? 1 : 0;
+	/* only the instructions independent from their address are moved,
+	 * leaving out branches and accesses relative to rip */
+	opcode = *(p++);
+	if(opcode < 0x40 && (opcode & 0x07) < 4)
+		modrm = 1;
+	else if(opcode < 0x40 && (opcode & 0x07) == 4)
+		immediate = 1;
+	else if(opcode < 0x40 && (opcode & 0x07) == 5)
+		immediate = operand16 ? 2 : 4;
+	else if(opcode >= 0x50 && opcode <= 0x5f)
+		;
+	else if(opcode == 0x63 || (opcode >= 0x84 && opcode <= 0x8b)
+			|| opcode == 0x8d || opcode == 0x8f
+			|| (opcode >= 0xd0 && opcode <= 0xd3) || opcode == 0xfe)
+		modrm = 1;
+	else if(opcode == 0x68)
+		immediate = 4;
+	else if(opcode == 0x6a || opcode == 0xa8
+			|| (opcode >= 0xb0 && opcode <= 0xb7))
+		immediate = 1;
+	else if(opcode == 0x69 || opcode == 0x81 || opcode == 0xc7)
+	{
+		modrm = 1;
+		immediate = operand16 ? 2 : 4;
+	}
+	else if(opcode == 0x6b || opcode == 0x80 || opcode == 0x83
+			|| opcode == 0xc0 || opcode == 0xc1 || opcode == 0xc6)
+	{
+		modrm = 1;
+		immediate = 1;
+	}
+	else if((opcode >= 0x90 && opcode <= 0x99) || opcode == 0x9c
+			|| opcode == 0x9d || opcode == 0xc9)
+		;
+	else if(opcode == 0xa9)
+		immediate = operand16 ? 2 : 4;
+	else if(opcode >= 0xb8 && opcode <= 0xbf)
+		immediate = rexw ? 8 : (operand16 ? 2 : 4);
+	else if(opcode == 0xf6 || opcode == 0xf7)
+	{
+		modrm = 1;
+		/* test has an immediate operand, not the rest of the group */
+		if(((*p >> 3) & 0x07) < 2)
+			immediate = (opcode == 0xf6) ? 1 : (operand16 ? 2 : 4);
+	}
+	else if(opcode == 0xff)
+	{
+		/* inc, dec and push but no indirect calls or jumps */
+		if(((*p >> 3) & 0x07) != 0 && ((*p >> 3) & 0x07) != 1
+				&& ((*p >> 3) & 0x07) != 6)
+			return 0;
+		modrm = 1;
+	}
+	else if(opcode == 0x0f)
+	{
+		opcode = *(p++);
+		if(opcode == 0x05 || opcode == 0xa2)
+			;
+		else if(opcode == 0x10 || opcode == 0x11 || opcode == 0x1e
+				|| opcode == 0x1f || opcode == 0x28
+				|| opcode == 0x29
+				|| (opcode >= 0x40 && opcode <= 0x4f)
+				|| opcode == 0x57 || opcode == 0x6f
+				|| opcode == 0x7f
+				|| (opcode >= 0x90 && opcode <= 0x9f)
+				|| opcode == 0xaf || opcode == 0xb6
+				|| opcode == 0xb7 || opcode == 0xbe
+				|| opcode == 0xbf || opcode == 0xd6
+				|| opcode == 0xef)
+			modrm = 1;
+		else
+			return 0;
+	}
+	else
+		return 0;
+	if(modrm)
+	{
+		mod = *p >> 6;
+		rm = *(p++) & 0x07;
+		if(mod == 0 && rm == 5)
+			return 0;
+		/* scale, index and base, then a displacement without base */
+		if(mod != 3 && rm == 4)
+		{
+			if(mod == 0 && (*p & 0x07) == 5)
+				p += 4;
+			p++;
+		}
+		if(mod == 1)
+			p += 1;
+		else if(mod == 2)
+			p += 4;
+	}
+	p += immediate;
+	return ((size_t)(p - code) <= 15) ? (size_t)(p - code) : 0;
+}
+
+
+/* agent_patch */
+static AgentStatus _agent_patch(AgentBuffer * buffer, uint32_t tracepoint)
+{
+	int prot;
+	unsigned char * address = (unsigned char *)(uintptr_t)
+		buffer->tracepoints[tracepoint].address;
+	const long pagesize = sysconf(_SC_PAGESIZE);
+	unsigned char * page = (unsigned char *)((uintptr_t)address
+			& ~(uintptr_t)(pagesize - 1));
+	const size_t size = (address + AGENT_DISPLACED - page + pagesize - 1)
+		/ pagesize * pagesize;
+	unsigned char * trampoline;
+	unsigned char * p;
+	uint64_t resume;
+	uint64_t stub = (uintptr_t)_agent_stub;
+	int32_t offset;
+	size_t displaced;
+	size_t length;
+	uint32_t i;
+
+	/* a tracepoint cannot fall within the jump of another */
+	for(i = 0; i < tracepoint; i++)
+		if(buffer->tracepoints[i].status == AS_ACTIVE
+				&& address + AGENT_JUMP > (unsigned char *)
+				(uintptr_t)buffer->tracepoints[i].address
+				&& (unsigned char *)(uintptr_t)
+				buffer->tracepoints[i].address + AGENT_JUMP
+				> address)
+			return AS_UNSUPPORTED;
+	/* only code is patched, its protection restored afterwards */
+	if((prot = _agent_protection((uintptr_t)address, (uintptr_t)address
+					+ AGENT_DISPLACED)) < 0
+			|| (prot & PROT_EXEC) == 0
+			|| mprotect(page, size, prot | PROT_WRITE) != 0)
+		return AS_FAILED;
+	for(displaced = 0; displaced < AGENT_JUMP; displaced += length)
+		if((length = _agent_decode(&address[displaced])) == 0)
+		{
+			mprotect(page, size, prot);
+			return AS_UNSUPPORTED;
+		}
+	if((trampoline = _agent_trampoline(address)) == NULL)
+	{
+		mprotect(page, size, prot);
+		return AS_UNREACHABLE;
+	}
+	p = trampoline;
+	/* lea -128(%rsp), %rsp: past the red zone */
+	memcpy(p, "\x48\x8d\x64\x24\x80", 5);
+	p += 5;
+	/* push $tracepoint */
+	*(p++) = 0x68;
+	memcpy(p, &tracepoint, sizeof(tracepoint));
+	p += sizeof(tracepoint);
+	/* call *stub(%rip), the address of the stub stored last */
+	memcpy(p, "\xff\x15", 2);
+	offset = AGENT_TRAMPOLINE - 8 - (p + 6 - trampoline);
+	memcpy(p + 2, &offset, sizeof(offset));
+	p += 6;
+	/* lea 136(%rsp), %rsp: back to the stack of the program */
+	memcpy(p, "\x48\x8d\xa4\x24\x88\x00\x00\x00", 8);
+	p += 8;
+	memcpy(p, address, displaced);
+	p += displaced;
+	/* jmp *0(%rip), back after the instructions displaced */
+	memcpy(p, "\xff\x25\x00\x00\x00\x00", 6);
+	p += 6;
+	resume = (uintptr_t)address + displaced;
+	memcpy(p, &resume, sizeof(resume));
+	memcpy(trampoline + AGENT_TRAMPOLINE - 8, &stub, sizeof(stub));
+	mprotect(_agent_page, _agent_page_size, PROT_READ | PROT_EXEC);
+	/* jmp trampoline, padded with nops */
+	offset = trampoline - (address + AGENT_JUMP);
+	address[0] = 0xe9;
+	memcpy(&address[1], &offset, sizeof(offset));
+	memset(&address[AGENT_JUMP], 0x90, displaced - AGENT_JUMP);
+	mprotect(page, size, prot);
+	__builtin___clear_cache((char *)address, (char *)address + displaced);
+	return AS_ACTIVE;
+}
+
+
+/* agent_protection */
+/* returns the protection of the mapping containing this range, or -1 */
+static int _agent_protection(uintptr_t start, uintptr_t end)
+{
+	int ret = -1;
+	FILE * fp;
+	char buf[256];
+	unsigned long from;
+	unsigned long to;
+	char perms[5];
+
+	if((fp = fopen("/proc/self/maps", "r")) == NULL)
+		return -1;
+	while(fgets(buf, sizeof(buf), fp) != NULL)
+	{
+		/* the rest of the longer lines is skipped as well */
+		if(sscanf(buf, "%lx-%lx %4s", &from, &to, perms) != 3
+				|| start < from || start >= to)
+			continue;
+		if(end <= to)
+			ret = ((perms[0] == 'r') ? PROT_READ : 0)
+				| ((perms[1] == 'w') ? PROT_WRITE : 0)
+				| ((perms[2] == 'x') ? PROT_EXEC : 0);
+		break;
+	}
+	fclose(fp);
+	return ret;
+}
+
+
+/* agent_record */
+/* called from the trampolines, on any thread of the program */
+static void _agent_record(AgentFrame const * frame)
+{
+	AgentBuffer * buffer = _agent_buffer;
+	AgentSlot * slot;
+	uint64_t position;
+	uint64_t sequence;
+	struct timespec ts;
+
+	if(_agent_busy)
+		return;
+	_agent_busy = 1;
+	if(_agent_thread == 0)
+		_agent_thread = syscall(SYS_gettid);
+	/* claim the next slot, unless the debugger is still to read it */
+	position = __atomic_load_n(&buffer->head, __ATOMIC_RELAXED);
+	for(;;)
+	{
+		slot = &buffer->slots[position & (AGENT_EVENTS - 1)];
+		sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+		if(sequence == position)
+		{
+			if(__atomic_compare_exchange_n(&buffer->head, &position,
+						position + 1, 1,
+						__ATOMIC_RELAXED,
+						__ATOMIC_RELAXED))
+				break;
+		}
+		else if((int64_t)(sequence - position) < 0)
+		{
+			__atomic_fetch_add(&buffer->tracepoints[
+					frame->tracepoint].dropped, 1,
+					__ATOMIC_RELAXED);
+			_agent_busy = 0;
+			return;
+		}
+		else
+			position = __atomic_load_n(&buffer->head,
+					__ATOMIC_RELAXED);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	slot->event.tracepoint = frame->tracepoint;
+	slot->event.thread = _agent_thread;
+	slot->event.time = (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+	slot->event.arguments[0] = frame->rdi;
+	slot->event.arguments[1] = frame->rsi;
+	slot->event.arguments[2] = frame->rdx;
+	slot->event.arguments[3] = frame->rcx;
+	slot->event.arguments[4] = frame->r8;
+	slot->event.arguments[5] = frame->r9;
+	slot->event.stack = (uintptr_t)(frame + 1) + 128;
+	/* the debugger may read it now */
+	__atomic_store_n(&slot->sequence, position + 1, __ATOMIC_RELEASE);
+	_agent_busy = 0;
+}
+
+
+/* agent_trampoline */
+static unsigned char * _trampoline_map(unsigned char const * address,
+		uintptr_t hint);
+
+static unsigned char * _agent_trampoline(unsigned char const * address)
+{
+	const uintptr_t base = (uintptr_t)address & ~(uintptr_t)0xffff;
+	unsigned char * page;
+	uintptr_t step;
+	size_t i;
+
+	if(_agent_page_size == 0)
+		_agent_page_size = sysconf(_SC_PAGESIZE);
+	/* the current page, if within reach with room left */
+	if(_agent_page != NULL && _agent_page_used + AGENT_TRAMPOLINE
+			<= _agent_page_size
+			&& _trampoline_map(address, (uintptr_t)_agent_page)
+			== _agent_page)
+	{
+		if(mprotect(_agent_page, _agent_page_size, PROT_READ
+					| PROT_WRITE) != 0)
+			return NULL;
+		_agent_page_used += AGENT_TRAMPOLINE;
+		return _agent_page + _agent_page_used - AGENT_TRAMPOLINE;
+	}
+	/* otherwise a new one, the closest first */
+	for(i = 1; i <= AGENT_REACH_STEPS; i++)
+	{
+		step = i * AGENT_REACH_STEP;
+		if(base > step && (page = _trampoline_map(address, base - step))
+				!= NULL)
+			break;
+		if(UINTPTR_MAX - base > step && (page = _trampoline_map(
+						address, base + step)) != NULL)
+			break;
+	}
+	if(i > AGENT_REACH_STEPS)
+		return NULL;
+	_agent_page = page;
+	_agent_page_used = AGENT_TRAMPOLINE;
+	return page;
+}
+
+static unsigned char * _trampoline_map(unsigned char const * address,
+		uintptr_t hint)
+{
+	unsigned char * page = (unsigned char *)hint;
+	int64_t distance;
+
+	/* the page is only mapped if it is not already */
+	if(page != _agent_page && (page = mmap(page, _agent_page_size,
+					PROT_READ | PROT_WRITE,
+					MAP_PRIVATE | MAP_ANONYMOUS, -1, 0))
+			== MAP_FAILED)
+		return NULL;
+	distance = (int64_t)((uintptr_t)page - (uintptr_t)address);
+	if(distance > INT32_MAX - (int64_t)_agent_page_size
+			|| distance < INT32_MIN + (int64_t)_agent_page_size)
+	{
+		if(page != _agent_page)
+			munmap(page, _agent_page_size);
+		return NULL;
+	}
+	return page;
+}
+
+
+/* callbacks */
+/* agent_on_fork */
+static void _agent_on_fork(void)
+{
+	/* the thread forking is another one in the child */
+	_agent_thread = 0;
+}
+#endif /* __linux__ && __x86_64__ */
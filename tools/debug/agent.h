@@ -0,0 +1,109 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+
+#ifndef CODER_DEBUGGER_DEBUG_AGENT_H
+# define CODER_DEBUGGER_DEBUG_AGENT_H
+
+# include <stdint.h>
+
+
+/* Agent */
+/* the linux plug-in preloads the agent into the program, which patches the
+ * tracepoints into jumps and records the events into shared memory */
+/* constants */
+/* the name of the shared memory object, in the environment */
+# define AGENT_ENVIRONMENT	"CODER_AGENT"
+# define AGENT_MAGIC		0x544e4741
+# define AGENT_VERSION		1
+
+# define AGENT_TRACEPOINTS	64
+/* events buffered at most, a power of two */
+# define AGENT_EVENTS		65536
+/* rdi, rsi, rdx, rcx, r8 and r9 */
+# define AGENT_ARGUMENTS	6
+
+
+/* types */
+typedef enum _AgentStatus
+{
+	AS_PENDING = 0,
+	AS_ACTIVE,
+	/* the code patched cannot be moved to the trampoline */
+	AS_UNSUPPORTED,
+	/* no trampoline could be allocated close enough */
+	AS_UNREACHABLE,
+	AS_FAILED
+} AgentStatus;
+# define AS_LAST AS_FAILED
+# define AS_COUNT (AS_LAST + 1)
+
+typedef struct _AgentTracepoint
+{
+	/* set by the debugger */
+	uint64_t address;
+	/* set by the agent */
+	uint32_t status;
+	uint32_t padding;
+	/* events lost as the buffer was full */
+	uint64_t dropped;
+} AgentTracepoint;
+
+typedef struct _AgentEvent
+{
+	uint32_t tracepoint;
+	uint32_t thread;
+	/* CLOCK_MONOTONIC, in nanoseconds */
+	uint64_t time;
+	uint64_t arguments[AGENT_ARGUMENTS];
+	/* the stack pointer, as on the tracepoint */
+	uint64_t stack;
+} AgentEvent;
+
+/* an event can be read once its sequence is its position plus one, and
+ * written again once it is its position plus AGENT_EVENTS */
+typedef struct _AgentSlot
+{
+	uint64_t sequence;
+	AgentEvent event;
+} AgentSlot;
+
+typedef struct _AgentBuffer
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t tracepoints_cnt;
+	uint32_t padding;
+	AgentTracepoint tracepoints[AGENT_TRACEPOINTS];
+
+	/* the next position written, shared by every thread of the program */
+	uint64_t head __attribute__((aligned(64)));
+
+	/* read by the debugger alone, in order */
+	AgentSlot slots[AGENT_EVENTS] __attribute__((aligned(64)));
+} AgentBuffer;
+
+#endif /* !CODER_DEBUGGER_DEBUG_AGENT_H */
@@ -0,0 +1,1905 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <libintl.h>
+#include <glib.h>
+#include "../debug.h"
+#define _(string) gettext(string)
+
+
+/* gdb */
+/* private */
+/* types */
+typedef struct _DebuggerDebug GdbDebug;
+
+typedef struct _GdbBreakpoint
+{
+	uint64_t address;
+	gboolean inserted;
+	DebuggerDebugBreakpoint statistics;
+} GdbBreakpoint;
+
+/* memory read since the last stop */
+typedef struct _GdbMemory
+{
+	uint64_t address;
+	size_t size;
+	unsigned char data[];
+} GdbMemory;
+
+typedef struct _GdbRange
+{
+	size_t offset;
+	size_t size;
+} GdbRange;
+
+typedef struct _GdbRegister
+{
+	char * name;
+	unsigned int number;
+	/* in bytes, within the reply to "g" */
+	size_t offset;
+	size_t size;
+	/* as of the last stop */
+	gboolean set;
+	uint64_t value;
+} GdbRegister;
+
+/* memory read in chunks, then the parts the replies fell short of */
+typedef struct _GdbTransfer
+{
+	uint64_t address;
+	unsigned char * buf;
+	/* shortened on errors */
+	size_t size;
+	GArray * missing;
+	/* as sent, answered from the first reply on */
+	GArray * queued;
+	size_t first;
+} GdbTransfer;
+
+struct _DebuggerDebug
+{
+	DebuggerDebugHelper const * helper;
+
+	/* connection */
+	int fd;
+	GIOChannel * channel;
+	guint source;
+	/* the server spawned, if any */
+	GPid pid;
+	int server;
+	/* received and not parsed yet */
+	GString * input;
+	/* framed, sent at once and answered in order */
+	GPtrArray * queue;
+	size_t expected;
+	GPtrArray * replies;
+
+	/* features of the remote target */
+	gboolean noack;
+	size_t packet;
+	gboolean binary;
+	gboolean features;
+	gboolean vcont;
+	gboolean syscalls;
+
+	/* registers, by number */
+	GArray * registers;
+	char * architecture;
+	GdbRegister * pc;
+	GdbRegister * sp;
+
+	/* program */
+	gboolean running;
+	gboolean exited;
+	/* the first stop, reported from the main loop */
+	GString * stop;
+	guint idle;
+	char * thread;
+	/* delivered when resuming */
+	unsigned int signal;
+	gboolean stepping;
+	gboolean catching;
+
+	/* read at the stack pointer on every stop */
+	size_t stack;
+	GSList * cache;
+
+	/* breakpoints, by address */
+	GHashTable * breakpoints;
+};
+
+
+/* constants */
+/* the remote target, as host:port or the path to a socket */
+#define GDB_ENVIRONMENT		"CODER_GDB_REMOTE"
+/* spawned otherwise, talking over its standard input and output */
+#define GDB_SERVER		"gdbserver"
+/* packets are never larger, whatever the remote target accepts */
+#define GDB_PACKET_SIZE		400
+#define GDB_PACKET_MAX		0x10000
+/* bytes read at the stack pointer until the debugger asks otherwise */
+#define GDB_STACK		4096
+#define GDB_STACK_MAX		0x100000
+/* in milliseconds */
+#define GDB_TIMEOUT		10000
+/* target descriptions included from another */
+#define GDB_FEATURES_DEPTH	4
+
+/* signals, as numbered by the protocol */
+#define GDB_SIGNAL_INT		2
+#define GDB_SIGNAL_TRAP		5
+
+/* assumed without any target description */
+static const struct
+{
+	char const * name;
+	size_t size;
+} _gdb_registers_amd64[] =
+{
+	{ "rax", 8 }, { "rbx", 8 }, { "rcx", 8 }, { "rdx", 8 },
+	{ "rsi", 8 }, { "rdi", 8 }, { "rbp", 8 }, { "rsp", 8 },
+	{ "r8", 8 }, { "r9", 8 }, { "r10", 8 }, { "r11", 8 },
+	{ "r12", 8 }, { "r13", 8 }, { "r14", 8 }, { "r15", 8 },
+	{ "rip", 8 }, { "eflags", 4 }, { "cs", 4 }, { "ss", 4 },
+	{ "ds", 4 }, { "es", 4 }, { "fs", 4 }, { "gs", 4 }
+};
+
+
+/* prototypes */
+/* plug-in */
+static GdbDebug * _gdb_init(DebuggerDebugHelper const * helper);
+static void _gdb_destroy(GdbDebug * debug);
+static int _gdb_start(GdbDebug * debug, va_list argp);
+static int _gdb_pause(GdbDebug * debug);
+static int _gdb_stop(GdbDebug * debug);
+static int _gdb_continue(GdbDebug * debug);
+static int _gdb_next(GdbDebug * debug);
+static int _gdb_step(GdbDebug * debug);
+static ssize_t _gdb_read_memory(GdbDebug * debug, uint64_t address,
+		void * buf, size_t size);
+static ssize_t _gdb_write_memory(GdbDebug * debug, uint64_t address,
+		void const * buf, size_t size);
+static int _gdb_add_breakpoint(GdbDebug * debug, uint64_t address,
+		DebuggerDebugCondition const * condition);
+static int _gdb_remove_breakpoint(GdbDebug * debug, uint64_t address);
+
+/* useful */
+static unsigned int _gdb_breakpoint_kind(GdbDebug * debug);
+static void _gdb_breakpoint_report(GdbDebug * debug);
+static int _gdb_breakpoints_insert(GdbDebug * debug);
+static void _gdb_cache_add(GdbDebug * debug, uint64_t address,
+		void const * buf, size_t size);
+static void _gdb_cache_clear(GdbDebug * debug);
+static void _gdb_close(GdbDebug * debug);
+static int _gdb_connect(GdbDebug * debug, char const * remote);
+static int _gdb_features(GdbDebug * debug);
+static int _gdb_flush(GdbDebug * debug);
+static void _gdb_frame(GdbDebug * debug, char const * data, size_t size,
+		gboolean reply);
+static int _gdb_halt(GdbDebug * debug);
+static int _gdb_handshake(GdbDebug * debug);
+static ssize_t _gdb_memory_read(GdbDebug * debug, uint64_t address,
+		void * buf, size_t size);
+static void _gdb_output(GdbDebug * debug, GString const * packet);
+static int _gdb_packet(GdbDebug * debug, GString * packet);
+static void _gdb_queue(GdbDebug * debug, char const * format, ...);
+static int _gdb_read(GdbDebug * debug);
+static int _gdb_receive(GdbDebug * debug, GString * packet);
+static int _gdb_refresh(GdbDebug * debug);
+static GdbRegister * _gdb_register(GdbDebug * debug, unsigned int number);
+static void _gdb_register_report(GdbDebug * debug);
+static int _gdb_register_value(GdbRegister * reg, char const * hex,
+		size_t size);
+static GString * _gdb_reply(GdbDebug * debug, size_t i);
+static int _gdb_resume(GdbDebug * debug, gboolean step, gboolean syscalls);
+static int _gdb_spawn(GdbDebug * debug, char const * filename);
+static int _gdb_stop_parse(GdbDebug * debug, GString const * packet);
+static int _gdb_stopped(GdbDebug * debug, GString const * packet);
+static void _gdb_transfer_destroy(GdbTransfer * transfer);
+static void _gdb_transfer_init(GdbTransfer * transfer, uint64_t address,
+		void * buf, size_t size);
+static size_t _gdb_transfer_parse(GdbDebug * debug, GdbTransfer * transfer);
+static void _gdb_transfer_queue(GdbDebug * debug, GdbTransfer * transfer);
+static int _gdb_write(GdbDebug * debug, char const * data, size_t size);
+
+/* callbacks */
+static void _gdb_on_child_setup(gpointer data);
+static gboolean _gdb_on_input(GIOChannel * source, GIOCondition condition,
+		gpointer data);
+static gboolean _gdb_on_started(gpointer data);
+
+
+/* constants */
+DebuggerDebugDefinition debug =
+{
+	"gdb",
+	NULL,
+	LICENSE_BSD3_FLAGS,
+	_gdb_init,
+	_gdb_destroy,
+	_gdb_start,
+	_gdb_pause,
+	_gdb_stop,
+	_gdb_continue,
+	_gdb_next,
+	_gdb_step,
+	_gdb_read_memory,
+	_gdb_write_memory,
+	_gdb_add_breakpoint,
+	_gdb_remove_breakpoint,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL
+};
+
+
+/* protected */
+/* functions */
+/* plug-in */
+/* gdb_init */
+static GdbDebug * _gdb_init(DebuggerDebugHelper const * helper)
+{
+	GdbDebug * debug;
+
+	if((debug = object_new(sizeof(*debug))) == NULL)
+		return NULL;
+	debug->helper = helper;
+	debug->fd = -1;
+	debug->channel = NULL;
+	debug->source = 0;
+	debug->pid = -1;
+	debug->server = -1;
+	debug->input = g_string_new(NULL);
+	debug->queue = g_ptr_array_new();
+	debug->expected = 0;
+	debug->replies = g_ptr_array_new();
+	debug->noack = FALSE;
+	debug->packet = GDB_PACKET_SIZE;
+	debug->binary = FALSE;
+	debug->features = FALSE;
+	debug->vcont = FALSE;
+	debug->syscalls = FALSE;
+	debug->registers = g_array_new(FALSE, FALSE, sizeof(GdbRegister));
+	debug->architecture = NULL;
+	debug->pc = NULL;
+	debug->sp = NULL;
+	debug->running = FALSE;
+	debug->exited = FALSE;
+	debug->stop = NULL;
+	debug->idle = 0;
+	debug->thread = NULL;
+	debug->signal = 0;
+	debug->stepping = FALSE;
+	debug->catching = FALSE;
+	debug->stack = GDB_STACK;
+	debug->cache = NULL;
+	debug->breakpoints = g_hash_table_new_full(g_int64_hash,
+			g_int64_equal, NULL, g_free);
+	return debug;
+}
+
+
+/* gdb_destroy */
+static void _gdb_destroy(GdbDebug * debug)
+{
+	size_t i;
+
+	_gdb_stop(debug);
+	g_string_free(debug->input, TRUE);
+	g_ptr_array_free(debug->queue, TRUE);
+	for(i = 0; i < debug->replies->len; i++)
+		g_string_free(g_ptr_array_index(debug->replies, i), TRUE);
+	g_ptr_array_free(debug->replies, TRUE);
+	for(i = 0; i < debug->registers->len; i++)
+		g_free(g_array_index(debug->registers, GdbRegister, i).name);
+	g_array_free(debug->registers, TRUE);
+	g_free(debug->architecture);
+	g_free(debug->thread);
+	g_hash_table_destroy(debug->breakpoints);
+	object_delete(debug);
+}
+
+
+/* gdb_start */
+static int _gdb_start(GdbDebug * debug, va_list argp)
+{
+	char const * filename;
+	char const * remote;
+	GString * vcont;
+	GString * stop;
+
+	if((filename = va_arg(argp, char const *)) == NULL)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(EINVAL));
+	if(debug->fd >= 0)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(EBUSY));
+	debug->exited = FALSE;
+	/* the remote target already runs the program if set */
+	if((remote = getenv(GDB_ENVIRONMENT)) != NULL && remote[0] != '\0')
+	{
+		if(_gdb_connect(debug, remote) != 0)
+			return -debug->helper->error(debug->helper->debugger,
+					1, "%s", error_get(NULL));
+	}
+	else if(_gdb_spawn(debug, filename) != 0)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s: %s", _("Could not start execution"),
+				error_get(NULL));
+	if(_gdb_handshake(debug) != 0 || _gdb_features(debug) != 0)
+	{
+		_gdb_close(debug);
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", error_get(NULL));
+	}
+	/* the breakpoints are inserted along with these requests */
+	_gdb_queue(debug, "vCont?");
+	_gdb_queue(debug, "?");
+	if(_gdb_breakpoints_insert(debug) != 0)
+	{
+		_gdb_close(debug);
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", error_get(NULL));
+	}
+	vcont = _gdb_reply(debug, 0);
+	debug->vcont = (strncmp(vcont->str, "vCont", 5) == 0
+			&& strstr(vcont->str, ";c") != NULL
+			&& strstr(vcont->str, ";s") != NULL);
+	stop = _gdb_reply(debug, 1);
+	debug->stop = g_string_new_len(stop->str, stop->len);
+	debug->idle = g_idle_add(_gdb_on_started, debug);
+	debug->channel = g_io_channel_unix_new(debug->fd);
+	debug->source = g_io_add_watch(debug->channel, G_IO_IN | G_IO_ERR
+			| G_IO_HUP, _gdb_on_input, debug);
+	return 0;
+}
+
+
+/* gdb_pause */
+static int _gdb_pause(GdbDebug * debug)
+{
+	if(debug->fd < 0 || debug->exited)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", _("No process is being debugged"));
+	if(!debug->running)
+		return 0;
+	/* reported as any other stop */
+	if(_gdb_write(debug, "\003", 1) != 0)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", error_get(NULL));
+	return 0;
+}
+
+
+/* gdb_stop */
+static int _gdb_stop(GdbDebug * debug)
+{
+	if(debug->fd < 0)
+		return 0;
+	if(!debug->exited)
+	{
+		/* neither is answered */
+		if(debug->running)
+			_gdb_write(debug, "\003", 1);
+		_gdb_frame(debug, "k", 1, FALSE);
+		_gdb_flush(debug);
+	}
+	_gdb_close(debug);
+	return 0;
+}
+
+
+/* gdb_continue */
+static int _gdb_continue(GdbDebug * debug)
+{
+	return _gdb_resume(debug, FALSE, FALSE);
+}
+
+
+/* gdb_next */
+static int _gdb_next(GdbDebug * debug)
+{
+	/* until the next system call, if the remote target can tell */
+	return _gdb_resume(debug, !debug->syscalls, debug->syscalls);
+}
+
+
+/* gdb_step */
+static int _gdb_step(GdbDebug * debug)
+{
+	return _gdb_resume(debug, TRUE, FALSE);
+}
+
+
+/* gdb_read_memory */
+static ssize_t _gdb_read_memory(GdbDebug * debug, uint64_t address,
+		void * buf, size_t size)
+{
+	GSList * p;
+	GdbMemory * memory;
+
+	if(debug->fd < 0 || debug->exited)
+		return -error_set_code(1, "%s",
+				_("No process is being debugged"));
+	if(debug->running)
+		return -error_set_code(1, "%s", _("The program is running"));
+	if(size == 0)
+		return 0;
+	/* prefetched on the next stops */
+	if(debug->sp != NULL && debug->sp->set
+			&& address == debug->sp->value)
+		debug->stack = MIN(size, GDB_STACK_MAX);
+	for(p = debug->cache; p != NULL; p = p->next)
+	{
+		memory = p->data;
+		if(address >= memory->address && address + size
+				<= memory->address + memory->size)
+		{
+			memcpy(buf, &memory->data[address - memory->address],
+					size);
+			return size;
+		}
+	}
+	return _gdb_memory_read(debug, address, buf, size);
+}
+
+
+/* gdb_write_memory */
+static ssize_t _gdb_write_memory(GdbDebug * debug, uint64_t address,
+		void const * buf, size_t size)
+{
+	unsigned char const * b = buf;
+	const size_t chunk = (debug->packet - 32) / 2;
+	GString * packet;
+	size_t cnt = 0;
+	size_t i;
+	size_t j;
+	ssize_t ret = 0;
+
+	if(debug->fd < 0 || debug->exited)
+		return -error_set_code(1, "%s",
+				_("No process is being debugged"));
+	if(debug->running)
+		return -error_set_code(1, "%s", _("The program is running"));
+	_gdb_cache_clear(debug);
+	/* every chunk at once */
+	packet = g_string_new(NULL);
+	for(i = 0; i < size; i += chunk, cnt++)
+	{
+		g_string_printf(packet, "M%" PRIx64 ",%zx:", address + i,
+				MIN(chunk, size - i));
+		for(j = i; j < size && j < i + chunk; j++)
+			g_string_append_printf(packet, "%02x", b[j]);
+		_gdb_frame(debug, packet->str, packet->len, TRUE);
+	}
+	g_string_free(packet, TRUE);
+	if(_gdb_flush(debug) != 0)
+		return -1;
+	for(i = 0; i < cnt; i++)
+	{
+		if(strcmp(_gdb_reply(debug, i)->str, "OK") != 0)
+			break;
+		ret += MIN(chunk, size - i * chunk);
+	}
+	if(ret == 0)
+		return -error_set_code(1, "%s", _("Could not write memory"));
+	return ret;
+}
+
+
+/* gdb_add_breakpoint */
+static int _gdb_add_breakpoint(GdbDebug * debug, uint64_t address,
+		DebuggerDebugCondition const * condition)
+{
+	GdbBreakpoint * breakpoint;
+	gboolean running = debug->running;
+	int halted = 0;
+	int ret;
+
+	if(condition != NULL)
+		return -debug->helper->error(debug->helper->debugger, 1, "%s",
+				_("Conditional breakpoints are not supported"
+					" by this plug-in"));
+	if(g_hash_table_lookup(debug->breakpoints, &address) != NULL)
+		return 0;
+	breakpoint = g_new(GdbBreakpoint, 1);
+	breakpoint->address = address;
+	breakpoint->inserted = FALSE;
+	memset(&breakpoint->statistics, 0, sizeof(breakpoint->statistics));
+	breakpoint->statistics.address = address;
+	g_hash_table_insert(debug->breakpoints, &breakpoint->address,
+			breakpoint);
+	/* inserted once the program is started */
+	if(debug->fd < 0 || debug->exited)
+		return 0;
+	/* the remote target only handles requests while stopped */
+	if(running && (halted = _gdb_halt(debug)) < 0)
+		return -debug->helper->error(debug->helper->debugger, 1, "%s",
+				error_get(NULL));
+	if(debug->exited)
+		return 0;
+	if((ret = _gdb_breakpoints_insert(debug)) != 0)
+	{
+		g_hash_table_remove(debug->breakpoints, &address);
+		debug->helper->error(debug->helper->debugger, 1, "%s",
+				error_get(NULL));
+	}
+	/* unless it stopped on its own meanwhile */
+	if(running && halted == 0)
+		_gdb_resume(debug, FALSE, debug->catching);
+	return ret;
+}
+
+
+/* gdb_remove_breakpoint */
+static int _gdb_remove_breakpoint(GdbDebug * debug, uint64_t address)
+{
+	GdbBreakpoint * breakpoint;
+	gboolean running = debug->running;
+	int halted = 0;
+	int ret = 0;
+
+	if((breakpoint = g_hash_table_lookup(debug->breakpoints, &address))
+			== NULL)
+		return 0;
+	if(running && breakpoint->inserted && !debug->exited
+			&& (halted = _gdb_halt(debug)) < 0)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", error_get(NULL));
+	if(breakpoint->inserted && !debug->exited)
+	{
+		_gdb_queue(debug, "z0,%" PRIx64 ",%u", address,
+				_gdb_breakpoint_kind(debug));
+		if(_gdb_flush(debug) != 0)
+			ret = -debug->helper->error(debug->helper->debugger,
+					1, "%s", error_get(NULL));
+		else if(strcmp(_gdb_reply(debug, 0)->str, "OK") != 0)
+			ret = -debug->helper->error(debug->helper->debugger,
+					1, "%s", _("Could not remove the"
+						" breakpoint"));
+		if(running && halted == 0)
+			_gdb_resume(debug, FALSE, debug->catching);
+	}
+	g_hash_table_remove(debug->breakpoints, &address);
+	return ret;
+}
+
+
+/* useful */
+/* gdb_breakpoint_kind */
+static unsigned int _gdb_breakpoint_kind(GdbDebug * debug)
+{
+	/* the size of the breakpoint instruction */
+	if(debug->architecture == NULL
+			|| strncmp(debug->architecture, "i386", 4) == 0)
+		return 1;
+	return 4;
+}
+
+
+/* gdb_breakpoint_report */
+static void _gdb_breakpoint_report(GdbDebug * debug)
+{
+	DebuggerDebugHelper const * helper = debug->helper;
+	DebuggerDebugBreakpoint * breakpoints;
+	size_t cnt = 0;
+	GHashTableIter iter;
+	gpointer value;
+
+	if(g_hash_table_size(debug->breakpoints) == 0)
+		return;
+	breakpoints = g_new(DebuggerDebugBreakpoint,
+			g_hash_table_size(debug->breakpoints));
+	g_hash_table_iter_init(&iter, debug->breakpoints);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+		breakpoints[cnt++] = ((GdbBreakpoint *)value)->statistics;
+	helper->set_breakpoints(helper->debugger, breakpoints, cnt);
+	g_free(breakpoints);
+}
+
+
+/* gdb_breakpoints_insert */
+static int _gdb_breakpoints_insert(GdbDebug * debug)
+{
+	GHashTableIter iter;
+	gpointer value;
+	GdbBreakpoint * breakpoint;
+	GdbBreakpoint ** pending;
+	size_t first = debug->expected;
+	size_t cnt = 0;
+	size_t i;
+	GString * reply;
+	int ret = 0;
+
+	/* along with any request queued already */
+	pending = g_new(GdbBreakpoint *,
+			g_hash_table_size(debug->breakpoints) + 1);
+	g_hash_table_iter_init(&iter, debug->breakpoints);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		if((breakpoint = value)->inserted)
+			continue;
+		_gdb_queue(debug, "Z0,%" PRIx64 ",%u", breakpoint->address,
+				_gdb_breakpoint_kind(debug));
+		pending[cnt++] = breakpoint;
+	}
+	if(_gdb_flush(debug) != 0)
+	{
+		g_free(pending);
+		return -1;
+	}
+	for(i = 0; i < cnt; i++)
+	{
+		reply = _gdb_reply(debug, first + i);
+		if(strcmp(reply->str, "OK") == 0)
+			pending[i]->inserted = TRUE;
+		else if(ret == 0)
+			ret = -error_set_code(1, "%s", (reply->len == 0)
+					? _("Breakpoints are not supported by"
+						" the remote target")
+					: _("Could not insert the breakpoint"));
+	}
+	g_free(pending);
+	return ret;
+}
+
+
+/* gdb_cache_add */
+static void _gdb_cache_add(GdbDebug * debug, uint64_t address,
+		void const * buf, size_t size)
+{
+	GdbMemory * memory;
+
+	/* valid until resuming */
+	memory = g_malloc(sizeof(*memory) + size);
+	memory->address = address;
+	memory->size = size;
+	memcpy(memory->data, buf, size);
+	debug->cache = g_slist_prepend(debug->cache, memory);
+}
+
+
+/* gdb_cache_clear */
+static void _gdb_cache_clear(GdbDebug * debug)
+{
+	GSList * p;
+
+	for(p = debug->cache; p != NULL; p = p->next)
+		g_free(p->data);
+	g_slist_free(debug->cache);
+	debug->cache = NULL;
+}
+
+
+/* gdb_close */
+static void _gdb_close(GdbDebug * debug)
+{
+	size_t i;
+
+	if(debug->idle != 0)
+		g_source_remove(debug->idle);
+	debug->idle = 0;
+	if(debug->stop != NULL)
+		g_string_free(debug->stop, TRUE);
+	debug->stop = NULL;
+	if(debug->source != 0)
+		g_source_remove(debug->source);
+	debug->source = 0;
+	if(debug->channel != NULL)
+		g_io_channel_unref(debug->channel);
+	debug->channel = NULL;
+	if(debug->fd >= 0)
+		close(debug->fd);
+	debug->fd = -1;
+	if(debug->server >= 0)
+		close(debug->server);
+	debug->server = -1;
+	/* the program was killed along with the connection */
+	if(debug->pid > 0)
+	{
+		kill(debug->pid, SIGKILL);
+		waitpid(debug->pid, NULL, 0);
+		g_spawn_close_pid(debug->pid);
+	}
+	debug->pid = -1;
+	g_string_truncate(debug->input, 0);
+	for(i = 0; i < debug->queue->len; i++)
+		g_free(g_ptr_array_index(debug->queue, i));
+	g_ptr_array_set_size(debug->queue, 0);
+	debug->expected = 0;
+	debug->running = FALSE;
+	debug->exited = TRUE;
+	_gdb_cache_clear(debug);
+}
+
+
+/* gdb_connect */
+static int _connect_inet(GdbDebug * debug, char const * remote);
+static int _connect_unix(GdbDebug * debug, char const * remote);
+
+static int _gdb_connect(GdbDebug * debug, char const * remote)
+{
+	if(strchr(remote, '/') != NULL || strchr(remote, ':') == NULL)
+		return _connect_unix(debug, remote);
+	return _connect_inet(debug, remote);
+}
+
+static int _connect_inet(GdbDebug * debug, char const * remote)
+{
+	char * host;
+	char * port;
+	struct addrinfo hints;
+	struct addrinfo * ai;
+	struct addrinfo * p;
+	int res;
+	const int one = 1;
+
+	host = g_strdup(remote);
+	port = strrchr(host, ':');
+	*(port++) = '\0';
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	if((res = getaddrinfo((host[0] != '\0') ? host : NULL, port, &hints,
+					&ai)) != 0)
+	{
+		error_set_code(1, "%s: %s", remote, gai_strerror(res));
+		g_free(host);
+		return -1;
+	}
+	g_free(host);
+	for(p = ai; p != NULL; p = p->ai_next)
+	{
+		if((debug->fd = socket(p->ai_family, p->ai_socktype,
+						p->ai_protocol)) < 0)
+			continue;
+		if(connect(debug->fd, p->ai_addr, p->ai_addrlen) == 0)
+			break;
+		close(debug->fd);
+		debug->fd = -1;
+	}
+	freeaddrinfo(ai);
+	if(debug->fd < 0)
+		return -error_set_code(-errno, "%s: %s", remote,
+				strerror(errno));
+	/* pipelined requests are not delayed */
+	setsockopt(debug->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	return 0;
+}
+
+static int _connect_unix(GdbDebug * debug, char const * remote)
+{
+	struct sockaddr_un sun;
+
+	if(strlen(remote) >= sizeof(sun.sun_path))
+		return -error_set_code(1, "%s: %s", remote,
+				strerror(ENAMETOOLONG));
+	memset(&sun, 0, sizeof(sun));
+	sun.sun_family = AF_UNIX;
+	strcpy(sun.sun_path, remote);
+	if((debug->fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+		return -error_set_code(-errno, "%s: %s", "socket",
+				strerror(errno));
+	if(connect(debug->fd, (struct sockaddr *)&sun, sizeof(sun)) != 0)
+	{
+		error_set_code(-errno, "%s: %s", remote, strerror(errno));
+		close(debug->fd);
+		debug->fd = -1;
+		return -1;
+	}
+	return 0;
+}
+
+
+/* gdb_features */
+static char * _features_attribute(char const * tag, char const * name);
+static gint _features_compare(gconstpointer a, gconstpointer b);
+static int _features_fetch(GdbDebug * debug, GHashTable * documents,
+		GPtrArray * annexes);
+static void _features_free(gpointer data);
+static void _features_parse(GdbDebug * debug, GHashTable * documents,
+		char const * annex, unsigned int depth, unsigned int * number);
+
+static int _gdb_features(GdbDebug * debug)
+{
+	GHashTable * documents;
+	GPtrArray * annexes;
+	unsigned int depth;
+	unsigned int number = 0;
+	GdbRegister reg;
+	GdbRegister * r;
+	size_t offset = 0;
+	size_t i;
+	int ret = 0;
+
+	if(debug->features)
+	{
+		documents = g_hash_table_new_full(g_str_hash, g_str_equal,
+				g_free, _features_free);
+		annexes = g_ptr_array_new();
+		g_ptr_array_add(annexes, g_strdup("target.xml"));
+		/* the documents included are fetched a level at once */
+		for(depth = 0; ret == 0 && annexes->len > 0
+				&& depth < GDB_FEATURES_DEPTH; depth++)
+			ret = _features_fetch(debug, documents, annexes);
+		if(ret == 0)
+			_features_parse(debug, documents, "target.xml", 0,
+					&number);
+		for(i = 0; i < annexes->len; i++)
+			g_free(g_ptr_array_index(annexes, i));
+		g_ptr_array_free(annexes, TRUE);
+		g_hash_table_destroy(documents);
+		if(ret != 0)
+			return ret;
+	}
+	if(debug->registers->len == 0)
+		/* the usual layout of most remote targets without any */
+		for(i = 0; i < sizeof(_gdb_registers_amd64)
+				/ sizeof(*_gdb_registers_amd64); i++)
+		{
+			reg.name = g_strdup(_gdb_registers_amd64[i].name);
+			reg.number = i;
+			reg.size = _gdb_registers_amd64[i].size;
+			g_array_append_val(debug->registers, reg);
+		}
+	else
+		g_array_sort(debug->registers, _features_compare);
+	/* as found in the reply to "g" */
+	for(i = 0; i < debug->registers->len; i++)
+	{
+		r = &g_array_index(debug->registers, GdbRegister, i);
+		r->offset = offset;
+		offset += r->size;
+		r->set = FALSE;
+		r->value = 0;
+		if(g_ascii_strcasecmp(r->name, "rip") == 0
+				|| g_ascii_strcasecmp(r->name, "eip") == 0
+				|| g_ascii_strcasecmp(r->name, "pc") == 0)
+			debug->pc = r;
+		else if(g_ascii_strcasecmp(r->name, "rsp") == 0
+				|| g_ascii_strcasecmp(r->name, "esp") == 0
+				|| g_ascii_strcasecmp(r->name, "sp") == 0)
+			debug->sp = r;
+	}
+	return 0;
+}
+
+static char * _features_attribute(char const * tag, char const * name)
+{
+	size_t len = strlen(name);
+	char const * p;
+	char const * q;
+
+	for(p = tag; (p = strstr(p, name)) != NULL; p += len)
+	{
+		if(p == tag || !g_ascii_isspace(p[-1]) || p[len] != '='
+				|| (p[len + 1] != '"' && p[len + 1] != '\''))
+			continue;
+		if((q = strchr(&p[len + 2], p[len + 1])) == NULL)
+			return NULL;
+		return g_strndup(&p[len + 2], q - &p[len + 2]);
+	}
+	return NULL;
+}
+
+static gint _features_compare(gconstpointer a, gconstpointer b)
+{
+	GdbRegister const * ra = a;
+	GdbRegister const * rb = b;
+
+	return (ra->number > rb->number) - (ra->number < rb->number);
+}
+
+static int _features_fetch(GdbDebug * debug, GHashTable * documents,
+		GPtrArray * annexes)
+{
+	const size_t chunk = debug->packet - 1;
+	size_t cnt = annexes->len;
+	GString ** fetched;
+	gboolean * more;
+	GString * reply;
+	char const * p;
+	char const * end;
+	char * tag;
+	char * annex;
+	size_t i;
+	size_t j;
+	int ret = 0;
+
+	fetched = g_new(GString *, cnt);
+	more = g_new(gboolean, cnt);
+	for(i = 0; i < cnt; i++)
+	{
+		fetched[i] = g_string_new(NULL);
+		more[i] = TRUE;
+	}
+	/* the larger documents take a few more requests, all at once */
+	for(j = cnt; ret == 0 && j > 0;)
+	{
+		for(i = 0; i < cnt; i++)
+			if(more[i])
+				_gdb_queue(debug, "qXfer:features:read:%s:"
+						"%zx,%zx", (char *)
+						g_ptr_array_index(annexes, i),
+						fetched[i]->len, chunk);
+		if((ret = _gdb_flush(debug)) != 0)
+			break;
+		for(i = 0, j = 0; i < cnt; i++)
+		{
+			if(!more[i])
+				continue;
+			reply = _gdb_reply(debug, j++);
+			if(reply->len == 0 || (reply->str[0] != 'm'
+						&& reply->str[0] != 'l'))
+			{
+				ret = -error_set_code(1, "%s: %s",
+						(char *)g_ptr_array_index(
+							annexes, i),
+						_("Could not read the target"
+							" description"));
+				break;
+			}
+			g_string_append_len(fetched[i], &reply->str[1],
+					reply->len - 1);
+			more[i] = (reply->str[0] == 'm');
+		}
+		for(i = 0, j = 0; i < cnt; i++)
+			j += more[i] ? 1 : 0;
+	}
+	/* the next level */
+	for(i = 0; i < cnt; i++)
+		g_hash_table_insert(documents, g_ptr_array_index(annexes, i),
+				fetched[i]);
+	g_ptr_array_set_size(annexes, 0);
+	for(i = 0; ret == 0 && i < cnt; i++)
+		for(p = fetched[i]->str; (p = strstr(p, "<xi:include")) != NULL;
+				p = end)
+		{
+			if((end = strchr(p, '>')) == NULL)
+				break;
+			tag = g_strndup(p, end - p);
+			annex = _features_attribute(tag, "href");
+			g_free(tag);
+			if(annex == NULL || g_hash_table_lookup(documents,
+						annex) != NULL)
+				g_free(annex);
+			else
+			{
+				/* inserted now to only be fetched once */
+				g_hash_table_insert(documents, g_strdup(annex),
+						g_string_new(NULL));
+				g_ptr_array_add(annexes, annex);
+			}
+		}
+	g_free(more);
+	g_free(fetched);
+	return ret;
+}
+
+static void _features_free(gpointer data)
+{
+	g_string_free(data, TRUE);
+}
+
+static void _features_parse(GdbDebug * debug, GHashTable * documents,
+		char const * annex, unsigned int depth, unsigned int * number)
+{
+	GString * document;
+	char const * p;
+	char const * end;
+	char * tag;
+	char * name;
+	char * s;
+	GdbRegister reg;
+
+	if(depth > GDB_FEATURES_DEPTH || (document = g_hash_table_lookup(
+					documents, annex)) == NULL)
+		return;
+	/* in order, as the registers are numbered from the previous one */
+	for(p = document->str; (p = strchr(p, '<')) != NULL; p = end)
+	{
+		if((end = strchr(p, '>')) == NULL)
+			break;
+		tag = g_strndup(p, end - p);
+		if(strcmp(tag, "<architecture") == 0)
+		{
+			g_free(debug->architecture);
+			debug->architecture = g_strndup(&end[1],
+					strcspn(&end[1], "<"));
+			g_strstrip(debug->architecture);
+		}
+		else if(strncmp(tag, "<xi:include", 11) == 0
+				&& g_ascii_isspace(tag[11])
+				&& (s = _features_attribute(tag, "href"))
+				!= NULL)
+		{
+			_features_parse(debug, documents, s, depth + 1,
+					number);
+			g_free(s);
+		}
+		else if(strncmp(tag, "<reg", 4) == 0
+				&& g_ascii_isspace(tag[4])
+				&& (name = _features_attribute(tag, "name"))
+				!= NULL)
+		{
+			if((s = _features_attribute(tag, "regnum")) != NULL)
+				*number = strtoul(s, NULL, 10);
+			g_free(s);
+			s = _features_attribute(tag, "bitsize");
+			reg.name = name;
+			reg.number = (*number)++;
+			reg.size = (s != NULL) ? (strtoul(s, NULL, 10) + 7) / 8
+				: 0;
+			g_free(s);
+			g_array_append_val(debug->registers, reg);
+		}
+		g_free(tag);
+	}
+}
+
+
+/* gdb_flush */
+static int _gdb_flush(GdbDebug * debug)
+{
+	GString * output;
+	size_t i;
+	int ret = 0;
+
+	while(debug->replies->len < debug->expected)
+		g_ptr_array_add(debug->replies, g_string_new(NULL));
+	if(debug->noack)
+	{
+		/* every request at once, then every reply in order */
+		output = g_string_new(NULL);
+		for(i = 0; i < debug->queue->len; i++)
+			g_string_append(output, g_ptr_array_index(debug->queue,
+						i));
+		ret = _gdb_write(debug, output->str, output->len);
+		g_string_free(output, TRUE);
+		for(i = 0; ret == 0 && i < debug->expected; i++)
+			ret = _gdb_receive(debug, g_ptr_array_index(
+						debug->replies, i));
+	}
+	else
+		/* one at a time, each reply being acknowledged */
+		for(i = 0; ret == 0 && i < debug->queue->len; i++)
+		{
+			output = g_ptr_array_index(debug->queue, i);
+			ret = _gdb_write(debug, (char const *)output,
+					strlen((char const *)output));
+			if(ret == 0 && i < debug->expected)
+				ret = _gdb_receive(debug, g_ptr_array_index(
+							debug->replies, i));
+		}
+	for(i = 0; i < debug->queue->len; i++)
+		g_free(g_ptr_array_index(debug->queue, i));
+	g_ptr_array_set_size(debug->queue, 0);
+	debug->expected = 0;
+	return ret;
+}
+
+
+/* gdb_frame */
+static void _gdb_frame(GdbDebug * debug, char const * data, size_t size,
+		gboolean reply)
+{
+	GString * frame;
+	unsigned char sum = 0;
+	char c;
+	size_t i;
+
+	frame = g_string_sized_new(size + 4);
+	g_string_append_c(frame, '$');
+	for(i = 0; i < size; i++)
+	{
+		if((c = data[i]) == '#' || c == '$' || c == '}' || c == '*')
+		{
+			g_string_append_c(frame, '}');
+			sum += '}';
+			c ^= 0x20;
+		}
+		g_string_append_c(frame, c);
+		sum += c;
+	}
+	g_string_append_printf(frame, "#%02x", sum);
+	g_ptr_array_add(debug->queue, g_string_free(frame, FALSE));
+	/* the requests answered are queued first */
+	if(reply)
+		debug->expected++;
+}
+
+
+/* gdb_halt */
+static int _gdb_halt(GdbDebug * debug)
+{
+	GString * packet;
+	int ret;
+
+	if(_gdb_write(debug, "\003", 1) != 0)
+		return -1;
+	packet = g_string_new(NULL);
+	/* the output of the program may come first */
+	while((ret = _gdb_receive(debug, packet)) == 0
+			&& packet->str[0] == 'O')
+		_gdb_output(debug, packet);
+	if(ret == 0)
+	{
+		debug->running = FALSE;
+		/* only reported if stopped for another reason meanwhile */
+		if((packet->str[0] == 'S' || packet->str[0] == 'T')
+				&& _gdb_stop_parse(debug, packet)
+				== GDB_SIGNAL_INT)
+			ret = 0;
+		else
+		{
+			_gdb_stopped(debug, packet);
+			ret = 1;
+		}
+	}
+	g_string_free(packet, TRUE);
+	return ret;
+}
+
+
+/* gdb_handshake */
+static int _gdb_handshake(GdbDebug * debug)
+{
+	gchar ** features;
+	gboolean noack = FALSE;
+	size_t i;
+
+	/* gdbserver only describes the x86 registers if asked to */
+	_gdb_queue(debug, "qSupported:swbreak+;hwbreak+;vContSupported+"
+			";xmlRegisters=i386");
+	if(_gdb_flush(debug) != 0)
+		return -1;
+	features = g_strsplit(_gdb_reply(debug, 0)->str, ";", -1);
+	for(i = 0; features[i] != NULL; i++)
+		if(strncmp(features[i], "PacketSize=", 11) == 0)
+			debug->packet = MAX(GDB_PACKET_SIZE,
+					MIN(strtoul(&features[i][11], NULL,
+							16), GDB_PACKET_MAX));
+		else if(strcmp(features[i], "QStartNoAckMode+") == 0)
+			noack = TRUE;
+		else if(strcmp(features[i], "qXfer:features:read+") == 0)
+			debug->features = TRUE;
+		else if(strcmp(features[i], "binary-upload+") == 0)
+			debug->binary = TRUE;
+		else if(strcmp(features[i], "QCatchSyscalls+") == 0)
+			debug->syscalls = TRUE;
+	g_strfreev(features);
+	if(!noack)
+		return 0;
+	/* required to send requests before the previous replies */
+	_gdb_queue(debug, "QStartNoAckMode");
+	if(_gdb_flush(debug) != 0)
+		return -1;
+	debug->noack = (strcmp(_gdb_reply(debug, 0)->str, "OK") == 0);
+	return 0;
+}
+
+
+/* gdb_memory_read */
+static ssize_t _gdb_memory_read(GdbDebug * debug, uint64_t address,
+		void * buf, size_t size)
+{
+	GdbTransfer transfer;
+	ssize_t ret;
+
+	_gdb_transfer_init(&transfer, address, buf, size);
+	/* every chunk at once, then those the replies fell short of */
+	do
+	{
+		_gdb_transfer_queue(debug, &transfer);
+		if(_gdb_flush(debug) != 0)
+		{
+			_gdb_transfer_destroy(&transfer);
+			return -1;
+		}
+	}
+	while(_gdb_transfer_parse(debug, &transfer) > 0);
+	ret = transfer.size;
+	_gdb_transfer_destroy(&transfer);
+	if(ret == 0)
+		return -error_set_code(1, "%s", _("Could not read memory"));
+	_gdb_cache_add(debug, address, buf, ret);
+	return ret;
+}
+
+
+/* gdb_output */
+static void _gdb_output(GdbDebug * debug, GString const * packet)
+{
+	size_t i;
+	int hi;
+	int lo;
+
+	(void) debug;
+	/* forwarded from the program by some remote targets */
+	for(i = 1; i + 1 < packet->len; i += 2)
+		if((hi = g_ascii_xdigit_value(packet->str[i])) >= 0
+				&& (lo = g_ascii_xdigit_value(
+						packet->str[i + 1])) >= 0)
+			fputc((hi << 4) | lo, stderr);
+}
+
+
+/* gdb_packet */
+static int _gdb_packet(GdbDebug * debug, GString * packet)
+{
+	char const * p = debug->input->str;
+	size_t len = debug->input->len;
+	size_t start;
+	size_t end;
+	size_t i;
+	unsigned char sum = 0;
+	int hi;
+	int lo;
+	int n;
+
+	/* acknowledgments are skipped */
+	for(start = 0; start < len && p[start] != '$'; start++);
+	for(end = start; end < len && p[end] != '#'; end++);
+	if(end + 2 >= len)
+	{
+		g_string_erase(debug->input, 0, start);
+		return 0;
+	}
+	g_string_truncate(packet, 0);
+	for(i = start + 1; i < end; i++)
+	{
+		sum += p[i];
+		if(p[i] == '}' && i + 1 < end)
+		{
+			sum += p[++i];
+			g_string_append_c(packet, p[i] ^ 0x20);
+		}
+		/* run-length encoded */
+		else if(p[i] == '*' && i + 1 < end && packet->len > 0)
+		{
+			sum += p[++i];
+			for(n = (unsigned char)p[i] - 29; n > 0; n--)
+				g_string_append_c(packet,
+						packet->str[packet->len - 1]);
+		}
+		else
+			g_string_append_c(packet, p[i]);
+	}
+	hi = g_ascii_xdigit_value(p[end + 1]);
+	lo = g_ascii_xdigit_value(p[end + 2]);
+	g_string_erase(debug->input, 0, end + 3);
+	/* not checked once the transport is known to be reliable */
+	if(debug->noack)
+		return 1;
+	if(hi < 0 || lo < 0 || ((hi << 4) | lo) != sum)
+		return -error_set_code(1, "%s",
+				_("Invalid packet from the remote target"));
+	if(_gdb_write(debug, "+", 1) != 0)
+		return -1;
+	return 1;
+}
+
+
+/* gdb_queue */
+static void _gdb_queue(GdbDebug * debug, char const * format, ...)
+{
+	va_list ap;
+	gchar * data;
+
+	va_start(ap, format);
+	data = g_strdup_vprintf(format, ap);
+	va_end(ap);
+	_gdb_frame(debug, data, strlen(data), TRUE);
+	g_free(data);
+}
+
+
+/* gdb_read */
+static int _gdb_read(GdbDebug * debug)
+{
+	char buf[16384];
+	ssize_t res;
+
+	if((res = read(debug->fd, buf, sizeof(buf))) < 0)
+	{
+		if(errno == EINTR || errno == EAGAIN)
+			return 0;
+		return -error_set_code(-errno, "%s", strerror(errno));
+	}
+	if(res == 0)
+		return -error_set_code(1, "%s", _("The remote target closed"
+					" the connection"));
+	g_string_append_len(debug->input, buf, res);
+	return 0;
+}
+
+
+/* gdb_receive */
+static int _gdb_receive(GdbDebug * debug, GString * packet)
+{
+	struct pollfd pfd;
+	int res;
+
+	for(;;)
+	{
+		if((res = _gdb_packet(debug, packet)) != 0)
+			return (res > 0) ? 0 : -1;
+		pfd.fd = debug->fd;
+		pfd.events = POLLIN;
+		if((res = poll(&pfd, 1, GDB_TIMEOUT)) < 0 && errno == EINTR)
+			continue;
+		else if(res < 0)
+			return -error_set_code(-errno, "%s: %s", "poll",
+					strerror(errno));
+		else if(res == 0)
+			return -error_set_code(1, "%s", _("The remote target"
+						" did not reply in time"));
+		if(_gdb_read(debug) != 0)
+			return -1;
+	}
+}
+
+
+/* gdb_refresh */
+static int _gdb_refresh(GdbDebug * debug)
+{
+	gboolean stack = (debug->sp != NULL && debug->sp->set);
+	GdbTransfer transfer;
+	size_t first;
+	GString * reply;
+	GdbRegister * reg;
+	unsigned char * buf;
+	size_t i;
+
+	_gdb_cache_clear(debug);
+	buf = g_malloc(debug->stack);
+	/* the stack is read along with the registers when the stop reply
+	 * had the stack pointer, as usual */
+	if(debug->thread != NULL)
+		_gdb_queue(debug, "Hg%s", debug->thread);
+	first = debug->expected;
+	_gdb_queue(debug, "g");
+	if(stack)
+	{
+		_gdb_transfer_init(&transfer, debug->sp->value, buf,
+				debug->stack);
+		_gdb_transfer_queue(debug, &transfer);
+	}
+	if(_gdb_flush(debug) != 0)
+	{
+		if(stack)
+			_gdb_transfer_destroy(&transfer);
+		g_free(buf);
+		return -1;
+	}
+	reply = _gdb_reply(debug, first);
+	for(i = 0; reply->str[0] != 'E' && i < debug->registers->len; i++)
+	{
+		reg = &g_array_index(debug->registers, GdbRegister, i);
+		if((reg->offset + reg->size) * 2 <= reply->len)
+			_gdb_register_value(reg, &reply->str[reg->offset * 2],
+					reg->size * 2);
+	}
+	if(stack)
+	{
+		while(_gdb_transfer_parse(debug, &transfer) > 0)
+		{
+			_gdb_transfer_queue(debug, &transfer);
+			if(_gdb_flush(debug) != 0)
+			{
+				transfer.size = 0;
+				break;
+			}
+		}
+		if(transfer.size > 0)
+			_gdb_cache_add(debug, transfer.address, buf,
+					transfer.size);
+		_gdb_transfer_destroy(&transfer);
+	}
+	else if(debug->sp != NULL && debug->sp->set)
+		/* cached for the debugger */
+		_gdb_memory_read(debug, debug->sp->value, buf, debug->stack);
+	g_free(buf);
+	return 0;
+}
+
+
+/* gdb_register */
+static GdbRegister * _gdb_register(GdbDebug * debug, unsigned int number)
+{
+	GdbRegister * reg;
+	size_t i;
+
+	for(i = 0; i < debug->registers->len; i++)
+		if((reg = &g_array_index(debug->registers, GdbRegister, i))
+				->number == number)
+			return reg;
+	return NULL;
+}
+
+
+/* gdb_register_report */
+static void _gdb_register_report(GdbDebug * debug)
+{
+	DebuggerDebugHelper const * helper = debug->helper;
+	DebuggerDebugRegister * registers;
+	GdbRegister * reg;
+	size_t cnt = 0;
+	size_t i;
+
+	registers = g_new(DebuggerDebugRegister, debug->registers->len + 1);
+	for(i = 0; i < debug->registers->len; i++)
+		if((reg = &g_array_index(debug->registers, GdbRegister, i))
+				->set)
+		{
+			registers[cnt].name = reg->name;
+			registers[cnt++].value = reg->value;
+		}
+	/* report them all at once */
+	if(cnt > 0)
+		helper->set_registers(helper->debugger, registers, cnt);
+	g_free(registers);
+}
+
+
+/* gdb_register_value */
+static int _gdb_register_value(GdbRegister * reg, char const * hex,
+		size_t size)
+{
+	uint64_t value = 0;
+	size_t i;
+	int hi;
+	int lo;
+
+	if(reg->size == 0 || reg->size > sizeof(value)
+			|| size < reg->size * 2)
+		return -1;
+	/* the targets supported are little-endian */
+	for(i = reg->size; i > 0; i--)
+	{
+		/* unavailable otherwise */
+		if((hi = g_ascii_xdigit_value(hex[i * 2 - 2])) < 0
+				|| (lo = g_ascii_xdigit_value(hex[i * 2 - 1]))
+				< 0)
+			return -1;
+		value = (value << 8) | (hi << 4) | lo;
+	}
+	reg->value = value;
+	reg->set = TRUE;
+	return 0;
+}
+
+
+/* gdb_reply */
+static GString * _gdb_reply(GdbDebug * debug, size_t i)
+{
+	return g_ptr_array_index(debug->replies, i);
+}
+
+
+/* gdb_resume */
+static int _gdb_resume(GdbDebug * debug, gboolean step, gboolean syscalls)
+{
+	gboolean catching = (syscalls != debug->catching);
+	GString * action;
+
+	if(debug->fd < 0 || debug->exited)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", _("No process is being debugged"));
+	if(debug->running)
+		return 0;
+	/* the first stop is not reported anymore */
+	if(debug->idle != 0)
+	{
+		g_source_remove(debug->idle);
+		debug->idle = 0;
+		_gdb_stop_parse(debug, debug->stop);
+		g_string_free(debug->stop, TRUE);
+		debug->stop = NULL;
+	}
+	/* system calls are only caught to stop on the next one */
+	if(catching)
+		_gdb_queue(debug, "QCatchSyscalls:%d", syscalls ? 1 : 0);
+	action = g_string_new(NULL);
+	/* the other threads remain stopped when stepping */
+	if(debug->vcont && debug->thread != NULL && step && debug->signal)
+		g_string_printf(action, "vCont;S%02x:%s", debug->signal,
+				debug->thread);
+	else if(debug->vcont && debug->thread != NULL && step)
+		g_string_printf(action, "vCont;s:%s", debug->thread);
+	else if(debug->vcont && debug->thread != NULL && debug->signal)
+		g_string_printf(action, "vCont;C%02x:%s;c", debug->signal,
+				debug->thread);
+	else if(debug->signal)
+		g_string_printf(action, "%c%02x", step ? 'S' : 'C',
+				debug->signal);
+	else
+		g_string_printf(action, "%c", step ? 's' : 'c');
+	/* answered once stopped again */
+	_gdb_frame(debug, action->str, action->len, FALSE);
+	g_string_free(action, TRUE);
+	if(_gdb_flush(debug) != 0)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", error_get(NULL));
+	if(catching && strcmp(_gdb_reply(debug, 0)->str, "OK") == 0)
+		debug->catching = syscalls;
+	debug->signal = 0;
+	debug->stepping = step;
+	debug->running = TRUE;
+	_gdb_cache_clear(debug);
+	return 0;
+}
+
+
+/* gdb_spawn */
+static int _gdb_spawn(GdbDebug * debug, char const * filename)
+{
+	char * argv[] = { GDB_SERVER, "-", NULL, NULL };
+	const unsigned int flags = G_SPAWN_SEARCH_PATH
+		| G_SPAWN_DO_NOT_REAP_CHILD;
+	int fds[2];
+	GError * error = NULL;
+
+	argv[2] = (char *)filename;
+	if(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+		return -error_set_code(-errno, "%s: %s", "socketpair",
+				strerror(errno));
+	debug->fd = fds[0];
+	debug->server = fds[1];
+	if(g_spawn_async(NULL, argv, NULL, flags, _gdb_on_child_setup, debug,
+				&debug->pid, &error) == FALSE)
+	{
+		error_set_code(1, "%s", error->message);
+		g_error_free(error);
+		debug->pid = -1;
+		_gdb_close(debug);
+		return -1;
+	}
+	close(debug->server);
+	debug->server = -1;
+	return 0;
+}
+
+
+/* gdb_stop_parse */
+static int _gdb_stop_parse(GdbDebug * debug, GString const * packet)
+{
+	int signal;
+	gchar ** fields;
+	char * p;
+	char * q;
+	GdbRegister * reg;
+	size_t i;
+
+	if(packet->len < 3 || (signal = g_ascii_xdigit_value(packet->str[1]))
+			< 0 || g_ascii_xdigit_value(packet->str[2]) < 0)
+		return -1;
+	signal = (signal << 4) | g_ascii_xdigit_value(packet->str[2]);
+	for(i = 0; i < debug->registers->len; i++)
+		g_array_index(debug->registers, GdbRegister, i).set = FALSE;
+	/* with the thread and usually some registers */
+	fields = g_strsplit(&packet->str[3], ";", -1);
+	for(i = 0; packet->str[0] == 'T' && fields[i] != NULL; i++)
+	{
+		if((p = strchr(fields[i], ':')) == NULL)
+			continue;
+		*(p++) = '\0';
+		if(strcmp(fields[i], "thread") == 0)
+		{
+			g_free(debug->thread);
+			debug->thread = g_strdup(p);
+		}
+		else if((reg = _gdb_register(debug, strtoul(fields[i], &q,
+							16))) != NULL
+				&& fields[i][0] != '\0' && *q == '\0')
+			_gdb_register_value(reg, p, strlen(p));
+	}
+	g_strfreev(fields);
+	/* breakpoints and interruptions are not delivered */
+	debug->signal = (signal == GDB_SIGNAL_TRAP || signal == GDB_SIGNAL_INT)
+		? 0 : signal;
+	return signal;
+}
+
+
+/* gdb_stopped */
+static int _gdb_stopped(GdbDebug * debug, GString const * packet)
+{
+	GdbBreakpoint * breakpoint;
+
+	switch(packet->str[0])
+	{
+		case 'O':
+			_gdb_output(debug, packet);
+			break;
+		case 'S':
+		case 'T':
+			debug->running = FALSE;
+			if(_gdb_stop_parse(debug, packet) < 0
+					|| _gdb_refresh(debug) != 0)
+				return -debug->helper->error(
+						debug->helper->debugger, 1,
+						"%s", error_get(NULL));
+			if(!debug->stepping && debug->pc != NULL
+					&& debug->pc->set
+					&& (breakpoint = g_hash_table_lookup(
+							debug->breakpoints,
+							&debug->pc->value))
+					!= NULL)
+			{
+				breakpoint->statistics.hits++;
+				breakpoint->statistics.stops++;
+			}
+			_gdb_register_report(debug);
+			_gdb_breakpoint_report(debug);
+			break;
+		case 'W':
+		case 'X':
+			/* nothing is left to debug */
+			debug->running = FALSE;
+			debug->exited = TRUE;
+			_gdb_cache_clear(debug);
+			_gdb_breakpoint_report(debug);
+			break;
+		case 'E':
+			return -debug->helper->error(debug->helper->debugger,
+					1, "%s", _("The remote target reported"
+						" an error"));
+		default:
+			break;
+	}
+	return 0;
+}
+
+
+/* gdb_transfer_destroy */
+static void _gdb_transfer_destroy(GdbTransfer * transfer)
+{
+	g_array_free(transfer->missing, TRUE);
+	g_array_free(transfer->queued, TRUE);
+}
+
+
+/* gdb_transfer_init */
+static void _gdb_transfer_init(GdbTransfer * transfer, uint64_t address,
+		void * buf, size_t size)
+{
+	GdbRange range;
+
+	transfer->address = address;
+	transfer->buf = buf;
+	transfer->size = size;
+	transfer->missing = g_array_new(FALSE, FALSE, sizeof(range));
+	transfer->queued = g_array_new(FALSE, FALSE, sizeof(range));
+	transfer->first = 0;
+	range.offset = 0;
+	range.size = size;
+	g_array_append_val(transfer->missing, range);
+}
+
+
+/* gdb_transfer_parse */
+static size_t _gdb_transfer_parse(GdbDebug * debug, GdbTransfer * transfer)
+{
+	GdbRange * range;
+	GdbRange rest;
+	GString * reply;
+	size_t i;
+	size_t n;
+	char const * p;
+	int hi;
+	int lo;
+
+	g_array_set_size(transfer->missing, 0);
+	for(i = 0; i < transfer->queued->len; i++)
+	{
+		range = &g_array_index(transfer->queued, GdbRange, i);
+		reply = _gdb_reply(debug, transfer->first + i);
+		n = 0;
+		if(debug->binary && reply->len > 0 && reply->str[0] == 'b')
+		{
+			n = MIN(reply->len - 1, range->size);
+			memcpy(&transfer->buf[range->offset], &reply->str[1],
+					n);
+		}
+		/* errors have an odd length */
+		else if(!debug->binary && reply->len % 2 == 0)
+			for(; n < range->size && n * 2 < reply->len; n++)
+			{
+				p = &reply->str[n * 2];
+				if((hi = g_ascii_xdigit_value(p[0])) < 0
+						|| (lo = g_ascii_xdigit_value(
+								p[1])) < 0)
+					break;
+				transfer->buf[range->offset + n] = (hi << 4)
+					| lo;
+			}
+		/* nothing can be read from there on */
+		if(n == 0)
+			transfer->size = MIN(transfer->size, range->offset);
+		else if(n < range->size)
+		{
+			rest.offset = range->offset + n;
+			rest.size = range->size - n;
+			g_array_append_val(transfer->missing, rest);
+		}
+	}
+	/* only what is still contiguous */
+	for(i = 0; i < transfer->missing->len;)
+	{
+		range = &g_array_index(transfer->missing, GdbRange, i);
+		if(range->offset >= transfer->size)
+			g_array_remove_index(transfer->missing, i);
+		else
+		{
+			range->size = MIN(range->size, transfer->size
+					- range->offset);
+			i++;
+		}
+	}
+	return transfer->missing->len;
+}
+
+
+/* gdb_transfer_queue */
+static void _gdb_transfer_queue(GdbDebug * debug, GdbTransfer * transfer)
+{
+	/* binary replies are about twice as compact, escaped bytes aside */
+	const size_t chunk = debug->binary
+		? debug->packet - 1 - debug->packet / 16 : debug->packet / 2;
+	GdbRange const * range;
+	GdbRange request;
+	size_t i;
+	size_t j;
+
+	transfer->first = debug->expected;
+	g_array_set_size(transfer->queued, 0);
+	for(i = 0; i < transfer->missing->len; i++)
+	{
+		range = &g_array_index(transfer->missing, GdbRange, i);
+		for(j = 0; j < range->size; j += chunk)
+		{
+			request.offset = range->offset + j;
+			request.size = MIN(chunk, range->size - j);
+			_gdb_queue(debug, "%c%" PRIx64 ",%zx", debug->binary
+					? 'x' : 'm', transfer->address
+					+ request.offset, request.size);
+			g_array_append_val(transfer->queued, request);
+		}
+	}
+}
+
+
+/* gdb_write */
+static int _gdb_write(GdbDebug * debug, char const * data, size_t size)
+{
+	ssize_t res;
+
+	if(debug->fd < 0)
+		return -error_set_code(1, "%s",
+				_("No process is being debugged"));
+	while(size > 0)
+		if((res = send(debug->fd, data, size, MSG_NOSIGNAL)) < 0)
+		{
+			if(errno != EINTR)
+				return -error_set_code(-errno, "%s",
+						strerror(errno));
+		}
+		else
+		{
+			data += res;
+			size -= res;
+		}
+	return 0;
+}
+
+
+/* callbacks */
+/* gdb_on_child_setup */
+static void _gdb_on_child_setup(gpointer data)
+{
+	GdbDebug * debug = data;
+
+	/* the server talks through its standard input and output */
+	if(dup2(debug->server, 0) != 0 || dup2(debug->server, 1) != 1)
+		_exit(125);
+}
+
+
+/* gdb_on_input */
+static gboolean _gdb_on_input(GIOChannel * source, GIOCondition condition,
+		gpointer data)
+{
+	GdbDebug * debug = data;
+	GString * packet;
+	int res = 0;
+
+	(void) source;
+	(void) condition;
+	if(_gdb_read(debug) != 0)
+	{
+		if(!debug->exited)
+			debug->helper->error(debug->helper->debugger, 1, "%s",
+					error_get(NULL));
+		debug->source = 0;
+		_gdb_close(debug);
+		return FALSE;
+	}
+	packet = g_string_new(NULL);
+	while(debug->fd >= 0 && (res = _gdb_packet(debug, packet)) > 0)
+		_gdb_stopped(debug, packet);
+	g_string_free(packet, TRUE);
+	if(res < 0)
+		debug->helper->error(debug->helper->debugger, 1, "%s",
+				error_get(NULL));
+	if(!debug->exited)
+		return TRUE;
+	/* the remote target is done */
+	debug->source = 0;
+	_gdb_close(debug);
+	return FALSE;
+}
+
+
+/* gdb_on_started */
+static gboolean _gdb_on_started(gpointer data)
+{
+	GdbDebug * debug = data;
+	GString * stop = debug->stop;
+
+	debug->idle = 0;
+	debug->stop = NULL;
+	_gdb_stopped(debug, stop);
+	g_string_free(stop, TRUE);
+	if(debug->exited)
+		_gdb_close(debug);
+	return FALSE;
+}
@@ -0,0 +1,4401 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+/* this plug-in is specific to Linux */
+#ifdef __linux__
+/* for process_vm_readv() */
+#define _GNU_SOURCE
+#include <sys/types.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/ptrace.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/user.h>
+#include <sys/wait.h>
+#include <linux/audit.h>
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <libintl.h>
+#include <glib.h>
+#include "../debug.h"
+#include "../condition.h"
+#include "../trace.h"
+#include "../../config.h"
+#include "agent.h"
+#define _(string) gettext(string)
+
+#ifndef PREFIX
+# define PREFIX		"/usr/local"
+#endif
+#ifndef LIBDIR
+# define LIBDIR		PREFIX "/lib"
+#endif
+#ifndef PACKAGE
+# define PACKAGE	"Coder"
+#endif
+
+
+/* Linux */
+/* private */
+/* types */
+typedef struct _DebuggerDebug LinuxDebug;
+
+/* frames walked at most when sampling */
+#define LINUX_STACK_MAX	64
+
+/* software breakpoints */
+#if defined(__x86_64__)
+# define LINUX_BREAKPOINT	"\xcc"
+# define LINUX_PC		offsetof(struct user, regs.rip)
+#endif
+
+/* hardware watchpoints */
+#if defined(__x86_64__)
+# define LINUX_WATCHPOINTS	4
+# define LINUX_DR(i)		(offsetof(struct user, u_debugreg) \
+		+ (i) * sizeof(long))
+#endif
+
+/* system calls traced */
+#if defined(__x86_64__)
+# define LINUX_SECCOMP		AUDIT_ARCH_X86_64
+# define LINUX_SYSCALL		offsetof(struct user, regs.orig_rax)
+/* the filter cannot jump further than 255 instructions */
+# define LINUX_SYSCALLS_MAX	64
+#endif
+
+/* recording: checks for the next step before sleeping, and the sleep in
+ * milliseconds until a command is queued */
+#define LINUX_RECORD_SPIN	256
+#define LINUX_RECORD_POLL	1
+
+/* checkpoints, as copies of the process forked at a stop */
+#if defined(__x86_64__)
+# define LINUX_CHECKPOINTS
+#endif
+
+/* tracepoints, recorded by an agent preloaded into the process */
+#if defined(__x86_64__)
+# define LINUX_AGENT		LIBDIR "/" PACKAGE "/debug/linux-agent.so"
+/* interval in milliseconds between reading the events recorded */
+# define LINUX_AGENT_POLL	100
+#endif
+
+typedef enum _LinuxMessageType
+{
+	/* to the tracer */
+	LMT_START = 0, LMT_PAUSE, LMT_RESUME, LMT_RECORD, LMT_PROFILE,
+	LMT_SAMPLE, LMT_KILL, LMT_WAIT, LMT_ADD_BREAKPOINT,
+	LMT_REMOVE_BREAKPOINT, LMT_ADD_WATCHPOINT, LMT_REMOVE_WATCHPOINT,
+	LMT_CHECKPOINT, LMT_RESTORE, LMT_DISCARD,
+	/* to the main loop */
+	LMT_ERROR, LMT_BIAS, LMT_CHECKPOINTED, LMT_REGISTERS, LMT_SAMPLES,
+	LMT_BREAKPOINTS, LMT_SYSCALLS, LMT_EXIT
+} LinuxMessageType;
+
+typedef struct _LinuxBreakpoint
+{
+	uint64_t address;
+	gboolean inserted;
+	/* could not be inserted, as reported once */
+	gboolean failed;
+#ifdef LINUX_BREAKPOINT
+	/* the original code */
+	unsigned char code[sizeof(LINUX_BREAKPOINT) - 1];
+#endif
+
+	/* the condition if any, its registers resolved to their index */
+	DebuggerDebugInstruction * condition;
+	size_t condition_cnt;
+	size_t * registers;
+	uint64_t * stack;
+
+	/* hits, stops and time spent on the condition */
+	DebuggerDebugBreakpoint statistics;
+} LinuxBreakpoint;
+
+/* what conditions are evaluated against */
+typedef struct _LinuxEvaluation
+{
+	LinuxDebug * debug;
+	LinuxBreakpoint * breakpoint;
+	void const * regs;
+} LinuxEvaluation;
+
+typedef struct _LinuxWatchpoint
+{
+	uint64_t address;
+	size_t size;
+	DebuggerDebugWatch watch;
+	/* the debug register used, or -1 to protect the pages instead */
+	int slot;
+	gboolean inserted;
+	/* the original protection of every page, once inserted */
+	int * prots;
+	/* the system calls failing on these pages were reported */
+	gboolean reported;
+} LinuxWatchpoint;
+
+typedef struct _LinuxMessage
+{
+	struct _LinuxMessage * next;
+	LinuxMessageType type;
+	union
+	{
+		char * filename;
+		int request;
+		unsigned int frequency;
+		struct
+		{
+			char * filename;
+			int registers;
+		} record;
+		struct
+		{
+			pid_t tid;
+			int status;
+		} wait;
+		LinuxBreakpoint * breakpoint;
+		LinuxWatchpoint * watchpoint;
+		/* also the load bias */
+		uint64_t address;
+		/* also replied with the process copied, or -1 */
+		struct
+		{
+			int id;
+			pid_t pid;
+		} checkpoint;
+		char * error;
+		struct
+		{
+			DebuggerDebugRegister * values;
+			size_t cnt;
+		} registers;
+		struct
+		{
+			DebuggerDebugSample * values;
+			size_t cnt;
+			uint64_t * callers;
+			uint64_t duration;
+		} samples;
+		struct
+		{
+			DebuggerDebugBreakpoint * values;
+			size_t cnt;
+		} breakpoints;
+		struct
+		{
+			DebuggerDebugSyscall * values;
+			size_t cnt;
+		} syscalls;
+	} u;
+} LinuxMessage;
+
+/* lock-free, for any number of producers and a single consumer */
+typedef struct _LinuxQueue
+{
+	LinuxMessage * head;
+	int fd;
+} LinuxQueue;
+
+/* a program counter followed by the return addresses */
+typedef struct _LinuxStack
+{
+	/* times found, not compared */
+	uint64_t count;
+	size_t cnt;
+	uint64_t addresses[LINUX_STACK_MAX];
+} LinuxStack;
+
+typedef struct _LinuxThread
+{
+	pid_t tid;
+	/* the process traced, or another one forked from it */
+	pid_t process;
+	/* forked with the breakpoints, removed once stopped */
+	gboolean inherited;
+	gboolean started;
+	gboolean stopped;
+	/* to be stopped along with the others */
+	gboolean interrupted;
+	/* to be resumed once sampled */
+	gboolean sampled;
+	/* stopped while the others are changed, with this status */
+	int held;
+	/* the debug registers programmed, as of this generation */
+	unsigned int generation;
+	/* the system call traced, until it returns */
+	DebuggerDebugSyscall * syscall;
+	struct timespec entry;
+} LinuxThread;
+
+struct _DebuggerDebug
+{
+	DebuggerDebugHelper const * helper;
+	/* set by the tracer, and cleared with the lock held */
+	gint pid;
+
+	/* main loop */
+	LinuxQueue messages;
+	GIOChannel * channel;
+	guint source;
+#ifdef LINUX_AGENT
+	/* tracepoints, along with the last events read */
+	DebuggerDebugTracepoint * tracepoints;
+	size_t tracepoints_cnt;
+	/* shared with the agent, from the start */
+	AgentBuffer * agent;
+	char agent_name[32];
+	uint64_t agent_tail;
+	guint agent_source;
+	/* relocated once executed, before the agent patches the code */
+	gboolean relocating;
+#endif
+	/* the last checkpoint requested */
+	int checkpoint;
+
+	/* tracer */
+	GThread * tracer;
+	LinuxQueue commands;
+
+	/* only accessed by the tracer */
+	gboolean running;
+	/* interrupted on request */
+	gboolean pausing;
+	/* the thread stopped last */
+	pid_t tid;
+	/* the signal to deliver when resuming */
+	int signal;
+	/* the last request resuming it */
+	int request;
+	/* threads, by id */
+	GHashTable * threads;
+	/* stopped before known, with their status */
+	GHashTable * unknown;
+	/* the process exited, the others forked are let go */
+	gboolean exited;
+	GThread * waiter;
+	/* the waiter steps aside while the tracer waits itself */
+	GMutex lock;
+	GCond cond;
+	gint waiting;
+	/* breakpoints, by address */
+	GHashTable * breakpoints;
+	/* watchpoints, by address */
+	GHashTable * watchpoints;
+#ifdef LINUX_WATCHPOINTS
+	LinuxWatchpoint * slots[LINUX_WATCHPOINTS];
+#endif
+	/* changed along with the slots, programmed into every thread */
+	unsigned int generation;
+	/* the program was executed, its code can be patched */
+	gboolean executed;
+	/* checkpoints, by id: the processes copied, never resumed */
+	GHashTable * checkpoints;
+	/* system calls traced, along with their statistics */
+	DebuggerDebugSyscall * syscalls;
+	size_t syscalls_cnt;
+	/* recording */
+	TraceWriter * writer;
+	gboolean registers;
+	/* profiling, with the period in microseconds */
+	GThread * sampler;
+	gint period;
+	/* samples, by stack */
+	GHashTable * samples;
+	gint64 since;
+};
+
+
+/* constants */
+#define LINUX_OPTIONS	(PTRACE_O_TRACECLONE | PTRACE_O_TRACEFORK \
+		| PTRACE_O_TRACEVFORK | PTRACE_O_TRACEEXEC \
+		| PTRACE_O_TRACESYSGOOD | PTRACE_O_EXITKILL)
+
+#if defined(__x86_64__)
+# define LINUX_REGISTER(name) \
+	{ # name, offsetof(struct user_regs_struct, name) }
+static const struct
+{
+	char const * name;
+	size_t offset;
+} _linux_registers[] =
+{
+	LINUX_REGISTER(rax), LINUX_REGISTER(rcx), LINUX_REGISTER(rdx),
+	LINUX_REGISTER(rbx), LINUX_REGISTER(r8), LINUX_REGISTER(r9),
+	LINUX_REGISTER(r10), LINUX_REGISTER(r11), LINUX_REGISTER(r12),
+	LINUX_REGISTER(r13), LINUX_REGISTER(r14), LINUX_REGISTER(r15),
+	LINUX_REGISTER(rsi), LINUX_REGISTER(rdi), LINUX_REGISTER(rsp),
+	LINUX_REGISTER(rbp), LINUX_REGISTER(rip), LINUX_REGISTER(eflags),
+	LINUX_REGISTER(cs), LINUX_REGISTER(ss), LINUX_REGISTER(ds),
+	LINUX_REGISTER(es), LINUX_REGISTER(fs), LINUX_REGISTER(gs),
+	LINUX_REGISTER(fs_base), LINUX_REGISTER(gs_base)
+};
+#endif
+
+#ifdef LINUX_SECCOMP
+/* the names of the system calls, by number */
+static char const * _linux_syscalls[] =
+{
+	"read", "write", "open", "close", "stat", "fstat", "lstat", "poll",
+	"lseek", "mmap", "mprotect", "munmap", "brk", "rt_sigaction",
+	"rt_sigprocmask", "rt_sigreturn", "ioctl", "pread64", "pwrite64",
+	"readv", "writev", "access", "pipe", "select", "sched_yield", "mremap",
+	"msync", "mincore", "madvise", "shmget", "shmat", "shmctl", "dup",
+	"dup2", "pause", "nanosleep", "getitimer", "alarm", "setitimer",
+	"getpid", "sendfile", "socket", "connect", "accept", "sendto",
+	"recvfrom", "sendmsg", "recvmsg", "shutdown", "bind", "listen",
+	"getsockname", "getpeername", "socketpair", "setsockopt", "getsockopt",
+	"clone", "fork", "vfork", "execve", "exit", "wait4", "kill", "uname",
+	"semget", "semop", "semctl", "shmdt", "msgget", "msgsnd", "msgrcv",
+	"msgctl", "fcntl", "flock", "fsync", "fdatasync", "truncate",
+	"ftruncate", "getdents", "getcwd", "chdir", "fchdir", "rename",
+	"mkdir", "rmdir", "creat", "link", "unlink", "symlink", "readlink",
+	"chmod", "fchmod", "chown", "fchown", "lchown", "umask",
+	"gettimeofday", "getrlimit", "getrusage", "sysinfo", "times", "ptrace",
+	"getuid", "syslog", "getgid", "setuid", "setgid", "geteuid", "getegid",
+	"setpgid", "getppid", "getpgrp", "setsid", "setreuid", "setregid",
+	"getgroups", "setgroups", "setresuid", "getresuid", "setresgid",
+	"getresgid", "getpgid", "setfsuid", "setfsgid", "getsid", "capget",
+	"capset", "rt_sigpending", "rt_sigtimedwait", "rt_sigqueueinfo",
+	"rt_sigsuspend", "sigaltstack", "utime", "mknod", "uselib",
+	"personality", "ustat", "statfs", "fstatfs", "sysfs", "getpriority",
+	"setpriority", "sched_setparam", "sched_getparam",
+	"sched_setscheduler", "sched_getscheduler", "sched_get_priority_max",
+	"sched_get_priority_min", "sched_rr_get_interval", "mlock", "munlock",
+	"mlockall", "munlockall", "vhangup", "modify_ldt", "pivot_root",
+	"_sysctl", "prctl", "arch_prctl", "adjtimex", "setrlimit", "chroot",
+	"sync", "acct", "settimeofday", "mount", "umount2", "swapon",
+	"swapoff", "reboot", "sethostname", "setdomainname", "iopl", "ioperm",
+	"create_module", "init_module", "delete_module", "get_kernel_syms",
+	"query_module", "quotactl", "nfsservctl", "getpmsg", "putpmsg",
+	"afs_syscall", "tuxcall", "security", "gettid", "readahead",
+	"setxattr", "lsetxattr", "fsetxattr", "getxattr", "lgetxattr",
+	"fgetxattr", "listxattr", "llistxattr", "flistxattr", "removexattr",
+	"lremovexattr", "fremovexattr", "tkill", "time", "futex",
+	"sched_setaffinity", "sched_getaffinity", "set_thread_area",
+	"io_setup", "io_destroy", "io_getevents", "io_submit", "io_cancel",
+	"get_thread_area", "lookup_dcookie", "epoll_create", "epoll_ctl_old",
+	"epoll_wait_old", "remap_file_pages", "getdents64", "set_tid_address",
+	"restart_syscall", "semtimedop", "fadvise64", "timer_create",
+	"timer_settime", "timer_gettime", "timer_getoverrun", "timer_delete",
+	"clock_settime", "clock_gettime", "clock_getres", "clock_nanosleep",
+	"exit_group", "epoll_wait", "epoll_ctl", "tgkill", "utimes", "vserver",
+	"mbind", "set_mempolicy", "get_mempolicy", "mq_open", "mq_unlink",
+	"mq_timedsend", "mq_timedreceive", "mq_notify", "mq_getsetattr",
+	"kexec_load", "waitid", "add_key", "request_key", "keyctl",
+	"ioprio_set", "ioprio_get", "inotify_init", "inotify_add_watch",
+	"inotify_rm_watch", "migrate_pages", "openat", "mkdirat", "mknodat",
+	"fchownat", "futimesat", "newfstatat", "unlinkat", "renameat",
+	"linkat", "symlinkat", "readlinkat", "fchmodat", "faccessat",
+	"pselect6", "ppoll", "unshare", "set_robust_list", "get_robust_list",
+	"splice", "tee", "sync_file_range", "vmsplice", "move_pages",
+	"utimensat", "epoll_pwait", "signalfd", "timerfd_create", "eventfd",
+	"fallocate", "timerfd_settime", "timerfd_gettime", "accept4",
+	"signalfd4", "eventfd2", "epoll_create1", "dup3", "pipe2",
+	"inotify_init1", "preadv", "pwritev", "rt_tgsigqueueinfo",
+	"perf_event_open", "recvmmsg", "fanotify_init", "fanotify_mark",
+	"prlimit64", "name_to_handle_at", "open_by_handle_at", "clock_adjtime",
+	"syncfs", "sendmmsg", "setns", "getcpu", "process_vm_readv",
+	"process_vm_writev", "kcmp", "finit_module", "sched_setattr",
+	"sched_getattr", "renameat2", "seccomp", "getrandom", "memfd_create",
+	"kexec_file_load", "bpf", "execveat", "userfaultfd", "membarrier",
+	"mlock2", "copy_file_range", "preadv2", "pwritev2", "pkey_mprotect",
+	"pkey_alloc", "pkey_free", "statx", "io_pgetevents", "rseq",
+	[424] = "pidfd_send_signal", "io_uring_setup", "io_uring_enter",
+	"io_uring_register", "open_tree", "move_mount", "fsopen", "fsconfig",
+	"fsmount", "fspick", "pidfd_open", "clone3", "close_range", "openat2",
+	"pidfd_getfd", "faccessat2", "process_madvise", "epoll_pwait2",
+	"mount_setattr", "quotactl_fd", "landlock_create_ruleset",
+	"landlock_add_rule", "landlock_restrict_self", "memfd_secret",
+	"process_mrelease", "futex_waitv", "set_mempolicy_home_node"
+};
+#endif
+
+
+/* prototypes */
+/* plug-in */
+static LinuxDebug * _linux_init(DebuggerDebugHelper const * helper);
+static void _linux_destroy(LinuxDebug * debug);
+static int _linux_start(LinuxDebug * debug, va_list argp);
+static int _linux_pause(LinuxDebug * debug);
+static int _linux_stop(LinuxDebug * debug);
+static int _linux_continue(LinuxDebug * debug);
+static int _linux_next(LinuxDebug * debug);
+static int _linux_step(LinuxDebug * debug);
+static ssize_t _linux_read_memory(LinuxDebug * debug, uint64_t address,
+		void * buf, size_t size);
+static ssize_t _linux_write_memory(LinuxDebug * debug, uint64_t address,
+		void const * buf, size_t size);
+static int _linux_add_breakpoint(LinuxDebug * debug, uint64_t address,
+		DebuggerDebugCondition const * condition);
+static int _linux_remove_breakpoint(LinuxDebug * debug, uint64_t address);
+static int _linux_add_watchpoint(LinuxDebug * debug, uint64_t address,
+		size_t size, DebuggerDebugWatch watch);
+static int _linux_remove_watchpoint(LinuxDebug * debug, uint64_t address);
+static int _linux_profile(LinuxDebug * debug, unsigned int frequency);
+static int _linux_record(LinuxDebug * debug, char const * filename,
+		int registers);
+static int _linux_trace_syscalls(LinuxDebug * debug, char const ** syscalls,
+		size_t syscalls_cnt);
+#ifdef LINUX_CHECKPOINTS
+static int _linux_checkpoint(LinuxDebug * debug);
+static int _linux_restore(LinuxDebug * debug, int checkpoint);
+static int _linux_discard(LinuxDebug * debug, int checkpoint);
+#endif
+static int _linux_tracepoints(LinuxDebug * debug, uint64_t const * addresses,
+		size_t addresses_cnt);
+
+/* accessors */
+static void _linux_get_registers(LinuxDebug * debug);
+
+/* useful */
+#ifdef LINUX_AGENT
+static void _linux_agent_close(LinuxDebug * debug);
+#endif
+static int _linux_bias(LinuxDebug * debug, uint64_t * bias);
+static void _linux_breakpoint_add(LinuxDebug * debug,
+		LinuxBreakpoint * breakpoint);
+static LinuxBreakpoint * _linux_breakpoint_at(LinuxDebug * debug, pid_t tid);
+static void _linux_breakpoint_delete(LinuxBreakpoint * breakpoint);
+static int _linux_breakpoint_evaluate(LinuxDebug * debug,
+		LinuxBreakpoint * breakpoint, pid_t tid);
+static int _linux_breakpoint_insert(LinuxDebug * debug,
+		LinuxBreakpoint * breakpoint);
+static LinuxBreakpoint * _linux_breakpoint_new(LinuxDebug * debug,
+		uint64_t address, DebuggerDebugCondition const * condition);
+static void _linux_breakpoint_remove(LinuxDebug * debug, uint64_t address);
+static void _linux_breakpoint_report(LinuxDebug * debug);
+static int _linux_breakpoint_restore(LinuxDebug * debug,
+		LinuxBreakpoint * breakpoint);
+static int _linux_breakpoint_step(LinuxDebug * debug, pid_t tid,
+		LinuxBreakpoint * breakpoint, int sig);
+static LinuxBreakpoint * _linux_breakpoint_trap(LinuxDebug * debug,
+		pid_t tid);
+static void _linux_breakpoints_insert(LinuxDebug * debug);
+static void _linux_breakpoints_reset(LinuxDebug * debug);
+static void _linux_checkpoints_kill(LinuxDebug * debug);
+static int _linux_clean(LinuxDebug * debug, pid_t child);
+static int _linux_command(LinuxDebug * debug, LinuxMessageType type,
+		int request);
+static int _linux_error(LinuxDebug * debug, char const * format, ...);
+#ifdef LINUX_CHECKPOINTS
+static pid_t _linux_fork(LinuxDebug * debug, pid_t tid);
+#endif
+static void _linux_hold(LinuxDebug * debug);
+static int _linux_mprotect(LinuxDebug * debug, pid_t tid, uint64_t address,
+		uint64_t size, int prot);
+static void _linux_post(LinuxDebug * debug, LinuxMessage * message);
+#ifdef LINUX_CHECKPOINTS
+static void _linux_reap(pid_t tid);
+#endif
+static void _linux_release(LinuxDebug * debug);
+#ifdef LINUX_CHECKPOINTS
+static int _linux_request(LinuxDebug * debug, LinuxMessageType type,
+		int checkpoint);
+#endif
+static void _linux_requeue(LinuxDebug * debug, pid_t tid, int status);
+static int _linux_resume(LinuxDebug * debug, int request);
+static int _linux_singlestep(LinuxDebug * debug, pid_t tid, int sig);
+static int _linux_syscall(LinuxDebug * debug, pid_t tid, long number,
+		unsigned long const * args, size_t args_cnt, long * result);
+static int _linux_syscall_enter(LinuxDebug * debug, LinuxThread * thread);
+static void _linux_syscall_exit(LinuxThread * thread);
+static void _linux_syscall_report(LinuxDebug * debug);
+static LinuxThread * _linux_thread(LinuxDebug * debug, pid_t tid);
+static void _linux_threads_continue(LinuxDebug * debug);
+static pid_t _linux_threads_stop(LinuxDebug * debug, pid_t tid);
+static void _linux_tracepoint_report(LinuxDebug * debug);
+static int _linux_wait(pid_t tid, int * status);
+static void _linux_watchpoint_add(LinuxDebug * debug,
+		LinuxWatchpoint * watchpoint);
+static void _linux_watchpoint_delete(LinuxWatchpoint * watchpoint);
+static LinuxWatchpoint * _linux_watchpoint_fault(LinuxDebug * debug,
+		pid_t tid, gboolean * hit);
+static int _linux_watchpoint_insert(LinuxDebug * debug, pid_t tid,
+		LinuxWatchpoint * watchpoint);
+static void _linux_watchpoint_pages(LinuxWatchpoint * watchpoint,
+		uint64_t * start, uint64_t * end);
+static int _linux_watchpoint_protect(LinuxDebug * debug, pid_t tid,
+		LinuxWatchpoint * watchpoint, gboolean watched);
+static void _linux_watchpoint_remove(LinuxDebug * debug, uint64_t address);
+static int _linux_watchpoint_restore(LinuxDebug * debug, pid_t tid,
+		LinuxWatchpoint * watchpoint);
+static int _linux_watchpoint_step(LinuxDebug * debug, pid_t tid,
+		LinuxWatchpoint * watchpoint);
+static LinuxWatchpoint * _linux_watchpoint_trap(LinuxDebug * debug,
+		pid_t tid);
+static int _linux_watchpoint_update(LinuxDebug * debug,
+		LinuxWatchpoint * watchpoint, gboolean insert);
+static void _linux_watchpoints_insert(LinuxDebug * debug);
+static void _linux_watchpoints_reset(LinuxDebug * debug);
+static void _linux_watchpoints_set(LinuxDebug * debug, LinuxThread * thread);
+
+/* stack */
+static gboolean _linux_stack_equal(gconstpointer a, gconstpointer b);
+static guint _linux_stack_hash(gconstpointer key);
+
+/* message */
+static LinuxMessage * _linux_message_new(LinuxMessageType type);
+static void _linux_message_delete(LinuxMessage * message);
+
+/* queue */
+static int _linux_queue_init(LinuxQueue * queue, int flags);
+static void _linux_queue_destroy(LinuxQueue * queue);
+static LinuxMessage * _linux_queue_pop(LinuxQueue * queue);
+static void _linux_queue_push(LinuxQueue * queue, LinuxMessage * message);
+
+/* callbacks */
+#ifdef LINUX_AGENT
+static gboolean _linux_on_agent(gpointer data);
+#endif
+static gboolean _linux_on_message(GIOChannel * source, GIOCondition condition,
+		gpointer data);
+static gpointer _linux_on_sample(gpointer data);
+static gpointer _linux_on_trace(gpointer data);
+static gpointer _linux_on_wait(gpointer data);
+
+
+/* constants */
+DebuggerDebugDefinition debug =
+{
+	"linux",
+	NULL,
+	LICENSE_BSD3_FLAGS,
+	_linux_init,
+	_linux_destroy,
+	_linux_start,
+	_linux_pause,
+	_linux_stop,
+	_linux_continue,
+	_linux_next,
+	_linux_step,
+	_linux_read_memory,
+	_linux_write_memory,
+	_linux_add_breakpoint,
+	_linux_remove_breakpoint,
+	_linux_add_watchpoint,
+	_linux_remove_watchpoint,
+	_linux_record,
+	_linux_profile,
+	_linux_trace_syscalls,
+#ifdef LINUX_CHECKPOINTS
+	_linux_checkpoint,
+	_linux_restore,
+	_linux_discard,
+#else
+	NULL,
+	NULL,
+	NULL,
+#endif
+	_linux_tracepoints
+};
+
+#ifdef LINUX_AGENT
+static const DebuggerDebugTracepointStatus _linux_agent_status[AS_COUNT] =
+{
+	DDTS_PENDING, DDTS_ACTIVE, DDTS_UNSUPPORTED, DDTS_UNREACHABLE,
+	DDTS_FAILED
+};
+#endif
+
+
+/* protected */
+/* functions */
+/* plug-in */
+/* linux_init */
+static LinuxDebug * _linux_init(DebuggerDebugHelper const * helper)
+{
+	LinuxDebug * debug;
+
+	if((debug = object_new(sizeof(*debug))) == NULL)
+		return NULL;
+	debug->helper = helper;
+	debug->pid = -1;
+	debug->channel = NULL;
+	debug->source = 0;
+#ifdef LINUX_AGENT
+	/* tracepoints */
+	debug->tracepoints = NULL;
+	debug->tracepoints_cnt = 0;
+	debug->agent = NULL;
+	debug->agent_name[0] = '\0';
+	debug->agent_tail = 0;
+	debug->agent_source = 0;
+	debug->relocating = FALSE;
+#endif
+	debug->checkpoint = 0;
+	debug->tracer = NULL;
+	debug->running = FALSE;
+	debug->pausing = FALSE;
+	debug->tid = -1;
+	debug->signal = 0;
+	debug->request = PTRACE_CONT;
+	debug->threads = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+			NULL, g_free);
+	debug->unknown = g_hash_table_new(g_direct_hash, g_direct_equal);
+	debug->exited = FALSE;
+	debug->waiter = NULL;
+	g_mutex_init(&debug->lock);
+	g_cond_init(&debug->cond);
+	debug->waiting = 0;
+	debug->breakpoints = g_hash_table_new_full(g_int64_hash,
+			g_int64_equal, NULL,
+			(GDestroyNotify)_linux_breakpoint_delete);
+	debug->watchpoints = g_hash_table_new_full(g_int64_hash, g_int64_equal,
+			NULL, (GDestroyNotify)_linux_watchpoint_delete);
+#ifdef LINUX_WATCHPOINTS
+	memset(debug->slots, 0, sizeof(debug->slots));
+#endif
+	debug->generation = 0;
+	debug->executed = FALSE;
+	debug->checkpoints = g_hash_table_new(g_direct_hash, g_direct_equal);
+	debug->syscalls = NULL;
+	debug->syscalls_cnt = 0;
+	debug->writer = NULL;
+	debug->registers = FALSE;
+	debug->sampler = NULL;
+	debug->period = 0;
+	debug->samples = NULL;
+	debug->since = 0;
+	if(_linux_queue_init(&debug->messages, EFD_NONBLOCK) != 0)
+	{
+		debug->commands.fd = -1;
+		_linux_destroy(debug);
+		return NULL;
+	}
+	if(_linux_queue_init(&debug->commands, 0) != 0)
+	{
+		_linux_destroy(debug);
+		return NULL;
+	}
+	/* the tracer wakes the main loop up through an eventfd */
+	debug->channel = g_io_channel_unix_new(debug->messages.fd);
+	debug->source = g_io_add_watch(debug->channel, G_IO_IN,
+			_linux_on_message, debug);
+	return debug;
+}
+
+
+/* linux_destroy */
+static void _linux_destroy(LinuxDebug * debug)
+{
+	LinuxMessage * message;
+	LinuxMessage * next;
+
+	if(debug->tracer != NULL)
+	{
+		/* the tracer returns once the process is collected */
+		_linux_stop(debug);
+		g_thread_join(debug->tracer);
+	}
+	if(debug->source != 0)
+		g_source_remove(debug->source);
+	if(debug->channel != NULL)
+		g_io_channel_unref(debug->channel);
+	for(message = _linux_queue_pop(&debug->messages); message != NULL;
+			message = next)
+	{
+		next = message->next;
+		_linux_message_delete(message);
+	}
+	_linux_queue_destroy(&debug->commands);
+	_linux_queue_destroy(&debug->messages);
+	g_hash_table_destroy(debug->threads);
+	g_hash_table_destroy(debug->unknown);
+	g_hash_table_destroy(debug->breakpoints);
+	g_hash_table_destroy(debug->watchpoints);
+	g_hash_table_destroy(debug->checkpoints);
+	g_free(debug->syscalls);
+#ifdef LINUX_AGENT
+	_linux_agent_close(debug);
+	g_free(debug->tracepoints);
+#endif
+	g_cond_clear(&debug->cond);
+	g_mutex_clear(&debug->lock);
+	object_delete(debug);
+}
+
+
+/* linux_start */
+#ifdef LINUX_AGENT
+static int _start_agent(LinuxDebug * debug);
+#endif
+
+static int _linux_start(LinuxDebug * debug, va_list argp)
+{
+	char const * filename;
+	LinuxMessage * message;
+
+	if((filename = va_arg(argp, char const *)) == NULL)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(EINVAL));
+	if(debug->tracer != NULL)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(EBUSY));
+#ifdef LINUX_AGENT
+	/* preloaded by the tracer */
+	if(debug->tracepoints_cnt > 0 && _start_agent(debug) != 0)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s: %s", _("Could not set the tracepoints"),
+				error_get(NULL));
+#endif
+	if((message = _linux_message_new(LMT_START)) == NULL)
+	{
+#ifdef LINUX_AGENT
+		_linux_agent_close(debug);
+#endif
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(errno));
+	}
+	message->u.filename = g_strdup(filename);
+	_linux_queue_push(&debug->commands, message);
+	/* every request is issued from this thread */
+	debug->tracer = g_thread_new("linux", _linux_on_trace, debug);
+#ifdef LINUX_AGENT
+	/* the events are read here, as the tracer may be busy */
+	if(debug->agent != NULL)
+		debug->agent_source = g_timeout_add(LINUX_AGENT_POLL,
+				_linux_on_agent, debug);
+#endif
+	return 0;
+}
+
+#ifdef LINUX_AGENT
+static int _start_agent(LinuxDebug * debug)
+{
+	static unsigned int count = 0;
+	AgentBuffer * agent;
+	int fd;
+	size_t i;
+
+	snprintf(debug->agent_name, sizeof(debug->agent_name),
+			"/coder-agent-%d-%u", getpid(), count++);
+	if((fd = shm_open(debug->agent_name, O_RDWR | O_CREAT | O_EXCL, 0600))
+			< 0)
+	{
+		error_set_code(-errno, "%s: %s", debug->agent_name,
+				strerror(errno));
+		debug->agent_name[0] = '\0';
+		return -1;
+	}
+	/* the events are not copied, the debugger reads them in place */
+	if(ftruncate(fd, sizeof(*agent)) != 0
+			|| (agent = mmap(NULL, sizeof(*agent),
+					PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+					0)) == MAP_FAILED)
+	{
+		error_set_code(-errno, "%s: %s", debug->agent_name,
+				strerror(errno));
+		close(fd);
+		_linux_agent_close(debug);
+		return -1;
+	}
+	close(fd);
+	debug->agent = agent;
+	agent->magic = AGENT_MAGIC;
+	agent->version = AGENT_VERSION;
+	agent->tracepoints_cnt = debug->tracepoints_cnt;
+	for(i = 0; i < debug->tracepoints_cnt; i++)
+	{
+		agent->tracepoints[i].address = debug->tracepoints[i].address;
+		debug->tracepoints[i].status = DDTS_PENDING;
+		debug->tracepoints[i].count = 0;
+		debug->tracepoints[i].dropped = 0;
+	}
+	for(i = 0; i < AGENT_EVENTS; i++)
+		agent->slots[i].sequence = i;
+	debug->agent_tail = 0;
+	return 0;
+}
+#endif
+
+
+/* linux_pause */
+static int _linux_pause(LinuxDebug * debug)
+{
+	return _linux_command(debug, LMT_PAUSE, 0);
+}
+
+
+/* linux_stop */
+static int _linux_stop(LinuxDebug * debug)
+{
+	pid_t pid = g_atomic_int_get(&debug->pid);
+
+	if(debug->tracer == NULL)
+		return 0;
+	/* the tracer may be waiting for a step to be recorded */
+	if(pid > 0)
+		kill(pid, SIGKILL);
+	return _linux_command(debug, LMT_KILL, 0);
+}
+
+
+/* linux_continue */
+static int _linux_continue(LinuxDebug * debug)
+{
+	return _linux_command(debug, LMT_RESUME, PTRACE_CONT);
+}
+
+
+/* linux_next */
+static int _linux_next(LinuxDebug * debug)
+{
+	return _linux_command(debug, LMT_RESUME, PTRACE_SYSCALL);
+}
+
+
+/* linux_step */
+static int _linux_step(LinuxDebug * debug)
+{
+	return _linux_command(debug, LMT_RESUME, PTRACE_SINGLESTEP);
+}
+
+
+/* linux_read_memory */
+static ssize_t _linux_read_memory(LinuxDebug * debug, uint64_t address,
+		void * buf, size_t size)
+{
+	pid_t pid = g_atomic_int_get(&debug->pid);
+	struct iovec local;
+	struct iovec remote;
+	char path[32];
+	int fd;
+	ssize_t res;
+
+	if(pid <= 0)
+		return -error_set_code(1, "%s",
+				_("No process is being traced"));
+	if(size == 0)
+		return 0;
+	local.iov_base = buf;
+	local.iov_len = size;
+	remote.iov_base = (void *)(uintptr_t)address;
+	remote.iov_len = size;
+	if((res = process_vm_readv(pid, &local, 1, &remote, 1, 0)) > 0)
+		return res;
+	snprintf(path, sizeof(path), "/proc/%d/mem", pid);
+	if((fd = open(path, O_RDONLY)) < 0)
+	{
+		error_set_code(-errno, "%s: %s", path, strerror(errno));
+		return -1;
+	}
+	res = pread(fd, buf, size, address);
+	close(fd);
+	if(res < 0)
+	{
+		error_set_code(-errno, "%s: %s", path, strerror(errno));
+		return -1;
+	}
+	return res;
+}
+
+
+/* linux_write_memory */
+static ssize_t _linux_write_memory(LinuxDebug * debug, uint64_t address,
+		void const * buf, size_t size)
+{
+	pid_t pid = g_atomic_int_get(&debug->pid);
+	char path[32];
+	int fd;
+	ssize_t res;
+
+	if(pid <= 0)
+		return -error_set_code(1, "%s",
+				_("No process is being traced"));
+	if(size == 0)
+		return 0;
+	/* unlike process_vm_writev() this also patches read-only mappings */
+	snprintf(path, sizeof(path), "/proc/%d/mem", pid);
+	if((fd = open(path, O_WRONLY)) < 0)
+	{
+		error_set_code(-errno, "%s: %s", path, strerror(errno));
+		return -1;
+	}
+	res = pwrite(fd, buf, size, address);
+	close(fd);
+	if(res < 0)
+	{
+		error_set_code(-errno, "%s: %s", path, strerror(errno));
+		return -1;
+	}
+	return res;
+}
+
+
+/* linux_add_breakpoint */
+static int _linux_add_breakpoint(LinuxDebug * debug, uint64_t address,
+		DebuggerDebugCondition const * condition)
+{
+#ifdef LINUX_BREAKPOINT
+	LinuxBreakpoint * breakpoint;
+	LinuxMessage * message;
+
+	/* checked here, evaluated by the tracer on every hit */
+	if((breakpoint = _linux_breakpoint_new(debug, address, condition))
+			== NULL)
+		return -1;
+	if((message = _linux_message_new(LMT_ADD_BREAKPOINT)) == NULL)
+	{
+		_linux_breakpoint_delete(breakpoint);
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(errno));
+	}
+	message->u.breakpoint = breakpoint;
+	/* inserted once the process is started otherwise */
+	_linux_queue_push(&debug->commands, message);
+	return 0;
+#else
+	(void) address;
+	(void) condition;
+
+	return -debug->helper->error(debug->helper->debugger, 1, "%s",
+			_("Breakpoints are not supported on this platform"));
+#endif
+}
+
+
+/* linux_remove_breakpoint */
+static int _linux_remove_breakpoint(LinuxDebug * debug, uint64_t address)
+{
+	LinuxMessage * message;
+
+	if((message = _linux_message_new(LMT_REMOVE_BREAKPOINT)) == NULL)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(errno));
+	message->u.address = address;
+	_linux_queue_push(&debug->commands, message);
+	return 0;
+}
+
+
+/* linux_add_watchpoint */
+static int _linux_add_watchpoint(LinuxDebug * debug, uint64_t address,
+		size_t size, DebuggerDebugWatch watch)
+{
+#ifdef LINUX_WATCHPOINTS
+	LinuxWatchpoint * watchpoint;
+	LinuxMessage * message;
+
+	if(size == 0)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(EINVAL));
+	if((message = _linux_message_new(LMT_ADD_WATCHPOINT)) == NULL)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(errno));
+	watchpoint = g_new(LinuxWatchpoint, 1);
+	watchpoint->address = address;
+	watchpoint->size = size;
+	watchpoint->watch = watch;
+	watchpoint->slot = -1;
+	watchpoint->inserted = FALSE;
+	watchpoint->prots = NULL;
+	watchpoint->reported = FALSE;
+	message->u.watchpoint = watchpoint;
+	/* inserted once the process is started otherwise */
+	_linux_queue_push(&debug->commands, message);
+	return 0;
+#else
+	(void) address;
+	(void) size;
+	(void) watch;
+
+	return -debug->helper->error(debug->helper->debugger, 1, "%s",
+			_("Watchpoints are not supported on this platform"));
+#endif
+}
+
+
+/* linux_remove_watchpoint */
+static int _linux_remove_watchpoint(LinuxDebug * debug, uint64_t address)
+{
+	LinuxMessage * message;
+
+	if((message = _linux_message_new(LMT_REMOVE_WATCHPOINT)) == NULL)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(errno));
+	message->u.address = address;
+	_linux_queue_push(&debug->commands, message);
+	return 0;
+}
+
+
+/* linux_profile */
+static int _linux_profile(LinuxDebug * debug, unsigned int frequency)
+{
+	LinuxMessage * message;
+
+	if(frequency == 0 || frequency > 1000000)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(EINVAL));
+	if(debug->tracer == NULL)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", _("No process is being traced"));
+	if((message = _linux_message_new(LMT_PROFILE)) == NULL)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(errno));
+	message->u.frequency = frequency;
+	_linux_queue_push(&debug->commands, message);
+	return 0;
+}
+
+
+/* linux_record */
+static int _linux_record(LinuxDebug * debug, char const * filename,
+		int registers)
+{
+	LinuxMessage * message;
+
+	if(filename == NULL)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(EINVAL));
+	if(debug->tracer == NULL)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", _("No process is being traced"));
+	if((message = _linux_message_new(LMT_RECORD)) == NULL)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(errno));
+	message->u.record.filename = g_strdup(filename);
+	message->u.record.registers = registers;
+	_linux_queue_push(&debug->commands, message);
+	return 0;
+}
+
+
+/* linux_trace_syscalls */
+#ifdef LINUX_SECCOMP
+static int _syscalls_lookup(char const * name, unsigned int * number);
+#endif
+
+static int _linux_trace_syscalls(LinuxDebug * debug, char const ** syscalls,
+		size_t syscalls_cnt)
+{
+#ifdef LINUX_SECCOMP
+	DebuggerDebugSyscall * s;
+	size_t cnt = 0;
+	unsigned int number;
+	size_t i;
+	size_t j;
+
+	/* the tracer owns them once started */
+	if(debug->tracer != NULL)
+		return -debug->helper->error(debug->helper->debugger, 1, "%s",
+				_("The system calls traced must be set before"
+					" starting"));
+	if(syscalls_cnt > LINUX_SYSCALLS_MAX)
+		return -debug->helper->error(debug->helper->debugger, 1, "%s",
+				_("Too many system calls to trace"));
+	s = g_new0(DebuggerDebugSyscall, syscalls_cnt);
+	for(i = 0; i < syscalls_cnt; i++)
+	{
+		if(_syscalls_lookup(syscalls[i], &number) != 0)
+		{
+			g_free(s);
+			return -debug->helper->error(debug->helper->debugger,
+					1, "%s: %s", syscalls[i],
+					_("Unknown system call"));
+		}
+		/* the filter is installed before executing the program */
+		if(number == SYS_execve || number == SYS_execveat)
+		{
+			g_free(s);
+			return -debug->helper->error(debug->helper->debugger,
+					1, "%s: %s", syscalls[i],
+					_("Cannot be traced"));
+		}
+		for(j = 0; j < cnt && s[j].number != number; j++);
+		if(j < cnt)
+			continue;
+		s[cnt].number = number;
+		s[cnt++].name = (number < G_N_ELEMENTS(_linux_syscalls))
+			? _linux_syscalls[number] : NULL;
+	}
+	g_free(debug->syscalls);
+	debug->syscalls = s;
+	debug->syscalls_cnt = cnt;
+	return 0;
+#else
+	(void) syscalls;
+	(void) syscalls_cnt;
+
+	return -debug->helper->error(debug->helper->debugger, 1, "%s",
+			_("Tracing system calls is not supported on this"
+				" platform"));
+#endif
+}
+
+#ifdef LINUX_SECCOMP
+static int _syscalls_lookup(char const * name, unsigned int * number)
+{
+	unsigned long u;
+	char * p;
+	size_t i;
+
+	for(i = 0; i < G_N_ELEMENTS(_linux_syscalls); i++)
+		if(_linux_syscalls[i] != NULL
+				&& strcmp(_linux_syscalls[i], name) == 0)
+		{
+			*number = i;
+			return 0;
+		}
+	/* also accept numbers, for the calls not known by name */
+	u = strtoul(name, &p, 0);
+	if(name[0] == '\0' || *p != '\0' || u > UINT_MAX)
+		return -1;
+	*number = u;
+	return 0;
+}
+#endif
+
+
+#ifdef LINUX_CHECKPOINTS
+/* linux_checkpoint */
+static int _linux_checkpoint(LinuxDebug * debug)
+{
+	int checkpoint;
+
+	/* confirmed once copied by the tracer */
+	if((checkpoint = debug->checkpoint + 1) <= 0)
+		checkpoint = 1;
+	if(_linux_request(debug, LMT_CHECKPOINT, checkpoint) != 0)
+		return -1;
+	debug->checkpoint = checkpoint;
+	return checkpoint;
+}
+
+
+/* linux_restore */
+static int _linux_restore(LinuxDebug * debug, int checkpoint)
+{
+	return _linux_request(debug, LMT_RESTORE, checkpoint);
+}
+
+
+/* linux_discard */
+static int _linux_discard(LinuxDebug * debug, int checkpoint)
+{
+	return _linux_request(debug, LMT_DISCARD, checkpoint);
+}
+#endif
+
+
+/* linux_tracepoints */
+static int _linux_tracepoints(LinuxDebug * debug, uint64_t const * addresses,
+		size_t addresses_cnt)
+{
+#ifdef LINUX_AGENT
+	DebuggerDebugTracepoint * t;
+	size_t cnt = 0;
+	size_t i;
+	size_t j;
+
+	/* patched by the agent as the process starts */
+	if(debug->tracer != NULL && !debug->relocating)
+		return -debug->helper->error(debug->helper->debugger, 1, "%s",
+				_("The tracepoints must be set before"
+					" starting"));
+	if(addresses_cnt > AGENT_TRACEPOINTS)
+		return -debug->helper->error(debug->helper->debugger, 1, "%s",
+				_("Too many tracepoints"));
+	t = g_new0(DebuggerDebugTracepoint, addresses_cnt);
+	for(i = 0; i < addresses_cnt; i++)
+	{
+		for(j = 0; j < cnt && t[j].address != addresses[i]; j++);
+		if(j == cnt)
+			t[cnt++].address = addresses[i];
+	}
+	/* stopped on exec, the agent is not loaded yet */
+	if(debug->tracer != NULL)
+	{
+		if(debug->agent == NULL || cnt != debug->tracepoints_cnt)
+		{
+			g_free(t);
+			return -debug->helper->error(debug->helper->debugger,
+					1, "%s", _("The tracepoints must be set"
+						" before starting"));
+		}
+		for(i = 0; i < cnt; i++)
+		{
+			debug->agent->tracepoints[i].address = t[i].address;
+			t[i].status = DDTS_PENDING;
+		}
+	}
+	g_free(debug->tracepoints);
+	debug->tracepoints = t;
+	debug->tracepoints_cnt = cnt;
+	return 0;
+#else
+	(void) addresses;
+	(void) addresses_cnt;
+
+	return -debug->helper->error(debug->helper->debugger, 1, "%s",
+			_("Tracepoints are not supported on this platform"));
+#endif
+}
+
+
+/* accessors */
+/* linux_get_registers */
+static void _linux_get_registers(LinuxDebug * debug)
+{
+#if defined(__x86_64__)
+	struct user_regs_struct regs;
+	struct iovec iov;
+	const size_t cnt = sizeof(_linux_registers)
+		/ sizeof(*_linux_registers);
+	LinuxMessage * message;
+	size_t i;
+
+	/* the whole register file at once */
+	iov.iov_base = &regs;
+	iov.iov_len = sizeof(regs);
+	if(ptrace(PTRACE_GETREGSET, debug->tid, (void *)NT_PRSTATUS, &iov)
+			!= 0)
+	{
+		_linux_error(debug, "%s: %s", "ptrace", strerror(errno));
+		return;
+	}
+	if((message = _linux_message_new(LMT_REGISTERS)) == NULL)
+		return;
+	message->u.registers.values = g_new(DebuggerDebugRegister, cnt);
+	message->u.registers.cnt = cnt;
+	for(i = 0; i < cnt; i++)
+	{
+		message->u.registers.values[i].name = _linux_registers[i].name;
+		message->u.registers.values[i].value
+			= *(unsigned long long *)((char *)&regs
+					+ _linux_registers[i].offset);
+	}
+	_linux_post(debug, message);
+#else
+	(void) debug;
+#endif
+}
+
+
+/* useful */
+#ifdef LINUX_AGENT
+/* linux_agent_close */
+static void _linux_agent_close(LinuxDebug * debug)
+{
+	if(debug->agent_source != 0)
+		g_source_remove(debug->agent_source);
+	debug->agent_source = 0;
+	if(debug->agent != NULL)
+		munmap(debug->agent, sizeof(*debug->agent));
+	debug->agent = NULL;
+	/* the agent removes it once loaded, otherwise it is still there */
+	if(debug->agent_name[0] != '\0')
+		shm_unlink(debug->agent_name);
+	debug->agent_name[0] = '\0';
+}
+#endif
+
+
+/* linux_bias */
+static int _linux_bias(LinuxDebug * debug, uint64_t * bias)
+{
+	char path[32];
+	int fd;
+	ssize_t size;
+	union
+	{
+		unsigned char ident[EI_NIDENT];
+		Elf32_Ehdr e32;
+		Elf64_Ehdr e64;
+	} ehdr;
+	union
+	{
+		Elf32_auxv_t a32[64];
+		Elf64_auxv_t a64[32];
+	} auxv;
+	gboolean elf64;
+	uint64_t entry;
+	size_t i;
+
+	/* the entry point of the program, as linked */
+	snprintf(path, sizeof(path), "/proc/%d/exe", debug->pid);
+	if((fd = open(path, O_RDONLY)) < 0)
+		return -error_set_code(-errno, "%s: %s", path,
+				strerror(errno));
+	size = read(fd, &ehdr, sizeof(ehdr));
+	close(fd);
+	elf64 = (size >= EI_NIDENT && ehdr.ident[EI_CLASS] == ELFCLASS64);
+	if(size < (ssize_t)(elf64 ? sizeof(ehdr.e64) : sizeof(ehdr.e32))
+			|| memcmp(ehdr.ident, ELFMAG, SELFMAG) != 0)
+		return -error_set_code(1, "%s: %s", path,
+				_("Not an ELF executable"));
+	/* only position-independent programs are moved */
+	*bias = 0;
+	if((elf64 ? ehdr.e64.e_type : ehdr.e32.e_type) != ET_DYN)
+		return 0;
+	entry = elf64 ? ehdr.e64.e_entry : ehdr.e32.e_entry;
+	/* against the entry point given to the program */
+	snprintf(path, sizeof(path), "/proc/%d/auxv", debug->pid);
+	if((fd = open(path, O_RDONLY)) < 0)
+		return -error_set_code(-errno, "%s: %s", path,
+				strerror(errno));
+	size = read(fd, &auxv, sizeof(auxv));
+	close(fd);
+	for(i = 0; elf64 && size > 0
+			&& i < (size_t)size / sizeof(*auxv.a64); i++)
+		if(auxv.a64[i].a_type == AT_ENTRY)
+		{
+			*bias = auxv.a64[i].a_un.a_val - entry;
+			return 0;
+		}
+	for(i = 0; !elf64 && size > 0
+			&& i < (size_t)size / sizeof(*auxv.a32); i++)
+		if(auxv.a32[i].a_type == AT_ENTRY)
+		{
+			*bias = (uint32_t)(auxv.a32[i].a_un.a_val - entry);
+			return 0;
+		}
+	return -error_set_code(1, "%s: %s", path,
+			_("The entry point is unknown"));
+}
+
+
+/* linux_breakpoint_add */
+static void _linux_breakpoint_add(LinuxDebug * debug,
+		LinuxBreakpoint * breakpoint)
+{
+	LinuxBreakpoint * p;
+
+	/* only the condition changes on existing breakpoints */
+	if((p = g_hash_table_lookup(debug->breakpoints, &breakpoint->address))
+			!= NULL)
+	{
+		breakpoint->inserted = p->inserted;
+		breakpoint->failed = p->failed;
+#ifdef LINUX_BREAKPOINT
+		memcpy(breakpoint->code, p->code, sizeof(p->code));
+#endif
+		breakpoint->statistics = p->statistics;
+		g_hash_table_replace(debug->breakpoints, &breakpoint->address,
+				breakpoint);
+		return;
+	}
+	g_hash_table_insert(debug->breakpoints, &breakpoint->address,
+			breakpoint);
+	/* patched right away, even while running */
+	if(debug->executed && _linux_breakpoint_insert(debug, breakpoint) != 0)
+	{
+		breakpoint->failed = TRUE;
+		_linux_error(debug, "%s 0x%llx: %s",
+				_("Could not set the breakpoint at"),
+				(unsigned long long)breakpoint->address,
+				error_get(NULL));
+	}
+}
+
+
+/* linux_breakpoint_at */
+static LinuxBreakpoint * _linux_breakpoint_at(LinuxDebug * debug, pid_t tid)
+{
+#ifdef LINUX_BREAKPOINT
+	LinuxBreakpoint * breakpoint;
+	uint64_t address;
+
+	if(g_hash_table_size(debug->breakpoints) == 0)
+		return NULL;
+	errno = 0;
+	address = ptrace(PTRACE_PEEKUSER, tid, LINUX_PC, NULL);
+	if(errno != 0 || (breakpoint = g_hash_table_lookup(debug->breakpoints,
+					&address)) == NULL
+			|| !breakpoint->inserted)
+		return NULL;
+	return breakpoint;
+#else
+	(void) debug;
+	(void) tid;
+
+	return NULL;
+#endif
+}
+
+
+/* linux_breakpoint_delete */
+static void _linux_breakpoint_delete(LinuxBreakpoint * breakpoint)
+{
+	g_free(breakpoint->condition);
+	g_free(breakpoint->registers);
+	g_free(breakpoint->stack);
+	g_free(breakpoint);
+}
+
+
+/* linux_breakpoint_evaluate */
+#if defined(__x86_64__)
+static uint64_t _evaluate_on_register(void * data, size_t index);
+static ssize_t _evaluate_on_read(void * data, uint64_t address, void * buf,
+		size_t size);
+#endif
+
+static int _linux_breakpoint_evaluate(LinuxDebug * debug,
+		LinuxBreakpoint * breakpoint, pid_t tid)
+{
+#if defined(__x86_64__)
+	struct user_regs_struct regs;
+	LinuxEvaluation evaluation = { debug, breakpoint, &regs };
+	ConditionHelper helper = { &evaluation, _evaluate_on_register,
+		_evaluate_on_read };
+	struct iovec iov;
+	struct timespec start;
+	struct timespec end;
+	int ret;
+
+	if(breakpoint->condition == NULL)
+		return 1;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	iov.iov_base = &regs;
+	iov.iov_len = sizeof(regs);
+	/* stop on errors too, as if the condition held */
+	ret = (ptrace(PTRACE_GETREGSET, tid, (void *)NT_PRSTATUS, &iov) != 0
+			|| condition_evaluate(breakpoint->condition,
+				breakpoint->condition_cnt, breakpoint->stack,
+				breakpoint->statistics.hits, &helper) != 0)
+		? 1 : 0;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	breakpoint->statistics.evaluation += (end.tv_sec - start.tv_sec)
+		* 1000000000 + end.tv_nsec - start.tv_nsec;
+	return ret;
+#else
+	(void) debug;
+	(void) breakpoint;
+	(void) tid;
+
+	return 1;
+#endif
+}
+
+#if defined(__x86_64__)
+static uint64_t _evaluate_on_register(void * data, size_t index)
+{
+	LinuxEvaluation * evaluation = data;
+
+	return *(unsigned long long const *)((char const *)evaluation->regs
+			+ _linux_registers[evaluation->breakpoint->registers[
+			index]].offset);
+}
+
+static ssize_t _evaluate_on_read(void * data, uint64_t address, void * buf,
+		size_t size)
+{
+	LinuxEvaluation * evaluation = data;
+
+	return _linux_read_memory(evaluation->debug, address, buf, size);
+}
+#endif
+
+
+/* linux_breakpoint_insert */
+static int _linux_breakpoint_insert(LinuxDebug * debug,
+		LinuxBreakpoint * breakpoint)
+{
+#ifdef LINUX_BREAKPOINT
+	size_t size = sizeof(breakpoint->code);
+
+	if(breakpoint->inserted)
+		return 0;
+	if(_linux_read_memory(debug, breakpoint->address, breakpoint->code,
+				size) != (ssize_t)size
+			|| _linux_write_memory(debug, breakpoint->address,
+				LINUX_BREAKPOINT, size) != (ssize_t)size)
+		return -1;
+	breakpoint->inserted = TRUE;
+	return 0;
+#else
+	(void) debug;
+	(void) breakpoint;
+
+	return -error_set_code(1, "%s", strerror(ENOSYS));
+#endif
+}
+
+
+/* linux_breakpoint_new */
+static LinuxBreakpoint * _linux_breakpoint_new(LinuxDebug * debug,
+		uint64_t address, DebuggerDebugCondition const * condition)
+{
+	DebuggerDebugHelper const * helper = debug->helper;
+	LinuxBreakpoint * breakpoint;
+#if defined(__x86_64__)
+	const size_t cnt = sizeof(_linux_registers)
+		/ sizeof(*_linux_registers);
+#else
+	const size_t cnt = 0;
+#endif
+	size_t i;
+	size_t j;
+
+	if(condition != NULL && condition_check(condition) != 0)
+	{
+		helper->error(helper->debugger, 1, "%s",
+				_("Invalid breakpoint condition"));
+		return NULL;
+	}
+	if((breakpoint = g_new0(LinuxBreakpoint, 1)) == NULL)
+	{
+		helper->error(helper->debugger, 1, "%s", strerror(errno));
+		return NULL;
+	}
+	breakpoint->address = address;
+	breakpoint->statistics.address = address;
+	if(condition == NULL)
+		return breakpoint;
+	/* resolve the registers once, only the names matter here */
+	breakpoint->registers = g_new(size_t, condition->registers_cnt);
+	for(i = 0; i < condition->registers_cnt; i++)
+	{
+#if defined(__x86_64__)
+		for(j = 0; j < cnt; j++)
+			if(g_ascii_strcasecmp(condition->registers[i],
+						_linux_registers[j].name) == 0)
+				break;
+#else
+		/* none is known */
+		j = cnt;
+#endif
+		if(j == cnt)
+		{
+			helper->error(helper->debugger, 1, "%s: %s",
+					condition->registers[i],
+					_("Unknown register"));
+			_linux_breakpoint_delete(breakpoint);
+			return NULL;
+		}
+		breakpoint->registers[i] = j;
+	}
+	breakpoint->condition = g_new(DebuggerDebugInstruction,
+			condition->code_cnt);
+	memcpy(breakpoint->condition, condition->code,
+			sizeof(*condition->code) * condition->code_cnt);
+	breakpoint->condition_cnt = condition->code_cnt;
+	breakpoint->stack = g_new(uint64_t, condition->depth);
+	return breakpoint;
+}
+
+
+/* linux_breakpoint_remove */
+static void _linux_breakpoint_remove(LinuxDebug * debug, uint64_t address)
+{
+	LinuxBreakpoint * breakpoint;
+
+	if((breakpoint = g_hash_table_lookup(debug->breakpoints, &address))
+			== NULL)
+		return;
+	if(_linux_breakpoint_restore(debug, breakpoint) != 0)
+		_linux_error(debug, "%s", error_get(NULL));
+	g_hash_table_remove(debug->breakpoints, &address);
+}
+
+
+/* linux_breakpoint_report */
+static void _linux_breakpoint_report(LinuxDebug * debug)
+{
+	LinuxMessage * message;
+	GHashTableIter iter;
+	gpointer value;
+	size_t cnt = 0;
+
+	if(g_hash_table_size(debug->breakpoints) == 0
+			|| (message = _linux_message_new(LMT_BREAKPOINTS))
+			== NULL)
+		return;
+	message->u.breakpoints.values = g_new(DebuggerDebugBreakpoint,
+			g_hash_table_size(debug->breakpoints));
+	g_hash_table_iter_init(&iter, debug->breakpoints);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+		message->u.breakpoints.values[cnt++]
+			= ((LinuxBreakpoint *)value)->statistics;
+	message->u.breakpoints.cnt = cnt;
+	_linux_post(debug, message);
+}
+
+
+/* linux_breakpoint_restore */
+static int _linux_breakpoint_restore(LinuxDebug * debug,
+		LinuxBreakpoint * breakpoint)
+{
+#ifdef LINUX_BREAKPOINT
+	size_t size = sizeof(breakpoint->code);
+
+	if(!breakpoint->inserted)
+		return 0;
+	if(_linux_write_memory(debug, breakpoint->address, breakpoint->code,
+				size) != (ssize_t)size)
+		return -1;
+	breakpoint->inserted = FALSE;
+	return 0;
+#else
+	(void) debug;
+	(void) breakpoint;
+
+	return 0;
+#endif
+}
+
+
+/* linux_breakpoint_step */
+static int _linux_breakpoint_step(LinuxDebug * debug, pid_t tid,
+		LinuxBreakpoint * breakpoint, int sig)
+{
+	int ret = -1;
+
+	/* this thread is waited for here, while the others are held */
+	_linux_hold(debug);
+	_linux_threads_stop(debug, tid);
+	if(_linux_breakpoint_restore(debug, breakpoint) != 0)
+		_linux_error(debug, "%s", error_get(NULL));
+	else
+		ret = _linux_singlestep(debug, tid, sig);
+	if(_linux_breakpoint_insert(debug, breakpoint) != 0 && ret == 0)
+		ret = -_linux_error(debug, "%s", error_get(NULL));
+	_linux_threads_continue(debug);
+	_linux_release(debug);
+	return ret;
+}
+
+
+/* linux_breakpoint_trap */
+static LinuxBreakpoint * _linux_breakpoint_trap(LinuxDebug * debug,
+		pid_t tid)
+{
+#ifdef LINUX_BREAKPOINT
+	LinuxBreakpoint * breakpoint;
+	siginfo_t info;
+	uint64_t address;
+
+	if(g_hash_table_size(debug->breakpoints) == 0)
+		return NULL;
+	errno = 0;
+	address = ptrace(PTRACE_PEEKUSER, tid, LINUX_PC, NULL);
+	if(errno != 0)
+		return NULL;
+	/* the trap leaves the program counter after the breakpoint */
+	address -= sizeof(LINUX_BREAKPOINT) - 1;
+	if((breakpoint = g_hash_table_lookup(debug->breakpoints, &address))
+			== NULL || !breakpoint->inserted
+			|| ptrace(PTRACE_GETSIGINFO, tid, NULL, &info) != 0
+			|| info.si_code != SI_KERNEL
+			|| ptrace(PTRACE_POKEUSER, tid, LINUX_PC, address)
+			!= 0)
+		return NULL;
+	return breakpoint;
+#else
+	(void) debug;
+	(void) tid;
+
+	return NULL;
+#endif
+}
+
+
+/* linux_breakpoints_insert */
+static void _linux_breakpoints_insert(LinuxDebug * debug)
+{
+	GHashTableIter iter;
+	gpointer value;
+	LinuxBreakpoint * breakpoint;
+
+	if(!debug->executed)
+		return;
+	/* the others are retried on every resume, as code gets mapped */
+	g_hash_table_iter_init(&iter, debug->breakpoints);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		breakpoint = value;
+		if(_linux_breakpoint_insert(debug, breakpoint) == 0)
+			breakpoint->failed = FALSE;
+		else if(!breakpoint->failed)
+		{
+			breakpoint->failed = TRUE;
+			_linux_error(debug, "%s 0x%llx: %s",
+					_("Could not set the breakpoint at"),
+					(unsigned long long)breakpoint->address,
+					error_get(NULL));
+		}
+	}
+}
+
+
+/* linux_breakpoints_reset */
+static void _linux_breakpoints_reset(LinuxDebug * debug)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	/* the code was replaced altogether */
+	g_hash_table_iter_init(&iter, debug->breakpoints);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		((LinuxBreakpoint *)value)->inserted = FALSE;
+		((LinuxBreakpoint *)value)->failed = FALSE;
+	}
+}
+
+
+/* linux_checkpoints_kill */
+static void _linux_checkpoints_kill(LinuxDebug * debug)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	/* collected by the waiter, as they keep the process group alive */
+	g_hash_table_iter_init(&iter, debug->checkpoints);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+		kill(GPOINTER_TO_INT(value), SIGKILL);
+	g_hash_table_remove_all(debug->checkpoints);
+}
+
+
+/* linux_clean */
+static int _linux_clean(LinuxDebug * debug, pid_t child)
+{
+	pid_t pid = debug->pid;
+	GHashTableIter iter;
+	gpointer value;
+	LinuxWatchpoint * watchpoint;
+	GSList * breakpoints = NULL;
+	GSList * watchpoints = NULL;
+	GSList * l;
+	int ret = 0;
+
+	/* from a copy of the process, its memory accessed meanwhile */
+	g_atomic_int_set(&debug->pid, child);
+	g_hash_table_iter_init(&iter, debug->breakpoints);
+	while(ret == 0 && g_hash_table_iter_next(&iter, NULL, &value))
+		if(!((LinuxBreakpoint *)value)->inserted)
+			continue;
+		else if((ret = _linux_breakpoint_restore(debug, value)) == 0)
+			breakpoints = g_slist_prepend(breakpoints, value);
+	g_hash_table_iter_init(&iter, debug->watchpoints);
+	while(ret == 0 && g_hash_table_iter_next(&iter, NULL, &value))
+		if((watchpoint = value)->slot >= 0 || !watchpoint->inserted)
+			continue;
+		else if((ret = _linux_watchpoint_restore(debug, child,
+						watchpoint)) == 0)
+			watchpoints = g_slist_prepend(watchpoints, watchpoint);
+	/* they remain in the process itself */
+	for(l = breakpoints; l != NULL; l = l->next)
+		((LinuxBreakpoint *)l->data)->inserted = TRUE;
+	for(l = watchpoints; l != NULL; l = l->next)
+		((LinuxWatchpoint *)l->data)->inserted = TRUE;
+	g_slist_free(breakpoints);
+	g_slist_free(watchpoints);
+	g_atomic_int_set(&debug->pid, pid);
+	return ret;
+}
+
+
+/* linux_command */
+static int _linux_command(LinuxDebug * debug, LinuxMessageType type,
+		int request)
+{
+	LinuxMessage * message;
+
+	if(debug->tracer == NULL)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", _("No process is being traced"));
+	if((message = _linux_message_new(type)) == NULL)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(errno));
+	message->u.request = request;
+	/* handled asynchronously */
+	_linux_queue_push(&debug->commands, message);
+	return 0;
+}
+
+
+/* linux_error */
+static int _linux_error(LinuxDebug * debug, char const * format, ...)
+{
+	LinuxMessage * message;
+	va_list ap;
+
+	if((message = _linux_message_new(LMT_ERROR)) == NULL)
+		return 1;
+	va_start(ap, format);
+	message->u.error = g_strdup_vprintf(format, ap);
+	va_end(ap);
+	/* reported from the main loop */
+	_linux_post(debug, message);
+	return 1;
+}
+
+
+#ifdef LINUX_CHECKPOINTS
+/* linux_fork */
+static int _fork_clean(LinuxDebug * debug, pid_t child,
+		struct user_regs_struct * regs, unsigned char const * code,
+		size_t size);
+
+static pid_t _linux_fork(LinuxDebug * debug, pid_t tid)
+{
+	/* without any signal on exit, the process does not wait for it */
+	const unsigned long args[3] = { 0, 0, 0 };
+	pid_t pid = debug->pid;
+	struct user_regs_struct regs;
+	struct iovec iov;
+	unsigned char code[2];
+	long child;
+	int status;
+	pid_t ret = -1;
+
+	/* the copy is waited for here */
+	_linux_hold(debug);
+	if(_linux_syscall(debug, tid, SYS_clone, args, 3, &child) != 0)
+	{
+		_linux_release(debug);
+		return -1;
+	}
+	if(child < 0)
+	{
+		_linux_release(debug);
+		return -error_set_code(1, "%s: %s", "clone", strerror(-child));
+	}
+	/* reported as a new thread, although another process */
+	g_hash_table_remove(debug->threads, GINT_TO_POINTER(child));
+	/* the copy starts stopped, right after the call */
+	if(_linux_wait(child, &status) != 0 || !WIFSTOPPED(status))
+	{
+		kill(child, SIGKILL);
+		_linux_reap(child);
+		_linux_release(debug);
+		return -error_set_code(1, "%s", strerror(ECHILD));
+	}
+	/* the thread was restored as it was */
+	iov.iov_base = &regs;
+	iov.iov_len = sizeof(regs);
+	if(ptrace(PTRACE_GETREGSET, tid, (void *)NT_PRSTATUS, &iov) != 0)
+		error_set_code(-errno, "%s: %s", "ptrace", strerror(errno));
+	else if(_linux_read_memory(debug, regs.rip, code, sizeof(code))
+			== (ssize_t)sizeof(code))
+	{
+		/* the memory accessed is that of the copy meanwhile */
+		g_atomic_int_set(&debug->pid, child);
+		if(_fork_clean(debug, child, &regs, code, sizeof(code)) == 0)
+			ret = child;
+		g_atomic_int_set(&debug->pid, pid);
+	}
+	if(ret < 0)
+	{
+		kill(child, SIGKILL);
+		_linux_reap(child);
+	}
+	_linux_release(debug);
+	return ret;
+}
+
+static int _fork_clean(LinuxDebug * debug, pid_t child,
+		struct user_regs_struct * regs, unsigned char const * code,
+		size_t size)
+{
+	struct iovec iov;
+	int ret;
+
+	/* the copy resumes from the same instruction and registers */
+	iov.iov_base = regs;
+	iov.iov_len = sizeof(*regs);
+	if(_linux_write_memory(debug, regs->rip, code, size) != (ssize_t)size)
+		return -1;
+	if(ptrace(PTRACE_SETREGSET, child, (void *)NT_PRSTATUS, &iov) != 0)
+		return -error_set_code(-errno, "%s: %s", "ptrace",
+				strerror(errno));
+	/* without the breakpoints and watchpoints, inserted on resume */
+	ret = _linux_clean(debug, child);
+	/* stepped as a thread meanwhile */
+	g_hash_table_remove(debug->threads, GINT_TO_POINTER(child));
+	return ret;
+}
+#endif
+
+
+/* linux_hold */
+static void _linux_hold(LinuxDebug * debug)
+{
+	/* the waiter steps aside until released */
+	g_mutex_lock(&debug->lock);
+	debug->waiting++;
+	g_mutex_unlock(&debug->lock);
+}
+
+
+/* linux_mprotect */
+static int _linux_mprotect(LinuxDebug * debug, pid_t tid, uint64_t address,
+		uint64_t size, int prot)
+{
+	unsigned long args[3] = { address, size, prot };
+	long res;
+
+	if(_linux_syscall(debug, tid, SYS_mprotect, args, 3, &res) != 0)
+		return -1;
+	if(res < 0)
+		return -error_set_code(1, "%s: %s", "mprotect",
+				strerror(-res));
+	return 0;
+}
+
+
+/* linux_post */
+static void _linux_post(LinuxDebug * debug, LinuxMessage * message)
+{
+	_linux_queue_push(&debug->messages, message);
+}
+
+
+#ifdef LINUX_CHECKPOINTS
+/* linux_reap */
+static void _linux_reap(pid_t tid)
+{
+	int status;
+
+	/* killed already, any stop left is ignored */
+	while(_linux_wait(tid, &status) == 0 && WIFSTOPPED(status));
+}
+#endif
+
+
+/* linux_release */
+static void _linux_release(LinuxDebug * debug)
+{
+	g_mutex_lock(&debug->lock);
+	if(--debug->waiting == 0)
+		g_cond_broadcast(&debug->cond);
+	g_mutex_unlock(&debug->lock);
+}
+
+
+#ifdef LINUX_CHECKPOINTS
+/* linux_request */
+static int _linux_request(LinuxDebug * debug, LinuxMessageType type,
+		int checkpoint)
+{
+	LinuxMessage * message;
+	gboolean queued;
+
+	if((message = _linux_message_new(type)) == NULL)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(errno));
+	message->u.checkpoint.id = checkpoint;
+	message->u.checkpoint.pid = -1;
+	/* only queued while the tracer handles them, as a process is */
+	g_mutex_lock(&debug->lock);
+	if((queued = (g_atomic_int_get(&debug->pid) > 0)))
+		_linux_queue_push(&debug->commands, message);
+	g_mutex_unlock(&debug->lock);
+	if(queued)
+		return 0;
+	_linux_message_delete(message);
+	return -debug->helper->error(debug->helper->debugger, 1, "%s",
+			_("No process is being traced"));
+}
+#endif
+
+
+/* linux_requeue */
+static void _linux_requeue(LinuxDebug * debug, pid_t tid, int status)
+{
+	LinuxMessage * message;
+
+	/* handled as if collected by the waiter */
+	if((message = _linux_message_new(LMT_WAIT)) == NULL)
+		return;
+	message->u.wait.tid = tid;
+	message->u.wait.status = status;
+	_linux_queue_push(&debug->commands, message);
+}
+
+
+/* linux_resume */
+static int _linux_resume(LinuxDebug * debug, int request)
+{
+	GHashTableIter iter;
+	gpointer value;
+	LinuxThread * thread;
+	LinuxBreakpoint * breakpoint;
+	int ret = 0;
+
+	if(debug->pid <= 0)
+		return -_linux_error(debug, "%s",
+				_("No process is being traced"));
+	if(debug->running)
+		return 0;
+	_linux_breakpoints_insert(debug);
+	_linux_watchpoints_insert(debug);
+	/* step over the breakpoint stopped at first */
+	if((breakpoint = _linux_breakpoint_at(debug, debug->tid)) != NULL)
+	{
+		if(_linux_breakpoint_step(debug, debug->tid, breakpoint,
+					debug->signal) != 0)
+			return -1;
+		debug->signal = 0;
+		/* unless recording, this was the step requested */
+		if(request == PTRACE_SINGLESTEP && debug->writer == NULL)
+		{
+			_linux_get_registers(debug);
+			return 0;
+		}
+	}
+	if((thread = _linux_thread(debug, debug->tid)) != NULL)
+		_linux_watchpoints_set(debug, thread);
+	if(ptrace(request, debug->tid, NULL, debug->signal) != 0)
+		return -_linux_error(debug, "%s: %s", "ptrace",
+				strerror(errno));
+	debug->signal = 0;
+	debug->request = request;
+	debug->running = TRUE;
+	if(thread != NULL)
+		thread->stopped = FALSE;
+	/* the other threads remain stopped when stepping */
+	if(request == PTRACE_SINGLESTEP)
+		return 0;
+	g_hash_table_iter_init(&iter, debug->threads);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		thread = value;
+		if(!thread->stopped)
+			continue;
+		_linux_watchpoints_set(debug, thread);
+		if(ptrace(PTRACE_CONT, thread->tid, NULL, 0) != 0)
+			ret = -_linux_error(debug, "%s: %s", "ptrace",
+					strerror(errno));
+		else
+			thread->stopped = FALSE;
+	}
+	return ret;
+}
+
+
+/* linux_singlestep */
+static int _linux_singlestep(LinuxDebug * debug, pid_t tid, int sig)
+{
+	LinuxThread * thread;
+	unsigned long msg;
+	int status;
+	gboolean interrupted = FALSE;
+	int ret = -1;
+
+	/* this thread is waited for here */
+	_linux_hold(debug);
+	for(;;)
+	{
+		if(ptrace(PTRACE_SINGLESTEP, tid, NULL, sig) != 0
+				|| _linux_wait(tid, &status) != 0)
+		{
+			_linux_error(debug, "%s: %s", "ptrace",
+					strerror(errno));
+			break;
+		}
+		if(!WIFSTOPPED(status))
+		{
+			_linux_requeue(debug, tid, status);
+			break;
+		}
+		if(status >> 16 == PTRACE_EVENT_CLONE
+				&& ptrace(PTRACE_GETEVENTMSG, tid, NULL, &msg)
+				== 0)
+			_linux_thread(debug, msg);
+		/* interrupted as requested before, and again once resumed */
+		if(status >> 16 == PTRACE_EVENT_STOP)
+			interrupted = TRUE;
+		/* deliver the signals received meanwhile */
+		if(status >> 16 != 0)
+			sig = 0;
+		else if((sig = WSTOPSIG(status)) == SIGTRAP)
+		{
+			ret = 0;
+			break;
+		}
+	}
+	/* the step cancelled any interruption, requested again */
+	if(ret == 0 && (thread = _linux_thread(debug, tid)) != NULL
+			&& (interrupted || thread->interrupted
+				|| thread->sampled))
+		ptrace(PTRACE_INTERRUPT, tid, NULL, 0);
+	_linux_release(debug);
+	return ret;
+}
+
+
+/* linux_syscall */
+static int _linux_syscall(LinuxDebug * debug, pid_t tid, long number,
+		unsigned long const * args, size_t args_cnt, long * result)
+{
+#if defined(__x86_64__)
+# ifdef PTRACE_GET_SYSCALL_INFO
+	struct __ptrace_syscall_info info;
+# endif
+	struct user_regs_struct saved;
+	struct user_regs_struct regs;
+	struct iovec iov;
+	unsigned char code[2];
+	size_t i;
+	int ret = -1;
+
+	if(args_cnt > 3)
+		return -error_set_code(1, "%s", strerror(E2BIG));
+# ifdef PTRACE_GET_SYSCALL_INFO
+	/* the system call entered would be skipped */
+	if(ptrace(PTRACE_GET_SYSCALL_INFO, tid, (void *)sizeof(info), &info)
+			> 0 && (info.op == PTRACE_SYSCALL_INFO_ENTRY
+				|| info.op == PTRACE_SYSCALL_INFO_SECCOMP))
+		return -error_set_code(1, "%s", strerror(EBUSY));
+# endif
+	/* have the thread call it from the current instruction */
+	iov.iov_len = sizeof(saved);
+	iov.iov_base = &saved;
+	if(ptrace(PTRACE_GETREGSET, tid, (void *)NT_PRSTATUS, &iov) != 0)
+		return -error_set_code(-errno, "%s: %s", "ptrace",
+				strerror(errno));
+	if(_linux_read_memory(debug, saved.rip, code, sizeof(code))
+			!= (ssize_t)sizeof(code)
+			|| _linux_write_memory(debug, saved.rip, "\x0f\x05",
+				sizeof(code)) != (ssize_t)sizeof(code))
+		return -1;
+	/* twice if stopped within a system call, only returning at first */
+	for(i = 0; ret != 0 && i < 2; i++)
+	{
+		regs = saved;
+		regs.rax = number;
+		/* nor is the system call interrupted if any restarted */
+		regs.orig_rax = -1;
+		regs.rdi = (args_cnt > 0) ? args[0] : 0;
+		regs.rsi = (args_cnt > 1) ? args[1] : 0;
+		regs.rdx = (args_cnt > 2) ? args[2] : 0;
+		iov.iov_base = &regs;
+		if(ptrace(PTRACE_SETREGSET, tid, (void *)NT_PRSTATUS, &iov)
+				!= 0)
+		{
+			error_set_code(-errno, "%s: %s", "ptrace",
+					strerror(errno));
+			break;
+		}
+		if(_linux_singlestep(debug, tid, 0) != 0)
+		{
+			error_set_code(1, "%s", strerror(ESRCH));
+			break;
+		}
+		if(ptrace(PTRACE_GETREGSET, tid, (void *)NT_PRSTATUS, &iov)
+				!= 0)
+		{
+			error_set_code(-errno, "%s: %s", "ptrace",
+					strerror(errno));
+			break;
+		}
+		if(regs.rip != saved.rip)
+		{
+			*result = regs.rax;
+			ret = 0;
+		}
+		else
+			/* the value returned by the system call left */
+			saved.rax = regs.rax;
+	}
+	if(ret != 0 && i == 2)
+		error_set_code(1, "%s", strerror(EAGAIN));
+	/* restore the thread as it was */
+	_linux_write_memory(debug, saved.rip, code, sizeof(code));
+	iov.iov_base = &saved;
+	ptrace(PTRACE_SETREGSET, tid, (void *)NT_PRSTATUS, &iov);
+	return ret;
+#else
+	(void) debug;
+	(void) tid;
+	(void) number;
+	(void) args;
+	(void) args_cnt;
+	(void) result;
+
+	return -error_set_code(1, "%s", strerror(ENOSYS));
+#endif
+}
+
+
+/* linux_syscall_enter */
+static int _linux_syscall_enter(LinuxDebug * debug, LinuxThread * thread)
+{
+#ifdef LINUX_SECCOMP
+	long number;
+	size_t i;
+
+	/* stopped by the filter, on one of the system calls traced */
+	errno = 0;
+	number = ptrace(PTRACE_PEEKUSER, thread->tid, LINUX_SYSCALL, NULL);
+	if(errno != 0)
+		return -1;
+	for(i = 0; i < debug->syscalls_cnt; i++)
+		if(debug->syscalls[i].number == (unsigned long)number)
+			break;
+	if(i == debug->syscalls_cnt)
+		return -1;
+	thread->syscall = &debug->syscalls[i];
+	clock_gettime(CLOCK_MONOTONIC, &thread->entry);
+	/* this stop cancelled the pause, reported on return instead */
+	if(debug->pausing && thread->tid == debug->tid)
+		ptrace(PTRACE_INTERRUPT, thread->tid, NULL, 0);
+	/* stop again when returning from the call */
+	if(ptrace(PTRACE_SYSCALL, thread->tid, NULL, 0) != 0)
+	{
+		thread->syscall = NULL;
+		return -1;
+	}
+	return 0;
+#else
+	(void) debug;
+	(void) thread;
+
+	return -1;
+#endif
+}
+
+
+/* linux_syscall_exit */
+static void _linux_syscall_exit(LinuxThread * thread)
+{
+	DebuggerDebugSyscall * syscall = thread->syscall;
+	struct timespec now;
+	uint64_t latency;
+	size_t i;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	latency = (now.tv_sec - thread->entry.tv_sec) * 1000000000
+		+ now.tv_nsec - thread->entry.tv_nsec;
+	thread->syscall = NULL;
+	syscall->count++;
+	syscall->total += latency;
+	if(latency > syscall->maximum)
+		syscall->maximum = latency;
+	for(i = 0; i < DEBUGGER_DEBUG_HISTOGRAM - 1 && latency >> (i + 1) != 0;
+			i++);
+	syscall->histogram[i]++;
+}
+
+
+/* linux_syscall_report */
+static void _linux_syscall_report(LinuxDebug * debug)
+{
+	LinuxMessage * message;
+
+	if(debug->syscalls_cnt == 0
+			|| (message = _linux_message_new(LMT_SYSCALLS)) == NULL)
+		return;
+	message->u.syscalls.values = g_new(DebuggerDebugSyscall,
+			debug->syscalls_cnt);
+	memcpy(message->u.syscalls.values, debug->syscalls,
+			sizeof(*debug->syscalls) * debug->syscalls_cnt);
+	message->u.syscalls.cnt = debug->syscalls_cnt;
+	_linux_post(debug, message);
+}
+
+
+/* linux_thread */
+static LinuxThread * _linux_thread(LinuxDebug * debug, pid_t tid)
+{
+	LinuxThread * thread;
+
+	if((thread = g_hash_table_lookup(debug->threads, GINT_TO_POINTER(tid)))
+			!= NULL)
+		return thread;
+	if((thread = g_new(LinuxThread, 1)) == NULL)
+		return NULL;
+	thread->tid = tid;
+	thread->process = debug->pid;
+	thread->inherited = FALSE;
+	thread->started = FALSE;
+	thread->stopped = FALSE;
+	thread->interrupted = FALSE;
+	thread->sampled = FALSE;
+	thread->held = 0;
+	thread->generation = 0;
+	thread->syscall = NULL;
+	g_hash_table_insert(debug->threads, GINT_TO_POINTER(tid), thread);
+	return thread;
+}
+
+
+/* linux_threads_continue */
+static void _linux_threads_continue(LinuxDebug * debug)
+{
+	GHashTableIter iter;
+	gpointer value;
+	LinuxThread * thread;
+	int sig;
+	gboolean again = FALSE;
+	gboolean hit;
+
+	g_hash_table_iter_init(&iter, debug->threads);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		if((thread = value)->held == 0)
+			continue;
+		sig = WSTOPSIG(thread->held);
+		if(thread->held >> 16 == PTRACE_EVENT_STOP)
+		{
+			/* interrupted as intended, if not already meant to */
+			sig = 0;
+			again = thread->interrupted || thread->sampled
+				|| (debug->pausing
+						&& thread->tid == debug->tid);
+		}
+		else
+		{
+			/* stopped otherwise, interrupted once resumed */
+			again = FALSE;
+			thread->interrupted = TRUE;
+			ptrace(PTRACE_INTERRUPT, thread->tid, NULL, 0);
+			/* breakpoints and watchpoints are hit again */
+			if(thread->held >> 16 != 0 || (sig == SIGTRAP
+						&& _linux_breakpoint_trap(debug,
+							thread->tid) != NULL)
+					|| (sig == SIGSEGV
+						&& _linux_watchpoint_fault(
+							debug, thread->tid,
+							&hit) != NULL))
+				sig = 0;
+		}
+		_linux_watchpoints_set(debug, thread);
+		/* entering a system call traced, timed until it returns */
+		if(thread->held >> 16 == PTRACE_EVENT_SECCOMP
+				&& _linux_syscall_enter(debug, thread) == 0)
+		{
+			thread->held = 0;
+			continue;
+		}
+		thread->held = 0;
+		if(ptrace(PTRACE_CONT, thread->tid, NULL, sig) == 0 && again)
+			ptrace(PTRACE_INTERRUPT, thread->tid, NULL, 0);
+	}
+}
+
+
+/* linux_threads_stop */
+static pid_t _linux_threads_stop(LinuxDebug * debug, pid_t tid)
+{
+	GHashTableIter iter;
+	gpointer value;
+	LinuxThread * thread;
+	char path[64];
+	char buf[256];
+	char * p;
+	int fd;
+	ssize_t size;
+	int status;
+	pid_t ret = -1;
+
+	/* the waiter has to be held meanwhile */
+	g_hash_table_iter_init(&iter, debug->threads);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		thread = value;
+		if(thread->tid == tid || !thread->started)
+			continue;
+		if(thread->stopped)
+		{
+			ret = (ret < 0) ? thread->tid : ret;
+			continue;
+		}
+		/* unless already stopped, its stop not handled yet */
+		snprintf(path, sizeof(path), "/proc/%d/task/%d/stat",
+				debug->pid, thread->tid);
+		if((fd = open(path, O_RDONLY)) < 0)
+			continue;
+		size = read(fd, buf, sizeof(buf) - 1);
+		close(fd);
+		buf[(size > 0) ? size : 0] = '\0';
+		if((p = strrchr(buf, ')')) == NULL || p[1] != ' '
+				|| p[2] == 't')
+			continue;
+		if(ptrace(PTRACE_INTERRUPT, thread->tid, NULL, 0) != 0
+				|| _linux_wait(thread->tid, &status) != 0)
+			continue;
+		if(!WIFSTOPPED(status))
+			_linux_requeue(debug, thread->tid, status);
+		else
+		{
+			thread->held = status;
+			ret = (ret < 0) ? thread->tid : ret;
+		}
+	}
+	/* a thread stopped, to call into the process if needed */
+	return ret;
+}
+
+
+/* linux_tracepoint_report */
+static void _linux_tracepoint_report(LinuxDebug * debug)
+{
+#ifdef LINUX_AGENT
+	DebuggerDebugHelper const * helper = debug->helper;
+	AgentBuffer * agent = debug->agent;
+	AgentSlot * slot;
+	AgentTracepoint * a;
+	DebuggerDebugTracepoint * tracepoint;
+	size_t i;
+	size_t j;
+
+	/* from the main loop, unlike the other reports */
+	if(agent == NULL)
+		return;
+	/* at most a buffer at a time, not to hold the interface */
+	for(i = 0; i < AGENT_EVENTS; i++)
+	{
+		slot = &agent->slots[debug->agent_tail & (AGENT_EVENTS - 1)];
+		if(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE)
+				!= debug->agent_tail + 1)
+			break;
+		if(slot->event.tracepoint < debug->tracepoints_cnt)
+		{
+			tracepoint = &debug->tracepoints[
+				slot->event.tracepoint];
+			tracepoint->count++;
+			tracepoint->thread = slot->event.thread;
+			for(j = 0; j < DEBUGGER_DEBUG_ARGUMENTS
+					&& j < AGENT_ARGUMENTS; j++)
+				tracepoint->arguments[j]
+					= slot->event.arguments[j];
+		}
+		/* the process may record into this slot again */
+		__atomic_store_n(&slot->sequence, debug->agent_tail
+				+ AGENT_EVENTS, __ATOMIC_RELEASE);
+		debug->agent_tail++;
+	}
+	for(i = 0; i < debug->tracepoints_cnt; i++)
+	{
+		a = &agent->tracepoints[i];
+		debug->tracepoints[i].status = (a->status < AS_COUNT)
+			? _linux_agent_status[a->status] : DDTS_FAILED;
+		debug->tracepoints[i].dropped = __atomic_load_n(&a->dropped,
+				__ATOMIC_RELAXED);
+	}
+	helper->set_tracepoints(helper->debugger, debug->tracepoints,
+			debug->tracepoints_cnt);
+#else
+	(void) debug;
+#endif
+}
+
+
+/* linux_wait */
+static int _linux_wait(pid_t tid, int * status)
+{
+	pid_t res;
+
+	/* the waiter has to be held meanwhile */
+	while((res = waitpid(tid, status, __WALL)) == -1 && errno == EINTR);
+	return (res == tid) ? 0 : -1;
+}
+
+
+/* linux_watchpoint_add */
+static void _linux_watchpoint_add(LinuxDebug * debug,
+		LinuxWatchpoint * watchpoint)
+{
+#ifdef LINUX_WATCHPOINTS
+	size_t size = watchpoint->size;
+	size_t i;
+#endif
+
+	if(g_hash_table_lookup(debug->watchpoints, &watchpoint->address)
+			!= NULL)
+	{
+		g_free(watchpoint);
+		return;
+	}
+#ifdef LINUX_WATCHPOINTS
+	/* the debug registers only cover aligned 1, 2, 4 or 8 bytes */
+	if((size == 1 || size == 2 || size == 4 || size == 8)
+			&& watchpoint->address % size == 0)
+		for(i = 0; i < LINUX_WATCHPOINTS; i++)
+			if(debug->slots[i] == NULL)
+			{
+				debug->slots[i] = watchpoint;
+				watchpoint->slot = i;
+				debug->generation++;
+				break;
+			}
+#endif
+	g_hash_table_insert(debug->watchpoints, &watchpoint->address,
+			watchpoint);
+	/* set right away, even while running */
+	if(debug->executed && _linux_watchpoint_update(debug, watchpoint, TRUE)
+			!= 0)
+		_linux_error(debug, "%s", error_get(NULL));
+}
+
+
+/* linux_watchpoint_delete */
+static void _linux_watchpoint_delete(LinuxWatchpoint * watchpoint)
+{
+	g_free(watchpoint->prots);
+	g_free(watchpoint);
+}
+
+
+/* linux_watchpoint_fault */
+static LinuxWatchpoint * _linux_watchpoint_fault(LinuxDebug * debug,
+		pid_t tid, gboolean * hit)
+{
+	siginfo_t info;
+	GHashTableIter iter;
+	gpointer value;
+	LinuxWatchpoint * watchpoint = NULL;
+	LinuxWatchpoint * w;
+	uint64_t address;
+	uint64_t start;
+	uint64_t end;
+
+	*hit = FALSE;
+	if(g_hash_table_size(debug->watchpoints) == 0
+			|| ptrace(PTRACE_GETSIGINFO, tid, NULL, &info) != 0
+			|| info.si_code != SEGV_ACCERR)
+		return NULL;
+	address = (uintptr_t)info.si_addr;
+	/* look for the protected pages faulted */
+	g_hash_table_iter_init(&iter, debug->watchpoints);
+	while(*hit == FALSE && g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		w = value;
+		if(w->slot >= 0 || !w->inserted)
+			continue;
+		_linux_watchpoint_pages(w, &start, &end);
+		if(address < start || address >= end)
+			continue;
+		watchpoint = w;
+		*hit = (address >= w->address
+				&& address - w->address < w->size)
+			? TRUE : FALSE;
+	}
+	return watchpoint;
+}
+
+
+/* linux_watchpoint_insert */
+static int _insert_prot(LinuxDebug * debug, LinuxWatchpoint * watchpoint);
+
+static int _linux_watchpoint_insert(LinuxDebug * debug, pid_t tid,
+		LinuxWatchpoint * watchpoint)
+{
+	/* the debug registers are set along with the threads */
+	if(watchpoint->slot >= 0 || watchpoint->inserted)
+		return 0;
+	if(_insert_prot(debug, watchpoint) != 0)
+		return -1;
+	watchpoint->inserted = TRUE;
+	if(_linux_watchpoint_protect(debug, tid, watchpoint, TRUE) != 0)
+	{
+		watchpoint->inserted = FALSE;
+		return -1;
+	}
+	/* unlike the program, the kernel does not fault on these pages */
+	if(!watchpoint->reported)
+		_linux_error(debug, "0x%llx: %s", (unsigned long long)
+				watchpoint->address, _("Watched by protecting"
+					" its pages, where system calls fail"
+					" with EFAULT meanwhile"));
+	watchpoint->reported = TRUE;
+	return 0;
+}
+
+static int _insert_prot(LinuxDebug * debug, LinuxWatchpoint * watchpoint)
+{
+	const uint64_t page = sysconf(_SC_PAGESIZE);
+	uint64_t start;
+	uint64_t end;
+	uint64_t s;
+	uint64_t e;
+	uint64_t address;
+	size_t i;
+	GHashTableIter iter;
+	gpointer value;
+	LinuxWatchpoint * w;
+	char path[32];
+	FILE * fp;
+	char buf[256];
+	unsigned long long ms;
+	unsigned long long me;
+	char perms[5];
+	int prot;
+
+	_linux_watchpoint_pages(watchpoint, &start, &end);
+	g_free(watchpoint->prots);
+	watchpoint->prots = g_new(int, (end - start) / page);
+	for(i = 0; i < (end - start) / page; i++)
+		watchpoint->prots[i] = -1;
+	/* the pages protected already keep their original protection */
+	g_hash_table_iter_init(&iter, debug->watchpoints);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		if((w = value) == watchpoint || w->slot >= 0 || !w->inserted)
+			continue;
+		_linux_watchpoint_pages(w, &s, &e);
+		for(address = MAX(start, s); address < MIN(end, e);
+				address += page)
+			watchpoint->prots[(address - start) / page]
+				= w->prots[(address - s) / page];
+	}
+	/* the others are as mapped, possibly across several mappings */
+	snprintf(path, sizeof(path), "/proc/%d/maps", debug->pid);
+	if((fp = fopen(path, "r")) == NULL)
+		return -error_set_code(-errno, "%s: %s", path,
+				strerror(errno));
+	while(fgets(buf, sizeof(buf), fp) != NULL)
+	{
+		if(sscanf(buf, "%llx-%llx %4s", &ms, &me, perms) != 3
+				|| me <= start || ms >= end)
+			continue;
+		prot = PROT_NONE;
+		if(perms[0] == 'r')
+			prot |= PROT_READ;
+		if(perms[1] == 'w')
+			prot |= PROT_WRITE;
+		if(perms[2] == 'x')
+			prot |= PROT_EXEC;
+		for(address = MAX(start, ms); address < MIN(end, me);
+				address += page)
+			if(watchpoint->prots[(address - start) / page] < 0)
+				watchpoint->prots[(address - start) / page]
+					= prot;
+	}
+	fclose(fp);
+	for(i = 0; i < (end - start) / page; i++)
+		if(watchpoint->prots[i] < 0)
+			return -error_set_code(1, "%s", _("Invalid address"));
+	return 0;
+}
+
+
+/* linux_watchpoint_pages */
+static void _linux_watchpoint_pages(LinuxWatchpoint * watchpoint,
+		uint64_t * start, uint64_t * end)
+{
+	uint64_t page = sysconf(_SC_PAGESIZE);
+
+	*start = watchpoint->address - (watchpoint->address % page);
+	*end = watchpoint->address + watchpoint->size + page - 1;
+	*end -= *end % page;
+}
+
+
+/* linux_watchpoint_protect */
+static int _protect_page(LinuxDebug * debug, LinuxWatchpoint * watchpoint,
+		gboolean watched, uint64_t address);
+
+static int _linux_watchpoint_protect(LinuxDebug * debug, pid_t tid,
+		LinuxWatchpoint * watchpoint, gboolean watched)
+{
+	const uint64_t page = sysconf(_SC_PAGESIZE);
+	uint64_t start;
+	uint64_t end;
+	uint64_t address;
+	uint64_t next;
+	int prot;
+
+	/* the pages alike are protected at once */
+	_linux_watchpoint_pages(watchpoint, &start, &end);
+	for(address = start; address < end; address = next)
+	{
+		prot = _protect_page(debug, watchpoint, watched, address);
+		for(next = address + page; next < end && _protect_page(debug,
+					watchpoint, watched, next) == prot;
+				next += page);
+		if(_linux_mprotect(debug, tid, address, next - address, prot)
+				!= 0)
+			return -1;
+	}
+	return 0;
+}
+
+static int _protect_page(LinuxDebug * debug, LinuxWatchpoint * watchpoint,
+		gboolean watched, uint64_t address)
+{
+	const uint64_t page = sysconf(_SC_PAGESIZE);
+	GHashTableIter iter;
+	gpointer value;
+	LinuxWatchpoint * w;
+	uint64_t start;
+	uint64_t end;
+	int prot;
+
+	_linux_watchpoint_pages(watchpoint, &start, &end);
+	prot = watchpoint->prots[(address - start) / page];
+	if(!watched)
+		return prot;
+	/* combine every watchpoint on this page */
+	g_hash_table_iter_init(&iter, debug->watchpoints);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		w = value;
+		if(w->slot >= 0 || !w->inserted)
+			continue;
+		_linux_watchpoint_pages(w, &start, &end);
+		if(address < start || address >= end)
+			continue;
+		if(w->watch == DDW_WRITE)
+			prot &= ~PROT_WRITE;
+		else
+			prot = PROT_NONE;
+	}
+	return prot;
+}
+
+
+/* linux_watchpoint_remove */
+static void _linux_watchpoint_remove(LinuxDebug * debug, uint64_t address)
+{
+	LinuxWatchpoint * watchpoint;
+
+	if((watchpoint = g_hash_table_lookup(debug->watchpoints, &address))
+			== NULL)
+		return;
+#ifdef LINUX_WATCHPOINTS
+	if(watchpoint->slot >= 0)
+	{
+		debug->slots[watchpoint->slot] = NULL;
+		debug->generation++;
+	}
+#endif
+	if(debug->executed && (watchpoint->slot >= 0 || watchpoint->inserted)
+			&& _linux_watchpoint_update(debug, watchpoint, FALSE)
+			!= 0)
+		_linux_error(debug, "%s", error_get(NULL));
+	g_hash_table_remove(debug->watchpoints, &address);
+}
+
+
+/* linux_watchpoint_restore */
+static int _linux_watchpoint_restore(LinuxDebug * debug, pid_t tid,
+		LinuxWatchpoint * watchpoint)
+{
+	if(!watchpoint->inserted)
+		return 0;
+	watchpoint->inserted = FALSE;
+	if(_linux_watchpoint_protect(debug, tid, watchpoint, TRUE) != 0)
+	{
+		watchpoint->inserted = TRUE;
+		return -1;
+	}
+	return 0;
+}
+
+
+/* linux_watchpoint_step */
+static int _linux_watchpoint_step(LinuxDebug * debug, pid_t tid,
+		LinuxWatchpoint * watchpoint)
+{
+	int ret = -1;
+
+	/* let the access through once, while the others are held */
+	_linux_hold(debug);
+	_linux_threads_stop(debug, tid);
+	if(_linux_watchpoint_protect(debug, tid, watchpoint, FALSE) != 0)
+		_linux_error(debug, "%s", error_get(NULL));
+	else if((ret = _linux_singlestep(debug, tid, 0)) != 0)
+		/* protected again when resuming */
+		watchpoint->inserted = FALSE;
+	else if(_linux_watchpoint_protect(debug, tid, watchpoint, TRUE) != 0)
+		ret = -_linux_error(debug, "%s", error_get(NULL));
+	_linux_threads_continue(debug);
+	_linux_release(debug);
+	return ret;
+}
+
+
+/* linux_watchpoint_trap */
+static LinuxWatchpoint * _linux_watchpoint_trap(LinuxDebug * debug,
+		pid_t tid)
+{
+#ifdef LINUX_WATCHPOINTS
+	unsigned long dr6;
+	size_t i;
+
+	for(i = 0; i < LINUX_WATCHPOINTS; i++)
+		if(debug->slots[i] != NULL)
+			break;
+	/* never programmed otherwise */
+	if(i == LINUX_WATCHPOINTS)
+		return NULL;
+	errno = 0;
+	dr6 = ptrace(PTRACE_PEEKUSER, tid, LINUX_DR(6), NULL);
+	if(errno != 0 || (dr6 & ((1 << LINUX_WATCHPOINTS) - 1)) == 0)
+		return NULL;
+	/* the status is never cleared by the processor */
+	ptrace(PTRACE_POKEUSER, tid, LINUX_DR(6), 0);
+	for(i = 0; i < LINUX_WATCHPOINTS; i++)
+		if((dr6 & (1UL << i)) != 0 && debug->slots[i] != NULL)
+			return debug->slots[i];
+	return NULL;
+#else
+	(void) debug;
+	(void) tid;
+
+	return NULL;
+#endif
+}
+
+
+/* linux_watchpoint_update */
+static int _linux_watchpoint_update(LinuxDebug * debug,
+		LinuxWatchpoint * watchpoint, gboolean insert)
+{
+	pid_t tid = debug->tid;
+	int ret = 0;
+
+	/* the threads running are held, and set again as they resume */
+	if(debug->running)
+	{
+		_linux_hold(debug);
+		tid = _linux_threads_stop(debug,
+				(debug->request == PTRACE_SINGLESTEP)
+				? debug->tid : -1);
+	}
+	if(watchpoint->slot >= 0)
+		ret = 0;
+	else if(tid <= 0)
+		ret = -error_set_code(1, "%s", strerror(EBUSY));
+	else if(insert)
+		ret = _linux_watchpoint_insert(debug, tid, watchpoint);
+	else
+		ret = _linux_watchpoint_restore(debug, tid, watchpoint);
+	if(debug->running)
+	{
+		_linux_threads_continue(debug);
+		_linux_release(debug);
+	}
+	return ret;
+}
+
+
+/* linux_watchpoints_insert */
+static void _linux_watchpoints_insert(LinuxDebug * debug)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	if(!debug->executed)
+		return;
+	/* the others are retried on every resume, as memory gets mapped */
+	g_hash_table_iter_init(&iter, debug->watchpoints);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+		_linux_watchpoint_insert(debug, debug->tid, value);
+}
+
+
+/* linux_watchpoints_reset */
+static void _linux_watchpoints_reset(LinuxDebug * debug)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	/* the memory was replaced altogether, so were the debug registers */
+	g_hash_table_iter_init(&iter, debug->watchpoints);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+		((LinuxWatchpoint *)value)->inserted = FALSE;
+	debug->generation++;
+}
+
+
+/* linux_watchpoints_set */
+static void _linux_watchpoints_set(LinuxDebug * debug, LinuxThread * thread)
+{
+#ifdef LINUX_WATCHPOINTS
+	LinuxWatchpoint * watchpoint;
+	unsigned long dr7 = 0;
+	unsigned long rw;
+	unsigned long len;
+	size_t i;
+
+	/* not in the other processes */
+	if(thread->process != debug->pid
+			|| thread->generation == debug->generation)
+		return;
+	/* disabled while the addresses change */
+	if(ptrace(PTRACE_POKEUSER, thread->tid, LINUX_DR(7), 0) != 0)
+		return;
+	for(i = 0; i < LINUX_WATCHPOINTS; i++)
+	{
+		if((watchpoint = debug->slots[i]) == NULL
+				|| ptrace(PTRACE_POKEUSER, thread->tid,
+					LINUX_DR(i), watchpoint->address) != 0)
+			continue;
+		/* locally enabled */
+		dr7 |= 1UL << (i * 2);
+		rw = (watchpoint->watch == DDW_WRITE) ? 0x1 : 0x3;
+		switch(watchpoint->size)
+		{
+			case 1:	len = 0x0; break;
+			case 2:	len = 0x1; break;
+			case 8:	len = 0x2; break;
+			default:len = 0x3; break;
+		}
+		dr7 |= (rw | (len << 2)) << (16 + i * 4);
+	}
+	if(dr7 == 0 || ptrace(PTRACE_POKEUSER, thread->tid, LINUX_DR(7), dr7)
+			== 0)
+		thread->generation = debug->generation;
+#else
+	(void) debug;
+	(void) thread;
+#endif
+}
+
+
+/* stack */
+/* linux_stack_equal */
+static gboolean _linux_stack_equal(gconstpointer a, gconstpointer b)
+{
+	LinuxStack const * sa = a;
+	LinuxStack const * sb = b;
+
+	return (sa->cnt == sb->cnt && memcmp(sa->addresses, sb->addresses,
+				sizeof(*sa->addresses) * sa->cnt) == 0)
+		? TRUE : FALSE;
+}
+
+
+/* linux_stack_hash */
+static guint _linux_stack_hash(gconstpointer key)
+{
+	LinuxStack const * stack = key;
+	guint hash = 2166136261u;
+	size_t i;
+
+	for(i = 0; i < stack->cnt; i++)
+		hash = (hash ^ (guint)(stack->addresses[i]
+					^ (stack->addresses[i] >> 32)))
+			* 16777619u;
+	return hash;
+}
+
+
+/* message */
+/* linux_message_new */
+static LinuxMessage * _linux_message_new(LinuxMessageType type)
+{
+	LinuxMessage * message;
+
+	if((message = g_new0(LinuxMessage, 1)) == NULL)
+		return NULL;
+	message->type = type;
+	return message;
+}
+
+
+/* linux_message_delete */
+static void _linux_message_delete(LinuxMessage * message)
+{
+	switch(message->type)
+	{
+		case LMT_START:
+			g_free(message->u.filename);
+			break;
+		case LMT_RECORD:
+			g_free(message->u.record.filename);
+			break;
+		case LMT_ADD_BREAKPOINT:
+			/* unless handled by the tracer */
+			if(message->u.breakpoint != NULL)
+				_linux_breakpoint_delete(
+						message->u.breakpoint);
+			break;
+		case LMT_ADD_WATCHPOINT:
+			if(message->u.watchpoint != NULL)
+				_linux_watchpoint_delete(
+						message->u.watchpoint);
+			break;
+		case LMT_ERROR:
+			g_free(message->u.error);
+			break;
+		case LMT_REGISTERS:
+			g_free(message->u.registers.values);
+			break;
+		case LMT_SAMPLES:
+			g_free(message->u.samples.values);
+			g_free(message->u.samples.callers);
+			break;
+		case LMT_BREAKPOINTS:
+			g_free(message->u.breakpoints.values);
+			break;
+		case LMT_SYSCALLS:
+			g_free(message->u.syscalls.values);
+			break;
+		default:
+			break;
+	}
+	g_free(message);
+}
+
+
+/* queue */
+/* linux_queue_init */
+static int _linux_queue_init(LinuxQueue * queue, int flags)
+{
+	queue->head = NULL;
+	if((queue->fd = eventfd(0, EFD_CLOEXEC | flags)) < 0)
+	{
+		error_set_code(-errno, "%s: %s", "eventfd", strerror(errno));
+		return -1;
+	}
+	return 0;
+}
+
+
+/* linux_queue_destroy */
+static void _linux_queue_destroy(LinuxQueue * queue)
+{
+	LinuxMessage * message;
+	LinuxMessage * next;
+
+	for(message = queue->head; message != NULL; message = next)
+	{
+		next = message->next;
+		_linux_message_delete(message);
+	}
+	queue->head = NULL;
+	if(queue->fd >= 0)
+		close(queue->fd);
+	queue->fd = -1;
+}
+
+
+/* linux_queue_pop */
+static LinuxMessage * _linux_queue_pop(LinuxQueue * queue)
+{
+	eventfd_t value;
+	LinuxMessage * head;
+	LinuxMessage * message;
+	LinuxMessage * next;
+
+	/* blocks unless the eventfd is non-blocking */
+	eventfd_read(queue->fd, &value);
+	/* take every message at once */
+	do
+		head = g_atomic_pointer_get(&queue->head);
+	while(head != NULL && !g_atomic_pointer_compare_and_exchange(
+				&queue->head, head, NULL));
+	/* in the order they were pushed */
+	for(message = NULL; head != NULL; head = next)
+	{
+		next = head->next;
+		head->next = message;
+		message = head;
+	}
+	return message;
+}
+
+
+/* linux_queue_push */
+static void _linux_queue_push(LinuxQueue * queue, LinuxMessage * message)
+{
+	LinuxMessage * head;
+
+	do
+	{
+		head = g_atomic_pointer_get(&queue->head);
+		message->next = head;
+	}
+	while(!g_atomic_pointer_compare_and_exchange(&queue->head, head,
+				message));
+	eventfd_write(queue->fd, 1);
+}
+
+
+/* callbacks */
+#ifdef LINUX_AGENT
+/* linux_on_agent */
+static gboolean _linux_on_agent(gpointer data)
+{
+	LinuxDebug * debug = data;
+
+	/* until the process exits */
+	_linux_tracepoint_report(debug);
+	return TRUE;
+}
+#endif
+
+
+/* linux_on_message */
+static gboolean _linux_on_message(GIOChannel * source, GIOCondition condition,
+		gpointer data)
+{
+	LinuxDebug * debug = data;
+	DebuggerDebugHelper const * helper = debug->helper;
+	LinuxMessage * message;
+	LinuxMessage * next;
+	(void) source;
+	(void) condition;
+
+	for(message = _linux_queue_pop(&debug->messages); message != NULL;
+			message = next)
+	{
+		next = message->next;
+		switch(message->type)
+		{
+			case LMT_ERROR:
+				helper->error(helper->debugger, 1, "%s",
+						message->u.error);
+				break;
+			case LMT_BIAS:
+#ifdef LINUX_AGENT
+				debug->relocating = TRUE;
+#endif
+				helper->set_bias(helper->debugger,
+						message->u.address);
+#ifdef LINUX_AGENT
+				debug->relocating = FALSE;
+#endif
+				break;
+			case LMT_CHECKPOINTED:
+				helper->set_checkpoint(helper->debugger,
+						message->u.checkpoint.id,
+						(message->u.checkpoint.pid > 0)
+						? 0 : -1);
+				break;
+			case LMT_REGISTERS:
+				helper->set_registers(helper->debugger,
+						message->u.registers.values,
+						message->u.registers.cnt);
+				/* the events recorded up to this stop */
+				_linux_tracepoint_report(debug);
+				break;
+			case LMT_SAMPLES:
+				helper->set_profile(helper->debugger,
+						message->u.samples.values,
+						message->u.samples.cnt,
+						message->u.samples.duration);
+				break;
+			case LMT_BREAKPOINTS:
+				helper->set_breakpoints(helper->debugger,
+						message->u.breakpoints.values,
+						message->u.breakpoints.cnt);
+				break;
+			case LMT_SYSCALLS:
+				helper->set_syscalls(helper->debugger,
+						message->u.syscalls.values,
+						message->u.syscalls.cnt);
+				break;
+			case LMT_EXIT:
+				if(debug->tracer != NULL)
+					g_thread_join(debug->tracer);
+				debug->tracer = NULL;
+				/* along with the events left */
+				_linux_tracepoint_report(debug);
+#ifdef LINUX_AGENT
+				_linux_agent_close(debug);
+#endif
+				break;
+			default:
+				break;
+		}
+		_linux_message_delete(message);
+	}
+	return TRUE;
+}
+
+
+/* linux_on_sample */
+static gpointer _linux_on_sample(gpointer data)
+{
+	LinuxDebug * debug = data;
+	gint period;
+	gint64 deadline = g_get_monotonic_time();
+	gint64 now;
+	LinuxMessage * message;
+
+	/* the tracer interrupts the process at every period */
+	while((period = g_atomic_int_get(&debug->period)) > 0)
+	{
+		/* regardless of the time taken to sample */
+		deadline += period;
+		if((now = g_get_monotonic_time()) < deadline)
+			g_usleep(deadline - now);
+		else
+			deadline = now;
+		if((message = _linux_message_new(LMT_SAMPLE)) != NULL)
+			_linux_queue_push(&debug->commands, message);
+	}
+	return NULL;
+}
+
+
+/* linux_on_trace */
+static gboolean _trace_message(LinuxDebug * debug, LinuxMessage * message);
+static int _trace_start(LinuxDebug * debug, char const * filename);
+#ifdef LINUX_AGENT
+static gchar ** _trace_start_agent(LinuxDebug * debug);
+#endif
+static int _trace_start_seccomp(LinuxDebug * debug);
+#ifdef LINUX_CHECKPOINTS
+static void _trace_checkpoint(LinuxDebug * debug, int checkpoint);
+static int _trace_discard(LinuxDebug * debug, int checkpoint);
+#endif
+static void _trace_exited(LinuxDebug * debug, pid_t tid, int status);
+static void _trace_pause(LinuxDebug * debug);
+static int _trace_profile(LinuxDebug * debug, unsigned int frequency);
+static void _trace_profile_count(LinuxDebug * debug, LinuxStack const * stack);
+static void _trace_profile_stop(LinuxDebug * debug);
+static int _trace_record(LinuxDebug * debug, char const * filename,
+		int registers);
+static int _trace_record_step(LinuxDebug * debug, pid_t tid, int e, int sig);
+static void _trace_record_wait(LinuxDebug * debug);
+static void _trace_requests(LinuxDebug * debug);
+#ifdef LINUX_CHECKPOINTS
+static int _trace_restore(LinuxDebug * debug, int checkpoint);
+#endif
+static void _trace_sample(LinuxDebug * debug, pid_t tid);
+static void _trace_sample_interrupt(LinuxDebug * debug);
+static void _trace_stopped(LinuxDebug * debug, pid_t tid, int status);
+static int _trace_stopped_breakpoint(LinuxDebug * debug, LinuxThread * thread,
+		LinuxBreakpoint * breakpoint);
+static int _trace_stopped_syscall(LinuxDebug * debug, LinuxThread * thread);
+static void _trace_stopped_task(LinuxDebug * debug, LinuxThread * thread,
+		int e);
+static int _trace_stopped_watchpoint(LinuxDebug * debug, LinuxThread * thread,
+		LinuxWatchpoint * watchpoint, gboolean hit);
+static void _trace_stopped_report(LinuxDebug * debug, pid_t tid);
+
+static gpointer _linux_on_trace(gpointer data)
+{
+	LinuxDebug * debug = data;
+	LinuxMessage * message;
+	LinuxMessage * next;
+	gboolean done = FALSE;
+
+	while(done == FALSE)
+	{
+		if(debug->writer != NULL)
+			_trace_record_wait(debug);
+		for(message = _linux_queue_pop(&debug->commands);
+				message != NULL; message = next)
+		{
+			next = message->next;
+			if(done == FALSE)
+				done = _trace_message(debug, message);
+			_linux_message_delete(message);
+		}
+	}
+	if(debug->waiter != NULL)
+		g_thread_join(debug->waiter);
+	debug->waiter = NULL;
+	_trace_profile_stop(debug);
+	_linux_breakpoint_report(debug);
+	_linux_syscall_report(debug);
+	/* inserted again on the next run */
+	_linux_breakpoints_reset(debug);
+	_linux_watchpoints_reset(debug);
+	debug->executed = FALSE;
+	/* no request is queued from now on */
+	g_mutex_lock(&debug->lock);
+	g_atomic_int_set(&debug->pid, -1);
+	g_mutex_unlock(&debug->lock);
+	_trace_requests(debug);
+	debug->running = FALSE;
+	debug->pausing = FALSE;
+	debug->tid = -1;
+	debug->signal = 0;
+	debug->request = PTRACE_CONT;
+	g_hash_table_remove_all(debug->threads);
+	g_hash_table_remove_all(debug->unknown);
+	debug->exited = FALSE;
+	_linux_post(debug, _linux_message_new(LMT_EXIT));
+	return NULL;
+}
+
+static gboolean _trace_message(LinuxDebug * debug, LinuxMessage * message)
+{
+	switch(message->type)
+	{
+		case LMT_START:
+			return (_trace_start(debug, message->u.filename) != 0)
+				? TRUE : FALSE;
+		case LMT_PAUSE:
+			_trace_pause(debug);
+			break;
+		case LMT_RESUME:
+			_linux_resume(debug, message->u.request);
+			break;
+		case LMT_RECORD:
+			_trace_record(debug, message->u.record.filename,
+					message->u.record.registers);
+			break;
+		case LMT_PROFILE:
+			_trace_profile(debug, message->u.frequency);
+			break;
+		case LMT_SAMPLE:
+			_trace_sample_interrupt(debug);
+			break;
+		case LMT_KILL:
+			if(debug->pid <= 0)
+				return TRUE;
+			kill(debug->pid, SIGKILL);
+			break;
+		case LMT_ADD_BREAKPOINT:
+			_linux_breakpoint_add(debug, message->u.breakpoint);
+			message->u.breakpoint = NULL;
+			break;
+		case LMT_REMOVE_BREAKPOINT:
+			_linux_breakpoint_remove(debug, message->u.address);
+			break;
+		case LMT_ADD_WATCHPOINT:
+			_linux_watchpoint_add(debug, message->u.watchpoint);
+			message->u.watchpoint = NULL;
+			break;
+		case LMT_REMOVE_WATCHPOINT:
+			_linux_watchpoint_remove(debug, message->u.address);
+			break;
+#ifdef LINUX_CHECKPOINTS
+		case LMT_CHECKPOINT:
+			_trace_checkpoint(debug, message->u.checkpoint.id);
+			break;
+		case LMT_RESTORE:
+			_trace_restore(debug, message->u.checkpoint.id);
+			break;
+		case LMT_DISCARD:
+			_trace_discard(debug, message->u.checkpoint.id);
+			break;
+#endif
+		case LMT_WAIT:
+			if(message->u.wait.tid < 0)
+				/* every thread was collected */
+				return TRUE;
+			if(WIFSTOPPED(message->u.wait.status))
+				_trace_stopped(debug, message->u.wait.tid,
+						message->u.wait.status);
+			else
+				_trace_exited(debug, message->u.wait.tid,
+						message->u.wait.status);
+			break;
+		default:
+			break;
+	}
+	return FALSE;
+}
+
+static int _trace_start(LinuxDebug * debug, char const * filename)
+{
+	char * argv[2] = { NULL, NULL };
+	gchar ** envp = NULL;
+	pid_t pid;
+	int status;
+	int options = LINUX_OPTIONS;
+
+	argv[0] = (char *)filename;
+#ifdef LINUX_AGENT
+	/* prepared here, as the child must not allocate memory */
+	if(debug->agent != NULL)
+		envp = _trace_start_agent(debug);
+#endif
+	if((pid = fork()) == -1)
+	{
+		g_strfreev(envp);
+		return -_linux_error(debug, "%s: %s", "fork", strerror(errno));
+	}
+	else if(pid == 0)
+	{
+		/* wait to be traced in a process group of our own */
+		setpgid(0, 0);
+		raise(SIGSTOP);
+		if(debug->syscalls_cnt > 0 && _trace_start_seccomp(debug) != 0)
+			_exit(125);
+		if(envp != NULL)
+			execve(argv[0], argv, envp);
+		else
+			execv(argv[0], argv);
+		_exit(125);
+	}
+	g_strfreev(envp);
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s() %d\n", __func__, pid);
+#endif
+	setpgid(pid, pid);
+	/* only woken up by the filter for the system calls traced */
+	if(debug->syscalls_cnt > 0)
+		options |= PTRACE_O_TRACESECCOMP;
+	if(waitpid(pid, &status, WUNTRACED) != pid || !WIFSTOPPED(status)
+			|| ptrace(PTRACE_SEIZE, pid, NULL, options) != 0)
+	{
+		_linux_error(debug, "%s: %s", _("Could not start execution"),
+				strerror(errno));
+		kill(pid, SIGKILL);
+		waitpid(pid, NULL, 0);
+		return -1;
+	}
+	g_atomic_int_set(&debug->pid, pid);
+	debug->tid = pid;
+	_linux_thread(debug, pid);
+	/* stops are reported from now on */
+	debug->request = PTRACE_CONT;
+	debug->running = TRUE;
+	debug->waiter = g_thread_new("linux-wait", _linux_on_wait, debug);
+	kill(pid, SIGCONT);
+	return 0;
+}
+
+#ifdef LINUX_AGENT
+static gchar ** _trace_start_agent(LinuxDebug * debug)
+{
+	gchar ** envp;
+	gchar const * preload;
+	gchar * p;
+
+	/* the agent is loaded first, along with any other library */
+	envp = g_get_environ();
+	if((preload = g_environ_getenv(envp, "LD_PRELOAD")) != NULL
+			&& preload[0] != '\0')
+		p = g_strdup_printf("%s:%s", LINUX_AGENT, preload);
+	else
+		p = g_strdup(LINUX_AGENT);
+	envp = g_environ_setenv(envp, "LD_PRELOAD", p, TRUE);
+	g_free(p);
+	return g_environ_setenv(envp, AGENT_ENVIRONMENT, debug->agent_name,
+			TRUE);
+}
+#endif
+
+static int _trace_start_seccomp(LinuxDebug * debug)
+{
+#ifdef LINUX_SECCOMP
+	struct sock_filter filter[LINUX_SYSCALLS_MAX + 5];
+	struct sock_fprog program;
+	size_t cnt = 0;
+	size_t i;
+
+	/* the other architectures are not traced */
+	filter[cnt++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS,
+			offsetof(struct seccomp_data, arch));
+	filter[cnt++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K,
+			LINUX_SECCOMP, 0, debug->syscalls_cnt + 1);
+	filter[cnt++] = (struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS,
+			offsetof(struct seccomp_data, nr));
+	for(i = 0; i < debug->syscalls_cnt; i++)
+		filter[cnt++] = (struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ
+				| BPF_K, debug->syscalls[i].number,
+				debug->syscalls_cnt - i, 0);
+	/* the kernel only wakes the tracer up for the calls selected */
+	filter[cnt++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K,
+			SECCOMP_RET_ALLOW);
+	filter[cnt++] = (struct sock_filter)BPF_STMT(BPF_RET | BPF_K,
+			SECCOMP_RET_TRACE);
+	program.len = cnt;
+	program.filter = filter;
+	/* in the child, already traced: required without privileges */
+	if(prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) != 0
+			|| prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &program)
+			!= 0)
+		return -1;
+	return 0;
+#else
+	(void) debug;
+
+	return -1;
+#endif
+}
+
+#ifdef LINUX_CHECKPOINTS
+static void _trace_checkpoint(LinuxDebug * debug, int checkpoint)
+{
+	LinuxMessage * message;
+	pid_t pid = -1;
+
+	if(debug->pid <= 0)
+		_linux_error(debug, "%s", _("No process is being traced"));
+	else if(debug->running)
+		_linux_error(debug, "%s",
+				_("The process has to be stopped first"));
+	/* a copy of the thread stopped, never resumed itself */
+	else if((pid = _linux_fork(debug, debug->tid)) < 0)
+		_linux_error(debug, "%s", error_get(NULL));
+	else
+		g_hash_table_insert(debug->checkpoints,
+				GINT_TO_POINTER(checkpoint),
+				GINT_TO_POINTER(pid));
+	/* replied either way */
+	if((message = _linux_message_new(LMT_CHECKPOINTED)) == NULL)
+		return;
+	message->u.checkpoint.id = checkpoint;
+	message->u.checkpoint.pid = pid;
+	_linux_post(debug, message);
+}
+
+static int _trace_discard(LinuxDebug * debug, int checkpoint)
+{
+	pid_t pid;
+
+	if((pid = GPOINTER_TO_INT(g_hash_table_lookup(debug->checkpoints,
+						GINT_TO_POINTER(checkpoint))))
+			<= 0)
+		return -_linux_error(debug, "%s", strerror(EINVAL));
+	g_hash_table_remove(debug->checkpoints, GINT_TO_POINTER(checkpoint));
+	_linux_hold(debug);
+	kill(pid, SIGKILL);
+	_linux_reap(pid);
+	_linux_release(debug);
+	return 0;
+}
+#endif
+
+static void _trace_exited(LinuxDebug * debug, pid_t tid, int status)
+{
+	GHashTableIter iter;
+	gpointer value;
+	LinuxThread * thread;
+
+	g_hash_table_remove(debug->threads, GINT_TO_POINTER(tid));
+	g_hash_table_remove(debug->unknown, GINT_TO_POINTER(tid));
+	if(tid == debug->pid || (tid == debug->tid && debug->writer != NULL))
+		/* nothing left to record */
+		_trace_profile_stop(debug);
+	if(tid != debug->pid)
+		return;
+	debug->running = FALSE;
+	/* along with the checkpoints */
+	_linux_checkpoints_kill(debug);
+	/* the processes forked keep running untraced, once stopped */
+	debug->exited = TRUE;
+	g_hash_table_iter_init(&iter, debug->threads);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+		if((thread = value)->stopped)
+		{
+			if(ptrace(PTRACE_DETACH, thread->tid, NULL, 0) == 0)
+				g_hash_table_iter_remove(&iter);
+		}
+		else if(ptrace(PTRACE_INTERRUPT, thread->tid, NULL, 0) == 0)
+			thread->interrupted = TRUE;
+	if(WIFEXITED(status) && WEXITSTATUS(status) != 0)
+		_linux_error(debug, "%s%d", _("Process exited with status "),
+				WEXITSTATUS(status));
+}
+
+static void _trace_pause(LinuxDebug * debug)
+{
+	if(debug->pid <= 0 || !debug->running || debug->pausing)
+		return;
+	/* the stop is reported as an event */
+	if(ptrace(PTRACE_INTERRUPT, debug->tid, NULL, 0) != 0)
+		_linux_error(debug, "%s: %s", "ptrace", strerror(errno));
+	else
+		debug->pausing = TRUE;
+}
+
+static int _trace_profile(LinuxDebug * debug, unsigned int frequency)
+{
+#if defined(__x86_64__)
+	if(debug->pid <= 0)
+		return -_linux_error(debug, "%s",
+				_("No process is being traced"));
+	if(debug->running || debug->samples != NULL)
+		return -_linux_error(debug, "%s", strerror(EBUSY));
+	debug->samples = g_hash_table_new_full(_linux_stack_hash,
+			_linux_stack_equal, g_free, NULL);
+	debug->since = g_get_monotonic_time();
+	if(_linux_resume(debug, PTRACE_CONT) != 0)
+	{
+		_trace_profile_stop(debug);
+		return -1;
+	}
+	/* the process runs at full speed between the samples */
+	g_atomic_int_set(&debug->period, 1000000 / frequency);
+	debug->sampler = g_thread_new("linux-sample", _linux_on_sample, debug);
+	return 0;
+#else
+	(void) frequency;
+
+	return -_linux_error(debug, "%s", _("Not implemented"));
+#endif
+}
+
+static void _trace_profile_count(LinuxDebug * debug, LinuxStack const * stack)
+{
+	LinuxStack * p;
+	const size_t size = offsetof(LinuxStack, addresses)
+		+ sizeof(*stack->addresses) * stack->cnt;
+
+	if((p = g_hash_table_lookup(debug->samples, stack)) != NULL)
+		p->count++;
+	else if((p = g_malloc(size)) != NULL)
+	{
+		memcpy(p, stack, size);
+		p->count = 1;
+		g_hash_table_add(debug->samples, p);
+	}
+}
+
+static void _trace_profile_stop(LinuxDebug * debug)
+{
+	LinuxMessage * message;
+	GHashTableIter iter;
+	gpointer key;
+	LinuxStack * stack;
+	DebuggerDebugSample * sample;
+	uint64_t * callers;
+	size_t cnt = 0;
+
+	if(debug->sampler != NULL)
+	{
+		g_atomic_int_set(&debug->period, 0);
+		g_thread_join(debug->sampler);
+		debug->sampler = NULL;
+	}
+	if(debug->writer != NULL)
+	{
+		if(trace_writer_delete(debug->writer) != 0)
+			_linux_error(debug, "%s", error_get(NULL));
+		debug->writer = NULL;
+	}
+	if(debug->samples == NULL)
+		return;
+	g_hash_table_iter_init(&iter, debug->samples);
+	while(g_hash_table_iter_next(&iter, &key, NULL))
+		cnt += ((LinuxStack *)key)->cnt - 1;
+	/* the callers of every sample are reported at once */
+	if((message = _linux_message_new(LMT_SAMPLES)) != NULL)
+	{
+		message->u.samples.cnt = g_hash_table_size(debug->samples);
+		message->u.samples.values = g_new(DebuggerDebugSample,
+				message->u.samples.cnt);
+		message->u.samples.callers = g_new(uint64_t, cnt);
+		message->u.samples.duration = g_get_monotonic_time()
+			- debug->since;
+		sample = message->u.samples.values;
+		callers = message->u.samples.callers;
+		g_hash_table_iter_init(&iter, debug->samples);
+		for(; g_hash_table_iter_next(&iter, &key, NULL); sample++)
+		{
+			stack = key;
+			sample->address = stack->addresses[0];
+			sample->count = stack->count;
+			sample->callers = callers;
+			sample->callers_cnt = stack->cnt - 1;
+			memcpy(callers, &stack->addresses[1],
+					sizeof(*callers) * sample->callers_cnt);
+			callers += sample->callers_cnt;
+		}
+		_linux_post(debug, message);
+	}
+	g_hash_table_destroy(debug->samples);
+	debug->samples = NULL;
+}
+
+static int _trace_record(LinuxDebug * debug, char const * filename,
+		int registers)
+{
+#if defined(__x86_64__)
+	const size_t cnt = sizeof(_linux_registers)
+		/ sizeof(*_linux_registers);
+
+	if(debug->pid <= 0)
+		return -_linux_error(debug, "%s",
+				_("No process is being traced"));
+	if(debug->running || debug->samples != NULL)
+		return -_linux_error(debug, "%s", strerror(EBUSY));
+	if((debug->writer = trace_writer_new(filename, registers ? cnt : 0))
+			== NULL)
+		return -_linux_error(debug, "%s", error_get(NULL));
+	debug->registers = registers ? TRUE : FALSE;
+	debug->samples = g_hash_table_new_full(_linux_stack_hash,
+			_linux_stack_equal, g_free, NULL);
+	debug->since = g_get_monotonic_time();
+	/* every step is then handled without reporting */
+	if(_linux_resume(debug, PTRACE_SINGLESTEP) != 0)
+	{
+		_trace_profile_stop(debug);
+		return -1;
+	}
+	return 0;
+#else
+	(void) filename;
+	(void) registers;
+
+	return -_linux_error(debug, "%s", _("Not implemented"));
+#endif
+}
+
+static int _trace_record_step(LinuxDebug * debug, pid_t tid, int e, int sig)
+{
+#if defined(__x86_64__)
+	const size_t cnt = sizeof(_linux_registers)
+		/ sizeof(*_linux_registers);
+	struct user_regs_struct regs;
+	struct iovec iov;
+	uint64_t values[sizeof(_linux_registers) / sizeof(*_linux_registers)];
+	LinuxStack stack;
+	size_t i;
+
+	if(debug->pausing)
+	{
+		_trace_profile_stop(debug);
+		return -1;
+	}
+	/* the other threads keep running, with the signals they got */
+	if(tid != debug->tid)
+	{
+		if(e != 0 || sig == SIGTRAP || sig == (SIGTRAP | 0x80))
+			sig = 0;
+		_linux_watchpoints_set(debug, _linux_thread(debug, tid));
+		if(ptrace(PTRACE_CONT, tid, NULL, sig) != 0)
+		{
+			_trace_profile_stop(debug);
+			return -_linux_error(debug, "%s: %s", "ptrace",
+					strerror(errno));
+		}
+		return 0;
+	}
+	/* anything but a step of the thread recorded ends the recording */
+	if(e != 0 || sig != SIGTRAP)
+	{
+		_trace_profile_stop(debug);
+		return -1;
+	}
+	stack.cnt = 1;
+	if(debug->registers)
+	{
+		iov.iov_base = &regs;
+		iov.iov_len = sizeof(regs);
+		if(ptrace(PTRACE_GETREGSET, tid, (void *)NT_PRSTATUS, &iov)
+				!= 0)
+		{
+			_trace_profile_stop(debug);
+			return -_linux_error(debug, "%s: %s", "ptrace",
+					strerror(errno));
+		}
+		for(i = 0; i < cnt; i++)
+			values[i] = *(unsigned long long *)((char *)&regs
+					+ _linux_registers[i].offset);
+		stack.addresses[0] = regs.rip;
+	}
+	else
+	{
+		/* only the program counter */
+		errno = 0;
+		stack.addresses[0] = ptrace(PTRACE_PEEKUSER, tid,
+				offsetof(struct user, regs.rip), NULL);
+		if(errno != 0)
+		{
+			_trace_profile_stop(debug);
+			return -_linux_error(debug, "%s: %s", "ptrace",
+					strerror(errno));
+		}
+	}
+	if(trace_writer_append(debug->writer, stack.addresses[0],
+				debug->registers ? values : NULL) != 0)
+	{
+		_linux_error(debug, "%s", error_get(NULL));
+		_trace_profile_stop(debug);
+		return -1;
+	}
+	_trace_profile_count(debug, &stack);
+	_linux_watchpoints_set(debug, _linux_thread(debug, tid));
+	if(ptrace(PTRACE_SINGLESTEP, tid, NULL, 0) != 0)
+	{
+		_trace_profile_stop(debug);
+		return -_linux_error(debug, "%s: %s", "ptrace",
+				strerror(errno));
+	}
+	return 0;
+#else
+	(void) tid;
+	(void) e;
+	(void) sig;
+
+	_trace_profile_stop(debug);
+	return -1;
+#endif
+}
+
+static void _trace_record_wait(LinuxDebug * debug)
+{
+	/* kept by the copies of the process restored */
+	pid_t pgid = getpgid(debug->pid);
+	struct pollfd pfd;
+	unsigned int spin = 0;
+	pid_t tid;
+	int status;
+
+	pfd.fd = debug->commands.fd;
+	pfd.events = POLLIN;
+	_linux_hold(debug);
+	/* every thread is waited for here, until a command is queued */
+	while(debug->writer != NULL
+			&& g_atomic_pointer_get(&debug->commands.head) == NULL)
+	{
+		if((tid = waitpid(-pgid, &status, __WALL | WNOHANG)) == 0)
+		{
+			/* the next step is usually about to stop */
+			if(spin++ < LINUX_RECORD_SPIN)
+				sched_yield();
+			/* otherwise blocked, as in a system call: wake up on
+			 * the commands, if not signalled already */
+			else if(poll(&pfd, 1, LINUX_RECORD_POLL) > 0
+					&& g_atomic_pointer_get(
+						&debug->commands.head) == NULL)
+				g_usleep(LINUX_RECORD_POLL * 1000);
+			continue;
+		}
+		if(tid == -1)
+		{
+			if(errno == EINTR)
+				continue;
+			/* reported by the waiter */
+			break;
+		}
+		spin = 0;
+		if(WIFSTOPPED(status))
+			_trace_stopped(debug, tid, status);
+		else
+			_trace_exited(debug, tid, status);
+	}
+	_linux_release(debug);
+}
+
+static void _trace_requests(LinuxDebug * debug)
+{
+	LinuxMessage * message;
+	LinuxMessage * next;
+
+	if(g_atomic_pointer_get(&debug->commands.head) == NULL)
+		return;
+	/* the requests left fail, the other commands are kept for later */
+	for(message = _linux_queue_pop(&debug->commands); message != NULL;
+			message = next)
+	{
+		next = message->next;
+		if(message->type == LMT_CHECKPOINT
+				|| message->type == LMT_RESTORE
+				|| message->type == LMT_DISCARD)
+		{
+			_linux_error(debug, "%s",
+					_("No process is being traced"));
+			/* the checkpoints requested are replied as failed */
+			if(message->type != LMT_CHECKPOINT)
+				_linux_message_delete(message);
+			else
+			{
+				message->type = LMT_CHECKPOINTED;
+				_linux_post(debug, message);
+			}
+		}
+		else
+			_linux_queue_push(&debug->commands, message);
+	}
+}
+
+#ifdef LINUX_CHECKPOINTS
+static int _trace_restore(LinuxDebug * debug, int checkpoint)
+{
+	GHashTableIter iter;
+	gpointer value;
+	LinuxThread * thread;
+	pid_t copy;
+	pid_t pid;
+
+	if((copy = GPOINTER_TO_INT(g_hash_table_lookup(debug->checkpoints,
+						GINT_TO_POINTER(checkpoint))))
+			<= 0)
+		return -_linux_error(debug, "%s", strerror(EINVAL));
+	/* the process is replaced altogether, without reporting its end */
+	_trace_profile_stop(debug);
+	_linux_hold(debug);
+	/* along with the processes forked */
+	g_hash_table_iter_init(&iter, debug->threads);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		thread = value;
+		if(thread->tid == thread->process)
+			kill(thread->tid, SIGKILL);
+	}
+	g_hash_table_iter_init(&iter, debug->threads);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		thread = value;
+		if(thread->tid != thread->process)
+			_linux_reap(thread->tid);
+	}
+	/* the leaders are only collected after their threads */
+	g_hash_table_iter_init(&iter, debug->threads);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		thread = value;
+		if(thread->tid == thread->process)
+			_linux_reap(thread->tid);
+	}
+	g_hash_table_remove_all(debug->threads);
+	debug->running = FALSE;
+	debug->pausing = FALSE;
+	debug->signal = 0;
+	debug->request = PTRACE_CONT;
+	/* nothing is inserted into the checkpoint */
+	_linux_breakpoints_reset(debug);
+	_linux_watchpoints_reset(debug);
+	/* which is copied in turn, and kept for later */
+	g_atomic_int_set(&debug->pid, copy);
+	pid = _linux_fork(debug, copy);
+	g_hash_table_remove_all(debug->threads);
+	if(pid < 0)
+	{
+		/* the end of the checkpoints ends the run */
+		_linux_error(debug, "%s", error_get(NULL));
+		_linux_checkpoints_kill(debug);
+		_linux_release(debug);
+		return -1;
+	}
+	g_atomic_int_set(&debug->pid, pid);
+	debug->tid = pid;
+	if((thread = _linux_thread(debug, pid)) != NULL)
+	{
+		thread->started = TRUE;
+		thread->stopped = TRUE;
+	}
+	_linux_release(debug);
+	_linux_get_registers(debug);
+	return 0;
+}
+#endif
+
+static void _trace_sample(LinuxDebug * debug, pid_t tid)
+{
+#if defined(__x86_64__)
+	struct user_regs_struct regs;
+	struct iovec iov;
+	struct iovec local;
+	struct iovec remote;
+	uint64_t frame[2];
+	uint64_t fp;
+	LinuxStack stack;
+
+	if(debug->samples == NULL)
+		return;
+	iov.iov_base = &regs;
+	iov.iov_len = sizeof(regs);
+	if(ptrace(PTRACE_GETREGSET, tid, (void *)NT_PRSTATUS, &iov) != 0)
+		return;
+	stack.addresses[0] = regs.rip;
+	stack.cnt = 1;
+	/* follow the frame pointers, each saved along the return address */
+	local.iov_base = frame;
+	local.iov_len = sizeof(frame);
+	remote.iov_len = sizeof(frame);
+	for(fp = regs.rbp; fp != 0 && stack.cnt < LINUX_STACK_MAX;
+			fp = frame[0])
+	{
+		remote.iov_base = (void *)(uintptr_t)fp;
+		if(process_vm_readv(debug->pid, &local, 1, &remote, 1, 0)
+				!= sizeof(frame) || frame[1] == 0)
+			break;
+		stack.addresses[stack.cnt++] = frame[1];
+		/* the callers are always further up the stack */
+		if(frame[0] <= fp)
+			break;
+	}
+	_trace_profile_count(debug, &stack);
+#else
+	(void) debug;
+	(void) tid;
+#endif
+}
+
+static void _trace_sample_interrupt(LinuxDebug * debug)
+{
+	GHashTableIter iter;
+	gpointer value;
+	LinuxThread * thread;
+
+	if(debug->sampler == NULL || !debug->running || debug->pausing)
+		return;
+	/* every thread running is sampled */
+	g_hash_table_iter_init(&iter, debug->threads);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		thread = value;
+		if(!thread->started || thread->stopped || thread->interrupted
+				|| thread->sampled)
+			continue;
+		if(ptrace(PTRACE_INTERRUPT, thread->tid, NULL, 0) == 0)
+			thread->sampled = TRUE;
+	}
+}
+
+static void _trace_stopped(LinuxDebug * debug, pid_t tid, int status)
+{
+	LinuxThread * thread;
+	int sig = WSTOPSIG(status);
+	int e = status >> 16;
+	gboolean sampled = FALSE;
+	LinuxBreakpoint * breakpoint = NULL;
+	LinuxWatchpoint * watchpoint = NULL;
+	gboolean hit = TRUE;
+	uint64_t bias;
+	LinuxMessage * message;
+	int res;
+
+	/* forked, or left over from a process replaced by a checkpoint */
+	if(g_hash_table_lookup(debug->threads, GINT_TO_POINTER(tid)) == NULL
+			&& syscall(SYS_tgkill, debug->pid, tid, 0) != 0)
+	{
+		/* until the event of the parent, if any */
+		g_hash_table_insert(debug->unknown, GINT_TO_POINTER(tid),
+				GINT_TO_POINTER(status));
+		return;
+	}
+	if((thread = _linux_thread(debug, tid)) == NULL)
+		return;
+	thread->stopped = TRUE;
+	/* any other stop cancels the interruption, requested again */
+	if(e != PTRACE_EVENT_STOP && (thread->interrupted || thread->sampled))
+		ptrace(PTRACE_INTERRUPT, tid, NULL, 0);
+	/* the system calls traced are timed transparently */
+	if(e == PTRACE_EVENT_SECCOMP && _linux_syscall_enter(debug, thread)
+			== 0)
+	{
+		thread->stopped = FALSE;
+		return;
+	}
+	if(e == 0 && sig == (SIGTRAP | 0x80) && thread->syscall != NULL
+			&& (res = _trace_stopped_syscall(debug, thread)) != 1)
+	{
+		if(res == 0)
+			thread->stopped = FALSE;
+		return;
+	}
+	/* back on the breakpoint hit if any, whether reported or not */
+	if(e == 0 && sig == SIGTRAP && thread->started
+			&& (breakpoint = _linux_breakpoint_trap(debug, tid))
+			== NULL)
+		watchpoint = _linux_watchpoint_trap(debug, tid);
+	else if(e == 0 && sig == SIGSEGV && thread->started)
+		watchpoint = _linux_watchpoint_fault(debug, tid, &hit);
+	if(e == PTRACE_EVENT_STOP && thread->sampled)
+	{
+		/* unless stopped for another reason meanwhile */
+		thread->sampled = FALSE;
+		sampled = !thread->interrupted && !(debug->pausing
+				&& tid == debug->tid);
+	}
+	if(e == PTRACE_EVENT_CLONE || e == PTRACE_EVENT_FORK
+			|| e == PTRACE_EVENT_VFORK)
+		_trace_stopped_task(debug, thread, e);
+	else if(sampled)
+		/* resumed right away */
+		_trace_sample(debug, tid);
+	else if(thread->interrupted)
+	{
+		/* stopped along with the others, or about to be */
+		if(e == PTRACE_EVENT_STOP)
+			thread->interrupted = FALSE;
+	}
+	else if(thread->started && e == PTRACE_EVENT_STOP && sig == SIGTRAP
+			&& !(debug->pausing && tid == debug->tid))
+	{
+		/* requested again after another stop, resumed below */
+	}
+	else if(tid != debug->pid && e == PTRACE_EVENT_EXEC)
+	{
+		/* the other processes are followed into any program */
+	}
+	else if(thread->started || (tid == debug->pid
+				&& e == PTRACE_EVENT_EXEC))
+	{
+		thread->started = TRUE;
+		if(tid == debug->pid && e == PTRACE_EVENT_EXEC)
+		{
+			/* inserted into the new program when resuming */
+			_linux_breakpoints_reset(debug);
+			_linux_watchpoints_reset(debug);
+			debug->executed = TRUE;
+			/* relocated by the debugger before this stop */
+			if(_linux_bias(debug, &bias) != 0)
+				_linux_error(debug, "%s", error_get(NULL));
+			else if((message = _linux_message_new(LMT_BIAS))
+					!= NULL)
+			{
+				message->u.address = bias;
+				_linux_post(debug, message);
+			}
+		}
+		if(debug->running)
+		{
+			if(breakpoint != NULL
+					&& (res = _trace_stopped_breakpoint(
+							debug, thread,
+							breakpoint)) != 1)
+			{
+				if(res == 0)
+					thread->stopped = FALSE;
+				return;
+			}
+			if(watchpoint != NULL
+					&& (res = _trace_stopped_watchpoint(
+							debug, thread,
+							watchpoint, hit)) != 1)
+			{
+				if(res == 0)
+					thread->stopped = FALSE;
+				return;
+			}
+			if(breakpoint == NULL && watchpoint == NULL
+					&& debug->writer != NULL
+					&& _trace_record_step(debug, tid, e,
+						sig) == 0)
+			{
+				thread->stopped = FALSE;
+				return;
+			}
+			if(e == 0 && sig != SIGTRAP && sig != (SIGTRAP | 0x80)
+					&& watchpoint == NULL)
+				/* deliver the signal when resuming */
+				debug->signal = sig;
+			_trace_stopped_report(debug, tid);
+			return;
+		}
+	}
+	else if(tid != debug->pid)
+	{
+		thread->started = TRUE;
+		/* their copy of the code is restored as it was */
+		if(thread->inherited && _linux_clean(debug, tid) != 0)
+			_linux_error(debug, "%s", error_get(NULL));
+		thread->inherited = FALSE;
+	}
+	else
+	{
+		/* the process is not reported until exec */
+		if(ptrace(PTRACE_CONT, tid, NULL, 0) == 0)
+			thread->stopped = FALSE;
+		return;
+	}
+	if(debug->exited)
+	{
+		if(ptrace(PTRACE_DETACH, tid, NULL, 0) == 0)
+			g_hash_table_remove(debug->threads,
+					GINT_TO_POINTER(tid));
+		return;
+	}
+	/* keep the thread running with the others, or recorded */
+	if(!debug->running)
+		return;
+	if(debug->pausing)
+	{
+		/* this stop cancelled the pause, reported instead */
+		if(tid == debug->tid && thread->started)
+			_trace_stopped_report(debug, tid);
+		return;
+	}
+	_linux_watchpoints_set(debug, thread);
+	if(ptrace((debug->writer != NULL && tid == debug->tid)
+				? PTRACE_SINGLESTEP : PTRACE_CONT, tid, NULL,
+				0) == 0)
+		thread->stopped = FALSE;
+}
+
+static int _trace_stopped_breakpoint(LinuxDebug * debug, LinuxThread * thread,
+		LinuxBreakpoint * breakpoint)
+{
+	pid_t tid = thread->tid;
+	int request = (tid == debug->tid) ? debug->request : PTRACE_CONT;
+
+	breakpoint->statistics.hits++;
+	/* stop when stepping or pausing, or if the condition holds */
+	if((request == PTRACE_SINGLESTEP && debug->writer == NULL)
+			|| (debug->pausing && tid == debug->tid)
+			|| _linux_breakpoint_evaluate(debug, breakpoint, tid)
+			!= 0)
+	{
+		breakpoint->statistics.stops++;
+		return 1;
+	}
+	/* resume right away otherwise */
+	if(_linux_breakpoint_step(debug, tid, breakpoint, 0) != 0)
+		return -1;
+	/* unless a watchpoint was hit meanwhile */
+	if(_linux_watchpoint_trap(debug, tid) != NULL)
+		return 1;
+	_linux_watchpoints_set(debug, thread);
+	if(ptrace(request, tid, NULL, 0) != 0)
+		return -_linux_error(debug, "%s: %s", "ptrace",
+				strerror(errno));
+	return 0;
+}
+
+static int _trace_stopped_syscall(LinuxDebug * debug, LinuxThread * thread)
+{
+	pid_t tid = thread->tid;
+	int request = (tid == debug->tid) ? debug->request : PTRACE_CONT;
+
+	_linux_syscall_exit(thread);
+	/* stop if stepping or pausing, or at every system call anyway */
+	if((request == PTRACE_SINGLESTEP && debug->writer == NULL)
+			|| (debug->pausing && tid == debug->tid)
+			|| request == PTRACE_SYSCALL)
+		return 1;
+	_linux_watchpoints_set(debug, thread);
+	if(ptrace(request, tid, NULL, 0) != 0)
+		return -_linux_error(debug, "%s: %s", "ptrace",
+				strerror(errno));
+	return 0;
+}
+
+static void _trace_stopped_task(LinuxDebug * debug, LinuxThread * thread,
+		int e)
+{
+	unsigned long msg;
+	LinuxThread * task;
+	gpointer status;
+
+	/* new tasks are only resumed once known */
+	if(ptrace(PTRACE_GETEVENTMSG, thread->tid, NULL, &msg) != 0
+			|| (task = _linux_thread(debug, msg)) == NULL)
+		return;
+	/* forked processes stay in the process group, as do their threads */
+	if(e == PTRACE_EVENT_CLONE)
+		task->process = thread->process;
+	else
+		task->process = msg;
+	/* unlike the others, they do not share the code patched */
+	task->inherited = (e == PTRACE_EVENT_FORK);
+	if(g_hash_table_lookup_extended(debug->unknown, GINT_TO_POINTER(msg),
+				NULL, &status))
+	{
+		/* stopped already */
+		g_hash_table_remove(debug->unknown, GINT_TO_POINTER(msg));
+		_trace_stopped(debug, msg, GPOINTER_TO_INT(status));
+	}
+}
+
+static int _trace_stopped_watchpoint(LinuxDebug * debug, LinuxThread * thread,
+		LinuxWatchpoint * watchpoint, gboolean hit)
+{
+	pid_t tid = thread->tid;
+	int request = (tid == debug->tid) ? debug->request : PTRACE_CONT;
+
+	/* the debug registers trap right after the access */
+	if(watchpoint->slot < 0)
+	{
+		if(_linux_watchpoint_step(debug, tid, watchpoint) != 0)
+			return 1;
+		/* or while stepping over it */
+		if(_linux_watchpoint_trap(debug, tid) != NULL)
+			hit = TRUE;
+	}
+	/* stop when stepping or pausing too, unless next to the memory */
+	if(hit || (request == PTRACE_SINGLESTEP && debug->writer == NULL)
+			|| (debug->pausing && tid == debug->tid))
+		return 1;
+	_linux_watchpoints_set(debug, thread);
+	if(ptrace(request, tid, NULL, 0) != 0)
+		return -_linux_error(debug, "%s: %s", "ptrace",
+				strerror(errno));
+	return 0;
+}
+
+static void _trace_stopped_report(LinuxDebug * debug, pid_t tid)
+{
+	GHashTableIter iter;
+	gpointer value;
+	LinuxThread * thread;
+
+	/* profiling lasts until the next stop */
+	_trace_profile_stop(debug);
+	_linux_breakpoint_report(debug);
+	_linux_syscall_report(debug);
+	debug->running = FALSE;
+	debug->pausing = FALSE;
+	debug->tid = tid;
+	/* stop every other thread as well */
+	g_hash_table_iter_init(&iter, debug->threads);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		thread = value;
+		if(thread->stopped || thread->interrupted)
+			continue;
+		if(ptrace(PTRACE_INTERRUPT, thread->tid, NULL, 0) == 0)
+			thread->interrupted = TRUE;
+	}
+	_linux_get_registers(debug);
+}
+
+
+/* linux_on_wait */
+static gpointer _linux_on_wait(gpointer data)
+{
+	LinuxDebug * debug = data;
+	pid_t pid = debug->pid;
+	siginfo_t info;
+	pid_t tid;
+	int status = 0;
+	LinuxMessage * message;
+
+	/* only the process group of the traced process is collected */
+	for(;;)
+	{
+		/* look first, as the tracer may be waiting itself */
+		if(waitid(P_PGID, pid, &info, WEXITED | WSTOPPED | WNOWAIT
+					| __WALL) != 0 && errno == EINTR)
+			continue;
+		g_mutex_lock(&debug->lock);
+		if(debug->waiting > 0)
+		{
+			while(debug->waiting > 0)
+				g_cond_wait(&debug->cond, &debug->lock);
+			g_mutex_unlock(&debug->lock);
+			continue;
+		}
+		if((tid = waitpid(-pid, &status, __WALL | WNOHANG)) == 0)
+		{
+			g_mutex_unlock(&debug->lock);
+			continue;
+		}
+		/* handled by the tracer, until every thread is collected */
+		if((message = _linux_message_new(LMT_WAIT)) != NULL)
+		{
+			message->u.wait.tid = tid;
+			message->u.wait.status = status;
+			/* queued before the tracer waits again */
+			_linux_queue_push(&debug->commands, message);
+		}
+		g_mutex_unlock(&debug->lock);
+		if(message == NULL || tid == -1)
+			break;
+	}
+	return NULL;
+}
+#endif /* __linux__ */
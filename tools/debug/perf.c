@@ -0,0 +1,743 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+/* this plug-in is specific to Linux */
+#ifdef __linux__
+/* for process_vm_readv() */
+#define _GNU_SOURCE
+#include <sys/types.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <linux/perf_event.h>
+#include <signal.h>
+#include <unistd.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <libintl.h>
+#include <glib.h>
+#include "../debug.h"
+#define _(string) gettext(string)
+
+
+/* Perf */
+/* private */
+/* types */
+typedef struct _DebuggerDebug PerfDebug;
+
+/* inherited events can only be mapped for a given CPU */
+typedef struct _PerfBuffer
+{
+	PerfDebug * debug;
+	int fd;
+	void * mapping;
+	unsigned char const * data;
+	GIOChannel * channel;
+	guint source;
+} PerfBuffer;
+
+/* frames kept at most for every sample */
+#define PERF_STACK_MAX	64
+
+/* a program counter followed by the return addresses */
+typedef struct _PerfStack
+{
+	/* times found, not compared */
+	uint64_t count;
+	size_t cnt;
+	uint64_t addresses[PERF_STACK_MAX];
+} PerfStack;
+
+struct _DebuggerDebug
+{
+	DebuggerDebugHelper const * helper;
+
+	/* child */
+	GPid pid;
+	guint source;
+	gboolean running;
+
+	/* sampling, one buffer per CPU */
+	PerfBuffer * buffers;
+	size_t buffers_cnt;
+	unsigned int frequency;
+	/* samples, by stack */
+	GHashTable * samples;
+	gint64 since;
+	uint64_t lost;
+};
+
+
+/* constants */
+/* samples per second by default */
+#define PERF_FREQUENCY	1000
+/* pages of samples, a power of two */
+#define PERF_PAGES	64
+
+
+/* prototypes */
+/* plug-in */
+static PerfDebug * _perf_init(DebuggerDebugHelper const * helper);
+static void _perf_destroy(PerfDebug * debug);
+static int _perf_start(PerfDebug * debug, va_list argp);
+static int _perf_pause(PerfDebug * debug);
+static int _perf_stop(PerfDebug * debug);
+static int _perf_continue(PerfDebug * debug);
+static int _perf_next(PerfDebug * debug);
+static int _perf_step(PerfDebug * debug);
+static ssize_t _perf_read_memory(PerfDebug * debug, uint64_t address,
+		void * buf, size_t size);
+static ssize_t _perf_write_memory(PerfDebug * debug, uint64_t address,
+		void const * buf, size_t size);
+static int _perf_profile(PerfDebug * debug, unsigned int frequency);
+
+/* useful */
+static void _perf_close(PerfDebug * debug);
+static int _perf_ioctl(PerfDebug * debug, unsigned long request, void * arg);
+static int _perf_open(PerfDebug * debug, unsigned int frequency);
+static void _perf_read(PerfDebug * debug);
+static void _perf_read_buffer(PerfDebug * debug, PerfBuffer * buffer);
+static void _perf_report(PerfDebug * debug);
+
+/* stack */
+static gboolean _perf_stack_equal(gconstpointer a, gconstpointer b);
+static guint _perf_stack_hash(gconstpointer key);
+
+/* callbacks */
+static void _perf_on_child(GPid pid, gint status, gpointer data);
+static gboolean _perf_on_samples(GIOChannel * source, GIOCondition condition,
+		gpointer data);
+
+
+/* constants */
+DebuggerDebugDefinition debug =
+{
+	"perf",
+	NULL,
+	LICENSE_BSD3_FLAGS,
+	_perf_init,
+	_perf_destroy,
+	_perf_start,
+	_perf_pause,
+	_perf_stop,
+	_perf_continue,
+	_perf_next,
+	_perf_step,
+	_perf_read_memory,
+	_perf_write_memory,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	_perf_profile,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL
+};
+
+
+/* protected */
+/* functions */
+/* plug-in */
+/* perf_init */
+static PerfDebug * _perf_init(DebuggerDebugHelper const * helper)
+{
+	PerfDebug * debug;
+
+	if((debug = object_new(sizeof(*debug))) == NULL)
+		return NULL;
+	debug->helper = helper;
+	debug->pid = -1;
+	debug->source = 0;
+	debug->running = FALSE;
+	debug->buffers = NULL;
+	debug->buffers_cnt = 0;
+	debug->frequency = 0;
+	debug->samples = NULL;
+	debug->since = 0;
+	debug->lost = 0;
+	return debug;
+}
+
+
+/* perf_destroy */
+static void _perf_destroy(PerfDebug * debug)
+{
+	if(debug->source != 0)
+		g_source_remove(debug->source);
+	if(debug->pid > 0)
+	{
+		kill(debug->pid, SIGKILL);
+		waitpid(debug->pid, NULL, 0);
+		g_spawn_close_pid(debug->pid);
+	}
+	_perf_close(debug);
+	object_delete(debug);
+}
+
+
+/* perf_start */
+static int _perf_start(PerfDebug * debug, va_list argp)
+{
+	char const * filename;
+	char * argv[2] = { NULL, NULL };
+	int fds[2];
+	char c;
+
+	if((filename = va_arg(argp, char const *)) == NULL)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(EINVAL));
+	if(debug->pid > 0)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(EBUSY));
+	argv[0] = (char *)filename;
+	if(pipe(fds) != 0)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s: %s", "pipe", strerror(errno));
+	if((debug->pid = fork()) == -1)
+	{
+		close(fds[0]);
+		close(fds[1]);
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s: %s", "fork", strerror(errno));
+	}
+	else if(debug->pid == 0)
+	{
+		/* wait until sampled, from exec on */
+		close(fds[1]);
+		if(read(fds[0], &c, sizeof(c)) == 0)
+		{
+			close(fds[0]);
+			execv(argv[0], argv);
+		}
+		_exit(125);
+	}
+	close(fds[0]);
+	if(_perf_open(debug, PERF_FREQUENCY) != 0)
+	{
+		debug->helper->error(debug->helper->debugger, 1, "%s: %s",
+				_("Could not start execution"),
+				error_get(NULL));
+		close(fds[1]);
+		kill(debug->pid, SIGKILL);
+		waitpid(debug->pid, NULL, 0);
+		debug->pid = -1;
+		return -1;
+	}
+	debug->source = g_child_watch_add(debug->pid, _perf_on_child, debug);
+	debug->running = TRUE;
+	/* let the child run */
+	close(fds[1]);
+	return 0;
+}
+
+
+/* perf_pause */
+static int _perf_pause(PerfDebug * debug)
+{
+	if(debug->pid <= 0 || !debug->running)
+		return 0;
+	if(kill(debug->pid, SIGSTOP) != 0)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s: %s", "kill", strerror(errno));
+	_perf_ioctl(debug, PERF_EVENT_IOC_DISABLE, NULL);
+	debug->running = FALSE;
+	_perf_report(debug);
+	return 0;
+}
+
+
+/* perf_stop */
+static int _perf_stop(PerfDebug * debug)
+{
+	if(debug->pid <= 0)
+		return 0;
+	/* collected along with the child */
+	if(kill(debug->pid, SIGKILL) != 0)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s: %s", "kill", strerror(errno));
+	return 0;
+}
+
+
+/* perf_continue */
+static int _perf_continue(PerfDebug * debug)
+{
+	if(debug->pid <= 0)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", _("No process is being traced"));
+	if(debug->running)
+		return 0;
+	/* a new profile is started */
+	g_hash_table_remove_all(debug->samples);
+	debug->since = g_get_monotonic_time();
+	debug->lost = 0;
+	_perf_ioctl(debug, PERF_EVENT_IOC_ENABLE, NULL);
+	if(kill(debug->pid, SIGCONT) != 0)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s: %s", "kill", strerror(errno));
+	debug->running = TRUE;
+	return 0;
+}
+
+
+/* perf_next */
+static int _perf_next(PerfDebug * debug)
+{
+	return -debug->helper->error(debug->helper->debugger, 1, "%s",
+			_("Not supported by this plug-in"));
+}
+
+
+/* perf_step */
+static int _perf_step(PerfDebug * debug)
+{
+	return -debug->helper->error(debug->helper->debugger, 1, "%s",
+			_("Not supported by this plug-in"));
+}
+
+
+/* perf_read_memory */
+static ssize_t _perf_read_memory(PerfDebug * debug, uint64_t address,
+		void * buf, size_t size)
+{
+	struct iovec local;
+	struct iovec remote;
+	ssize_t res;
+
+	if(debug->pid <= 0)
+		return -error_set_code(1, "%s",
+				_("No process is being traced"));
+	if(size == 0)
+		return 0;
+	local.iov_base = buf;
+	local.iov_len = size;
+	remote.iov_base = (void *)(uintptr_t)address;
+	remote.iov_len = size;
+	if((res = process_vm_readv(debug->pid, &local, 1, &remote, 1, 0)) < 0)
+	{
+		error_set_code(-errno, "%s", strerror(errno));
+		return -1;
+	}
+	return res;
+}
+
+
+/* perf_write_memory */
+static ssize_t _perf_write_memory(PerfDebug * debug, uint64_t address,
+		void const * buf, size_t size)
+{
+	struct iovec local;
+	struct iovec remote;
+	ssize_t res;
+
+	if(debug->pid <= 0)
+		return -error_set_code(1, "%s",
+				_("No process is being traced"));
+	if(size == 0)
+		return 0;
+	local.iov_base = (void *)buf;
+	local.iov_len = size;
+	remote.iov_base = (void *)(uintptr_t)address;
+	remote.iov_len = size;
+	if((res = process_vm_writev(debug->pid, &local, 1, &remote, 1, 0))
+			< 0)
+	{
+		error_set_code(-errno, "%s", strerror(errno));
+		return -1;
+	}
+	return res;
+}
+
+
+/* perf_profile */
+static int _perf_profile(PerfDebug * debug, unsigned int frequency)
+{
+	uint64_t value;
+
+	if(frequency == 0)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", strerror(EINVAL));
+	if(debug->pid <= 0)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", _("No process is being traced"));
+	/* the clock counts in nanoseconds; the threads already running
+	 * keep sampling at the former frequency though */
+	value = 1000000000 / frequency;
+	if(frequency != debug->frequency
+			&& _perf_ioctl(debug, PERF_EVENT_IOC_PERIOD, &value)
+			!= 0)
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", error_get(NULL));
+	debug->frequency = frequency;
+	if(!debug->running)
+		return _perf_continue(debug);
+	/* start over */
+	_perf_read(debug);
+	g_hash_table_remove_all(debug->samples);
+	debug->since = g_get_monotonic_time();
+	debug->lost = 0;
+	return 0;
+}
+
+
+/* useful */
+/* perf_close */
+static void _perf_close(PerfDebug * debug)
+{
+	PerfBuffer * buffer;
+	size_t i;
+
+	for(i = 0; i < debug->buffers_cnt; i++)
+	{
+		buffer = &debug->buffers[i];
+		if(buffer->source != 0)
+			g_source_remove(buffer->source);
+		g_io_channel_unref(buffer->channel);
+		munmap(buffer->mapping, (PERF_PAGES + 1) * getpagesize());
+		close(buffer->fd);
+	}
+	g_free(debug->buffers);
+	debug->buffers = NULL;
+	debug->buffers_cnt = 0;
+	if(debug->samples != NULL)
+		g_hash_table_destroy(debug->samples);
+	debug->samples = NULL;
+}
+
+
+/* perf_ioctl */
+static int _perf_ioctl(PerfDebug * debug, unsigned long request, void * arg)
+{
+	int ret = 0;
+	size_t i;
+
+	for(i = 0; i < debug->buffers_cnt; i++)
+		if(ioctl(debug->buffers[i].fd, request, arg) != 0)
+			ret = -error_set_code(-errno, "%s: %s", "perf_event",
+					strerror(errno));
+	return ret;
+}
+
+
+/* perf_open */
+static int _perf_open(PerfDebug * debug, unsigned int frequency)
+{
+	const size_t size = PERF_PAGES * getpagesize();
+	struct perf_event_attr attr;
+	long cpus;
+	long cpu;
+	PerfBuffer * buffer;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	/* a software clock, also available without any PMU */
+	attr.type = PERF_TYPE_SOFTWARE;
+	attr.config = PERF_COUNT_SW_CPU_CLOCK;
+	/* the clock counts in nanoseconds */
+	attr.sample_period = 1000000000 / frequency;
+	attr.sample_type = PERF_SAMPLE_IP | PERF_SAMPLE_TID
+		| PERF_SAMPLE_CALLCHAIN;
+	attr.disabled = 1;
+	attr.enable_on_exec = 1;
+	/* threads and children are sampled as well */
+	attr.inherit = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.exclude_callchain_kernel = 1;
+	attr.sample_max_stack = PERF_STACK_MAX;
+	/* only woken up once a buffer is half full */
+	attr.watermark = 1;
+	attr.wakeup_watermark = size / 2;
+	if((cpus = sysconf(_SC_NPROCESSORS_CONF)) <= 0)
+		cpus = 1;
+	debug->buffers = g_new(PerfBuffer, cpus);
+	error_set_code(1, "%s", strerror(ENODEV));
+	for(cpu = 0; cpu < cpus; cpu++)
+	{
+		buffer = &debug->buffers[debug->buffers_cnt];
+		buffer->debug = debug;
+		/* the CPUs offline are ignored */
+		if((buffer->fd = syscall(SYS_perf_event_open, &attr,
+						debug->pid, cpu, -1,
+						PERF_FLAG_FD_CLOEXEC)) < 0)
+		{
+			error_set_code(-errno, "%s: %s", "perf_event_open",
+					strerror(errno));
+			continue;
+		}
+		/* the first page is for control */
+		if((buffer->mapping = mmap(NULL, size + getpagesize(),
+						PROT_READ | PROT_WRITE,
+						MAP_SHARED, buffer->fd, 0))
+				== MAP_FAILED)
+		{
+			error_set_code(-errno, "%s: %s", "mmap",
+					strerror(errno));
+			close(buffer->fd);
+			continue;
+		}
+		buffer->data = (unsigned char const *)buffer->mapping
+			+ getpagesize();
+		buffer->channel = g_io_channel_unix_new(buffer->fd);
+		buffer->source = g_io_add_watch(buffer->channel,
+				G_IO_IN | G_IO_HUP, _perf_on_samples, buffer);
+		debug->buffers_cnt++;
+	}
+	if(debug->buffers_cnt == 0)
+	{
+		_perf_close(debug);
+		return -1;
+	}
+	debug->frequency = frequency;
+	debug->samples = g_hash_table_new_full(_perf_stack_hash,
+			_perf_stack_equal, g_free, NULL);
+	debug->since = g_get_monotonic_time();
+	debug->lost = 0;
+	return 0;
+}
+
+
+/* perf_read */
+static void _perf_read(PerfDebug * debug)
+{
+	size_t i;
+
+	for(i = 0; i < debug->buffers_cnt; i++)
+		_perf_read_buffer(debug, &debug->buffers[i]);
+}
+
+
+/* perf_read_buffer */
+static void _read_copy(PerfBuffer * buffer, uint64_t offset, void * buf,
+		size_t size);
+static void _read_sample(PerfDebug * debug, uint64_t const * values,
+		size_t values_cnt);
+
+static void _perf_read_buffer(PerfDebug * debug, PerfBuffer * buffer)
+{
+	struct perf_event_mmap_page * page = buffer->mapping;
+	uint64_t head;
+	uint64_t tail;
+	struct perf_event_header header;
+	uint64_t buf[4 + PERF_STACK_MAX + 8];
+
+	head = __atomic_load_n(&page->data_head, __ATOMIC_ACQUIRE);
+	for(tail = page->data_tail; tail < head; tail += header.size)
+	{
+		_read_copy(buffer, tail, &header, sizeof(header));
+		if(header.size < sizeof(header))
+			break;
+		if(header.size > sizeof(header) + sizeof(buf))
+			/* more addresses than requested */
+			continue;
+		_read_copy(buffer, tail + sizeof(header), buf,
+				header.size - sizeof(header));
+		if(header.type == PERF_RECORD_SAMPLE)
+			_read_sample(debug, buf, (header.size - sizeof(header))
+					/ sizeof(*buf));
+		else if(header.type == PERF_RECORD_LOST)
+			debug->lost += buf[1];
+	}
+	/* the space read can be written again */
+	__atomic_store_n(&page->data_tail, tail, __ATOMIC_RELEASE);
+}
+
+static void _read_copy(PerfBuffer * buffer, uint64_t offset, void * buf,
+		size_t size)
+{
+	const size_t total = PERF_PAGES * getpagesize();
+	size_t pos = offset % total;
+	size_t len;
+
+	/* the records may wrap around the end of the buffer */
+	len = MIN(size, total - pos);
+	memcpy(buf, &buffer->data[pos], len);
+	if(len < size)
+		memcpy((char *)buf + len, buffer->data, size - len);
+}
+
+static void _read_sample(PerfDebug * debug, uint64_t const * values,
+		size_t values_cnt)
+{
+	PerfStack stack;
+	PerfStack * p;
+	size_t size;
+	size_t i;
+	uint64_t nr;
+
+	/* the address, the process and thread identifiers, then the calls */
+	if(values_cnt < 3)
+		return;
+	stack.addresses[0] = values[0];
+	stack.cnt = 1;
+	nr = (values_cnt > 3) ? MIN(values[2], values_cnt - 3) : 0;
+	/* the first address in user context is the program counter again */
+	for(i = 0; i < nr; i++)
+		if(values[3 + i] < PERF_CONTEXT_MAX)
+			break;
+	for(i++; i < nr && stack.cnt < PERF_STACK_MAX; i++)
+		if(values[3 + i] < PERF_CONTEXT_MAX)
+			stack.addresses[stack.cnt++] = values[3 + i];
+	if((p = g_hash_table_lookup(debug->samples, &stack)) != NULL)
+	{
+		p->count++;
+		return;
+	}
+	size = offsetof(PerfStack, addresses)
+		+ sizeof(*stack.addresses) * stack.cnt;
+	if((p = g_malloc(size)) == NULL)
+		return;
+	memcpy(p, &stack, size);
+	p->count = 1;
+	g_hash_table_add(debug->samples, p);
+}
+
+
+/* perf_report */
+static void _perf_report(PerfDebug * debug)
+{
+	DebuggerDebugHelper const * helper = debug->helper;
+	GHashTableIter iter;
+	gpointer key;
+	PerfStack * stack;
+	DebuggerDebugSample * samples;
+	DebuggerDebugSample * sample;
+	uint64_t * callers;
+	uint64_t * p;
+	size_t cnt = 0;
+
+	if(debug->samples == NULL)
+		return;
+	_perf_read(debug);
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s() %lu samples lost\n", __func__,
+			(unsigned long)debug->lost);
+#endif
+	g_hash_table_iter_init(&iter, debug->samples);
+	while(g_hash_table_iter_next(&iter, &key, NULL))
+		cnt += ((PerfStack *)key)->cnt - 1;
+	/* the callers of every sample are reported at once */
+	samples = g_new(DebuggerDebugSample, g_hash_table_size(debug->samples));
+	callers = g_new(uint64_t, cnt);
+	sample = samples;
+	p = callers;
+	g_hash_table_iter_init(&iter, debug->samples);
+	for(; g_hash_table_iter_next(&iter, &key, NULL); sample++)
+	{
+		stack = key;
+		sample->address = stack->addresses[0];
+		sample->count = stack->count;
+		sample->callers = p;
+		sample->callers_cnt = stack->cnt - 1;
+		memcpy(p, &stack->addresses[1], sizeof(*p)
+				* sample->callers_cnt);
+		p += sample->callers_cnt;
+	}
+	helper->set_profile(helper->debugger, samples, sample - samples,
+			g_get_monotonic_time() - debug->since);
+	g_free(callers);
+	g_free(samples);
+}
+
+
+/* stack */
+/* perf_stack_equal */
+static gboolean _perf_stack_equal(gconstpointer a, gconstpointer b)
+{
+	PerfStack const * sa = a;
+	PerfStack const * sb = b;
+
+	return (sa->cnt == sb->cnt && memcmp(sa->addresses, sb->addresses,
+				sizeof(*sa->addresses) * sa->cnt) == 0)
+		? TRUE : FALSE;
+}
+
+
+/* perf_stack_hash */
+static guint _perf_stack_hash(gconstpointer key)
+{
+	PerfStack const * stack = key;
+	guint hash = 2166136261u;
+	size_t i;
+
+	for(i = 0; i < stack->cnt; i++)
+		hash = (hash ^ (guint)(stack->addresses[i]
+					^ (stack->addresses[i] >> 32)))
+			* 16777619u;
+	return hash;
+}
+
+
+/* callbacks */
+/* perf_on_child */
+static void _perf_on_child(GPid pid, gint status, gpointer data)
+{
+	PerfDebug * debug = data;
+
+	if(pid != debug->pid)
+		return;
+	debug->source = 0;
+	g_spawn_close_pid(debug->pid);
+	debug->pid = -1;
+	/* the profile covers the whole execution */
+	if(debug->running)
+		_perf_report(debug);
+	debug->running = FALSE;
+	_perf_close(debug);
+	if(WIFEXITED(status) && WEXITSTATUS(status) != 0)
+		debug->helper->error(debug->helper->debugger, 1, "%s%d",
+				_("Process exited with status "),
+				WEXITSTATUS(status));
+}
+
+
+/* perf_on_samples */
+static gboolean _perf_on_samples(GIOChannel * source, GIOCondition condition,
+		gpointer data)
+{
+	PerfBuffer * buffer = data;
+	(void) source;
+
+	_perf_read_buffer(buffer->debug, buffer);
+	if(condition & G_IO_HUP)
+	{
+		/* nothing left to sample */
+		buffer->source = 0;
+		return FALSE;
+	}
+	return TRUE;
+}
+#endif /* __linux__ */
@@ -28,11 +28,14 @@
 #include <sys/types.h>
 #include <sys/ptrace.h>
 #include <sys/wait.h>
+#include <sys/mman.h>
 #ifdef __NetBSD__
 # include <machine/reg.h>
 #endif
 #include <unistd.h>
+#include <signal.h>
 #include <stdarg.h>
+#include <time.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -40,6 +43,7 @@
 #include <libintl.h>
 #include <glib.h>
 #include "../debug.h"
+#include "../condition.h"
 #define _(string) gettext(string)
 
 
@@ -52,21 +56,83 @@ typedef struct _DebuggerDebug PtraceDebug;
 	|| defined(__NetBSD__)
 typedef int ptrace_data_t;
 #endif
+/* unit of PT_READ_D and PT_WRITE_D */
+typedef int ptrace_word_t;
+/* software breakpoints */
+#if defined(PT_GETREGS) && defined(__amd64__)
+# define PTRACE_BREAKPOINT	"\xcc"
+# define PTRACE_PC(regs)	((regs).regs[_REG_RIP])
+# define PTRACE_REGISTERS	17
+#elif defined(PT_GETREGS) && defined(__i386__)
+# define PTRACE_BREAKPOINT	"\xcc"
+# define PTRACE_PC(regs)	((regs).r_eip)
+# define PTRACE_REGISTERS	9
+#endif
 
-struct _DebuggerDebug
+typedef struct _PtraceBreakpoint
 {
-	DebuggerDebugHelper const * helper;
+	uint64_t address;
+	gboolean inserted;
+#ifdef PTRACE_BREAKPOINT
+	/* the original code */
+	unsigned char code[sizeof(PTRACE_BREAKPOINT) - 1];
+#endif
+
+	/* the condition if any, its registers resolved to their index */
+	DebuggerDebugInstruction * condition;
+	size_t condition_cnt;
+	size_t * registers;
+	uint64_t * stack;
+
+	/* hits, stops and time spent on the condition */
+	DebuggerDebugBreakpoint statistics;
+} PtraceBreakpoint;
+
+/* what conditions are evaluated against */
+typedef struct _PtraceEvaluation
+{
+	PtraceDebug * debug;
+	PtraceBreakpoint * breakpoint;
+	DebuggerDebugRegister const * registers;
+} PtraceEvaluation;
+
+typedef struct _PtraceTask
+{
+	PtraceDebug * debug;
 	GPid pid;
 	guint source;
 	gboolean running;
-
-	/* events */
-	ptrace_event_t event;
+	/* its initial stop was seen */
+	gboolean attached;
 
 	/* deferred requests */
 	int request;
 	void * addr;
 	ptrace_data_t data;
+
+	/* hit and to be stepped over before resuming */
+	PtraceBreakpoint * step_over;
+	int resume;
+	/* the last resume request */
+	int resumed;
+} PtraceTask;
+
+struct _DebuggerDebug
+{
+	DebuggerDebugHelper const * helper;
+
+	/* processes and threads traced, by pid */
+	GHashTable * tasks;
+	/* the task stopped last, or the program itself */
+	PtraceTask * task;
+
+	/* events */
+	ptrace_event_t event;
+
+	/* breakpoints, by address */
+	GHashTable * breakpoints;
+	/* not inserted yet */
+	GSList * pending;
 };
 
 
@@ -80,16 +146,49 @@ static int _ptrace_stop(PtraceDebug * debug);
 static int _ptrace_continue(PtraceDebug * debug);
 static int _ptrace_next(PtraceDebug * debug);
 static int _ptrace_step(PtraceDebug * debug);
+static ssize_t _ptrace_read_memory(PtraceDebug * debug, uint64_t address,
+		void * buf, size_t size);
+static ssize_t _ptrace_write_memory(PtraceDebug * debug, uint64_t address,
+		void const * buf, size_t size);
+static int _ptrace_add_breakpoint(PtraceDebug * debug, uint64_t address,
+		DebuggerDebugCondition const * condition);
+static int _ptrace_remove_breakpoint(PtraceDebug * debug, uint64_t address);
 
 /* accessors */
 static void _ptrace_get_registers(PtraceDebug * debug);
 
 /* useful */
+#ifdef PTRACE_BREAKPOINT
+static int _ptrace_breakpoint_condition(PtraceDebug * debug,
+		PtraceBreakpoint * breakpoint,
+		DebuggerDebugCondition const * condition);
+#endif
+static void _ptrace_breakpoint_delete(PtraceBreakpoint * breakpoint);
+#ifdef PTRACE_BREAKPOINT
+static int _ptrace_breakpoint_evaluate(PtraceDebug * debug,
+		PtraceBreakpoint * breakpoint, struct reg const * regs);
+#endif
+static int _ptrace_breakpoint_insert(PtraceDebug * debug,
+		PtraceBreakpoint * breakpoint);
+static void _ptrace_breakpoint_report(PtraceDebug * debug);
+static int _ptrace_breakpoint_restore(PtraceDebug * debug,
+		PtraceBreakpoint * breakpoint);
+static int _ptrace_breakpoint_trap(PtraceDebug * debug);
 static void _ptrace_exit(PtraceDebug * debug);
+#ifdef PT_GETREGS
+static size_t _ptrace_registers(struct reg const * regs,
+		DebuggerDebugRegister * registers);
+#endif
 static int _ptrace_request(PtraceDebug * debug, int request, void * addr,
 		ptrace_data_t data);
 static int _ptrace_schedule(PtraceDebug * debug, int request, void * addr,
 		ptrace_data_t data);
+static void _ptrace_task_delete(PtraceTask * task);
+static void _ptrace_task_exit(PtraceDebug * debug, PtraceTask * task);
+static PtraceTask * _ptrace_task_new(PtraceDebug * debug, GPid pid,
+		gboolean attached);
+static int _ptrace_task_trap(PtraceDebug * debug, int status);
+
 
 
 /* constants */
@@ -105,7 +204,20 @@ DebuggerDebugDefinition debug =
 	_ptrace_stop,
 	_ptrace_continue,
 	_ptrace_next,
-	_ptrace_step
+	_ptrace_step,
+	_ptrace_read_memory,
+	_ptrace_write_memory,
+	_ptrace_add_breakpoint,
+	_ptrace_remove_breakpoint,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL
 };
 
 
@@ -120,18 +232,20 @@ static PtraceDebug * _ptrace_init(DebuggerDebugHelper const * helper)
 	if((debug = object_new(sizeof(*debug))) == NULL)
 		return NULL;
 	debug->helper = helper;
-	debug->pid = -1;
-	debug->source = 0;
-	debug->running = FALSE;
+	/* tasks */
+	debug->tasks = g_hash_table_new_full(g_int_hash, g_int_equal, NULL,
+			(GDestroyNotify)_ptrace_task_delete);
+	debug->task = NULL;
 	/* events */
 	memset(&debug->event, 0, sizeof(debug->event));
 #ifdef PTRACE_FORK
 	debug->event.pe_set_event = PTRACE_FORK;
 #endif
-	/* deferred requests */
-	debug->request = -1;
-	debug->addr = NULL;
-	debug->data = 0;
+	/* breakpoints */
+	debug->breakpoints = g_hash_table_new_full(g_int64_hash,
+			g_int64_equal, NULL,
+			(GDestroyNotify)_ptrace_breakpoint_delete);
+	debug->pending = NULL;
 	return debug;
 }
 
@@ -140,21 +254,26 @@ static PtraceDebug * _ptrace_init(DebuggerDebugHelper const * helper)
 static void _ptrace_destroy(PtraceDebug * debug)
 {
 	_ptrace_exit(debug);
+	g_slist_free(debug->pending);
+	g_hash_table_destroy(debug->breakpoints);
+	g_hash_table_destroy(debug->tasks);
 	object_delete(debug);
 }
 
 
 /* ptrace_start */
-static int _start_parent(PtraceDebug * debug);
+static int _start_parent(PtraceDebug * debug, GPid pid);
 /* callbacks */
 static void _start_on_child_setup(gpointer data);
 static void _start_on_child_watch(GPid pid, gint status, gpointer data);
+static int _start_on_child_watch_stopped(PtraceDebug * debug, int status);
 
 static int _ptrace_start(PtraceDebug * debug, va_list argp)
 {
 	char * argv[3] = { NULL, NULL, NULL };
 	const unsigned int flags = G_SPAWN_DO_NOT_REAP_CHILD
 		| G_SPAWN_FILE_AND_ARGV_ZERO;
+	GPid pid;
 	GError * error = NULL;
 
 	if((argv[0] = va_arg(argp, char *)) == NULL)
@@ -162,7 +281,7 @@ static int _ptrace_start(PtraceDebug * debug, va_list argp)
 				"%s", strerror(EINVAL));
 	argv[1] = argv[0];
 	if(g_spawn_async(NULL, argv, NULL, flags, _start_on_child_setup,
-				debug, &debug->pid, &error) == FALSE)
+				debug, &pid, &error) == FALSE)
 	{
 		error_set_code(-errno, "%s", error->message);
 		g_error_free(error);
@@ -170,15 +289,21 @@ static int _ptrace_start(PtraceDebug * debug, va_list argp)
 				"%s", _("Could not start execution"));
 	}
 #ifdef DEBUG
-	fprintf(stderr, "DEBUG: %s() %d\n", __func__, debug->pid);
+	fprintf(stderr, "DEBUG: %s() %d\n", __func__, pid);
 #endif
-	return _start_parent(debug);
+	return _start_parent(debug, pid);
 }
 
-static int _start_parent(PtraceDebug * debug)
+static int _start_parent(PtraceDebug * debug, GPid pid)
 {
-	debug->source = g_child_watch_add(debug->pid, _start_on_child_watch,
-			debug);
+	/* the program is traced from the start */
+	if((debug->task = _ptrace_task_new(debug, pid, TRUE)) == NULL)
+	{
+		kill(pid, SIGKILL);
+		g_spawn_close_pid(pid);
+		return -debug->helper->error(debug->helper->debugger, 1,
+				"%s", error_get(NULL));
+	}
 #ifdef PTRACE_FORK
 	_ptrace_schedule(debug, PT_SET_EVENT_MASK, &debug->event,
 			sizeof(debug->event));
@@ -203,31 +328,27 @@ static void _start_on_child_setup(gpointer data)
 
 static void _start_on_child_watch(GPid pid, gint status, gpointer data)
 {
-	PtraceDebug * debug = data;
+	PtraceTask * task = data;
+	PtraceDebug * debug = task->debug;
+	GPid current;
 
 #ifdef DEBUG
 	fprintf(stderr, "DEBUG: %s(%d, %d)\n", __func__, pid, status);
 #endif
-#ifdef G_OS_UNIX
-	if(debug->pid != pid)
+	if(task->pid != pid)
 		return;
+	/* the task is handled as the current one */
+	current = (debug->task != NULL) ? debug->task->pid : -1;
+	debug->task = task;
+#ifdef G_OS_UNIX
 	if(WIFSTOPPED(status))
 	{
 # ifdef DEBUG
 		fprintf(stderr, "DEBUG: %s() stopped\n", __func__);
 # endif
-		debug->running = FALSE;
-		if(debug->request >= 0)
-		{
-			if(_ptrace_request(debug, debug->request,
-						debug->addr, debug->data) != 0)
-			{
-				debug->request = -1;
-				return;
-			}
-			debug->running = TRUE;
-			debug->request = -1;
-		}
+		task->running = FALSE;
+		if(_start_on_child_watch_stopped(debug, status) != 0)
+			return;
 	}
 	else if(WIFSIGNALED(status))
 	{
@@ -235,8 +356,10 @@ static void _start_on_child_watch(GPid pid, gint status, gpointer data)
 		fprintf(stderr, "DEBUG: %s() signal %d\n", __func__,
 				WTERMSIG(status));
 # endif
-		debug->source = 0;
-		_ptrace_exit(debug);
+		task->source = 0;
+		if(g_hash_table_size(debug->tasks) == 1)
+			_ptrace_breakpoint_report(debug);
+		_ptrace_task_exit(debug, task);
 	}
 	else if(WIFEXITED(status))
 	{
@@ -244,14 +367,14 @@ static void _start_on_child_watch(GPid pid, gint status, gpointer data)
 		fprintf(stderr, "DEBUG: %s() error %d\n", __func__,
 				WEXITSTATUS(status));
 # endif
-		debug->source = 0;
-		_ptrace_exit(debug);
+		task->source = 0;
+		if(g_hash_table_size(debug->tasks) == 1)
+			_ptrace_breakpoint_report(debug);
+		_ptrace_task_exit(debug, task);
 	}
 #else
 	GError * error = NULL;
 
-	if(debug->pid != pid)
-		return;
 	if(g_spawn_check_exit_status(status, &error) == FALSE)
 	{
 		error_set_code(WEXITSTATUS(status), "%s", error->message);
@@ -259,9 +382,42 @@ static void _start_on_child_watch(GPid pid, gint status, gpointer data)
 		debug->helper->error(debug->helper->debugger,
 				WEXITSTATUS(status), "%s", error_get(NULL),
 	}
-	debug->source = 0;
-	_ptrace_exit(debug);
+	task->source = 0;
+	_ptrace_task_exit(debug, task);
 #endif
+	/* transparent events leave the current task alone */
+	if((task = g_hash_table_lookup(debug->tasks, &current)) != NULL)
+		debug->task = task;
+}
+
+static int _start_on_child_watch_stopped(PtraceDebug * debug, int status)
+{
+	PtraceTask * task = debug->task;
+	int request;
+
+	/* following new processes and threads is transparent */
+	if(_ptrace_task_trap(debug, status) != 0)
+		return 0;
+	/* so is stepping over breakpoints */
+	if(WSTOPSIG(status) == SIGTRAP
+			&& _ptrace_breakpoint_trap(debug) != 0)
+		return 0;
+	if((request = task->request) >= 0)
+	{
+		/* the task is gone if the request fails */
+		task->request = -1;
+		if(_ptrace_request(debug, request, task->addr, task->data)
+				!= 0)
+			return 0;
+		task->running = TRUE;
+	}
+	else
+	{
+		_ptrace_get_registers(debug);
+		_ptrace_breakpoint_report(debug);
+	}
+	/* the task stopped becomes the current one */
+	return 1;
 }
 
 
@@ -275,6 +431,15 @@ static int _ptrace_pause(PtraceDebug * debug)
 /* ptrace_stop */
 static int _ptrace_stop(PtraceDebug * debug)
 {
+	GHashTableIter iter;
+	gpointer value;
+	PtraceTask * task;
+
+	/* the other processes and threads are not waited for */
+	g_hash_table_iter_init(&iter, debug->tasks);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+		if((task = value) != debug->task)
+			kill(task->pid, SIGKILL);
 	return _ptrace_schedule(debug, PT_KILL, NULL, 0);
 }
 
@@ -304,6 +469,229 @@ static int _ptrace_step(PtraceDebug * debug)
 }
 
 
+/* ptrace_read_memory */
+static ssize_t _read_memory_words(PtraceDebug * debug, uint64_t address,
+		void * buf, size_t size);
+
+static ssize_t _ptrace_read_memory(PtraceDebug * debug, uint64_t address,
+		void * buf, size_t size)
+{
+	PtraceTask * task = debug->task;
+#if defined(PT_IO)
+	struct ptrace_io_desc pio;
+#endif
+
+	if(task == NULL)
+		return -error_set_code(1, "%s",
+				_("No process is being traced"));
+	if(size == 0)
+		return 0;
+	/* transfer as much as possible at once */
+#if defined(PT_IO)
+	pio.piod_op = PIOD_READ_D;
+	pio.piod_offs = (void *)(uintptr_t)address;
+	pio.piod_addr = buf;
+	pio.piod_len = size;
+	if(ptrace(PT_IO, task->pid, (caddr_t)&pio, 0) == 0
+			&& pio.piod_len > 0)
+		return pio.piod_len;
+#endif
+	return _read_memory_words(debug, address, buf, size);
+}
+
+static ssize_t _read_memory_words(PtraceDebug * debug, uint64_t address,
+		void * buf, size_t size)
+{
+	uint64_t a;
+	ptrace_word_t word;
+	size_t pos = 0;
+	size_t skip;
+	size_t cnt;
+
+	/* one word at a time, starting from the aligned address */
+	for(a = address - (address % sizeof(word)); pos < size;
+			a += sizeof(word))
+	{
+		errno = 0;
+		word = ptrace(PT_READ_D, debug->task->pid,
+				(caddr_t)(uintptr_t)a, 0);
+		if(errno != 0)
+			break;
+		skip = (a < address) ? address - a : 0;
+		if((cnt = sizeof(word) - skip) > size - pos)
+			cnt = size - pos;
+		memcpy((char *)buf + pos, (char *)&word + skip, cnt);
+		pos += cnt;
+	}
+	if(pos == 0)
+	{
+		error_set_code(-errno, "%s: %s", "ptrace", strerror(errno));
+		return -1;
+	}
+	return pos;
+}
+
+
+/* ptrace_write_memory */
+static ssize_t _write_memory_words(PtraceDebug * debug, uint64_t address,
+		void const * buf, size_t size);
+
+static ssize_t _ptrace_write_memory(PtraceDebug * debug, uint64_t address,
+		void const * buf, size_t size)
+{
+	PtraceTask * task = debug->task;
+#if defined(PT_IO)
+	struct ptrace_io_desc pio;
+#endif
+
+	if(task == NULL)
+		return -error_set_code(1, "%s",
+				_("No process is being traced"));
+	if(size == 0)
+		return 0;
+	/* this can also patch read-only mappings such as the code */
+#if defined(PT_IO)
+	pio.piod_op = PIOD_WRITE_D;
+	pio.piod_offs = (void *)(uintptr_t)address;
+	pio.piod_addr = (void *)buf;
+	pio.piod_len = size;
+	if(ptrace(PT_IO, task->pid, (caddr_t)&pio, 0) == 0
+			&& pio.piod_len > 0)
+		return pio.piod_len;
+#endif
+	return _write_memory_words(debug, address, buf, size);
+}
+
+static ssize_t _write_memory_words(PtraceDebug * debug, uint64_t address,
+		void const * buf, size_t size)
+{
+	PtraceTask * task = debug->task;
+	uint64_t a;
+	ptrace_word_t word;
+	size_t pos = 0;
+	size_t skip;
+	size_t cnt;
+
+	for(a = address - (address % sizeof(word)); pos < size;
+			a += sizeof(word))
+	{
+		skip = (a < address) ? address - a : 0;
+		if((cnt = sizeof(word) - skip) > size - pos)
+			cnt = size - pos;
+		errno = 0;
+		/* preserve the bytes around partial words */
+		if(cnt < sizeof(word))
+		{
+			word = ptrace(PT_READ_D, task->pid,
+					(caddr_t)(uintptr_t)a, 0);
+			if(errno != 0)
+				break;
+		}
+		memcpy((char *)&word + skip, (char const *)buf + pos, cnt);
+		if(ptrace(PT_WRITE_D, task->pid, (caddr_t)(uintptr_t)a, word)
+				== -1 && errno != 0)
+			break;
+		pos += cnt;
+	}
+	if(pos == 0)
+	{
+		error_set_code(-errno, "%s: %s", "ptrace", strerror(errno));
+		return -1;
+	}
+	return pos;
+}
+
+
+/* ptrace_add_breakpoint */
+static int _ptrace_add_breakpoint(PtraceDebug * debug, uint64_t address,
+		DebuggerDebugCondition const * condition)
+{
+#ifdef PTRACE_BREAKPOINT
+	PtraceBreakpoint * breakpoint;
+	gboolean running = (debug->task != NULL)
+		? debug->task->running : FALSE;
+
+	/* only the condition changes on existing breakpoints */
+	if((breakpoint = g_hash_table_lookup(debug->breakpoints, &address))
+			!= NULL)
+		return _ptrace_breakpoint_condition(debug, breakpoint,
+				condition);
+	breakpoint = g_new(PtraceBreakpoint, 1);
+	breakpoint->address = address;
+	breakpoint->inserted = FALSE;
+	breakpoint->condition = NULL;
+	breakpoint->condition_cnt = 0;
+	breakpoint->registers = NULL;
+	breakpoint->stack = NULL;
+	memset(&breakpoint->statistics, 0, sizeof(breakpoint->statistics));
+	breakpoint->statistics.address = address;
+	if(_ptrace_breakpoint_condition(debug, breakpoint, condition) != 0)
+	{
+		_ptrace_breakpoint_delete(breakpoint);
+		return -1;
+	}
+	g_hash_table_insert(debug->breakpoints, &breakpoint->address,
+			breakpoint);
+	if(debug->task == NULL)
+	{
+		/* inserted once the process is started */
+		debug->pending = g_slist_prepend(debug->pending, breakpoint);
+		return 0;
+	}
+	/* the process has to be stopped to patch its code */
+	if(running && _ptrace_schedule(debug, -1, NULL, 0) != 0)
+		return -1;
+	if(_ptrace_breakpoint_insert(debug, breakpoint) != 0)
+	{
+		g_hash_table_remove(debug->breakpoints, &address);
+		return -debug->helper->error(debug->helper->debugger, 1, "%s",
+				error_get(NULL));
+	}
+	if(running)
+		return _ptrace_request(debug, PT_CONTINUE, (caddr_t)1, 0);
+	return 0;
+#else
+	(void) address;
+	(void) condition;
+
+	return -debug->helper->error(debug->helper->debugger, 1, "%s",
+			_("Breakpoints are not supported on this platform"));
+#endif
+}
+
+
+/* ptrace_remove_breakpoint */
+static int _ptrace_remove_breakpoint(PtraceDebug * debug, uint64_t address)
+{
+	PtraceBreakpoint * breakpoint;
+	GHashTableIter iter;
+	gpointer value;
+	PtraceTask * task;
+	gboolean running = (debug->task != NULL)
+		? debug->task->running : FALSE;
+	int ret = 0;
+
+	if((breakpoint = g_hash_table_lookup(debug->breakpoints, &address))
+			== NULL)
+		return 0;
+	debug->pending = g_slist_remove(debug->pending, breakpoint);
+	g_hash_table_iter_init(&iter, debug->tasks);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+		if((task = value)->step_over == breakpoint)
+			task->step_over = NULL;
+	if(breakpoint->inserted)
+	{
+		if(running && _ptrace_schedule(debug, -1, NULL, 0) != 0)
+			return -1;
+		ret = _ptrace_breakpoint_restore(debug, breakpoint);
+		if(running)
+			_ptrace_request(debug, PT_CONTINUE, (caddr_t)1, 0);
+	}
+	g_hash_table_remove(debug->breakpoints, &address);
+	return ret;
+}
+
+
 /* accessors */
 /* ptrace_get_registers */
 static void _ptrace_get_registers(PtraceDebug * debug)
@@ -311,115 +699,455 @@ static void _ptrace_get_registers(PtraceDebug * debug)
 #ifdef PT_GETREGS
 	DebuggerDebugHelper const * helper = debug->helper;
 	struct reg regs;
+	DebuggerDebugRegister registers[17];
+	size_t cnt;
 
 	if(_ptrace_request(debug, PT_GETREGS, &regs, 0) != 0)
 		return;
-# if defined(__amd64__)
-	/* XXX also support 32-bits on 64-bits */
-	helper->set_register(helper->debugger, "rax", regs.regs[_REG_RAX]);
-	helper->set_register(helper->debugger, "rcx", regs.regs[_REG_RCX]);
-	helper->set_register(helper->debugger, "rdx", regs.regs[_REG_RDX]);
-	helper->set_register(helper->debugger, "rbx", regs.regs[_REG_RBX]);
-	helper->set_register(helper->debugger, "r8", regs.regs[_REG_R8]);
-	helper->set_register(helper->debugger, "r9", regs.regs[_REG_R9]);
-	helper->set_register(helper->debugger, "r10", regs.regs[_REG_R10]);
-	helper->set_register(helper->debugger, "r11", regs.regs[_REG_R11]);
-	helper->set_register(helper->debugger, "r12", regs.regs[_REG_R12]);
-	helper->set_register(helper->debugger, "r13", regs.regs[_REG_R13]);
-	helper->set_register(helper->debugger, "r14", regs.regs[_REG_R14]);
-	helper->set_register(helper->debugger, "r15", regs.regs[_REG_R15]);
-	helper->set_register(helper->debugger, "rsi", regs.regs[_REG_RSI]);
-	helper->set_register(helper->debugger, "rdi", regs.regs[_REG_RDI]);
-	helper->set_register(helper->debugger, "rsp", regs.regs[_REG_RSP]);
-	helper->set_register(helper->debugger, "rbp", regs.regs[_REG_RBP]);
-	helper->set_register(helper->debugger, "rip", regs.regs[_REG_RIP]);
-# elif defined(__i386__)
-	helper->set_register(helper->debugger, "eax", regs.r_eax);
-	helper->set_register(helper->debugger, "ecx", regs.r_ecx);
-	helper->set_register(helper->debugger, "edx", regs.r_edx);
-	helper->set_register(helper->debugger, "ebx", regs.r_ebx);
-	helper->set_register(helper->debugger, "esi", regs.r_esi);
-	helper->set_register(helper->debugger, "edi", regs.r_edi);
-	helper->set_register(helper->debugger, "esp", regs.r_esp);
-	helper->set_register(helper->debugger, "ebp", regs.r_ebp);
-	helper->set_register(helper->debugger, "eip", regs.r_eip);
-# endif
+	cnt = _ptrace_registers(&regs, registers);
+	/* report them all at once */
+	helper->set_registers(helper->debugger, registers, cnt);
+#else
+	(void) debug;
 #endif
 }
 
 
 /* useful */
+#ifdef PTRACE_BREAKPOINT
+/* ptrace_breakpoint_condition */
+static int _ptrace_breakpoint_condition(PtraceDebug * debug,
+		PtraceBreakpoint * breakpoint,
+		DebuggerDebugCondition const * condition)
+{
+	DebuggerDebugHelper const * helper = debug->helper;
+	struct reg regs;
+	DebuggerDebugRegister registers[PTRACE_REGISTERS];
+	size_t cnt;
+	size_t * indexes = NULL;
+	size_t i;
+	size_t j;
+
+	if(condition != NULL && condition_check(condition) != 0)
+		return -helper->error(helper->debugger, 1, "%s",
+				_("Invalid breakpoint condition"));
+	if(condition != NULL && condition->registers_cnt > 0)
+	{
+		/* resolve the registers once, only the names matter here */
+		memset(&regs, 0, sizeof(regs));
+		cnt = _ptrace_registers(&regs, registers);
+		indexes = g_new(size_t, condition->registers_cnt);
+		for(i = 0; i < condition->registers_cnt; i++)
+		{
+			for(j = 0; j < cnt; j++)
+				if(g_ascii_strcasecmp(condition->registers[i],
+							registers[j].name) == 0)
+					break;
+			if(j == cnt)
+			{
+				g_free(indexes);
+				return -helper->error(helper->debugger, 1,
+						"%s: %s",
+						condition->registers[i],
+						_("Unknown register"));
+			}
+			indexes[i] = j;
+		}
+	}
+	g_free(breakpoint->condition);
+	g_free(breakpoint->registers);
+	g_free(breakpoint->stack);
+	breakpoint->registers = indexes;
+	if(condition == NULL)
+	{
+		breakpoint->condition = NULL;
+		breakpoint->condition_cnt = 0;
+		breakpoint->stack = NULL;
+		return 0;
+	}
+	breakpoint->condition = g_new(DebuggerDebugInstruction,
+			condition->code_cnt);
+	memcpy(breakpoint->condition, condition->code,
+			sizeof(*condition->code) * condition->code_cnt);
+	breakpoint->condition_cnt = condition->code_cnt;
+	breakpoint->stack = g_new(uint64_t, condition->depth);
+	return 0;
+}
+#endif
+
+
+/* ptrace_breakpoint_delete */
+static void _ptrace_breakpoint_delete(PtraceBreakpoint * breakpoint)
+{
+	g_free(breakpoint->condition);
+	g_free(breakpoint->registers);
+	g_free(breakpoint->stack);
+	g_free(breakpoint);
+}
+
+
+#ifdef PTRACE_BREAKPOINT
+/* ptrace_breakpoint_evaluate */
+static uint64_t _evaluate_on_register(void * data, size_t index);
+static ssize_t _evaluate_on_read(void * data, uint64_t address, void * buf,
+		size_t size);
+
+static int _ptrace_breakpoint_evaluate(PtraceDebug * debug,
+		PtraceBreakpoint * breakpoint, struct reg const * regs)
+{
+	DebuggerDebugRegister registers[PTRACE_REGISTERS];
+	PtraceEvaluation evaluation = { debug, breakpoint, registers };
+	ConditionHelper helper = { &evaluation, _evaluate_on_register,
+		_evaluate_on_read };
+	struct timespec start;
+	struct timespec end;
+	int ret;
+
+	if(breakpoint->condition == NULL)
+		return 1;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	_ptrace_registers(regs, registers);
+	/* stop on errors too, as if the condition held */
+	ret = (condition_evaluate(breakpoint->condition,
+				breakpoint->condition_cnt, breakpoint->stack,
+				breakpoint->statistics.hits, &helper) != 0)
+		? 1 : 0;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	breakpoint->statistics.evaluation += (end.tv_sec - start.tv_sec)
+		* 1000000000 + end.tv_nsec - start.tv_nsec;
+	return ret;
+}
+
+static uint64_t _evaluate_on_register(void * data, size_t index)
+{
+	PtraceEvaluation * evaluation = data;
+
+	return evaluation->registers[evaluation->breakpoint->registers[index]]
+		.value;
+}
+
+static ssize_t _evaluate_on_read(void * data, uint64_t address, void * buf,
+		size_t size)
+{
+	PtraceEvaluation * evaluation = data;
+
+	return _ptrace_read_memory(evaluation->debug, address, buf, size);
+}
+#endif
+
+
+/* ptrace_breakpoint_insert */
+static int _ptrace_breakpoint_insert(PtraceDebug * debug,
+		PtraceBreakpoint * breakpoint)
+{
+#ifdef PTRACE_BREAKPOINT
+	size_t size = sizeof(breakpoint->code);
+
+	if(breakpoint->inserted)
+		return 0;
+	if(_ptrace_read_memory(debug, breakpoint->address, breakpoint->code,
+				size) != (ssize_t)size
+			|| _ptrace_write_memory(debug, breakpoint->address,
+				PTRACE_BREAKPOINT, size) != (ssize_t)size)
+		return -1;
+	breakpoint->inserted = TRUE;
+	return 0;
+#else
+	(void) debug;
+	(void) breakpoint;
+
+	return -1;
+#endif
+}
+
+
+/* ptrace_breakpoint_report */
+static void _ptrace_breakpoint_report(PtraceDebug * debug)
+{
+	DebuggerDebugHelper const * helper = debug->helper;
+	DebuggerDebugBreakpoint * breakpoints;
+	size_t cnt = 0;
+	GHashTableIter iter;
+	gpointer value;
+
+	if(g_hash_table_size(debug->breakpoints) == 0)
+		return;
+	breakpoints = g_new(DebuggerDebugBreakpoint,
+			g_hash_table_size(debug->breakpoints));
+	g_hash_table_iter_init(&iter, debug->breakpoints);
+	while(g_hash_table_iter_next(&iter, NULL, &value))
+		breakpoints[cnt++] = ((PtraceBreakpoint *)value)->statistics;
+	helper->set_breakpoints(helper->debugger, breakpoints, cnt);
+	g_free(breakpoints);
+}
+
+
+/* ptrace_breakpoint_restore */
+static int _ptrace_breakpoint_restore(PtraceDebug * debug,
+		PtraceBreakpoint * breakpoint)
+{
+#ifdef PTRACE_BREAKPOINT
+	size_t size = sizeof(breakpoint->code);
+
+	if(!breakpoint->inserted)
+		return 0;
+	if(_ptrace_write_memory(debug, breakpoint->address, breakpoint->code,
+				size) != (ssize_t)size)
+		return -1;
+	breakpoint->inserted = FALSE;
+	return 0;
+#else
+	(void) debug;
+	(void) breakpoint;
+
+	return -1;
+#endif
+}
+
+
+/* ptrace_breakpoint_trap */
+static int _ptrace_breakpoint_trap(PtraceDebug * debug)
+{
+#ifdef PTRACE_BREAKPOINT
+	PtraceTask * task = debug->task;
+	PtraceBreakpoint * breakpoint;
+	struct reg regs;
+	uint64_t address;
+	int request;
+
+	if((breakpoint = task->step_over) != NULL)
+	{
+		/* stepped over the breakpoint: put it back */
+		task->step_over = NULL;
+		_ptrace_breakpoint_insert(debug, breakpoint);
+		request = task->resume;
+		task->resume = -1;
+		if(request == PT_STEP)
+			return 0;
+		return (_ptrace_request(debug, request, (caddr_t)1, 0) == 0)
+			? 1 : 0;
+	}
+	if(ptrace(PT_GETREGS, task->pid, (caddr_t)&regs, 0) == -1)
+		return 0;
+	/* the trap leaves the program counter after the breakpoint */
+	address = PTRACE_PC(regs) - (sizeof(PTRACE_BREAKPOINT) - 1);
+	if((breakpoint = g_hash_table_lookup(debug->breakpoints, &address))
+			== NULL || !breakpoint->inserted)
+		return 0;
+	PTRACE_PC(regs) = address;
+	if(ptrace(PT_SETREGS, task->pid, (caddr_t)&regs, 0) == -1
+			|| _ptrace_breakpoint_restore(debug, breakpoint) != 0)
+		return 0;
+	task->step_over = breakpoint;
+	breakpoint->statistics.hits++;
+	/* resume right away unless stepping or the condition holds */
+	if(task->resumed >= 0 && task->resumed != PT_STEP
+			&& _ptrace_breakpoint_evaluate(debug, breakpoint,
+				&regs) == 0)
+		return (_ptrace_request(debug, task->resumed, (caddr_t)1, 0)
+				== 0) ? 1 : 0;
+	breakpoint->statistics.stops++;
+	/* report the breakpoint */
+	return 0;
+#else
+	(void) debug;
+
+	return 0;
+#endif
+}
+
+
 /* ptrace_exit */
+static void _exit_foreach(gpointer key, gpointer value, gpointer data);
+
 static void _ptrace_exit(PtraceDebug * debug)
 {
-	if(debug->source != 0)
-		g_source_remove(debug->source);
-	debug->source = 0;
-	if(debug->pid > 0)
-		g_spawn_close_pid(debug->pid);
-	debug->pid = -1;
-	debug->running = FALSE;
-	debug->request = -1;
-	debug->addr = NULL;
-	debug->data = 0;
+	g_hash_table_remove_all(debug->tasks);
+	debug->task = NULL;
+	/* the breakpoints will be inserted again on the next run */
+	g_slist_free(debug->pending);
+	debug->pending = NULL;
+	g_hash_table_foreach(debug->breakpoints, _exit_foreach, debug);
+}
+
+static void _exit_foreach(gpointer key, gpointer value, gpointer data)
+{
+	PtraceBreakpoint * breakpoint = value;
+	PtraceDebug * debug = data;
+	(void) key;
+
+	breakpoint->inserted = FALSE;
+	debug->pending = g_slist_prepend(debug->pending, breakpoint);
 }
 
 
+
+/* ptrace_registers */
+#ifdef PT_GETREGS
+static size_t _ptrace_registers(struct reg const * regs,
+		DebuggerDebugRegister * registers)
+{
+	size_t cnt = 0;
+
+# if defined(__amd64__)
+	/* XXX also support 32-bits on 64-bits */
+	registers[cnt].name = "rax";
+	registers[cnt++].value = regs->regs[_REG_RAX];
+	registers[cnt].name = "rcx";
+	registers[cnt++].value = regs->regs[_REG_RCX];
+	registers[cnt].name = "rdx";
+	registers[cnt++].value = regs->regs[_REG_RDX];
+	registers[cnt].name = "rbx";
+	registers[cnt++].value = regs->regs[_REG_RBX];
+	registers[cnt].name = "r8";
+	registers[cnt++].value = regs->regs[_REG_R8];
+	registers[cnt].name = "r9";
+	registers[cnt++].value = regs->regs[_REG_R9];
+	registers[cnt].name = "r10";
+	registers[cnt++].value = regs->regs[_REG_R10];
+	registers[cnt].name = "r11";
+	registers[cnt++].value = regs->regs[_REG_R11];
+	registers[cnt].name = "r12";
+	registers[cnt++].value = regs->regs[_REG_R12];
+	registers[cnt].name = "r13";
+	registers[cnt++].value = regs->regs[_REG_R13];
+	registers[cnt].name = "r14";
+	registers[cnt++].value = regs->regs[_REG_R14];
+	registers[cnt].name = "r15";
+	registers[cnt++].value = regs->regs[_REG_R15];
+	registers[cnt].name = "rsi";
+	registers[cnt++].value = regs->regs[_REG_RSI];
+	registers[cnt].name = "rdi";
+	registers[cnt++].value = regs->regs[_REG_RDI];
+	registers[cnt].name = "rsp";
+	registers[cnt++].value = regs->regs[_REG_RSP];
+	registers[cnt].name = "rbp";
+	registers[cnt++].value = regs->regs[_REG_RBP];
+	registers[cnt].name = "rip";
+	registers[cnt++].value = regs->regs[_REG_RIP];
+# elif defined(__i386__)
+	registers[cnt].name = "eax";
+	registers[cnt++].value = regs->r_eax;
+	registers[cnt].name = "ecx";
+	registers[cnt++].value = regs->r_ecx;
+	registers[cnt].name = "edx";
+	registers[cnt++].value = regs->r_edx;
+	registers[cnt].name = "ebx";
+	registers[cnt++].value = regs->r_ebx;
+	registers[cnt].name = "esi";
+	registers[cnt++].value = regs->r_esi;
+	registers[cnt].name = "edi";
+	registers[cnt++].value = regs->r_edi;
+	registers[cnt].name = "esp";
+	registers[cnt++].value = regs->r_esp;
+	registers[cnt].name = "ebp";
+	registers[cnt++].value = regs->r_ebp;
+	registers[cnt].name = "eip";
+	registers[cnt++].value = regs->r_eip;
+# endif
+	return cnt;
+}
+#endif
+
+
 /* ptrace_request */
+static int _request_resume(PtraceDebug * debug, int request);
+
 static int _ptrace_request(PtraceDebug * debug, int request, void * addr,
 		int data)
 {
+	PtraceTask * task = debug->task;
+	int resume;
+
+	if(task == NULL)
+		return -1;
 #ifdef DEBUG
 	fprintf(stderr, "DEBUG: %s(%d, %p, %d) %d\n", __func__, request, addr,
-			data, debug->pid);
+			data, task->pid);
 #endif
-	if(debug->pid <= 0)
-		return -1;
+	if((resume = _request_resume(debug, request)) >= 0)
+		request = resume;
 	errno = 0;
-	if(ptrace(request, debug->pid, addr, data) == -1 && errno != 0)
+	if(ptrace(request, task->pid, addr, data) == -1 && errno != 0)
 	{
 		error_set_code(-errno, "%s: %s", "ptrace", strerror(errno));
 		if(errno == ESRCH)
-			_ptrace_exit(debug);
+			_ptrace_task_exit(debug, task);
 		return -debug->helper->error(debug->helper->debugger, 1,
 				"%s", error_get(NULL));
 	}
-	debug->running = TRUE;
+	/* only some requests let the process run */
+	if(resume >= 0)
+		task->running = TRUE;
 	return 0;
 }
 
+static int _request_resume(PtraceDebug * debug, int request)
+{
+	PtraceTask * task = debug->task;
+	PtraceBreakpoint * breakpoint;
+
+	switch(request)
+	{
+		case PT_CONTINUE:
+		case PT_STEP:
+#ifdef PT_SYSCALL
+		case PT_SYSCALL:
+#endif
+			break;
+		default:
+			return -1;
+	}
+	task->resumed = request;
+	/* step over the breakpoint hit first */
+	if(task->step_over != NULL)
+	{
+		task->resume = request;
+		return PT_STEP;
+	}
+	while(debug->pending != NULL)
+	{
+		breakpoint = debug->pending->data;
+		debug->pending = g_slist_delete_link(debug->pending,
+				debug->pending);
+		_ptrace_breakpoint_insert(debug, breakpoint);
+	}
+	return request;
+}
+
 
 /* ptrace_schedule */
 static int _ptrace_schedule(PtraceDebug * debug, int request, void * addr,
 		int data)
 {
+	PtraceTask * task = debug->task;
 	DebuggerDebugHelper const * helper = debug->helper;
 
 #ifdef DEBUG
 	fprintf(stderr, "DEBUG: %s(%d, %p, %d)\n", __func__, request, addr,
 			data);
 #endif
-	if(debug->running)
+	if(task != NULL && task->running)
 	{
 		/* stop the traced process */
-		if(kill(debug->pid, SIGSTOP) != 0)
+		if(kill(task->pid, SIGSTOP) != 0)
 		{
 			error_set_code(-errno, "%s: %s", "kill",
 					strerror(errno));
 			if(errno == ESRCH)
-				_ptrace_exit(debug);
+				_ptrace_task_exit(debug, task);
 			return -helper->error(helper->debugger, 1,
 					"%s", "Could not schedule command"
 					" (could not stop the traced process)");
 		}
-		debug->running = FALSE;
-		wait(NULL);
+		task->running = FALSE;
+		waitpid(task->pid, NULL, 0);
 		if(request < 0)
 			return 0;
 		/* schedule the request */
-		debug->request = request;
-		debug->addr = addr;
-		debug->data = data;
+		task->request = request;
+		task->addr = addr;
+		task->data = data;
 		return 0;
 	}
 	if(request < 0)
@@ -427,3 +1155,108 @@ static int _ptrace_schedule(PtraceDebug * debug, int request, void * addr,
 	/* we can issue the request directly */
 	return (_ptrace_request(debug, request, addr, data) == 0) ? 0 : -1;
 }
+
+
+/* ptrace_task_delete */
+static void _ptrace_task_delete(PtraceTask * task)
+{
+	if(task->source != 0)
+		g_source_remove(task->source);
+	g_spawn_close_pid(task->pid);
+	g_free(task);
+}
+
+
+/* ptrace_task_exit */
+static void _ptrace_task_exit(PtraceDebug * debug, PtraceTask * task)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s() %d\n", __func__, task->pid);
+#endif
+	/* the last task to exit ends the program */
+	if(g_hash_table_size(debug->tasks) <= 1)
+	{
+		_ptrace_exit(debug);
+		return;
+	}
+	if(debug->task == task)
+		debug->task = NULL;
+	g_hash_table_remove(debug->tasks, &task->pid);
+	if(debug->task != NULL)
+		return;
+	/* any task left becomes the current one */
+	g_hash_table_iter_init(&iter, debug->tasks);
+	if(g_hash_table_iter_next(&iter, NULL, &value))
+		debug->task = value;
+}
+
+
+/* ptrace_task_new */
+static PtraceTask * _ptrace_task_new(PtraceDebug * debug, GPid pid,
+		gboolean attached)
+{
+	PtraceTask * task;
+
+	if((task = g_hash_table_lookup(debug->tasks, &pid)) != NULL)
+		return task;
+	if((task = object_new(sizeof(*task))) == NULL)
+		return NULL;
+	task->debug = debug;
+	task->pid = pid;
+	task->running = FALSE;
+	task->attached = attached;
+	/* deferred requests */
+	task->request = -1;
+	task->addr = NULL;
+	task->data = 0;
+	/* breakpoints */
+	task->step_over = NULL;
+	task->resume = -1;
+	task->resumed = -1;
+	task->source = g_child_watch_add(pid, _start_on_child_watch, task);
+	g_hash_table_insert(debug->tasks, &task->pid, task);
+	return task;
+}
+
+
+/* ptrace_task_trap */
+static int _ptrace_task_trap(PtraceDebug * debug, int status)
+{
+#if defined(PTRACE_FORK)
+	PtraceTask * task = debug->task;
+	ptrace_state_t state;
+	GPid pid;
+
+	if(WSTOPSIG(status) != SIGTRAP
+			|| ptrace(PT_GET_PROCESS_STATE, task->pid,
+				(caddr_t)&state, sizeof(state)) == -1
+			|| state.pe_report_event != PTRACE_FORK)
+		return 0;
+	if(task->attached == FALSE)
+	{
+		/* the events are not inherited */
+		task->attached = TRUE;
+		ptrace(PT_SET_EVENT_MASK, task->pid, (caddr_t)&debug->event,
+				sizeof(debug->event));
+	}
+	pid = state.pe_other_pid;
+# ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s() %d: new task %d\n", __func__, task->pid,
+			(int)pid);
+# endif
+	/* both the parent and the child report the fork on some systems */
+	if(_ptrace_task_new(debug, pid, FALSE) == NULL)
+		debug->helper->error(debug->helper->debugger, 1, "%s",
+				error_get(NULL));
+	return (_ptrace_request(debug, (task->resumed >= 0) ? task->resumed
+				: PT_CONTINUE, (caddr_t)1, 0) == 0) ? 1 : 0;
+#else
+	(void) debug;
+	(void) status;
+
+	return 0;
+#endif
+}
@@ -26,6 +26,7 @@
 
 
 #include <unistd.h>
+#include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <locale.h>
@@ -70,9 +71,13 @@ static int _error(char const * message, int ret)
 /* usage */
 static int _usage(void)
 {
-	fprintf(stderr, _("Usage: %s [-b backend][-d debug] [filename]\n"
+	fprintf(stderr, _("Usage: %s [-b backend][-d debug][-s size]"
+"[-t syscalls][-T tracepoints] [filename]\n"
 "  -b	Analysis backend to load\n"
-"  -d	Debugging backend to load\n"),
+"  -d	Debugging backend to load\n"
+"  -s	Bytes of stack to display\n"
+"  -t	System calls to trace, separated by commas\n"
+"  -T	Tracepoints to set, separated by commas\n"),
 			PROGNAME_DEBUGGER);
 	return 1;
 }
@@ -86,6 +91,7 @@ int main(int argc, char * argv[])
 	int o;
 	Debugger * debugger;
 	DebuggerPrefs prefs;
+	char * p;
 
 	if(setlocale(LC_ALL, "") == NULL)
 		_error("setlocale", 1);
@@ -93,7 +99,7 @@ int main(int argc, char * argv[])
 	textdomain(PACKAGE);
 	gtk_init(&argc, &argv);
 	memset(&prefs, 0, sizeof(prefs));
-	while((o = getopt(argc, argv, "b:d:")) != -1)
+	while((o = getopt(argc, argv, "b:d:s:t:T:")) != -1)
 		switch(o)
 		{
 			case 'b':
@@ -102,6 +108,18 @@ int main(int argc, char * argv[])
 			case 'd':
 				prefs.debug = optarg;
 				break;
+			case 's':
+				prefs.stack = strtoul(optarg, &p, 0);
+				if(optarg[0] == '\0' || *p != '\0'
+						|| prefs.stack == 0)
+					return _usage();
+				break;
+			case 't':
+				prefs.syscalls = optarg;
+				break;
+			case 'T':
+				prefs.tracepoints = optarg;
+				break;
 			default:
 				return _usage();
 		}
@@ -28,21 +28,28 @@ static char const _debugger_license[] =
 
 
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <inttypes.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include <ctype.h>
 #include <errno.h>
 #include <libintl.h>
 #include <gtk/gtk.h>
 #include <gdk/gdkkeysyms.h>
 #include <Desktop.h>
 #include "backend.h"
+#include "callgraph.h"
+#include "condition.h"
 #include "debug.h"
 #include "debugger.h"
+#include "disassembly.h"
+#include "hexdump.h"
+#include "search.h"
 #include "../config.h"
 #define _(string) gettext(string)
 #define N_(string) (string)
@@ -55,9 +62,121 @@ static char const _debugger_license[] =
 /* Debugger */
 /* private */
 /* types */
-enum { NP_DISASSEMBLY = 0, NP_CALL_GRAPH, NP_HEXDUMP };
+enum { NP_DISASSEMBLY = 0, NP_CALL_GRAPH, NP_HEXDUMP, NP_PROFILE,
+	NP_SYSCALLS, NP_BREAKPOINTS, NP_TRACEPOINTS };
 
-enum { CP_REGISTERS = 0, CP_STACK };
+enum { CP_REGISTERS = 0, CP_STACK, CP_THREADS };
+
+/* profile: samples per second by default */
+#define PROFILE_FREQUENCY	1000
+
+/* checkpoints: kept at most, and stops between the automatic ones */
+#define CHECKPOINTS_MAX		8
+#define CHECKPOINTS_INTERVAL	32
+
+/* call graph: spacing between the nodes and columns (in pixels) */
+#define CALL_GRAPH_MARGIN	8
+
+/* disassembly: bytes decoded at once, blocks displayed and kept decoded */
+#define DISASSEMBLY_BLOCK	4096
+#define DISASSEMBLY_BLOCKS_MAX	16
+#define DISASSEMBLY_CACHE	64
+
+#define HEXDUMP_HIT_NONE	((size_t)-1)
+
+/* stack: bytes displayed above the stack pointer by default */
+#define STACK_SIZE		4096
+
+/* loading special files: block size, time budget per slice (us), limit */
+#define HEXDUMP_LOAD_BLOCK	(256 * 1024)
+#define HEXDUMP_LOAD_BUDGET	8000
+#define HEXDUMP_LOAD_MAX	(64 * 1024 * 1024)
+
+typedef struct _CallGraphNode
+{
+	/* CALLGRAPH_NONE for the remaining nodes not displayed */
+	size_t function;
+	size_t more;
+	GdkRectangle area;
+} CallGraphNode;
+
+typedef struct _DisassemblyRange
+{
+	off_t offset;
+	/* as requested, to look the block up again */
+	size_t size;
+	off_t end;
+	size_t lines;
+} DisassemblyRange;
+
+typedef struct _DebuggerRegister
+{
+	GtkTreeIter iter;
+	unsigned int size;
+	uint64_t value;
+	gboolean set;
+} DebuggerRegister;
+
+typedef enum _CheckpointCommand
+{
+	CC_NONE = 0, CC_CONTINUE, CC_NEXT, CC_STEP
+} CheckpointCommand;
+
+typedef struct _Checkpoint
+{
+	int id;
+	/* stops before it */
+	size_t position;
+} Checkpoint;
+
+typedef struct _CheckpointDelta
+{
+	DebuggerRegister const * reg;
+	uint64_t value;
+} CheckpointDelta;
+
+/* a command, and the registers it changed once stopped */
+typedef struct _CheckpointStop
+{
+	CheckpointCommand command;
+	CheckpointDelta * deltas;
+	size_t deltas_cnt;
+} CheckpointStop;
+
+typedef enum _BreakpointValue
+{
+	BV_ADDRESS = 0, BV_ADDRESS_DISPLAY, BV_CONDITION, BV_EXPRESSION,
+	BV_HITS, BV_HITS_DISPLAY, BV_STOPS, BV_STOPS_DISPLAY, BV_EVALUATION,
+	BV_EVALUATION_DISPLAY
+} BreakpointValue;
+#define BV_LAST BV_EVALUATION_DISPLAY
+#define BV_COUNT (BV_LAST + 1)
+
+typedef enum _ProfileValue
+{
+	PV_NAME = 0, PV_SAMPLES, PV_SAMPLES_DISPLAY, PV_SELF_DISPLAY, PV_TOTAL,
+	PV_TOTAL_DISPLAY
+} ProfileValue;
+#define PV_LAST PV_TOTAL_DISPLAY
+#define PV_COUNT (PV_LAST + 1)
+
+typedef enum _SyscallValue
+{
+	SCV_NAME = 0, SCV_CALLS, SCV_CALLS_DISPLAY, SCV_TOTAL,
+	SCV_TOTAL_DISPLAY, SCV_AVERAGE, SCV_AVERAGE_DISPLAY, SCV_MAXIMUM,
+	SCV_MAXIMUM_DISPLAY, SCV_LATENCY_DISPLAY
+} SyscallValue;
+#define SCV_LAST SCV_LATENCY_DISPLAY
+#define SCV_COUNT (SCV_LAST + 1)
+
+typedef enum _TracepointValue
+{
+	TV_ADDRESS = 0, TV_ADDRESS_DISPLAY, TV_STATUS, TV_EVENTS,
+	TV_EVENTS_DISPLAY, TV_DROPPED, TV_DROPPED_DISPLAY, TV_THREAD,
+	TV_ARGUMENTS
+} TracepointValue;
+#define TV_LAST TV_ARGUMENTS
+#define TV_COUNT (TV_LAST + 1)
 
 typedef enum _RegisterValue
 {
@@ -73,6 +192,13 @@ typedef enum _StackValue
 #define SV_LAST SV_VALUE_DISPLAY
 #define SV_COUNT (SV_LAST + 1)
 
+typedef enum _ThreadValue
+{
+	THV_ID = 0, THV_ID_DISPLAY, THV_SIGNAL_DISPLAY
+} ThreadValue;
+#define THV_LAST THV_SIGNAL_DISPLAY
+#define THV_COUNT (THV_LAST + 1)
+
 struct _Debugger
 {
 	DebuggerPrefs prefs;
@@ -82,43 +208,120 @@ struct _Debugger
 	Plugin * bplugin;
 	DebuggerBackendDefinition * bdefinition;
 	DebuggerBackend * backend;
+	AsmSection const * sections;
+	size_t sections_cnt;
+	AsmFunction const * functions;
+	size_t functions_cnt;
 
 	/* debug */
 	DebuggerDebugHelper dhelper;
 	Plugin * dplugin;
 	DebuggerDebugDefinition * ddefinition;
 	DebuggerDebug * debug;
+	/* where the program runs, relative to where it was linked */
+	uint64_t bias;
 
 	/* child */
 	String * filename;
 	guint source;
-	FILE * fp;
-	size_t pos;
+
+	/* checkpoints, the oldest first */
+	GArray * chk_checkpoints;
+	/* stops since the oldest checkpoint, the first one at chk_base */
+	GArray * chk_history;
+	size_t chk_base;
+	size_t chk_position;
+	/* the command issued, until it stops */
+	CheckpointCommand chk_pending;
+	/* replaying the commands recorded until chk_target */
+	gboolean chk_replay;
+	size_t chk_target;
+	guint chk_source;
 
 	/* widgets */
 	PangoFontDescription * bold;
 	PangoFontDescription * monospace;
 	GtkWidget * window;
 	GtkWidget * notebook;
+	/* breakpoints, with their condition compiled */
+	GtkWidget * brk_view;
+	GtkListStore * brk_store;
+	GtkWidget * brk_tree;
 	/* call graph */
 	GtkWidget * dcg_view;
+	CallGraph const * dcg_graph;
+	size_t dcg_focus;
+	GArray * dcg_nodes;
+	gboolean dcg_layout;
+	int dcg_height;
 	/* disassembly */
 	GtkWidget * das_view;
 	GtkTextBuffer * das_tbuf;
+	GtkAdjustment * das_adjustment;
+	GtkTextMark * das_top;
+	GtkTextTag * das_pc_tag;
+	Disassembly * das;
+	AsmSection const * das_section;
+	GArray * das_ranges;
+	off_t das_pc;
+	gboolean das_busy;
 	/* hexdump */
 	GtkWidget * dhx_view;
-	GtkTextBuffer * dhx_tbuf;
-	GtkTextIter dhx_iter;
+	GtkAdjustment * dhx_adjustment;
+	GMappedFile * dhx_mapped;
+	GByteArray * dhx_buffer;
+	GIOChannel * dhx_channel;
+	unsigned char const * dhx_data;
+	size_t dhx_size;
+	size_t dhx_total;
+	int dhx_height;
+	/* hexdump: search */
+	GtkWidget * dhx_search_type;
+	GtkWidget * dhx_search_entry;
+	GtkWidget * dhx_search_label;
+	Search * dhx_search;
+	guint dhx_search_source;
+	size_t dhx_search_hit;
+	/* profile */
+	GtkWidget * prf_view;
+	GtkListStore * prf_store;
+	/* samples including the callees, by function */
+	uint64_t * prf_total;
+	uint64_t prf_samples;
+	/* system calls */
+	GtkWidget * sys_view;
+	GtkListStore * sys_store;
+	/* traced from the next run */
+	gchar ** sys_selection;
+	/* kept for exporting */
+	DebuggerDebugSyscall * sys_syscalls;
+	size_t sys_syscalls_cnt;
+	/* tracepoints */
+	GtkWidget * trc_view;
+	GtkListStore * trc_store;
+	/* set from the next run */
+	gchar ** trc_selection;
 	/* combo */
 	GtkWidget * combo;
 	/* registers */
 	GtkWidget * reg_view;
 	GtkListStore * reg_store;
 	GtkWidget * reg_tree;
+	GHashTable * reg_index;
 	/* stack */
 	GtkWidget * stk_view;
 	GtkListStore * stk_store;
 	GtkWidget * stk_tree;
+	/* stack: values currently displayed, from stk_address */
+	GArray * stk_values;
+	uint64_t stk_address;
+	size_t stk_word;
+	/* threads, as found in the file analysed */
+	GtkWidget * thr_view;
+	GtkListStore * thr_store;
+	GtkWidget * thr_tree;
+	DebuggerBackendThread const * thr_threads;
+	size_t thr_threads_cnt;
 	/* statusbar */
 	GtkWidget * statusbar;
 };
@@ -128,41 +331,182 @@ struct _Debugger
 /* accessors */
 static void _debugger_set_sensitive_toolbar(Debugger * debugger, gboolean run,
 		gboolean debug);
+static void _debugger_set_status(Debugger * debugger, char const * status);
 
 /* useful */
+static int _debugger_address(Debugger * debugger, off_t offset,
+		uint64_t * address);
+static int _debugger_breakpoints_address(Debugger * debugger,
+		char const * string, uint64_t * address);
+static void _debugger_breakpoints_clear(Debugger * debugger);
+static gboolean _debugger_breakpoints_find(Debugger * debugger,
+		uint64_t address, GtkTreeIter * iter);
+static int _debugger_breakpoints_select(Debugger * debugger);
+
+static void _debugger_call_graph_close(Debugger * debugger);
+static void _debugger_call_graph_focus(Debugger * debugger, size_t function);
+static void _debugger_call_graph_layout(Debugger * debugger, int width,
+		int height);
+
+static int _debugger_checkpoints_add(Debugger * debugger);
+static void _debugger_checkpoints_close(Debugger * debugger);
+static int _debugger_checkpoints_command(Debugger * debugger,
+		CheckpointCommand command);
+static void _debugger_checkpoints_record(Debugger * debugger,
+		CheckpointStop * stop);
+static int _debugger_checkpoints_replay(Debugger * debugger, size_t target);
+static void _debugger_checkpoints_stopped(Debugger * debugger,
+		GArray * deltas);
+
 static gboolean _debugger_confirm(Debugger * debugger, char const * message);
 static gboolean _debugger_confirm_close(Debugger * debugger);
 static gboolean _debugger_confirm_reset(Debugger * debugger);
 
-static void _debugger_hexdump_append(Debugger * debugger, size_t pos,
-		char const * buf, size_t size);
+static int _debugger_disassembly_append(Debugger * debugger);
+static void _debugger_disassembly_close(Debugger * debugger);
+static void _debugger_disassembly_delete_lines(Debugger * debugger,
+		size_t line, size_t lines);
+static void _debugger_disassembly_goto(Debugger * debugger,
+		AsmSection const * section, off_t offset);
+static void _debugger_disassembly_goto_address(Debugger * debugger,
+		uint64_t address);
+static int _debugger_disassembly_highlight(Debugger * debugger);
+static int _debugger_disassembly_prepend(Debugger * debugger);
+
+static void _debugger_hexdump_close(Debugger * debugger);
+static int _debugger_hexdump_open(Debugger * debugger);
+static int _debugger_hexdump_search(Debugger * debugger);
+static void _debugger_hexdump_search_goto(Debugger * debugger, size_t hit);
+static void _debugger_hexdump_search_status(Debugger * debugger);
+static void _debugger_hexdump_search_stop(Debugger * debugger);
+static void _debugger_hexdump_update(Debugger * debugger);
+
+static AsmSection const * _debugger_offset(Debugger * debugger,
+		uint64_t address, off_t * offset);
+
+static void _debugger_profile_close(Debugger * debugger);
+static size_t _debugger_profile_function(Debugger * debugger,
+		uint64_t address);
+
+static void _debugger_stack_close(Debugger * debugger);
+static void _debugger_stack_update(Debugger * debugger, uint64_t address,
+		unsigned int size);
+
+static gchar ** _debugger_split(char const * string);
+
+static void _debugger_syscalls_close(Debugger * debugger);
+static void _debugger_syscalls_duration(char * buf, size_t size,
+		uint64_t duration);
+static int _debugger_syscalls_select(Debugger * debugger);
+
+static void _debugger_threads_close(Debugger * debugger);
+
+static void _debugger_tracepoints_close(Debugger * debugger);
+static int _debugger_tracepoints_select(Debugger * debugger);
 
 /* helpers */
 static int _debugger_helper_error(Debugger * debugger, int code,
 		char const * format, ...);
+static void _debugger_helper_set_bias(Debugger * debugger, uint64_t bias);
+static void _debugger_helper_set_breakpoints(Debugger * debugger,
+		DebuggerDebugBreakpoint const * breakpoints,
+		size_t breakpoints_cnt);
+static void _debugger_helper_set_checkpoint(Debugger * debugger,
+		int checkpoint, int result);
+static void _debugger_helper_set_profile(Debugger * debugger,
+		DebuggerDebugSample const * samples, size_t samples_cnt,
+		uint64_t duration);
 static void _debugger_helper_set_register(Debugger * debugger,
 		char const * name, uint64_t value);
+static void _debugger_helper_set_registers(Debugger * debugger,
+		DebuggerDebugRegister const * registers, size_t registers_cnt);
+static void _debugger_helper_set_syscalls(Debugger * debugger,
+		DebuggerDebugSyscall const * syscalls, size_t syscalls_cnt);
+static void _debugger_helper_set_tracepoints(Debugger * debugger,
+		DebuggerDebugTracepoint const * tracepoints,
+		size_t tracepoints_cnt);
 /* backend */
+static void _debugger_helper_backend_set_call_graph(Debugger * debugger,
+		CallGraph const * graph);
+static void _debugger_helper_backend_set_functions(Debugger * debugger,
+		AsmFunction const * functions, size_t functions_cnt);
 static void _debugger_helper_backend_set_registers(Debugger * debugger,
 		AsmArchRegister const * registers, size_t registers_cnt);
+static void _debugger_helper_backend_set_sections(Debugger * debugger,
+		AsmSection const * sections, size_t sections_cnt);
+static void _debugger_helper_backend_set_threads(Debugger * debugger,
+		DebuggerBackendThread const * threads, size_t threads_cnt);
 
 /* callbacks */
 static void _debugger_on_about(gpointer data);
+static void _debugger_on_breakpoint_add(gpointer data);
+static void _debugger_on_breakpoint_remove(gpointer data);
+static gboolean _debugger_on_call_graph_button_press(GtkWidget * widget,
+		GdkEventButton * event, gpointer data);
+#if GTK_CHECK_VERSION(3, 0, 0)
+static gboolean _debugger_on_call_graph_draw(GtkWidget * widget, cairo_t * cr,
+		gpointer data);
+#else
+static gboolean _debugger_on_call_graph_expose(GtkWidget * widget,
+		GdkEventExpose * event, gpointer data);
+#endif
+static void _debugger_on_call_graph_size_allocate(GtkWidget * widget,
+		GtkAllocation * allocation, gpointer data);
+static void _debugger_on_checkpoint(gpointer data);
+static gboolean _debugger_on_checkpoints_replay(gpointer data);
 static void _debugger_on_close(gpointer data);
 static gboolean _debugger_on_closex(gpointer data);
 static void _debugger_on_continue(gpointer data);
-static gboolean _debugger_on_idle(gpointer data);
+static int _debugger_on_disassembly_decode(void * data, off_t offset,
+		size_t size, off_t base, AsmArchInstructionCall ** calls,
+		size_t * calls_cnt);
+static void _debugger_on_disassembly_value_changed(gpointer data);
+#if GTK_CHECK_VERSION(3, 0, 0)
+static gboolean _debugger_on_hexdump_draw(GtkWidget * widget, cairo_t * cr,
+		gpointer data);
+#else
+static gboolean _debugger_on_hexdump_expose(GtkWidget * widget,
+		GdkEventExpose * event, gpointer data);
+#endif
+static gboolean _debugger_on_hexdump_key_press(GtkWidget * widget,
+		GdkEventKey * event, gpointer data);
+static gboolean _debugger_on_hexdump_read(GIOChannel * source,
+		GIOCondition condition, gpointer data);
+static gboolean _debugger_on_hexdump_scroll(GtkWidget * widget,
+		GdkEventScroll * event, gpointer data);
+static void _debugger_on_hexdump_search(gpointer data);
+static void _debugger_on_hexdump_search_changed(gpointer data);
+static void _debugger_on_hexdump_search_next(gpointer data);
+static void _debugger_on_hexdump_search_previous(gpointer data);
+static gboolean _debugger_on_hexdump_search_timeout(gpointer data);
+static void _debugger_on_hexdump_size_allocate(GtkWidget * widget,
+		GtkAllocation * allocation, gpointer data);
+static void _debugger_on_hexdump_value_changed(gpointer data);
 static void _debugger_on_next(gpointer data);
 static void _debugger_on_open(gpointer data);
 static void _debugger_on_pause(gpointer data);
+static void _debugger_on_profile(gpointer data);
 static void _debugger_on_properties(gpointer data);
+static void _debugger_on_record(gpointer data);
+static gboolean _debugger_on_register_equal(gconstpointer a, gconstpointer b);
+static guint _debugger_on_register_hash(gconstpointer key);
+static void _debugger_on_reverse_continue(gpointer data);
 static void _debugger_on_run(gpointer data);
 static void _debugger_on_step(gpointer data);
+static void _debugger_on_step_back(gpointer data);
 static void _debugger_on_stop(gpointer data);
+static void _debugger_on_syscalls(gpointer data);
+static void _debugger_on_syscalls_export(gpointer data);
+static void _debugger_on_thread_changed(gpointer data);
+static void _debugger_on_tracepoints(gpointer data);
+static void _debugger_on_view_breakpoints(gpointer data);
 static void _debugger_on_view_call_graph(gpointer data);
 static void _debugger_on_view_changed(gpointer data);
 static void _debugger_on_view_disassembly(gpointer data);
 static void _debugger_on_view_hexdump(gpointer data);
+static void _debugger_on_view_profile(gpointer data);
+static void _debugger_on_view_syscalls(gpointer data);
+static void _debugger_on_view_tracepoints(gpointer data);
 
 
 /* constants */
@@ -172,6 +516,13 @@ static char const * _debugger_authors[] =
 	NULL
 };
 
+/* by DebuggerDebugTracepointStatus */
+static char const * _debugger_tracepoint_status[] =
+{
+	N_("Not patched"), N_("Active"), N_("Unsupported code"),
+	N_("Out of reach"), N_("Failed")
+};
+
 static DesktopMenu const _debugger_menu_file[] =
 {
 	{ N_("_Open..."), G_CALLBACK(_debugger_on_open), GTK_STOCK_OPEN,
@@ -200,16 +551,46 @@ static DesktopMenu const _debugger_menu_debug[] =
 		"media-seek-forward", 0, 0 },
 	{ N_("Next"), G_CALLBACK(_debugger_on_next),
 		"media-skip-forward", 0, 0 },
+	{ "", NULL, NULL, 0, 0 },
+	{ N_("Checkpoint"), G_CALLBACK(_debugger_on_checkpoint), NULL, 0,
+		0 },
+	{ N_("Step back"), G_CALLBACK(_debugger_on_step_back),
+		"media-seek-backward", 0, 0 },
+	{ N_("Reverse continue"), G_CALLBACK(_debugger_on_reverse_continue),
+		"media-skip-backward", 0, 0 },
+	{ "", NULL, NULL, 0, 0 },
+	{ N_("Add breakpoint..."), G_CALLBACK(_debugger_on_breakpoint_add),
+		NULL, GDK_CONTROL_MASK, GDK_KEY_B },
+	{ N_("Remove breakpoint"), G_CALLBACK(_debugger_on_breakpoint_remove),
+		NULL, 0, 0 },
+	{ "", NULL, NULL, 0, 0 },
+	{ N_("Profile"), G_CALLBACK(_debugger_on_profile), NULL, 0, 0 },
+	{ N_("Record..."), G_CALLBACK(_debugger_on_record), "media-record",
+		0, 0 },
+	{ "", NULL, NULL, 0, 0 },
+	{ N_("Trace system calls..."), G_CALLBACK(_debugger_on_syscalls),
+		NULL, 0, 0 },
+	{ N_("Export system calls..."),
+		G_CALLBACK(_debugger_on_syscalls_export), NULL, 0, 0 },
+	{ N_("Set tracepoints..."), G_CALLBACK(_debugger_on_tracepoints),
+		NULL, 0, 0 },
 	{ NULL, NULL, NULL, 0, 0 }
 };
 
 static DesktopMenu const _debugger_menu_view[] =
 {
+	{ N_("Breakpoints"), G_CALLBACK(_debugger_on_view_breakpoints), NULL, 0,
+		0 },
 	{ N_("Call graph"), G_CALLBACK(_debugger_on_view_call_graph), NULL, 0,
 		0 },
 	{ N_("Disassembly"), G_CALLBACK(_debugger_on_view_disassembly), NULL, 0,
 		0 },
 	{ N_("Hexdump"), G_CALLBACK(_debugger_on_view_hexdump), NULL, 0, 0 },
+	{ N_("Profile"), G_CALLBACK(_debugger_on_view_profile), NULL, 0, 0 },
+	{ N_("System calls"), G_CALLBACK(_debugger_on_view_syscalls), NULL, 0,
+		0 },
+	{ N_("Tracepoints"), G_CALLBACK(_debugger_on_view_tracepoints), NULL,
+		0, 0 },
 	{ NULL, NULL, NULL, 0, 0 }
 };
 
@@ -276,9 +657,13 @@ Debugger * debugger_new(DebuggerPrefs * prefs)
 	GtkWidget * vbox;
 	GtkWidget * paned;
 	GtkWidget * window;
+	GtkWidget * hbox;
 	GtkWidget * widget;
 	GtkTreeViewColumn * column;
 	GtkCellRenderer * renderer;
+	GtkTextIter iter;
+	PangoLayout * layout;
+	int width;
 
 	if((debugger = object_new(sizeof(*debugger))) == NULL)
 		return NULL;
@@ -289,36 +674,95 @@ Debugger * debugger_new(DebuggerPrefs * prefs)
 	if(debugger->prefs.backend == NULL)
 		debugger->prefs.backend = "asm";
 	if(debugger->prefs.debug == NULL)
+#ifdef __linux__
+		debugger->prefs.debug = "linux";
+#else
 		debugger->prefs.debug = "ptrace";
+#endif
+	if(debugger->prefs.stack == 0)
+		debugger->prefs.stack = STACK_SIZE;
 	/* backend */
 	debugger->bhelper.debugger = debugger;
 	debugger->bhelper.error = _debugger_helper_error;
 	debugger->bhelper.set_registers
 		= _debugger_helper_backend_set_registers;
+	debugger->bhelper.set_sections = _debugger_helper_backend_set_sections;
+	debugger->bhelper.set_functions
+		= _debugger_helper_backend_set_functions;
+	debugger->bhelper.set_call_graph
+		= _debugger_helper_backend_set_call_graph;
+	debugger->bhelper.set_threads = _debugger_helper_backend_set_threads;
 	debugger->bplugin = plugin_new(LIBDIR, PACKAGE, "backend",
 			debugger->prefs.backend);
 	debugger->bdefinition = (debugger->bplugin != NULL)
 		? plugin_lookup(debugger->bplugin, "backend") : NULL;
 	debugger->backend = NULL;
+	debugger->sections = NULL;
+	debugger->sections_cnt = 0;
+	debugger->functions = NULL;
+	debugger->functions_cnt = 0;
 	/* debug */
 	debugger->dhelper.debugger = debugger;
 	debugger->dhelper.error = _debugger_helper_error;
+	debugger->dhelper.set_bias = _debugger_helper_set_bias;
+	debugger->dhelper.set_checkpoint = _debugger_helper_set_checkpoint;
 	debugger->dhelper.set_register = _debugger_helper_set_register;
+	debugger->dhelper.set_registers = _debugger_helper_set_registers;
+	debugger->dhelper.set_profile = _debugger_helper_set_profile;
+	debugger->dhelper.set_syscalls = _debugger_helper_set_syscalls;
+	debugger->dhelper.set_breakpoints = _debugger_helper_set_breakpoints;
+	debugger->dhelper.set_tracepoints = _debugger_helper_set_tracepoints;
 	debugger->dplugin = plugin_new(LIBDIR, PACKAGE, "debug",
 			debugger->prefs.debug);
 	debugger->ddefinition = (debugger->dplugin != NULL)
 		? plugin_lookup(debugger->dplugin, "debug") : NULL;
 	debugger->debug = NULL;
+	debugger->bias = 0;
 	/* child */
 	debugger->filename = NULL;
 	debugger->source = 0;
-	debugger->fp = NULL;
+	/* checkpoints */
+	debugger->chk_checkpoints = g_array_new(FALSE, FALSE,
+			sizeof(Checkpoint));
+	debugger->chk_history = g_array_new(FALSE, FALSE,
+			sizeof(CheckpointStop));
+	debugger->chk_base = 0;
+	debugger->chk_position = 0;
+	debugger->chk_pending = CC_NONE;
+	debugger->chk_replay = FALSE;
+	debugger->chk_target = 0;
+	debugger->chk_source = 0;
+	/* disassembly */
+	debugger->das = disassembly_new(DISASSEMBLY_CACHE,
+			_debugger_on_disassembly_decode, debugger);
+	debugger->das_section = NULL;
+	debugger->das_ranges = g_array_new(FALSE, FALSE,
+			sizeof(DisassemblyRange));
+	debugger->das_pc = -1;
+	debugger->das_busy = FALSE;
+	/* hexdump */
+	debugger->dhx_mapped = NULL;
+	debugger->dhx_buffer = NULL;
+	debugger->dhx_channel = NULL;
+	debugger->dhx_data = NULL;
+	debugger->dhx_size = 0;
+	debugger->dhx_total = 0;
+	debugger->dhx_search = NULL;
+	debugger->dhx_search_source = 0;
+	debugger->dhx_search_hit = HEXDUMP_HIT_NONE;
+	/* system calls */
+	debugger->sys_selection = NULL;
+	debugger->sys_syscalls = NULL;
+	debugger->sys_syscalls_cnt = 0;
+	/* tracepoints */
+	debugger->trc_selection = NULL;
 	/* widgets */
 	debugger->bold = NULL;
 	debugger->monospace = NULL;
 	debugger->window = NULL;
 	/* check for errors */
-	if(debugger->bdefinition == NULL
+	if(debugger->das == NULL
+			|| debugger->bdefinition == NULL
 			|| (debugger->backend = debugger->bdefinition->init(
 					&debugger->bhelper)) == NULL
 			|| debugger->ddefinition == NULL)
@@ -374,32 +818,402 @@ Debugger * debugger_new(DebuggerPrefs * prefs)
 #endif
 	debugger->das_tbuf = gtk_text_view_get_buffer(
 			GTK_TEXT_VIEW(debugger->das_view));
+	gtk_text_buffer_get_start_iter(debugger->das_tbuf, &iter);
+	debugger->das_top = gtk_text_buffer_create_mark(debugger->das_tbuf,
+			NULL, &iter, TRUE);
+	debugger->das_pc_tag = gtk_text_buffer_create_tag(debugger->das_tbuf,
+			NULL, "background", "yellow", NULL);
+	/* decode more as the view is scrolled */
+	debugger->das_adjustment = gtk_scrolled_window_get_vadjustment(
+			GTK_SCROLLED_WINDOW(window));
+	g_signal_connect_swapped(debugger->das_adjustment, "value-changed",
+			G_CALLBACK(_debugger_on_disassembly_value_changed),
+			debugger);
 	gtk_container_add(GTK_CONTAINER(window), debugger->das_view);
 	gtk_notebook_append_page(GTK_NOTEBOOK(debugger->notebook), window,
 			gtk_label_new(_("Disassembly")));
 	/* call graph */
+	debugger->dcg_graph = NULL;
+	debugger->dcg_focus = CALLGRAPH_NONE;
+	debugger->dcg_nodes = g_array_new(FALSE, FALSE, sizeof(CallGraphNode));
+	debugger->dcg_layout = FALSE;
 	debugger->dcg_view = gtk_drawing_area_new();
+	gtk_widget_add_events(debugger->dcg_view, GDK_BUTTON_PRESS_MASK);
+	layout = gtk_widget_create_pango_layout(debugger->dcg_view, "0");
+	pango_layout_get_pixel_size(layout, NULL, &debugger->dcg_height);
+	g_object_unref(layout);
+	debugger->dcg_height += CALL_GRAPH_MARGIN;
+#if GTK_CHECK_VERSION(3, 0, 0)
+	g_signal_connect(debugger->dcg_view, "draw", G_CALLBACK(
+				_debugger_on_call_graph_draw), debugger);
+#else
+	g_signal_connect(debugger->dcg_view, "expose-event", G_CALLBACK(
+				_debugger_on_call_graph_expose), debugger);
+#endif
+	g_signal_connect(debugger->dcg_view, "button-press-event", G_CALLBACK(
+				_debugger_on_call_graph_button_press),
+			debugger);
+	g_signal_connect(debugger->dcg_view, "size-allocate", G_CALLBACK(
+				_debugger_on_call_graph_size_allocate),
+			debugger);
 	gtk_notebook_append_page(GTK_NOTEBOOK(debugger->notebook),
 			debugger->dcg_view, gtk_label_new(_("Call graph")));
 	/* hexdump */
-	window = gtk_scrolled_window_new(NULL, NULL);
-	gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(window),
-			GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
-	debugger->dhx_view = gtk_text_view_new();
-	gtk_text_view_set_cursor_visible(GTK_TEXT_VIEW(debugger->dhx_view),
-			FALSE);
-	gtk_text_view_set_editable(GTK_TEXT_VIEW(debugger->dhx_view), FALSE);
 #if GTK_CHECK_VERSION(3, 0, 0)
-	gtk_widget_override_font(debugger->dhx_view, debugger->monospace);
+	window = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+	hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 4);
+#else
+	window = gtk_vbox_new(FALSE, 0);
+	hbox = gtk_hbox_new(FALSE, 4);
+#endif
+	/* hexdump: search */
+#if GTK_CHECK_VERSION(2, 24, 0)
+	debugger->dhx_search_type = gtk_combo_box_text_new();
+	gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(
+				debugger->dhx_search_type), _("Hexadecimal"));
+	gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(
+				debugger->dhx_search_type), _("ASCII"));
+	gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(
+				debugger->dhx_search_type), _("UTF-16"));
+	gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(
+				debugger->dhx_search_type),
+			_("Regular expression"));
+#else
+	debugger->dhx_search_type = gtk_combo_box_new_text();
+	gtk_combo_box_append_text(GTK_COMBO_BOX(debugger->dhx_search_type),
+			_("Hexadecimal"));
+	gtk_combo_box_append_text(GTK_COMBO_BOX(debugger->dhx_search_type),
+			_("ASCII"));
+	gtk_combo_box_append_text(GTK_COMBO_BOX(debugger->dhx_search_type),
+			_("UTF-16"));
+	gtk_combo_box_append_text(GTK_COMBO_BOX(debugger->dhx_search_type),
+			_("Regular expression"));
+#endif
+	gtk_combo_box_set_active(GTK_COMBO_BOX(debugger->dhx_search_type),
+			ST_HEXADECIMAL);
+	g_signal_connect_swapped(debugger->dhx_search_type, "changed",
+			G_CALLBACK(_debugger_on_hexdump_search_changed),
+			debugger);
+	gtk_box_pack_start(GTK_BOX(hbox), debugger->dhx_search_type, FALSE,
+			TRUE, 0);
+	debugger->dhx_search_entry = gtk_entry_new();
+	g_signal_connect_swapped(debugger->dhx_search_entry, "activate",
+			G_CALLBACK(_debugger_on_hexdump_search), debugger);
+	g_signal_connect_swapped(debugger->dhx_search_entry, "changed",
+			G_CALLBACK(_debugger_on_hexdump_search_changed),
+			debugger);
+	gtk_box_pack_start(GTK_BOX(hbox), debugger->dhx_search_entry, TRUE,
+			TRUE, 0);
+	widget = gtk_button_new();
+	gtk_button_set_image(GTK_BUTTON(widget), gtk_image_new_from_stock(
+				GTK_STOCK_FIND, GTK_ICON_SIZE_SMALL_TOOLBAR));
+	gtk_button_set_relief(GTK_BUTTON(widget), GTK_RELIEF_NONE);
+	gtk_widget_set_tooltip_text(widget, _("Find"));
+	g_signal_connect_swapped(widget, "clicked", G_CALLBACK(
+				_debugger_on_hexdump_search), debugger);
+	gtk_box_pack_start(GTK_BOX(hbox), widget, FALSE, TRUE, 0);
+	widget = gtk_button_new();
+	gtk_button_set_image(GTK_BUTTON(widget), gtk_image_new_from_stock(
+				GTK_STOCK_GO_UP, GTK_ICON_SIZE_SMALL_TOOLBAR));
+	gtk_button_set_relief(GTK_BUTTON(widget), GTK_RELIEF_NONE);
+	gtk_widget_set_tooltip_text(widget, _("Previous match"));
+	g_signal_connect_swapped(widget, "clicked", G_CALLBACK(
+				_debugger_on_hexdump_search_previous), debugger);
+	gtk_box_pack_start(GTK_BOX(hbox), widget, FALSE, TRUE, 0);
+	widget = gtk_button_new();
+	gtk_button_set_image(GTK_BUTTON(widget), gtk_image_new_from_stock(
+				GTK_STOCK_GO_DOWN, GTK_ICON_SIZE_SMALL_TOOLBAR));
+	gtk_button_set_relief(GTK_BUTTON(widget), GTK_RELIEF_NONE);
+	gtk_widget_set_tooltip_text(widget, _("Next match"));
+	g_signal_connect_swapped(widget, "clicked", G_CALLBACK(
+				_debugger_on_hexdump_search_next), debugger);
+	gtk_box_pack_start(GTK_BOX(hbox), widget, FALSE, TRUE, 0);
+	debugger->dhx_search_label = gtk_label_new(NULL);
+	gtk_box_pack_start(GTK_BOX(hbox), debugger->dhx_search_label, FALSE,
+			TRUE, 4);
+	gtk_box_pack_start(GTK_BOX(window), hbox, FALSE, TRUE, 0);
+	/* hexdump: view */
+#if GTK_CHECK_VERSION(3, 0, 0)
+	hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
+#else
+	hbox = gtk_hbox_new(FALSE, 0);
+#endif
+	debugger->dhx_view = gtk_drawing_area_new();
+	gtk_widget_set_can_focus(debugger->dhx_view, TRUE);
+	gtk_widget_add_events(debugger->dhx_view, GDK_KEY_PRESS_MASK
+			| GDK_SCROLL_MASK);
+	layout = gtk_widget_create_pango_layout(debugger->dhx_view, "0");
+	pango_layout_set_font_description(layout, debugger->monospace);
+	pango_layout_get_pixel_size(layout, &width, &debugger->dhx_height);
+	g_object_unref(layout);
+	if(debugger->dhx_height <= 0)
+		debugger->dhx_height = 1;
+	gtk_widget_set_size_request(debugger->dhx_view,
+			width * (HEXDUMP_ROW_MAX - 1), -1);
+#if GTK_CHECK_VERSION(3, 0, 0)
+	g_signal_connect(debugger->dhx_view, "draw", G_CALLBACK(
+				_debugger_on_hexdump_draw), debugger);
+#else
+	g_signal_connect(debugger->dhx_view, "expose-event", G_CALLBACK(
+				_debugger_on_hexdump_expose), debugger);
+#endif
+	g_signal_connect(debugger->dhx_view, "key-press-event", G_CALLBACK(
+				_debugger_on_hexdump_key_press), debugger);
+	g_signal_connect(debugger->dhx_view, "scroll-event", G_CALLBACK(
+				_debugger_on_hexdump_scroll), debugger);
+	g_signal_connect(debugger->dhx_view, "size-allocate", G_CALLBACK(
+				_debugger_on_hexdump_size_allocate), debugger);
+	gtk_box_pack_start(GTK_BOX(hbox), debugger->dhx_view, TRUE, TRUE, 0);
+	debugger->dhx_adjustment = GTK_ADJUSTMENT(gtk_adjustment_new(0.0, 0.0,
+				0.0, 1.0, 1.0, 1.0));
+	g_signal_connect_swapped(debugger->dhx_adjustment, "value-changed",
+			G_CALLBACK(_debugger_on_hexdump_value_changed),
+			debugger);
+#if GTK_CHECK_VERSION(3, 0, 0)
+	widget = gtk_scrollbar_new(GTK_ORIENTATION_VERTICAL,
+			debugger->dhx_adjustment);
 #else
-	gtk_widget_modify_font(debugger->dhx_view, debugger->monospace);
+	widget = gtk_vscrollbar_new(debugger->dhx_adjustment);
 #endif
-	debugger->dhx_tbuf = gtk_text_view_get_buffer(
-			GTK_TEXT_VIEW(debugger->dhx_view));
-	gtk_text_buffer_get_start_iter(debugger->dhx_tbuf, &debugger->dhx_iter);
-	gtk_container_add(GTK_CONTAINER(window), debugger->dhx_view);
+	gtk_box_pack_start(GTK_BOX(hbox), widget, FALSE, TRUE, 0);
+	gtk_box_pack_start(GTK_BOX(window), hbox, TRUE, TRUE, 0);
 	gtk_notebook_append_page(GTK_NOTEBOOK(debugger->notebook), window,
 			gtk_label_new(_("Hexdump")));
+	/* profile */
+	debugger->prf_view = gtk_scrolled_window_new(NULL, NULL);
+	gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(debugger->prf_view),
+			GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+	debugger->prf_store = gtk_list_store_new(PV_COUNT,
+			G_TYPE_STRING,	/* name */
+			G_TYPE_UINT64,	/* samples */
+			G_TYPE_STRING,	/* samples (string) */
+			G_TYPE_STRING,	/* self (string) */
+			G_TYPE_UINT64,	/* total */
+			G_TYPE_STRING);	/* total (string) */
+	debugger->prf_total = NULL;
+	debugger->prf_samples = 0;
+	/* the functions executed most first */
+	gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(
+				debugger->prf_store), PV_SAMPLES,
+			GTK_SORT_DESCENDING);
+	widget = gtk_tree_view_new_with_model(GTK_TREE_MODEL(
+				debugger->prf_store));
+	/* profile: name */
+	renderer = gtk_cell_renderer_text_new();
+	column = gtk_tree_view_column_new_with_attributes(_("Function"),
+			renderer, "text", PV_NAME, NULL);
+	gtk_tree_view_column_set_expand(column, TRUE);
+	gtk_tree_view_column_set_sort_column_id(column, PV_NAME);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
+	/* profile: samples */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", "xalign", 1.0, NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Samples"),
+			renderer, "text", PV_SAMPLES_DISPLAY, NULL);
+	gtk_tree_view_column_set_sort_column_id(column, PV_SAMPLES);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
+	/* profile: self */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", "xalign", 1.0, NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Self %"),
+			renderer, "text", PV_SELF_DISPLAY, NULL);
+	gtk_tree_view_column_set_sort_column_id(column, PV_SAMPLES);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
+	/* profile: total */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", "xalign", 1.0, NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Total %"),
+			renderer, "text", PV_TOTAL_DISPLAY, NULL);
+	gtk_tree_view_column_set_sort_column_id(column, PV_TOTAL);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
+	gtk_container_add(GTK_CONTAINER(debugger->prf_view), widget);
+	gtk_notebook_append_page(GTK_NOTEBOOK(debugger->notebook),
+			debugger->prf_view, gtk_label_new(_("Profile")));
+	/* system calls */
+	debugger->sys_view = gtk_scrolled_window_new(NULL, NULL);
+	gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(debugger->sys_view),
+			GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+	debugger->sys_store = gtk_list_store_new(SCV_COUNT,
+			G_TYPE_STRING,	/* name */
+			G_TYPE_UINT64,	/* calls */
+			G_TYPE_STRING,	/* calls (string) */
+			G_TYPE_UINT64,	/* total */
+			G_TYPE_STRING,	/* total (string) */
+			G_TYPE_UINT64,	/* average */
+			G_TYPE_STRING,	/* average (string) */
+			G_TYPE_UINT64,	/* maximum */
+			G_TYPE_STRING,	/* maximum (string) */
+			G_TYPE_STRING);	/* latency (string) */
+	/* the calls taking the most time first */
+	gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(
+				debugger->sys_store), SCV_TOTAL,
+			GTK_SORT_DESCENDING);
+	widget = gtk_tree_view_new_with_model(GTK_TREE_MODEL(
+				debugger->sys_store));
+	/* system calls: name */
+	renderer = gtk_cell_renderer_text_new();
+	column = gtk_tree_view_column_new_with_attributes(_("System call"),
+			renderer, "text", SCV_NAME, NULL);
+	gtk_tree_view_column_set_sort_column_id(column, SCV_NAME);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
+	/* system calls: calls */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", "xalign", 1.0, NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Calls"),
+			renderer, "text", SCV_CALLS_DISPLAY, NULL);
+	gtk_tree_view_column_set_sort_column_id(column, SCV_CALLS);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
+	/* system calls: total */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", "xalign", 1.0, NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Total"),
+			renderer, "text", SCV_TOTAL_DISPLAY, NULL);
+	gtk_tree_view_column_set_sort_column_id(column, SCV_TOTAL);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
+	/* system calls: average */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", "xalign", 1.0, NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Average"),
+			renderer, "text", SCV_AVERAGE_DISPLAY, NULL);
+	gtk_tree_view_column_set_sort_column_id(column, SCV_AVERAGE);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
+	/* system calls: maximum */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", "xalign", 1.0, NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Maximum"),
+			renderer, "text", SCV_MAXIMUM_DISPLAY, NULL);
+	gtk_tree_view_column_set_sort_column_id(column, SCV_MAXIMUM);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
+	/* system calls: latency */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Latency"),
+			renderer, "text", SCV_LATENCY_DISPLAY, NULL);
+	gtk_tree_view_column_set_expand(column, TRUE);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
+	gtk_container_add(GTK_CONTAINER(debugger->sys_view), widget);
+	gtk_notebook_append_page(GTK_NOTEBOOK(debugger->notebook),
+			debugger->sys_view, gtk_label_new(_("System calls")));
+	/* breakpoints */
+	debugger->brk_view = gtk_scrolled_window_new(NULL, NULL);
+	gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(debugger->brk_view),
+			GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+	debugger->brk_store = gtk_list_store_new(BV_COUNT,
+			G_TYPE_UINT64,	/* address */
+			G_TYPE_STRING,	/* address (string) */
+			G_TYPE_POINTER,	/* condition */
+			G_TYPE_STRING,	/* condition (string) */
+			G_TYPE_UINT64,	/* hits */
+			G_TYPE_STRING,	/* hits (string) */
+			G_TYPE_UINT64,	/* stops */
+			G_TYPE_STRING,	/* stops (string) */
+			G_TYPE_UINT64,	/* evaluation */
+			G_TYPE_STRING);	/* evaluation (string) */
+	gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(
+				debugger->brk_store), BV_ADDRESS,
+			GTK_SORT_ASCENDING);
+	debugger->brk_tree = gtk_tree_view_new_with_model(GTK_TREE_MODEL(
+				debugger->brk_store));
+	/* breakpoints: address */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Address"),
+			renderer, "text", BV_ADDRESS_DISPLAY, NULL);
+	gtk_tree_view_column_set_sort_column_id(column, BV_ADDRESS);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(debugger->brk_tree), column);
+	/* breakpoints: condition */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Condition"),
+			renderer, "text", BV_EXPRESSION, NULL);
+	gtk_tree_view_column_set_expand(column, TRUE);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(debugger->brk_tree), column);
+	/* breakpoints: hits */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", "xalign", 1.0, NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Hits"),
+			renderer, "text", BV_HITS_DISPLAY, NULL);
+	gtk_tree_view_column_set_sort_column_id(column, BV_HITS);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(debugger->brk_tree), column);
+	/* breakpoints: stops */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", "xalign", 1.0, NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Stops"),
+			renderer, "text", BV_STOPS_DISPLAY, NULL);
+	gtk_tree_view_column_set_sort_column_id(column, BV_STOPS);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(debugger->brk_tree), column);
+	/* breakpoints: evaluation */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Evaluation"),
+			renderer, "text", BV_EVALUATION_DISPLAY, NULL);
+	gtk_tree_view_column_set_sort_column_id(column, BV_EVALUATION);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(debugger->brk_tree), column);
+	gtk_container_add(GTK_CONTAINER(debugger->brk_view),
+			debugger->brk_tree);
+	gtk_notebook_append_page(GTK_NOTEBOOK(debugger->notebook),
+			debugger->brk_view, gtk_label_new(_("Breakpoints")));
+	/* tracepoints */
+	debugger->trc_view = gtk_scrolled_window_new(NULL, NULL);
+	gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(debugger->trc_view),
+			GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+	debugger->trc_store = gtk_list_store_new(TV_COUNT,
+			G_TYPE_UINT64,	/* address */
+			G_TYPE_STRING,	/* address (string) */
+			G_TYPE_STRING,	/* status */
+			G_TYPE_UINT64,	/* events */
+			G_TYPE_STRING,	/* events (string) */
+			G_TYPE_UINT64,	/* dropped */
+			G_TYPE_STRING,	/* dropped (string) */
+			G_TYPE_STRING,	/* thread */
+			G_TYPE_STRING);	/* arguments */
+	gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(
+				debugger->trc_store), TV_ADDRESS,
+			GTK_SORT_ASCENDING);
+	widget = gtk_tree_view_new_with_model(GTK_TREE_MODEL(
+				debugger->trc_store));
+	/* tracepoints: address */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Address"),
+			renderer, "text", TV_ADDRESS_DISPLAY, NULL);
+	gtk_tree_view_column_set_sort_column_id(column, TV_ADDRESS);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
+	/* tracepoints: status */
+	renderer = gtk_cell_renderer_text_new();
+	column = gtk_tree_view_column_new_with_attributes(_("Status"),
+			renderer, "text", TV_STATUS, NULL);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
+	/* tracepoints: events */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", "xalign", 1.0, NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Events"),
+			renderer, "text", TV_EVENTS_DISPLAY, NULL);
+	gtk_tree_view_column_set_sort_column_id(column, TV_EVENTS);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
+	/* tracepoints: dropped */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", "xalign", 1.0, NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Dropped"),
+			renderer, "text", TV_DROPPED_DISPLAY, NULL);
+	gtk_tree_view_column_set_sort_column_id(column, TV_DROPPED);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
+	/* tracepoints: thread */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", "xalign", 1.0, NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Thread"),
+			renderer, "text", TV_THREAD, NULL);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
+	/* tracepoints: arguments */
+	renderer = gtk_cell_renderer_text_new();
+	g_object_set(renderer, "family", "Monospace", NULL);
+	column = gtk_tree_view_column_new_with_attributes(_("Last arguments"),
+			renderer, "text", TV_ARGUMENTS, NULL);
+	gtk_tree_view_column_set_expand(column, TRUE);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(widget), column);
+	gtk_container_add(GTK_CONTAINER(debugger->trc_view), widget);
+	gtk_notebook_append_page(GTK_NOTEBOOK(debugger->notebook),
+			debugger->trc_view, gtk_label_new(_("Tracepoints")));
 	gtk_paned_add1(GTK_PANED(paned), debugger->notebook);
 	/* combo */
 #if GTK_CHECK_VERSION(3, 0, 0)
@@ -417,10 +1231,14 @@ Debugger * debugger_new(DebuggerPrefs * prefs)
 			_("Registers"));
 	gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(debugger->combo),
 			_("Stack"));
+	gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(debugger->combo),
+			_("Threads"));
 #else
 	gtk_combo_box_append_text(GTK_COMBO_BOX(debugger->combo),
 			_("Registers"));
 	gtk_combo_box_append_text(GTK_COMBO_BOX(debugger->combo), _("Stack"));
+	gtk_combo_box_append_text(GTK_COMBO_BOX(debugger->combo),
+			_("Threads"));
 #endif
 	gtk_combo_box_set_active(GTK_COMBO_BOX(debugger->combo), CP_REGISTERS);
 	g_signal_connect_swapped(debugger->combo, "changed", G_CALLBACK(
@@ -435,6 +1253,9 @@ Debugger * debugger_new(DebuggerPrefs * prefs)
 			G_TYPE_UINT64,	/* value */
 			G_TYPE_STRING,	/* value (string) */
 			G_TYPE_UINT);	/* size */
+	/* rows by register name, the names belong to the backend */
+	debugger->reg_index = g_hash_table_new_full(_debugger_on_register_hash,
+			_debugger_on_register_equal, NULL, g_free);
 	debugger->reg_tree = gtk_tree_view_new_with_model(
 			GTK_TREE_MODEL(debugger->reg_store));
 	/* registers: name */
@@ -480,6 +1301,39 @@ Debugger * debugger_new(DebuggerPrefs * prefs)
 	gtk_widget_show_all(debugger->stk_tree);
 	gtk_widget_set_no_show_all(debugger->stk_view, TRUE);
 	gtk_box_pack_start(GTK_BOX(widget), debugger->stk_view, TRUE, TRUE, 0);
+	debugger->stk_values = g_array_new(FALSE, FALSE, sizeof(uint64_t));
+	debugger->stk_address = 0;
+	debugger->stk_word = 0;
+	/* threads */
+	debugger->thr_view = gtk_scrolled_window_new(NULL, NULL);
+	gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(debugger->thr_view),
+			GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+	debugger->thr_store = gtk_list_store_new(THV_COUNT,
+			G_TYPE_UINT64,	/* id */
+			G_TYPE_STRING,	/* id (string) */
+			G_TYPE_STRING);	/* signal (string) */
+	debugger->thr_tree = gtk_tree_view_new_with_model(
+			GTK_TREE_MODEL(debugger->thr_store));
+	/* threads: id */
+	renderer = gtk_cell_renderer_text_new();
+	column = gtk_tree_view_column_new_with_attributes(_("Thread"),
+			renderer, "text", THV_ID_DISPLAY, NULL);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(debugger->thr_tree), column);
+	/* threads: signal */
+	renderer = gtk_cell_renderer_text_new();
+	column = gtk_tree_view_column_new_with_attributes(_("Signal"),
+			renderer, "text", THV_SIGNAL_DISPLAY, NULL);
+	gtk_tree_view_append_column(GTK_TREE_VIEW(debugger->thr_tree), column);
+	g_signal_connect_swapped(gtk_tree_view_get_selection(GTK_TREE_VIEW(
+					debugger->thr_tree)), "changed",
+			G_CALLBACK(_debugger_on_thread_changed), debugger);
+	gtk_container_add(GTK_CONTAINER(debugger->thr_view),
+			debugger->thr_tree);
+	gtk_widget_show_all(debugger->thr_tree);
+	gtk_widget_set_no_show_all(debugger->thr_view, TRUE);
+	gtk_box_pack_start(GTK_BOX(widget), debugger->thr_view, TRUE, TRUE, 0);
+	debugger->thr_threads = NULL;
+	debugger->thr_threads_cnt = 0;
 	gtk_paned_add2(GTK_PANED(paned), widget);
 	gtk_paned_set_position(GTK_PANED(paned), 600);
 	gtk_box_pack_start(GTK_BOX(vbox), paned, TRUE, TRUE, 0);
@@ -488,6 +1342,11 @@ Debugger * debugger_new(DebuggerPrefs * prefs)
 	gtk_box_pack_start(GTK_BOX(vbox), debugger->statusbar, FALSE, TRUE, 0);
 	gtk_container_add(GTK_CONTAINER(debugger->window), vbox);
 	gtk_widget_show_all(debugger->window);
+	if(debugger->prefs.syscalls != NULL)
+		debugger_trace_syscalls(debugger, debugger->prefs.syscalls);
+	if(debugger->prefs.tracepoints != NULL)
+		debugger_set_tracepoints(debugger,
+				debugger->prefs.tracepoints);
 	return debugger;
 }
 
@@ -495,8 +1354,7 @@ Debugger * debugger_new(DebuggerPrefs * prefs)
 /* debugger_delete */
 void debugger_delete(Debugger * debugger)
 {
-	if(debugger->source != 0)
-		g_source_remove(debugger->source);
+	_debugger_hexdump_close(debugger);
 	if(debugger_is_running(debugger))
 		debugger_stop(debugger);
 	if(debugger->debug != NULL)
@@ -509,9 +1367,25 @@ void debugger_delete(Debugger * debugger)
 		plugin_delete(debugger->bplugin);
 	string_delete(debugger->filename);
 	if(debugger->window != NULL)
+	{
+		_debugger_breakpoints_clear(debugger);
 		gtk_widget_destroy(debugger->window);
+	}
 	pango_font_description_free(debugger->monospace);
 	pango_font_description_free(debugger->bold);
+	if(debugger->das != NULL)
+		disassembly_delete(debugger->das);
+	_debugger_checkpoints_close(debugger);
+	g_array_free(debugger->chk_checkpoints, TRUE);
+	g_array_free(debugger->chk_history, TRUE);
+	g_array_free(debugger->das_ranges, TRUE);
+	g_array_free(debugger->dcg_nodes, TRUE);
+	g_hash_table_destroy(debugger->reg_index);
+	g_array_free(debugger->stk_values, TRUE);
+	g_free(debugger->prf_total);
+	g_strfreev(debugger->sys_selection);
+	g_free(debugger->sys_syscalls);
+	g_strfreev(debugger->trc_selection);
 	object_delete(debugger);
 }
 
@@ -532,22 +1406,181 @@ int debugger_is_running(Debugger * debugger)
 
 
 /* useful */
+/* debugger_add_breakpoint */
+int debugger_add_breakpoint(Debugger * debugger, uint64_t address,
+		char const * condition)
+{
+	GtkListStore * store = debugger->brk_store;
+	Condition * c = NULL;
+	Condition * previous = NULL;
+	GtkTreeIter iter;
+	char buf[19];
+
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s(0x%" PRIx64 ", \"%s\")\n", __func__,
+			address, condition);
+#endif
+	if(debugger->ddefinition->add_breakpoint == NULL)
+		return -debugger_error(debugger, _("Breakpoints are not"
+					" supported by this plug-in"), 1);
+	/* compiled once here, then evaluated by the plug-in on every hit */
+	if(condition != NULL && condition[0] != '\0'
+			&& (c = condition_new(condition)) == NULL)
+		return -debugger_error(debugger, error_get(NULL), 1);
+	if(debugger_is_running(debugger)
+			&& debugger->ddefinition->add_breakpoint(
+				debugger->debug, address, (c != NULL)
+				? condition_get_code(c) : NULL) != 0)
+	{
+		if(c != NULL)
+			condition_delete(c);
+		return -1;
+	}
+	if(_debugger_breakpoints_find(debugger, address, &iter))
+		gtk_tree_model_get(GTK_TREE_MODEL(store), &iter,
+				BV_CONDITION, &previous, -1);
+	else
+	{
+		snprintf(buf, sizeof(buf), "0x%016" PRIx64, address);
+		gtk_list_store_append(store, &iter);
+		gtk_list_store_set(store, &iter, BV_ADDRESS, address,
+				BV_ADDRESS_DISPLAY, buf, -1);
+	}
+	gtk_list_store_set(store, &iter, BV_CONDITION, c,
+			BV_EXPRESSION, (c != NULL)
+			? condition_get_expression(c) : NULL, -1);
+	if(previous != NULL)
+		condition_delete(previous);
+	return 0;
+}
+
+
+/* debugger_add_breakpoint_dialog */
+static GtkWidget * _add_breakpoint_dialog_entry(GtkWidget * vbox,
+		GtkSizeGroup * group, char const * label);
+
+int debugger_add_breakpoint_dialog(Debugger * debugger)
+{
+	const unsigned int flags = GTK_DIALOG_MODAL
+		| GTK_DIALOG_DESTROY_WITH_PARENT;
+	int ret = 0;
+	GtkWidget * dialog;
+	GtkSizeGroup * group;
+	GtkWidget * vbox;
+	GtkWidget * entry;
+	GtkWidget * widget;
+	gchar * address = NULL;
+	gchar * condition = NULL;
+	uint64_t a;
+
+	dialog = gtk_message_dialog_new(GTK_WINDOW(debugger->window), flags,
+			GTK_MESSAGE_QUESTION, GTK_BUTTONS_OK_CANCEL,
+#if GTK_CHECK_VERSION(2, 6, 0)
+			"%s", _("Add breakpoint"));
+	gtk_message_dialog_format_secondary_text(GTK_MESSAGE_DIALOG(dialog),
+#endif
+			"%s", _("Address or function to stop at, optionally"
+				" only when a condition holds (e.g."
+				" \"rdi == 0x42 && hits == 10000\"):"));
+	gtk_window_set_title(GTK_WINDOW(dialog), _("Add breakpoint"));
+#if GTK_CHECK_VERSION(2, 14, 0)
+	vbox = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
+#else
+	vbox = GTK_DIALOG(dialog)->vbox;
+#endif
+	group = gtk_size_group_new(GTK_SIZE_GROUP_HORIZONTAL);
+	entry = _add_breakpoint_dialog_entry(vbox, group, _("Address:"));
+	widget = _add_breakpoint_dialog_entry(vbox, group, _("Condition:"));
+	g_object_unref(group);
+	gtk_dialog_set_default_response(GTK_DIALOG(dialog), GTK_RESPONSE_OK);
+	if(gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_OK)
+	{
+		address = g_strstrip(g_strdup(gtk_entry_get_text(
+						GTK_ENTRY(entry))));
+		condition = g_strstrip(g_strdup(gtk_entry_get_text(
+						GTK_ENTRY(widget))));
+	}
+	gtk_widget_destroy(dialog);
+	if(address != NULL)
+		ret = (_debugger_breakpoints_address(debugger, address, &a)
+				== 0) ? debugger_add_breakpoint(debugger, a,
+					condition) : -1;
+	g_free(address);
+	g_free(condition);
+	return ret;
+}
+
+static GtkWidget * _add_breakpoint_dialog_entry(GtkWidget * vbox,
+		GtkSizeGroup * group, char const * label)
+{
+	GtkWidget * hbox;
+	GtkWidget * widget;
+
+#if GTK_CHECK_VERSION(3, 0, 0)
+	hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 4);
+#else
+	hbox = gtk_hbox_new(FALSE, 4);
+#endif
+	widget = gtk_label_new(label);
+#if GTK_CHECK_VERSION(3, 0, 0)
+	g_object_set(widget, "halign", GTK_ALIGN_START, NULL);
+#else
+	gtk_misc_set_alignment(GTK_MISC(widget), 0.0, 0.5);
+#endif
+	gtk_size_group_add_widget(group, widget);
+	gtk_box_pack_start(GTK_BOX(hbox), widget, FALSE, TRUE, 0);
+	widget = gtk_entry_new();
+	gtk_entry_set_activates_default(GTK_ENTRY(widget), TRUE);
+	gtk_box_pack_start(GTK_BOX(hbox), widget, TRUE, TRUE, 0);
+	gtk_widget_show_all(hbox);
+	gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, TRUE, 0);
+	return widget;
+}
+
+
+/* debugger_checkpoint */
+int debugger_checkpoint(Debugger * debugger)
+{
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s()\n", __func__);
+#endif
+	if(debugger_is_running(debugger) == FALSE)
+		return 0;
+	if(debugger->ddefinition->checkpoint == NULL)
+		return -debugger_error(debugger, _("Checkpoints are not"
+					" supported by this plug-in"), 1);
+	if(debugger->chk_pending != CC_NONE)
+		return -debugger_error(debugger,
+				_("The program has to be stopped first"), 1);
+	return _debugger_checkpoints_add(debugger);
+}
+
+
 /* debugger_close */
 int debugger_close(Debugger * debugger)
 {
 	if(debugger_is_opened(debugger) == FALSE)
 		return 0;
-	if(debugger->source != 0)
-		g_source_remove(debugger->source);
-	debugger->source = 0;
-	if(debugger->fp != NULL)
-		fclose(debugger->fp);
-	debugger->fp = NULL;
-	gtk_text_buffer_set_text(debugger->das_tbuf, "", 0);
-	gtk_text_buffer_set_text(debugger->dhx_tbuf, "", 0);
-	gtk_text_buffer_get_start_iter(debugger->dhx_tbuf, &debugger->dhx_iter);
+	_debugger_hexdump_close(debugger);
+	_debugger_hexdump_update(debugger);
+	_debugger_hexdump_search_status(debugger);
+	_debugger_disassembly_close(debugger);
+	_debugger_call_graph_close(debugger);
+	g_hash_table_remove_all(debugger->reg_index);
 	gtk_list_store_clear(debugger->reg_store);
-	gtk_list_store_clear(debugger->stk_store);
+	_debugger_stack_close(debugger);
+	_debugger_threads_close(debugger);
+	_debugger_profile_close(debugger);
+	_debugger_syscalls_close(debugger);
+	_debugger_tracepoints_close(debugger);
+	_debugger_breakpoints_clear(debugger);
+	/* this also cancels decoding if still in progress */
+	debugger->bdefinition->close(debugger->backend);
+	debugger->sections = NULL;
+	debugger->sections_cnt = 0;
+	debugger->functions = NULL;
+	debugger->functions_cnt = 0;
+	debugger->bias = 0;
 	/* FIXME really implement */
 	string_delete(debugger->filename);
 	debugger->filename = NULL;
@@ -564,7 +1597,8 @@ int debugger_continue(Debugger * debugger)
 #endif
 	if(debugger_is_running(debugger) == FALSE)
 		return 0;
-	return debugger->ddefinition->_continue(debugger->debug);
+	debugger->chk_replay = FALSE;
+	return _debugger_checkpoints_command(debugger, CC_CONTINUE);
 }
 
 
@@ -599,6 +1633,110 @@ static int _error_text(char const * message, int ret)
 }
 
 
+/* debugger_export_syscalls */
+static int _export_syscalls_write(FILE * fp,
+		DebuggerDebugSyscall const * syscalls, size_t syscalls_cnt);
+
+int debugger_export_syscalls(Debugger * debugger, char const * filename)
+{
+	FILE * fp;
+
+	if(filename == NULL)
+		return debugger_export_syscalls_dialog(debugger);
+	if(debugger->sys_syscalls_cnt == 0)
+		return -debugger_error(debugger,
+				_("No system calls were traced"), 1);
+	if((fp = fopen(filename, "w")) == NULL)
+		return -debugger_error(debugger, strerror(errno), 1);
+	if(_export_syscalls_write(fp, debugger->sys_syscalls,
+				debugger->sys_syscalls_cnt) != 0)
+	{
+		fclose(fp);
+		unlink(filename);
+		return -debugger_error(debugger, strerror(errno), 1);
+	}
+	if(fclose(fp) != 0)
+	{
+		unlink(filename);
+		return -debugger_error(debugger, strerror(errno), 1);
+	}
+	return 0;
+}
+
+static int _export_syscalls_write(FILE * fp,
+		DebuggerDebugSyscall const * syscalls, size_t syscalls_cnt)
+{
+	DebuggerDebugSyscall const * syscall;
+	size_t i;
+	size_t j;
+	int res;
+
+	/* the durations in nanoseconds, then the calls by latency */
+	if(fputs("syscall,calls,total,maximum", fp) < 0)
+		return -1;
+	for(j = 0; j < DEBUGGER_DEBUG_HISTOGRAM - 1; j++)
+		if(fprintf(fp, ",<%" PRIu64, (uint64_t)1 << (j + 1)) < 0)
+			return -1;
+	if(fprintf(fp, ",>=%" PRIu64 "\n", (uint64_t)1 << j) < 0)
+		return -1;
+	for(i = 0; i < syscalls_cnt; i++)
+	{
+		syscall = &syscalls[i];
+		if(syscall->name != NULL)
+			res = fputs(syscall->name, fp);
+		else
+			res = fprintf(fp, "%u", syscall->number);
+		if(res < 0 || fprintf(fp, ",%" PRIu64 ",%" PRIu64 ",%" PRIu64,
+					syscall->count, syscall->total,
+					syscall->maximum) < 0)
+			return -1;
+		for(j = 0; j < DEBUGGER_DEBUG_HISTOGRAM; j++)
+			if(fprintf(fp, ",%" PRIu64, syscall->histogram[j]) < 0)
+				return -1;
+		if(fputc('\n', fp) == EOF)
+			return -1;
+	}
+	return 0;
+}
+
+
+/* debugger_export_syscalls_dialog */
+int debugger_export_syscalls_dialog(Debugger * debugger)
+{
+	int ret = 0;
+	GtkWidget * dialog;
+	GtkFileFilter * filter;
+	char * filename = NULL;
+
+	if(debugger->sys_syscalls_cnt == 0)
+		return -debugger_error(debugger,
+				_("No system calls were traced"), 1);
+	dialog = gtk_file_chooser_dialog_new(_("Export system calls..."),
+			GTK_WINDOW(debugger->window),
+			GTK_FILE_CHOOSER_ACTION_SAVE,
+			GTK_STOCK_CANCEL, GTK_RESPONSE_CANCEL,
+			GTK_STOCK_SAVE, GTK_RESPONSE_ACCEPT, NULL);
+	gtk_file_chooser_set_do_overwrite_confirmation(GTK_FILE_CHOOSER(
+				dialog), TRUE);
+	filter = gtk_file_filter_new();
+	gtk_file_filter_set_name(filter, _("CSV files"));
+	gtk_file_filter_add_mime_type(filter, "text/csv");
+	gtk_file_chooser_add_filter(GTK_FILE_CHOOSER(dialog), filter);
+	filter = gtk_file_filter_new();
+	gtk_file_filter_set_name(filter, _("All files"));
+	gtk_file_filter_add_pattern(filter, "*");
+	gtk_file_chooser_add_filter(GTK_FILE_CHOOSER(dialog), filter);
+	if(gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT)
+		filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(
+					dialog));
+	gtk_widget_destroy(dialog);
+	if(filename != NULL)
+		ret = debugger_export_syscalls(debugger, filename);
+	g_free(filename);
+	return ret;
+}
+
+
 /* debugger_next */
 int debugger_next(Debugger * debugger)
 {
@@ -607,7 +1745,8 @@ int debugger_next(Debugger * debugger)
 #endif
 	if(debugger_is_running(debugger) == FALSE)
 		return 0;
-	return debugger->ddefinition->next(debugger->debug);
+	debugger->chk_replay = FALSE;
+	return _debugger_checkpoints_command(debugger, CC_NEXT);
 }
 
 
@@ -637,7 +1776,7 @@ int debugger_open(Debugger * debugger, char const * arch, char const * format,
 		gtk_window_set_title(GTK_WINDOW(debugger->window), s);
 	string_delete(s);
 	_debugger_set_sensitive_toolbar(debugger, TRUE, FALSE);
-	debugger->source = g_idle_add(_debugger_on_idle, debugger);
+	_debugger_hexdump_open(debugger);
 	return 0;
 }
 
@@ -669,16 +1808,46 @@ int debugger_open_dialog(Debugger * debugger, char const * arch,
 /* debugger_pause */
 int debugger_pause(Debugger * debugger)
 {
+	CheckpointStop stop;
+
 #ifdef DEBUG
 	fprintf(stderr, "DEBUG: %s()\n", __func__);
 #endif
 	if(debugger_is_running(debugger) == FALSE)
 		return 0;
-	return debugger->ddefinition->pause(debugger->debug);
+	if(debugger->ddefinition->pause(debugger->debug) != 0)
+		return -1;
+	if(debugger->chk_pending == CC_NONE)
+		return 0;
+	/* where it paused cannot be replayed, only checkpointed */
+	debugger->chk_pending = CC_NONE;
+	debugger->chk_replay = FALSE;
+	stop.command = CC_NONE;
+	stop.deltas = NULL;
+	stop.deltas_cnt = 0;
+	_debugger_checkpoints_record(debugger, &stop);
+	return 0;
 }
 
 
-/* debugger_properties */
+/* debugger_profile */
+int debugger_profile(Debugger * debugger, unsigned int frequency)
+{
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s(%u)\n", __func__, frequency);
+#endif
+	if(debugger_is_running(debugger) == FALSE)
+		return 0;
+	if(debugger->ddefinition->profile == NULL)
+		return -debugger_error(debugger,
+				_("Profiling is not supported by this plug-in"),
+				1);
+	return debugger->ddefinition->profile(debugger->debug,
+			(frequency != 0) ? frequency : PROFILE_FREQUENCY);
+}
+
+
+/* debugger_properties */
 static GtkWidget * _properties_label(Debugger * debugger, GtkSizeGroup * group,
 		char const * label, char const * value);
 
@@ -765,6 +1934,113 @@ static GtkWidget * _properties_label(Debugger * debugger, GtkSizeGroup * group,
 }
 
 
+/* debugger_record */
+int debugger_record(Debugger * debugger, char const * filename,
+		int registers)
+{
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s(\"%s\", %d)\n", __func__, filename,
+			registers);
+#endif
+	if(debugger_is_running(debugger) == FALSE)
+		return 0;
+	if(filename == NULL)
+		return debugger_record_dialog(debugger);
+	if(debugger->ddefinition->record == NULL)
+		return -debugger_error(debugger,
+				_("Recording is not supported by this plug-in"),
+				1);
+	return debugger->ddefinition->record(debugger->debug, filename,
+			registers);
+}
+
+
+/* debugger_record_dialog */
+int debugger_record_dialog(Debugger * debugger)
+{
+	int ret = 0;
+	GtkWidget * dialog;
+	GtkWidget * widget;
+	char * filename = NULL;
+	int registers = 0;
+
+	if(debugger_is_running(debugger) == FALSE)
+		return 0;
+	dialog = gtk_file_chooser_dialog_new(_("Record..."),
+			GTK_WINDOW(debugger->window),
+			GTK_FILE_CHOOSER_ACTION_SAVE,
+			GTK_STOCK_CANCEL, GTK_RESPONSE_CANCEL,
+			GTK_STOCK_SAVE, GTK_RESPONSE_ACCEPT, NULL);
+	gtk_file_chooser_set_do_overwrite_confirmation(GTK_FILE_CHOOSER(
+				dialog), TRUE);
+	widget = gtk_check_button_new_with_mnemonic(_("Record the _registers"));
+	gtk_file_chooser_set_extra_widget(GTK_FILE_CHOOSER(dialog), widget);
+	if(gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT)
+	{
+		filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(
+					dialog));
+		registers = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(
+					widget)) ? 1 : 0;
+	}
+	gtk_widget_destroy(dialog);
+	if(filename != NULL)
+		ret = debugger_record(debugger, filename, registers);
+	g_free(filename);
+	return ret;
+}
+
+
+/* debugger_remove_breakpoint */
+int debugger_remove_breakpoint(Debugger * debugger, uint64_t address)
+{
+	GtkTreeIter iter;
+	Condition * condition;
+
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s(0x%" PRIx64 ")\n", __func__, address);
+#endif
+	if(!_debugger_breakpoints_find(debugger, address, &iter))
+		return 0;
+	if(debugger_is_running(debugger)
+			&& debugger->ddefinition->remove_breakpoint != NULL
+			&& debugger->ddefinition->remove_breakpoint(
+				debugger->debug, address) != 0)
+		return -1;
+	gtk_tree_model_get(GTK_TREE_MODEL(debugger->brk_store), &iter,
+			BV_CONDITION, &condition, -1);
+	if(condition != NULL)
+		condition_delete(condition);
+	gtk_list_store_remove(debugger->brk_store, &iter);
+	return 0;
+}
+
+
+/* debugger_reverse_continue */
+int debugger_reverse_continue(Debugger * debugger)
+{
+	CheckpointStop * stop;
+	size_t position;
+
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s()\n", __func__);
+#endif
+	if(debugger_is_running(debugger) == FALSE)
+		return 0;
+	/* back to the last time the program stopped running freely */
+	position = debugger->chk_position;
+	if(debugger->chk_pending == CC_NONE && position > 0)
+		position--;
+	for(; position > debugger->chk_base; position--)
+	{
+		stop = &g_array_index(debugger->chk_history, CheckpointStop,
+				position - debugger->chk_base - 1);
+		if(stop->command == CC_CONTINUE)
+			break;
+	}
+	return _debugger_checkpoints_replay(debugger, position);
+}
+
+
 /* debugger_run */
 int debugger_run(Debugger * debugger, ...)
 {
@@ -787,6 +2063,9 @@ int debugger_runv(Debugger * debugger, va_list ap)
 		return -1;
 	if((debugger->debug = debugger->ddefinition->init(&debugger->dhelper))
 			== NULL
+			|| _debugger_syscalls_select(debugger) != 0
+			|| _debugger_tracepoints_select(debugger) != 0
+			|| _debugger_breakpoints_select(debugger) != 0
 			|| debugger->ddefinition->start(debugger->debug, ap)
 			!= 0)
 	{
@@ -798,6 +2077,90 @@ int debugger_runv(Debugger * debugger, va_list ap)
 }
 
 
+/* debugger_set_tracepoints */
+int debugger_set_tracepoints(Debugger * debugger, char const * tracepoints)
+{
+	gchar ** selection;
+	uint64_t address;
+	size_t i;
+
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s(\"%s\")\n", __func__, tracepoints);
+#endif
+	selection = _debugger_split(tracepoints);
+	if(selection != NULL && debugger->ddefinition->tracepoints == NULL)
+	{
+		g_strfreev(selection);
+		return -debugger_error(debugger, _("Tracepoints are not"
+					" supported by this plug-in"), 1);
+	}
+	/* the functions are looked up again when starting the program */
+	for(i = 0; selection != NULL && selection[i] != NULL; i++)
+		if(debugger_is_opened(debugger)
+				&& _debugger_breakpoints_address(debugger,
+					selection[i], &address) != 0)
+		{
+			g_strfreev(selection);
+			return -1;
+		}
+	g_strfreev(debugger->trc_selection);
+	debugger->trc_selection = selection;
+	/* the agent patches the program as it starts */
+	if(debugger_is_running(debugger))
+		_debugger_set_status(debugger, _("The tracepoints will be set"
+					" from the next run"));
+	return 0;
+}
+
+
+/* debugger_set_tracepoints_dialog */
+int debugger_set_tracepoints_dialog(Debugger * debugger)
+{
+	const unsigned int flags = GTK_DIALOG_MODAL
+		| GTK_DIALOG_DESTROY_WITH_PARENT;
+	int ret = 0;
+	GtkWidget * dialog;
+	GtkWidget * vbox;
+	GtkWidget * widget;
+	gchar * tracepoints = NULL;
+
+	dialog = gtk_message_dialog_new(GTK_WINDOW(debugger->window), flags,
+			GTK_MESSAGE_QUESTION, GTK_BUTTONS_OK_CANCEL,
+#if GTK_CHECK_VERSION(2, 6, 0)
+			"%s", _("Set tracepoints"));
+	gtk_message_dialog_format_secondary_text(GTK_MESSAGE_DIALOG(dialog),
+#endif
+			"%s", _("Addresses or functions to record the arguments"
+				" of without stopping, from the next run and"
+				" separated by commas:"));
+	gtk_window_set_title(GTK_WINDOW(dialog), _("Set tracepoints"));
+#if GTK_CHECK_VERSION(2, 14, 0)
+	vbox = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
+#else
+	vbox = GTK_DIALOG(dialog)->vbox;
+#endif
+	widget = gtk_entry_new();
+	if(debugger->trc_selection != NULL)
+	{
+		tracepoints = g_strjoinv(",", debugger->trc_selection);
+		gtk_entry_set_text(GTK_ENTRY(widget), tracepoints);
+		g_free(tracepoints);
+		tracepoints = NULL;
+	}
+	gtk_entry_set_activates_default(GTK_ENTRY(widget), TRUE);
+	gtk_dialog_set_default_response(GTK_DIALOG(dialog), GTK_RESPONSE_OK);
+	gtk_widget_show(widget);
+	gtk_box_pack_start(GTK_BOX(vbox), widget, FALSE, TRUE, 0);
+	if(gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_OK)
+		tracepoints = g_strdup(gtk_entry_get_text(GTK_ENTRY(widget)));
+	gtk_widget_destroy(dialog);
+	if(tracepoints != NULL)
+		ret = debugger_set_tracepoints(debugger, tracepoints);
+	g_free(tracepoints);
+	return ret;
+}
+
+
 /* debugger_step */
 int debugger_step(Debugger * debugger)
 {
@@ -806,7 +2169,29 @@ int debugger_step(Debugger * debugger)
 #endif
 	if(debugger_is_running(debugger) == FALSE)
 		return 0;
-	return debugger->ddefinition->step(debugger->debug);
+	debugger->chk_replay = FALSE;
+	return _debugger_checkpoints_command(debugger, CC_STEP);
+}
+
+
+/* debugger_step_back */
+int debugger_step_back(Debugger * debugger)
+{
+	size_t position;
+
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s()\n", __func__);
+#endif
+	if(debugger_is_running(debugger) == FALSE)
+		return 0;
+	/* the last stop if still running, or the one before */
+	if((position = debugger->chk_position) == 0
+			&& debugger->chk_pending == CC_NONE)
+		return -debugger_error(debugger,
+				_("No earlier stop to go back to"), 1);
+	if(debugger->chk_pending == CC_NONE)
+		position--;
+	return _debugger_checkpoints_replay(debugger, position);
 }
 
 
@@ -818,6 +2203,7 @@ int debugger_stop(Debugger * debugger)
 #endif
 	if(debugger_is_running(debugger) == FALSE)
 		return 0;
+	_debugger_checkpoints_close(debugger);
 	debugger->ddefinition->stop(debugger->debug);
 	debugger->ddefinition->destroy(debugger->debug);
 	debugger->debug = NULL;
@@ -826,6 +2212,79 @@ int debugger_stop(Debugger * debugger)
 }
 
 
+/* debugger_trace_syscalls */
+int debugger_trace_syscalls(Debugger * debugger, char const * syscalls)
+{
+	gchar ** selection;
+
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s(\"%s\")\n", __func__, syscalls);
+#endif
+	selection = _debugger_split(syscalls);
+	if(selection != NULL && debugger->ddefinition->trace_syscalls == NULL)
+	{
+		g_strfreev(selection);
+		return -debugger_error(debugger, _("Tracing system calls is"
+					" not supported by this plug-in"), 1);
+	}
+	g_strfreev(debugger->sys_selection);
+	debugger->sys_selection = selection;
+	/* the filter is installed when starting the program */
+	if(debugger_is_running(debugger))
+		_debugger_set_status(debugger, _("The system calls will be"
+					" traced from the next run"));
+	return 0;
+}
+
+
+/* debugger_trace_syscalls_dialog */
+int debugger_trace_syscalls_dialog(Debugger * debugger)
+{
+	const unsigned int flags = GTK_DIALOG_MODAL
+		| GTK_DIALOG_DESTROY_WITH_PARENT;
+	int ret = 0;
+	GtkWidget * dialog;
+	GtkWidget * vbox;
+	GtkWidget * widget;
+	gchar * syscalls = NULL;
+
+	dialog = gtk_message_dialog_new(GTK_WINDOW(debugger->window), flags,
+			GTK_MESSAGE_QUESTION, GTK_BUTTONS_OK_CANCEL,
+#if GTK_CHECK_VERSION(2, 6, 0)
+			"%s", _("Trace system calls"));
+	gtk_message_dialog_format_secondary_text(GTK_MESSAGE_DIALOG(dialog),
+#endif
+			"%s", _("System calls to stop on from the next run,"
+				" separated by commas (none to stop on every"
+				" call with \"Next\"):"));
+	gtk_window_set_title(GTK_WINDOW(dialog), _("Trace system calls"));
+#if GTK_CHECK_VERSION(2, 14, 0)
+	vbox = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
+#else
+	vbox = GTK_DIALOG(dialog)->vbox;
+#endif
+	widget = gtk_entry_new();
+	if(debugger->sys_selection != NULL)
+	{
+		syscalls = g_strjoinv(",", debugger->sys_selection);
+		gtk_entry_set_text(GTK_ENTRY(widget), syscalls);
+		g_free(syscalls);
+		syscalls = NULL;
+	}
+	gtk_entry_set_activates_default(GTK_ENTRY(widget), TRUE);
+	gtk_dialog_set_default_response(GTK_DIALOG(dialog), GTK_RESPONSE_OK);
+	gtk_widget_show(widget);
+	gtk_box_pack_start(GTK_BOX(vbox), widget, FALSE, TRUE, 0);
+	if(gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_OK)
+		syscalls = g_strdup(gtk_entry_get_text(GTK_ENTRY(widget)));
+	gtk_widget_destroy(dialog);
+	if(syscalls != NULL)
+		ret = debugger_trace_syscalls(debugger, syscalls);
+	g_free(syscalls);
+	return ret;
+}
+
+
 /* private */
 /* functions */
 /* accessors */
@@ -856,195 +2315,1891 @@ static void _debugger_set_sensitive_toolbar(Debugger * debugger, gboolean run,
 }
 
 
-/* useful */
-/* debugger_confirm */
-static gboolean _debugger_confirm(Debugger * debugger, char const * message)
+/* debugger_set_status */
+static void _debugger_set_status(Debugger * debugger, char const * status)
 {
-	const unsigned int flags = GTK_DIALOG_MODAL
-		| GTK_DIALOG_DESTROY_WITH_PARENT;
-	GtkWidget * widget;
-	int res;
+	GtkStatusbar * statusbar = GTK_STATUSBAR(debugger->statusbar);
+	guint id;
 
-	widget = gtk_message_dialog_new(GTK_WINDOW(debugger->window), flags,
-			GTK_MESSAGE_QUESTION, GTK_BUTTONS_YES_NO,
-#if GTK_CHECK_VERSION(2, 6, 0)
-			"%s", _("Question"));
-	gtk_message_dialog_format_secondary_text(GTK_MESSAGE_DIALOG(widget),
-#endif
-			"%s", message);
-	gtk_window_set_title(GTK_WINDOW(widget), _("Question"));
-	res = gtk_dialog_run(GTK_DIALOG(widget));
-	gtk_widget_destroy(widget);
-	return (res == GTK_RESPONSE_YES) ? TRUE : FALSE;
+	id = gtk_statusbar_get_context_id(statusbar, "");
+	gtk_statusbar_pop(statusbar, id);
+	gtk_statusbar_push(statusbar, id, status);
 }
 
 
-/* debugger_confirm_close */
-static gboolean _debugger_confirm_close(Debugger * debugger)
+/* useful */
+/* debugger_address */
+static int _debugger_address(Debugger * debugger, off_t offset,
+		uint64_t * address)
 {
-	if(debugger_is_opened(debugger)
-			&& _debugger_confirm(debugger, _(
-					"A file is already opened.\n"
-					"Would you like to close it?\n"
-					"Any progress will be lost.")) == FALSE)
-		return FALSE;
-	return TRUE;
-}
-
+	AsmSection const * section;
+	size_t i;
 
-/* debugger_confirm_reset */
-static gboolean _debugger_confirm_reset(Debugger * debugger)
-{
-	if(debugger_is_running(debugger)
-			&& _debugger_confirm(debugger, _(
-					"A process is being debugged already\n"
-					"Would you like to restart it?\n"
-					"Any progress will be lost.")) == FALSE)
-		return FALSE;
-	return TRUE;
+	/* where this offset of the file is loaded, once relocated */
+	for(i = 0; i < debugger->sections_cnt; i++)
+	{
+		section = &debugger->sections[i];
+		if(offset < section->offset
+				|| (size_t)(offset - section->offset)
+				>= section->size)
+			continue;
+		*address = section->base + (offset - section->offset)
+			+ debugger->bias;
+		return 0;
+	}
+	return -1;
 }
 
 
-/* debugger_hexdump_append */
-static unsigned char _append(int c);
-
-static void _debugger_hexdump_append(Debugger * debugger, size_t pos,
-		char const * buf, size_t size)
+/* debugger_breakpoints_address */
+static int _debugger_breakpoints_address(Debugger * debugger,
+		char const * string, uint64_t * address)
 {
+	AsmFunction const * function;
+	char * p;
 	size_t i;
-	unsigned char c[16];
-	char buf2[80];
-	char const * format = debugger->prefs.uppercase
-			? "%s%08x  %02X %02X %02X %02X %02X %02X %02X %02X"
-			" %02X %02X %02X %02X %02X %02X %02X %02X"
-			"  %c%c%c%c%c%c%c%c%c%c%c%c%c%c%c%c"
-			: "%s%08x  %02x %02x %02x %02x %02x %02x %02x %02x"
-			" %02x %02x %02x %02x %02x %02x %02x %02x"
-			"  %c%c%c%c%c%c%c%c%c%c%c%c%c%c%c%c";
-	int s;
-
-	/* hexadecimal values */
-	for(i = 0; i < 16 && i < size; i++)
-		c[i] = (unsigned char)buf[i];
-	for(; i < 16 && i < size; i++)
-		c[i] = 0;
-	/* FIXME wrong if i < 16 */
-	s = snprintf(buf2, sizeof(buf2), format, (pos > 0) ? "\n" : "", pos,
-			c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7],
-			c[8], c[9], c[10], c[11], c[12], c[13], c[14], c[15],
-			_append(c[0]), _append(c[1]), _append(c[2]),
-			_append(c[3]), _append(c[4]), _append(c[5]),
-			_append(c[6]), _append(c[7]), _append(c[8]),
-			_append(c[9]), _append(c[10]), _append(c[11]),
-			_append(c[12]), _append(c[13]), _append(c[14]),
-			_append(c[15]));
-	gtk_text_buffer_insert(debugger->dhx_tbuf, &debugger->dhx_iter, buf2,
-			s);
-}
-
-static unsigned char _append(int c)
-{
-	return isascii(c) && isprint(c) ? c : '.';
+
+	errno = 0;
+	*address = strtoull(string, &p, 0);
+	if(string[0] != '\0' && *p == '\0' && errno == 0)
+		return 0;
+	/* otherwise the entry point of a function */
+	for(i = 0; i < debugger->functions_cnt; i++)
+	{
+		function = &debugger->functions[i];
+		if(function->name != NULL && strcmp(function->name, string)
+				== 0)
+			break;
+	}
+	if(i == debugger->functions_cnt)
+		return -debugger_error(debugger,
+				_("Unknown address or function"), 1);
+	if(_debugger_address(debugger, function->offset, address) != 0)
+		return -debugger_error(debugger,
+				_("The function is not in any section"), 1);
+	return 0;
 }
 
 
-/* helpers */
-/* debugger_helper_error */
-static int _debugger_helper_error(Debugger * debugger, int code,
-		char const * format, ...)
+/* debugger_breakpoints_clear */
+static void _debugger_breakpoints_clear(Debugger * debugger)
 {
-	va_list ap;
-	int size;
-	char * message;
+	GtkTreeModel * model = GTK_TREE_MODEL(debugger->brk_store);
+	GtkTreeIter iter;
+	gboolean valid;
+	Condition * condition;
 
-	va_start(ap, format);
-	size = vsnprintf(NULL, 0, format, ap);
-	message = (size >= 0) ? malloc(size + 1) : NULL;
-	if(message != NULL)
-		vsnprintf(message, size + 1, format, ap);
-	va_end(ap);
-	if(message == NULL)
-		return code;
-	debugger_error(debugger, message, code);
-	free(message);
-	return code;
+	for(valid = gtk_tree_model_get_iter_first(model, &iter); valid;
+			valid = gtk_tree_model_iter_next(model, &iter))
+	{
+		gtk_tree_model_get(model, &iter, BV_CONDITION, &condition, -1);
+		if(condition != NULL)
+			condition_delete(condition);
+	}
+	gtk_list_store_clear(debugger->brk_store);
 }
 
 
-/* debugger_helper_set_register */
-static void _debugger_helper_set_register(Debugger * debugger,
-		char const * name, uint64_t value)
+/* debugger_breakpoints_find */
+static gboolean _debugger_breakpoints_find(Debugger * debugger,
+		uint64_t address, GtkTreeIter * iter)
 {
-	GtkTreeModel * model = GTK_TREE_MODEL(debugger->reg_store);
-	GtkTreeIter iter;
+	GtkTreeModel * model = GTK_TREE_MODEL(debugger->brk_store);
 	gboolean valid;
-	gchar * p;
-	unsigned int size;
-	int res;
-	char buf[33];
+	uint64_t a;
 
-	for(valid = gtk_tree_model_get_iter_first(model, &iter); valid == TRUE;
-			valid = gtk_tree_model_iter_next(model, &iter))
+	for(valid = gtk_tree_model_get_iter_first(model, iter); valid;
+			valid = gtk_tree_model_iter_next(model, iter))
 	{
-		gtk_tree_model_get(model, &iter, RV_NAME, &p, RV_SIZE, &size,
-				-1);
-		res = strcasecmp(p, name);
-		g_free(p);
-		if(res == 0)
-			break;
+		gtk_tree_model_get(model, iter, BV_ADDRESS, &a, -1);
+		if(a == address)
+			return TRUE;
 	}
-	if(valid != TRUE)
-		return;
-	if(size <= 16)
-		snprintf(buf, sizeof(buf), "%04" PRIx64, value);
-	else if(size <= 20)
-		snprintf(buf, sizeof(buf), "%05" PRIx64, value);
-	else if(size <= 32)
-		snprintf(buf, sizeof(buf), "%08" PRIx64, value);
-	else if(size <= 64)
-		snprintf(buf, sizeof(buf), "%016" PRIx64, value);
-	else
-		snprintf(buf, sizeof(buf), "%032" PRIx64, value);
-	gtk_list_store_set(debugger->reg_store, &iter, RV_VALUE, value,
-			RV_VALUE_DISPLAY, buf, -1);
+	return FALSE;
 }
 
 
-/* helpers: backend */
-/* debugger_helper_backend_set_registers */
-static void _debugger_helper_backend_set_registers(Debugger * debugger,
-		AsmArchRegister const * registers, size_t registers_cnt)
+/* debugger_breakpoints_select */
+static int _debugger_breakpoints_select(Debugger * debugger)
 {
-	GtkTreeModel * model;
-	size_t i;
+	GtkTreeModel * model = GTK_TREE_MODEL(debugger->brk_store);
 	GtkTreeIter iter;
+	gboolean valid;
+	uint64_t address;
+	Condition * condition;
 
-	model = gtk_tree_view_get_model(GTK_TREE_VIEW(debugger->reg_tree));
-	gtk_list_store_clear(GTK_LIST_STORE(model));
-	for(i = 0; i < registers_cnt; i++)
+	for(valid = gtk_tree_model_get_iter_first(model, &iter); valid;
+			valid = gtk_tree_model_iter_next(model, &iter))
 	{
-		if(registers[i].flags & ARF_ALIAS)
-			continue;
-		gtk_list_store_append(GTK_LIST_STORE(model), &iter);
-		gtk_list_store_set(GTK_LIST_STORE(model), &iter,
-				RV_NAME, registers[i].name,
-				RV_SIZE, registers[i].size, -1);
+		if(debugger->ddefinition->add_breakpoint == NULL)
+			return -debugger_error(debugger, _("Breakpoints are"
+						" not supported by this plug-in"),
+					1);
+		/* the statistics only cover the current run */
+		gtk_list_store_set(debugger->brk_store, &iter,
+				BV_HITS, (uint64_t)0, BV_HITS_DISPLAY, NULL,
+				BV_STOPS, (uint64_t)0, BV_STOPS_DISPLAY, NULL,
+				BV_EVALUATION, (uint64_t)0,
+				BV_EVALUATION_DISPLAY, NULL, -1);
+		gtk_tree_model_get(model, &iter, BV_ADDRESS, &address,
+				BV_CONDITION, &condition, -1);
+		if(debugger->ddefinition->add_breakpoint(debugger->debug,
+					address, (condition != NULL)
+					? condition_get_code(condition) : NULL)
+				!= 0)
+			return -1;
 	}
+	return 0;
 }
 
 
-/* callbacks */
-/* debugger_on_about */
-static void _debugger_on_about(gpointer data)
+/* debugger_call_graph_close */
+static void _debugger_call_graph_close(Debugger * debugger)
 {
-	Debugger * debugger = data;
-	GtkWidget * dialog;
+	debugger->dcg_graph = NULL;
+	debugger->dcg_focus = CALLGRAPH_NONE;
+	g_array_set_size(debugger->dcg_nodes, 0);
+	debugger->dcg_layout = FALSE;
+	gtk_widget_queue_draw(debugger->dcg_view);
+}
 
-	dialog = desktop_about_dialog_new();
-	gtk_window_set_transient_for(GTK_WINDOW(dialog), GTK_WINDOW(
-				debugger->window));
-	desktop_about_dialog_set_authors(dialog, _debugger_authors);
-	desktop_about_dialog_set_comments(dialog,
+
+/* debugger_call_graph_focus */
+static void _debugger_call_graph_focus(Debugger * debugger, size_t function)
+{
+	if(debugger->dcg_graph == NULL || function == CALLGRAPH_NONE
+			|| function == debugger->dcg_focus)
+		return;
+	/* only the neighbourhood of this function needs a new layout */
+	debugger->dcg_focus = function;
+	debugger->dcg_layout = FALSE;
+	gtk_widget_queue_draw(debugger->dcg_view);
+}
+
+
+/* debugger_call_graph_layout */
+static void _layout_column(Debugger * debugger, uint32_t const * functions,
+		size_t functions_cnt, int x, int width, int height);
+static void _layout_node(Debugger * debugger, size_t function, size_t more,
+		int x, int y, int width);
+
+static void _debugger_call_graph_layout(Debugger * debugger, int width,
+		int height)
+{
+	uint32_t const * functions;
+	size_t cnt;
+	int w;
+
+	g_array_set_size(debugger->dcg_nodes, 0);
+	debugger->dcg_layout = TRUE;
+	if(debugger->dcg_graph == NULL
+			|| debugger->dcg_focus >= debugger->functions_cnt)
+		return;
+	/* three columns: the callers, the function and the callees */
+	if((w = (width - CALL_GRAPH_MARGIN * 4) / 3) <= 0)
+		return;
+	_layout_node(debugger, debugger->dcg_focus, 0,
+			CALL_GRAPH_MARGIN * 2 + w,
+			(height - debugger->dcg_height) / 2, w);
+	cnt = callgraph_get_callers(debugger->dcg_graph, debugger->dcg_focus,
+			&functions);
+	_layout_column(debugger, functions, cnt, CALL_GRAPH_MARGIN, w, height);
+	cnt = callgraph_get_callees(debugger->dcg_graph, debugger->dcg_focus,
+			&functions);
+	_layout_column(debugger, functions, cnt, CALL_GRAPH_MARGIN * 3 + w * 2,
+			w, height);
+}
+
+static void _layout_column(Debugger * debugger, uint32_t const * functions,
+		size_t functions_cnt, int x, int width, int height)
+{
+	size_t rows;
+	size_t cnt;
+	size_t i;
+	int y;
+
+	/* lay out only what fits, regardless of the size of the graph */
+	rows = MAX(height / (debugger->dcg_height + CALL_GRAPH_MARGIN), 1);
+	cnt = (functions_cnt > rows) ? rows - 1 : functions_cnt;
+	y = (height - (int)MIN(functions_cnt, rows)
+			* (debugger->dcg_height + CALL_GRAPH_MARGIN)) / 2;
+	for(i = 0; i < cnt; i++)
+	{
+		_layout_node(debugger, functions[i], 0, x, y, width);
+		y += debugger->dcg_height + CALL_GRAPH_MARGIN;
+	}
+	if(cnt < functions_cnt)
+		_layout_node(debugger, CALLGRAPH_NONE, functions_cnt - cnt, x,
+				y, width);
+}
+
+static void _layout_node(Debugger * debugger, size_t function, size_t more,
+		int x, int y, int width)
+{
+	CallGraphNode node;
+
+	node.function = function;
+	node.more = more;
+	node.area.x = x;
+	node.area.y = y + CALL_GRAPH_MARGIN / 2;
+	node.area.width = width;
+	node.area.height = debugger->dcg_height;
+	g_array_append_val(debugger->dcg_nodes, node);
+}
+
+
+/* debugger_checkpoints_add */
+static int _debugger_checkpoints_add(Debugger * debugger)
+{
+	DebuggerDebugDefinition * definition = debugger->ddefinition;
+	GArray * checkpoints = debugger->chk_checkpoints;
+	Checkpoint checkpoint;
+	Checkpoint * c;
+	CheckpointStop * stop;
+	size_t i;
+
+	if(definition->checkpoint == NULL)
+		return -1;
+	/* one is enough for every position */
+	if(checkpoints->len > 0 && g_array_index(checkpoints, Checkpoint,
+				checkpoints->len - 1).position
+			== debugger->chk_position)
+		return 0;
+	if((checkpoint.id = definition->checkpoint(debugger->debug)) < 0)
+		return -1;
+	checkpoint.position = debugger->chk_position;
+	g_array_append_val(checkpoints, checkpoint);
+	if(checkpoints->len <= CHECKPOINTS_MAX)
+		return 0;
+	/* forget about the oldest one, and what happened until the next */
+	definition->discard(debugger->debug,
+			g_array_index(checkpoints, Checkpoint, 0).id);
+	g_array_remove_index(checkpoints, 0);
+	c = &g_array_index(checkpoints, Checkpoint, 0);
+	for(i = 0; i < c->position - debugger->chk_base; i++)
+	{
+		stop = &g_array_index(debugger->chk_history, CheckpointStop,
+				i);
+		g_free(stop->deltas);
+	}
+	g_array_remove_range(debugger->chk_history, 0, i);
+	debugger->chk_base = c->position;
+	return 0;
+}
+
+
+/* debugger_checkpoints_close */
+static void _debugger_checkpoints_close(Debugger * debugger)
+{
+	size_t i;
+
+	/* the checkpoints themselves go with the debug plug-in */
+	for(i = 0; i < debugger->chk_history->len; i++)
+		g_free(g_array_index(debugger->chk_history, CheckpointStop,
+					i).deltas);
+	g_array_set_size(debugger->chk_history, 0);
+	g_array_set_size(debugger->chk_checkpoints, 0);
+	debugger->chk_base = 0;
+	debugger->chk_position = 0;
+	debugger->chk_pending = CC_NONE;
+	debugger->chk_replay = FALSE;
+	if(debugger->chk_source != 0)
+		g_source_remove(debugger->chk_source);
+	debugger->chk_source = 0;
+}
+
+
+/* debugger_checkpoints_command */
+static int _debugger_checkpoints_command(Debugger * debugger,
+		CheckpointCommand command)
+{
+	DebuggerDebugDefinition * definition = debugger->ddefinition;
+	int ret = -1;
+
+	/* still running: where it stops then cannot be replayed */
+	if(debugger->chk_pending != CC_NONE && debugger_pause(debugger) != 0)
+		return -1;
+	debugger->chk_pending = command;
+	switch(command)
+	{
+		case CC_CONTINUE:
+			ret = definition->_continue(debugger->debug);
+			break;
+		case CC_NEXT:
+			ret = definition->next(debugger->debug);
+			break;
+		case CC_STEP:
+			ret = definition->step(debugger->debug);
+			break;
+		case CC_NONE:
+			break;
+	}
+	if(ret != 0)
+		debugger->chk_pending = CC_NONE;
+	return ret;
+}
+
+
+/* debugger_checkpoints_record */
+static void _debugger_checkpoints_record(Debugger * debugger,
+		CheckpointStop * stop)
+{
+	GArray * checkpoints = debugger->chk_checkpoints;
+	GArray * history = debugger->chk_history;
+	size_t i = debugger->chk_position - debugger->chk_base;
+	Checkpoint * last = NULL;
+
+	/* going forward again after going back starts a new execution */
+	while(checkpoints->len > 0 && g_array_index(checkpoints, Checkpoint,
+				checkpoints->len - 1).position
+			> debugger->chk_position)
+	{
+		debugger->ddefinition->discard(debugger->debug,
+				g_array_index(checkpoints, Checkpoint,
+					checkpoints->len - 1).id);
+		g_array_remove_index(checkpoints, checkpoints->len - 1);
+	}
+	while(history->len > i)
+	{
+		g_free(g_array_index(history, CheckpointStop,
+					history->len - 1).deltas);
+		g_array_remove_index(history, history->len - 1);
+	}
+	g_array_append_val(history, *stop);
+	debugger->chk_position++;
+	/* checkpoint regularly, and past the pauses as they are not replayed */
+	if(checkpoints->len > 0)
+		last = &g_array_index(checkpoints, Checkpoint,
+				checkpoints->len - 1);
+	if(stop->command == CC_NONE || last == NULL || debugger->chk_position
+			- last->position >= CHECKPOINTS_INTERVAL)
+		_debugger_checkpoints_add(debugger);
+}
+
+
+/* debugger_checkpoints_replay */
+static int _debugger_checkpoints_replay(Debugger * debugger, size_t target)
+{
+	DebuggerDebugDefinition * definition = debugger->ddefinition;
+	GArray * checkpoints = debugger->chk_checkpoints;
+	Checkpoint * checkpoint = NULL;
+	size_t i;
+
+	if(definition->restore == NULL)
+		return -debugger_error(debugger, _("Checkpoints are not"
+					" supported by this plug-in"), 1);
+	/* the nearest checkpoint before */
+	for(i = checkpoints->len; i > 0; i--)
+		if((checkpoint = &g_array_index(checkpoints, Checkpoint,
+						i - 1))->position <= target)
+			break;
+	if(i == 0)
+		return -debugger_error(debugger,
+				_("No checkpoint to go back to"), 1);
+	for(i = checkpoint->position; i < target; i++)
+		if(g_array_index(debugger->chk_history, CheckpointStop,
+					i - debugger->chk_base).command
+				== CC_NONE)
+			return -debugger_error(debugger, _("Pauses cannot be"
+						" replayed"), 1);
+	if(debugger->chk_source != 0)
+		g_source_remove(debugger->chk_source);
+	debugger->chk_source = 0;
+	debugger->chk_replay = FALSE;
+	debugger->chk_pending = CC_NONE;
+	if(definition->restore(debugger->debug, checkpoint->id) != 0)
+		return -1;
+	debugger->chk_position = checkpoint->position;
+	debugger->chk_target = target;
+	if(debugger->chk_position == target)
+	{
+		_debugger_set_status(debugger, _("Went back to a checkpoint"));
+		return 0;
+	}
+	/* replay the commands recorded from there */
+	_debugger_set_status(debugger, _("Replaying..."));
+	debugger->chk_replay = TRUE;
+	debugger->chk_source = g_idle_add(_debugger_on_checkpoints_replay,
+			debugger);
+	return 0;
+}
+
+
+/* debugger_checkpoints_stopped */
+static void _debugger_checkpoints_stopped(Debugger * debugger,
+		GArray * deltas)
+{
+	CheckpointStop stop;
+	CheckpointStop * s;
+	size_t i;
+
+	if((stop.command = debugger->chk_pending) == CC_NONE)
+	{
+		/* the program just started, or went back to a checkpoint */
+		if(debugger->debug != NULL
+				&& debugger->chk_checkpoints->len == 0)
+			_debugger_checkpoints_add(debugger);
+		return;
+	}
+	debugger->chk_pending = CC_NONE;
+	if(debugger->chk_replay)
+	{
+		/* the registers should end up as they were recorded */
+		s = &g_array_index(debugger->chk_history, CheckpointStop,
+				debugger->chk_position - debugger->chk_base);
+		for(i = 0; i < s->deltas_cnt; i++)
+			if(s->deltas[i].reg->value != s->deltas[i].value)
+				break;
+		if(i == s->deltas_cnt)
+		{
+			g_array_free(deltas, TRUE);
+			if(++debugger->chk_position < debugger->chk_target)
+			{
+				debugger->chk_source = g_idle_add(
+						_debugger_on_checkpoints_replay,
+						debugger);
+				return;
+			}
+			debugger->chk_replay = FALSE;
+			_debugger_set_status(debugger, _("Went back"));
+			return;
+		}
+		/* what follows was not recorded then */
+		debugger->chk_replay = FALSE;
+		_debugger_set_status(debugger, _("The execution replayed"
+					" diverged from the one recorded"));
+	}
+	stop.deltas_cnt = deltas->len;
+	stop.deltas = (CheckpointDelta *)g_array_free(deltas, FALSE);
+	_debugger_checkpoints_record(debugger, &stop);
+}
+
+
+/* debugger_confirm */
+static gboolean _debugger_confirm(Debugger * debugger, char const * message)
+{
+	const unsigned int flags = GTK_DIALOG_MODAL
+		| GTK_DIALOG_DESTROY_WITH_PARENT;
+	GtkWidget * widget;
+	int res;
+
+	widget = gtk_message_dialog_new(GTK_WINDOW(debugger->window), flags,
+			GTK_MESSAGE_QUESTION, GTK_BUTTONS_YES_NO,
+#if GTK_CHECK_VERSION(2, 6, 0)
+			"%s", _("Question"));
+	gtk_message_dialog_format_secondary_text(GTK_MESSAGE_DIALOG(widget),
+#endif
+			"%s", message);
+	gtk_window_set_title(GTK_WINDOW(widget), _("Question"));
+	res = gtk_dialog_run(GTK_DIALOG(widget));
+	gtk_widget_destroy(widget);
+	return (res == GTK_RESPONSE_YES) ? TRUE : FALSE;
+}
+
+
+/* debugger_confirm_close */
+static gboolean _debugger_confirm_close(Debugger * debugger)
+{
+	if(debugger_is_opened(debugger)
+			&& _debugger_confirm(debugger, _(
+					"A file is already opened.\n"
+					"Would you like to close it?\n"
+					"Any progress will be lost.")) == FALSE)
+		return FALSE;
+	return TRUE;
+}
+
+
+/* debugger_confirm_reset */
+static gboolean _debugger_confirm_reset(Debugger * debugger)
+{
+	if(debugger_is_running(debugger)
+			&& _debugger_confirm(debugger, _(
+					"A process is being debugged already\n"
+					"Would you like to restart it?\n"
+					"Any progress will be lost.")) == FALSE)
+		return FALSE;
+	return TRUE;
+}
+
+
+/* debugger_disassembly_append */
+static int _debugger_disassembly_append(Debugger * debugger)
+{
+	AsmSection const * section = debugger->das_section;
+	DisassemblyRange range;
+	DisassemblyBlock const * block;
+	GtkTextIter iter;
+	off_t end;
+
+	range.offset = (debugger->das_ranges->len > 0)
+		? g_array_index(debugger->das_ranges, DisassemblyRange,
+				debugger->das_ranges->len - 1).end
+		: section->offset;
+	end = section->offset + section->size;
+	if(range.offset >= end)
+		return 0;
+	range.size = MIN(end - range.offset, DISASSEMBLY_BLOCK);
+	if((block = disassembly_get_block(debugger->das, section, range.offset,
+					range.size)) == NULL)
+		return -1;
+	range.end = block->end;
+	range.lines = block->lines_cnt;
+	gtk_text_buffer_get_end_iter(debugger->das_tbuf, &iter);
+	gtk_text_buffer_insert(debugger->das_tbuf, &iter, block->text,
+			block->text_len);
+	g_array_append_val(debugger->das_ranges, range);
+	/* forget about the blocks furthest away */
+	if(debugger->das_ranges->len > DISASSEMBLY_BLOCKS_MAX)
+	{
+		range = g_array_index(debugger->das_ranges, DisassemblyRange,
+				0);
+		_debugger_disassembly_delete_lines(debugger, 0,
+				range.lines);
+		g_array_remove_index(debugger->das_ranges, 0);
+	}
+	_debugger_disassembly_highlight(debugger);
+	return 1;
+}
+
+
+/* debugger_disassembly_close */
+static void _debugger_disassembly_close(Debugger * debugger)
+{
+	gtk_text_buffer_set_text(debugger->das_tbuf, "", 0);
+	g_array_set_size(debugger->das_ranges, 0);
+	debugger->das_section = NULL;
+	debugger->das_pc = -1;
+	/* the cached blocks refer to the sections of the previous file */
+	disassembly_set_functions(debugger->das, NULL, 0);
+}
+
+
+/* debugger_disassembly_delete_lines */
+static void _debugger_disassembly_delete_lines(Debugger * debugger,
+		size_t line, size_t lines)
+{
+	GtkTextIter start;
+	GtkTextIter end;
+
+	gtk_text_buffer_get_iter_at_line(debugger->das_tbuf, &start, line);
+	gtk_text_buffer_get_iter_at_line(debugger->das_tbuf, &end,
+			line + lines);
+	gtk_text_buffer_delete(debugger->das_tbuf, &start, &end);
+}
+
+
+/* debugger_disassembly_goto */
+static void _debugger_disassembly_goto(Debugger * debugger,
+		AsmSection const * section, off_t offset)
+{
+	GtkTextIter iter;
+	DisassemblyRange range;
+	size_t i;
+	int line;
+
+	if(debugger->bdefinition->decode == NULL)
+	{
+		gtk_text_buffer_set_text(debugger->das_tbuf,
+				_("Disassembly is not available for this file"),
+				-1);
+		return;
+	}
+	/* check if the offset is displayed already */
+	if(section == debugger->das_section)
+		for(i = 0; i < debugger->das_ranges->len; i++)
+		{
+			range = g_array_index(debugger->das_ranges,
+					DisassemblyRange, i);
+			if(offset < range.offset || offset >= range.end)
+				continue;
+			if((line = _debugger_disassembly_highlight(debugger))
+					< 0)
+				break;
+			gtk_text_buffer_get_iter_at_line(debugger->das_tbuf,
+					&iter, line);
+			gtk_text_buffer_move_mark(debugger->das_tbuf,
+					debugger->das_top, &iter);
+			gtk_text_view_scroll_to_mark(GTK_TEXT_VIEW(
+						debugger->das_view),
+					debugger->das_top, 0.1, FALSE, 0.0,
+					0.0);
+			return;
+		}
+	debugger->das_busy = TRUE;
+	gtk_text_buffer_set_text(debugger->das_tbuf, "", 0);
+	g_array_set_size(debugger->das_ranges, 0);
+	debugger->das_section = section;
+	/* start decoding from the offset requested */
+	if(offset > section->offset)
+	{
+		range.offset = offset;
+		range.size = 0;
+		range.end = offset;
+		range.lines = 0;
+		g_array_append_val(debugger->das_ranges, range);
+	}
+	if(_debugger_disassembly_append(debugger) < 0)
+		_debugger_helper_error(debugger, 1, "%s", error_get(NULL));
+	/* keep something to scroll back to */
+	line = _debugger_disassembly_prepend(debugger) > 0
+		? g_array_index(debugger->das_ranges, DisassemblyRange, 0).lines
+		: 0;
+	gtk_text_buffer_get_iter_at_line(debugger->das_tbuf, &iter, line);
+	gtk_text_buffer_move_mark(debugger->das_tbuf, debugger->das_top,
+			&iter);
+	gtk_text_view_scroll_to_mark(GTK_TEXT_VIEW(debugger->das_view),
+			debugger->das_top, 0.0, TRUE, 0.0, 0.0);
+	debugger->das_busy = FALSE;
+}
+
+
+/* debugger_disassembly_goto_address */
+static void _debugger_disassembly_goto_address(Debugger * debugger,
+		uint64_t address)
+{
+	AsmSection const * section;
+	off_t offset;
+
+	if((section = _debugger_offset(debugger, address, &offset)) == NULL)
+		return;
+	debugger->das_pc = offset;
+	_debugger_disassembly_goto(debugger, section, debugger->das_pc);
+}
+
+
+/* debugger_disassembly_highlight */
+static int _debugger_disassembly_highlight(Debugger * debugger)
+{
+	GtkTextIter start;
+	GtkTextIter end;
+	DisassemblyRange * range;
+	DisassemblyBlock const * block;
+	size_t i;
+	size_t j;
+	size_t line = 0;
+
+	gtk_text_buffer_get_bounds(debugger->das_tbuf, &start, &end);
+	gtk_text_buffer_remove_tag(debugger->das_tbuf, debugger->das_pc_tag,
+			&start, &end);
+	if(debugger->das_pc < 0)
+		return -1;
+	for(i = 0; i < debugger->das_ranges->len; i++)
+	{
+		range = &g_array_index(debugger->das_ranges, DisassemblyRange,
+				i);
+		if(debugger->das_pc < range->offset
+				|| debugger->das_pc >= range->end)
+		{
+			line += range->lines;
+			continue;
+		}
+		/* this is normally still cached */
+		if((block = disassembly_get_block(debugger->das,
+						debugger->das_section,
+						range->offset, range->size))
+				== NULL)
+			return -1;
+		for(j = 0; j < block->lines_cnt; j++)
+			if(block->lines[j] == debugger->das_pc)
+			{
+				gtk_text_buffer_get_iter_at_line(
+						debugger->das_tbuf, &start,
+						line + j);
+				end = start;
+				gtk_text_iter_forward_line(&end);
+				gtk_text_buffer_apply_tag(debugger->das_tbuf,
+						debugger->das_pc_tag, &start,
+						&end);
+				return line + j;
+			}
+		break;
+	}
+	return -1;
+}
+
+
+/* debugger_disassembly_prepend */
+static int _debugger_disassembly_prepend(Debugger * debugger)
+{
+	AsmSection const * section = debugger->das_section;
+	DisassemblyRange range;
+	DisassemblyBlock const * block;
+	GtkTextIter iter;
+	off_t start;
+	off_t offset;
+
+	if(debugger->das_ranges->len == 0)
+		return 0;
+	start = g_array_index(debugger->das_ranges, DisassemblyRange, 0)
+		.offset;
+	if(start <= section->offset)
+		return 0;
+	/* decode from an instruction known, a function or a row decoded */
+	range.offset = MAX(section->offset, start - DISASSEMBLY_BLOCK);
+	if((offset = disassembly_get_boundary(debugger->das, section,
+					range.offset, start)) >= 0
+			&& start - offset <= DISASSEMBLY_BLOCK
+			* DISASSEMBLY_BLOCKS_MAX)
+		/* catch up with the block ending at the start */
+		for(range.offset = offset; start - range.offset
+				> DISASSEMBLY_BLOCK; range.offset = block->end)
+			if((block = disassembly_get_block(debugger->das,
+							section, range.offset,
+							DISASSEMBLY_BLOCK))
+					== NULL)
+				return -1;
+	/* the instruction crossing the start is left out, if any */
+	range.size = start - range.offset;
+	if((block = disassembly_get_block(debugger->das, section, range.offset,
+					range.size)) == NULL)
+		return -1;
+	range.end = start;
+	range.lines = block->lines_cnt;
+	gtk_text_buffer_get_start_iter(debugger->das_tbuf, &iter);
+	gtk_text_buffer_insert(debugger->das_tbuf, &iter, block->text,
+			block->text_len);
+	g_array_prepend_val(debugger->das_ranges, range);
+	/* forget about the blocks furthest away */
+	if(debugger->das_ranges->len > DISASSEMBLY_BLOCKS_MAX)
+	{
+		range = g_array_index(debugger->das_ranges, DisassemblyRange,
+				debugger->das_ranges->len - 1);
+		gtk_text_buffer_get_end_iter(debugger->das_tbuf, &iter);
+		_debugger_disassembly_delete_lines(debugger,
+				gtk_text_iter_get_line(&iter) - range.lines,
+				range.lines);
+		g_array_remove_index(debugger->das_ranges,
+				debugger->das_ranges->len - 1);
+	}
+	_debugger_disassembly_highlight(debugger);
+	return 1;
+}
+
+
+/* debugger_hexdump_close */
+static void _debugger_hexdump_close(Debugger * debugger)
+{
+	/* the search may be reading the data */
+	_debugger_hexdump_search_stop(debugger);
+	if(debugger->source != 0)
+		g_source_remove(debugger->source);
+	debugger->source = 0;
+	/* closing the file as well */
+	if(debugger->dhx_channel != NULL)
+		g_io_channel_unref(debugger->dhx_channel);
+	debugger->dhx_channel = NULL;
+	if(debugger->dhx_mapped != NULL)
+#if GLIB_CHECK_VERSION(2, 22, 0)
+		g_mapped_file_unref(debugger->dhx_mapped);
+#else
+		g_mapped_file_free(debugger->dhx_mapped);
+#endif
+	debugger->dhx_mapped = NULL;
+	if(debugger->dhx_buffer != NULL)
+		g_byte_array_free(debugger->dhx_buffer, TRUE);
+	debugger->dhx_buffer = NULL;
+	debugger->dhx_data = NULL;
+	debugger->dhx_size = 0;
+	debugger->dhx_total = 0;
+}
+
+
+/* debugger_hexdump_open */
+static int _debugger_hexdump_open(Debugger * debugger)
+{
+	GError * error = NULL;
+	int fd;
+	struct stat st;
+
+	_debugger_hexdump_close(debugger);
+	/* map the file: only the rows visible are ever formatted */
+	if((debugger->dhx_mapped = g_mapped_file_new(debugger->filename, FALSE,
+					&error)) != NULL)
+	{
+		debugger->dhx_data = (unsigned char const *)
+			g_mapped_file_get_contents(debugger->dhx_mapped);
+		debugger->dhx_size = g_mapped_file_get_length(
+				debugger->dhx_mapped);
+		_debugger_hexdump_update(debugger);
+		return 0;
+	}
+#ifdef DEBUG
+	fprintf(stderr, "DEBUG: %s() %s\n", __func__, error->message);
+#endif
+	g_error_free(error);
+	/* fallback to reading the file as it comes (for special files) */
+	if((fd = open(debugger->filename, O_RDONLY | O_NONBLOCK)) < 0)
+		return -debugger_error(debugger, strerror(errno), 1);
+	/* the size is only known in advance for regular files */
+	if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+		debugger->dhx_total = st.st_size;
+	debugger->dhx_buffer = g_byte_array_new();
+	debugger->dhx_channel = g_io_channel_unix_new(fd);
+	g_io_channel_set_close_on_unref(debugger->dhx_channel, TRUE);
+	debugger->source = g_io_add_watch(debugger->dhx_channel,
+			G_IO_IN | G_IO_ERR | G_IO_HUP, _debugger_on_hexdump_read,
+			debugger);
+	_debugger_hexdump_update(debugger);
+	return 0;
+}
+
+
+/* debugger_hexdump_search */
+static int _debugger_hexdump_search(Debugger * debugger)
+{
+	char const * pattern;
+	int type;
+
+	_debugger_hexdump_search_stop(debugger);
+	pattern = gtk_entry_get_text(GTK_ENTRY(debugger->dhx_search_entry));
+	if(pattern[0] == '\0' || debugger->dhx_data == NULL)
+		return 0;
+	if(debugger->source != 0)
+		return -debugger_error(debugger,
+				_("The file is still being loaded"), 1);
+	if((type = gtk_combo_box_get_active(GTK_COMBO_BOX(
+						debugger->dhx_search_type)))
+			< 0)
+		type = ST_HEXADECIMAL;
+	if((debugger->dhx_search = search_new(type, pattern)) == NULL)
+		return -debugger_error(debugger, error_get(NULL), 1);
+	if(search_start(debugger->dhx_search, debugger->dhx_data,
+				debugger->dhx_size) != 0)
+	{
+		_debugger_hexdump_search_stop(debugger);
+		return -debugger_error(debugger, error_get(NULL), 1);
+	}
+	/* collect the hits as they are found */
+	debugger->dhx_search_source = g_timeout_add(100,
+			_debugger_on_hexdump_search_timeout, debugger);
+	_debugger_hexdump_search_status(debugger);
+	return 0;
+}
+
+
+/* debugger_hexdump_search_goto */
+static void _debugger_hexdump_search_goto(Debugger * debugger, size_t hit)
+{
+	SearchHit const * hits;
+	size_t cnt;
+	gdouble row;
+	gdouble page;
+
+	hits = search_get_hits(debugger->dhx_search, &cnt);
+	if(hit >= cnt)
+		return;
+	debugger->dhx_search_hit = hit;
+	/* display the hit a third down the view */
+	row = hits[hit].offset / HEXDUMP_COLUMNS;
+	page = gtk_adjustment_get_page_size(debugger->dhx_adjustment);
+	gtk_adjustment_set_value(debugger->dhx_adjustment,
+			(row > page / 3) ? row - page / 3 : 0.0);
+	gtk_widget_queue_draw(debugger->dhx_view);
+	_debugger_hexdump_search_status(debugger);
+}
+
+
+/* debugger_hexdump_search_status */
+static void _debugger_hexdump_search_status(Debugger * debugger)
+{
+	size_t cnt;
+	char const * more;
+	gchar * status;
+
+	if(debugger->dhx_search == NULL)
+	{
+		gtk_label_set_text(GTK_LABEL(debugger->dhx_search_label), "");
+		return;
+	}
+	search_get_hits(debugger->dhx_search, &cnt);
+	more = search_is_running(debugger->dhx_search) ? "..."
+		: (search_is_truncated(debugger->dhx_search) ? "+" : "");
+	if(cnt == 0)
+		status = g_strdup(search_is_running(debugger->dhx_search)
+				? _("Searching...") : _("No match"));
+	else if(debugger->dhx_search_hit >= cnt)
+		status = g_strdup_printf(_("%lu%s matches"),
+				(unsigned long)cnt, more);
+	else
+		status = g_strdup_printf(_("%lu of %lu%s"),
+				(unsigned long)debugger->dhx_search_hit + 1,
+				(unsigned long)cnt, more);
+	gtk_label_set_text(GTK_LABEL(debugger->dhx_search_label), status);
+	g_free(status);
+}
+
+
+/* debugger_hexdump_search_stop */
+static void _debugger_hexdump_search_stop(Debugger * debugger)
+{
+	if(debugger->dhx_search_source != 0)
+		g_source_remove(debugger->dhx_search_source);
+	debugger->dhx_search_source = 0;
+	if(debugger->dhx_search != NULL)
+		search_delete(debugger->dhx_search);
+	debugger->dhx_search = NULL;
+	debugger->dhx_search_hit = HEXDUMP_HIT_NONE;
+}
+
+
+/* debugger_hexdump_update */
+static void _debugger_hexdump_update(Debugger * debugger)
+{
+	GtkAllocation allocation;
+	gdouble value;
+	gdouble upper;
+	gdouble page;
+
+	gtk_widget_get_allocation(debugger->dhx_view, &allocation);
+	page = allocation.height / debugger->dhx_height;
+	if(page < 1.0)
+		page = 1.0;
+	upper = (debugger->dhx_size + HEXDUMP_COLUMNS - 1) / HEXDUMP_COLUMNS;
+	value = gtk_adjustment_get_value(debugger->dhx_adjustment);
+	if(value > upper - page)
+		value = (upper > page) ? upper - page : 0.0;
+	gtk_adjustment_configure(debugger->dhx_adjustment, value, 0.0, upper,
+			1.0, (page > 1.0) ? page - 1.0 : 1.0, page);
+	gtk_widget_queue_draw(debugger->dhx_view);
+}
+
+
+/* debugger_offset */
+static AsmSection const * _debugger_offset(Debugger * debugger,
+		uint64_t address, off_t * offset)
+{
+	AsmSection const * section;
+	size_t i;
+
+	/* the other way around */
+	address -= debugger->bias;
+	for(i = 0; i < debugger->sections_cnt; i++)
+	{
+		section = &debugger->sections[i];
+		if(address < (uint64_t)section->base
+				|| address - section->base >= section->size)
+			continue;
+		*offset = section->offset + (address - section->base);
+		return section;
+	}
+	return NULL;
+}
+
+
+/* debugger_profile_close */
+static void _debugger_profile_close(Debugger * debugger)
+{
+	gtk_list_store_clear(debugger->prf_store);
+	g_free(debugger->prf_total);
+	debugger->prf_total = NULL;
+	debugger->prf_samples = 0;
+	gtk_widget_queue_draw(debugger->dcg_view);
+}
+
+
+/* debugger_profile_function */
+static size_t _debugger_profile_function(Debugger * debugger,
+		uint64_t address)
+{
+	AsmFunction const * function;
+	off_t offset;
+	size_t i;
+
+	if(_debugger_offset(debugger, address, &offset) == NULL)
+		return CALLGRAPH_NONE;
+	if(debugger->dcg_graph != NULL)
+		return callgraph_get_function(debugger->dcg_graph, offset);
+	/* before the call graph is available */
+	for(i = 0; i < debugger->functions_cnt; i++)
+	{
+		function = &debugger->functions[i];
+		if(offset >= function->offset
+				&& offset < function->offset + function->size)
+			return i;
+	}
+	return CALLGRAPH_NONE;
+}
+
+
+/* debugger_stack_close */
+static void _debugger_stack_close(Debugger * debugger)
+{
+	gtk_list_store_clear(debugger->stk_store);
+	g_array_set_size(debugger->stk_values, 0);
+	debugger->stk_address = 0;
+	debugger->stk_word = 0;
+}
+
+
+/* debugger_stack_update */
+static void _stack_update_row(Debugger * debugger, GtkTreeIter * iter,
+		uint64_t address, uint64_t value);
+static void _stack_update_shift(Debugger * debugger, uint64_t address,
+		uint64_t const * values, size_t values_cnt);
+
+static void _debugger_stack_update(Debugger * debugger, uint64_t address,
+		unsigned int size)
+{
+	size_t word = (size > 0 && size <= 64) ? (size + 7) / 8 : 8;
+	unsigned char * buf;
+	ssize_t res;
+	size_t cnt;
+	uint64_t * values;
+	uint32_t u32;
+	uint16_t u16;
+	size_t i;
+	size_t start;
+	GtkTreeIter iter;
+	gboolean valid;
+
+	if(debugger->debug != NULL)
+	{
+		if(debugger->ddefinition->read_memory == NULL)
+			return;
+	}
+	/* otherwise from the memory image of the file, if any */
+	else if(debugger->bdefinition->read_memory == NULL)
+		return;
+	if(word != 2 && word != 4)
+		word = 8;
+	/* read the whole window at once */
+	buf = g_malloc(debugger->prefs.stack);
+	if(debugger->debug != NULL)
+		res = debugger->ddefinition->read_memory(debugger->debug,
+				address, buf, debugger->prefs.stack);
+	else
+		res = debugger->bdefinition->read_memory(debugger->backend,
+				address, buf, debugger->prefs.stack);
+	if(res < 0)
+		res = 0;
+	cnt = res / word;
+	values = g_new(uint64_t, cnt + 1);
+	for(i = 0; i < cnt; i++)
+		if(word == 2)
+		{
+			memcpy(&u16, &buf[i * word], word);
+			values[i] = u16;
+		}
+		else if(word == 4)
+		{
+			memcpy(&u32, &buf[i * word], word);
+			values[i] = u32;
+		}
+		else
+			memcpy(&values[i], &buf[i * word], word);
+	g_free(buf);
+	if(word != debugger->stk_word)
+	{
+		_debugger_stack_close(debugger);
+		debugger->stk_word = word;
+		debugger->stk_address = address;
+	}
+	/* keep the rows still valid where they are */
+	start = (address < debugger->stk_address)
+		? (debugger->stk_address - address) / word : 0;
+	_stack_update_shift(debugger, address, values, cnt);
+	/* only update the values which changed */
+	valid = gtk_tree_model_iter_nth_child(GTK_TREE_MODEL(
+				debugger->stk_store), &iter, NULL, start);
+	for(i = start; valid == TRUE && i < cnt; i++)
+	{
+		if(g_array_index(debugger->stk_values, uint64_t, i)
+				!= values[i])
+			_stack_update_row(debugger, &iter, address + i * word,
+					values[i]);
+		valid = gtk_tree_model_iter_next(GTK_TREE_MODEL(
+					debugger->stk_store), &iter);
+	}
+	g_array_set_size(debugger->stk_values, 0);
+	g_array_append_vals(debugger->stk_values, values, cnt);
+	debugger->stk_address = address;
+	g_free(values);
+}
+
+static void _stack_update_row(Debugger * debugger, GtkTreeIter * iter,
+		uint64_t address, uint64_t value)
+{
+	char const * format = (debugger->stk_word == 8) ? "%016" PRIx64
+		: ((debugger->stk_word == 4) ? "%08" PRIx64 : "%04" PRIx64);
+	char abuf[17];
+	char vbuf[17];
+
+	snprintf(abuf, sizeof(abuf), format, address);
+	snprintf(vbuf, sizeof(vbuf), format, value);
+	gtk_list_store_set(debugger->stk_store, iter, SV_ADDRESS, address,
+			SV_ADDRESS_DISPLAY, abuf, SV_VALUE, value,
+			SV_VALUE_DISPLAY, vbuf, -1);
+}
+
+static void _stack_update_shift(Debugger * debugger, uint64_t address,
+		uint64_t const * values, size_t values_cnt)
+{
+	GtkTreeModel * model = GTK_TREE_MODEL(debugger->stk_store);
+	size_t word = debugger->stk_word;
+	uint64_t previous = debugger->stk_address;
+	size_t cnt = debugger->stk_values->len;
+	size_t shift;
+	size_t i;
+	GtkTreeIter iter;
+
+	if(address % word != previous % word
+			|| (address < previous && (previous - address) / word
+				>= values_cnt)
+			|| (address > previous && (address - previous) / word
+				>= cnt))
+	{
+		/* nothing in common with the rows displayed */
+		gtk_list_store_clear(debugger->stk_store);
+		g_array_set_size(debugger->stk_values, 0);
+		cnt = 0;
+	}
+	else if(address < previous)
+	{
+		/* the stack grew: insert the new rows on top */
+		shift = (previous - address) / word;
+		for(i = 0; i < shift; i++)
+		{
+			gtk_list_store_insert(debugger->stk_store, &iter, i);
+			_stack_update_row(debugger, &iter, address + i * word,
+					values[i]);
+		}
+		g_array_insert_vals(debugger->stk_values, 0, values, shift);
+		cnt += shift;
+	}
+	else if(address > previous)
+	{
+		/* the stack shrank: remove the rows on top */
+		shift = (address - previous) / word;
+		for(i = 0; i < shift && gtk_tree_model_get_iter_first(model,
+					&iter); i++)
+			gtk_list_store_remove(debugger->stk_store, &iter);
+		g_array_remove_range(debugger->stk_values, 0, shift);
+		cnt -= shift;
+	}
+	/* adjust the number of rows at the bottom */
+	if(cnt > values_cnt)
+	{
+		gtk_tree_model_iter_nth_child(model, &iter, NULL, values_cnt);
+		while(gtk_list_store_remove(debugger->stk_store, &iter));
+		g_array_set_size(debugger->stk_values, values_cnt);
+	}
+	for(i = cnt; i < values_cnt; i++)
+	{
+		gtk_list_store_append(debugger->stk_store, &iter);
+		_stack_update_row(debugger, &iter, address + i * word,
+				values[i]);
+		g_array_append_val(debugger->stk_values, values[i]);
+	}
+}
+
+
+/* debugger_split */
+static gchar ** _debugger_split(char const * string)
+{
+	gchar ** selection;
+	gchar ** p;
+	gchar ** q;
+
+	if(string == NULL)
+		return NULL;
+	/* separated by commas or spaces, ignoring the empty ones */
+	selection = g_strsplit_set(string, ", \t", -1);
+	for(p = selection, q = selection; *p != NULL; p++)
+		if((*p)[0] == '\0')
+			g_free(*p);
+		else
+			*(q++) = *p;
+	*q = NULL;
+	if(selection[0] == NULL)
+	{
+		g_strfreev(selection);
+		selection = NULL;
+	}
+	return selection;
+}
+
+
+/* debugger_syscalls_close */
+static void _debugger_syscalls_close(Debugger * debugger)
+{
+	gtk_list_store_clear(debugger->sys_store);
+	g_free(debugger->sys_syscalls);
+	debugger->sys_syscalls = NULL;
+	debugger->sys_syscalls_cnt = 0;
+}
+
+
+/* debugger_syscalls_duration */
+static void _debugger_syscalls_duration(char * buf, size_t size,
+		uint64_t duration)
+{
+	if(duration < 1000)
+		snprintf(buf, size, "%" PRIu64 " ns", duration);
+	else if(duration < 1000000)
+		snprintf(buf, size, "%.1f us", duration / 1000.0);
+	else if(duration < 1000000000)
+		snprintf(buf, size, "%.1f ms", duration / 1000000.0);
+	else
+		snprintf(buf, size, "%.2f s", duration / 1000000000.0);
+}
+
+
+/* debugger_syscalls_select */
+static int _debugger_syscalls_select(Debugger * debugger)
+{
+	if(debugger->sys_selection == NULL)
+		return 0;
+	if(debugger->ddefinition->trace_syscalls == NULL)
+		return -debugger_error(debugger, _("Tracing system calls is"
+					" not supported by this plug-in"), 1);
+	_debugger_syscalls_close(debugger);
+	return debugger->ddefinition->trace_syscalls(debugger->debug,
+			(char const **)debugger->sys_selection,
+			g_strv_length(debugger->sys_selection));
+}
+
+
+/* debugger_threads_close */
+static void _debugger_threads_close(Debugger * debugger)
+{
+	debugger->thr_threads = NULL;
+	debugger->thr_threads_cnt = 0;
+	gtk_list_store_clear(debugger->thr_store);
+}
+
+
+/* debugger_tracepoints_close */
+static void _debugger_tracepoints_close(Debugger * debugger)
+{
+	gtk_list_store_clear(debugger->trc_store);
+}
+
+
+/* debugger_tracepoints_select */
+static int _debugger_tracepoints_select(Debugger * debugger)
+{
+	int ret;
+	uint64_t * addresses;
+	size_t cnt;
+	size_t i;
+
+	if(debugger->trc_selection == NULL)
+		return 0;
+	if(debugger->ddefinition->tracepoints == NULL)
+		return -debugger_error(debugger, _("Tracepoints are not"
+					" supported by this plug-in"), 1);
+	_debugger_tracepoints_close(debugger);
+	cnt = g_strv_length(debugger->trc_selection);
+	addresses = g_new(uint64_t, cnt);
+	for(i = 0; i < cnt; i++)
+		if(_debugger_breakpoints_address(debugger,
+					debugger->trc_selection[i],
+					&addresses[i]) != 0)
+		{
+			g_free(addresses);
+			return -1;
+		}
+	ret = debugger->ddefinition->tracepoints(debugger->debug, addresses,
+			cnt);
+	g_free(addresses);
+	return ret;
+}
+
+
+/* helpers */
+/* debugger_helper_error */
+static int _debugger_helper_error(Debugger * debugger, int code,
+		char const * format, ...)
+{
+	va_list ap;
+	int size;
+	char * message;
+
+	va_start(ap, format);
+	size = vsnprintf(NULL, 0, format, ap);
+	message = (size >= 0) ? malloc(size + 1) : NULL;
+	if(message != NULL)
+		vsnprintf(message, size + 1, format, ap);
+	va_end(ap);
+	if(message == NULL)
+		return code;
+	debugger_error(debugger, message, code);
+	free(message);
+	return code;
+}
+
+
+/* debugger_helper_set_bias */
+static void _debugger_helper_set_bias(Debugger * debugger, uint64_t bias)
+{
+	GtkTreeModel * model = GTK_TREE_MODEL(debugger->brk_store);
+	GtkTreeIter iter;
+	gboolean valid;
+	uint64_t address;
+	off_t offset;
+	Condition * condition;
+	char buf[19];
+
+	if(bias == debugger->bias)
+		return;
+	/* the breakpoints in the program move along, before being inserted */
+	for(valid = gtk_tree_model_get_iter_first(model, &iter); valid;
+			valid = gtk_tree_model_iter_next(model, &iter))
+	{
+		gtk_tree_model_get(model, &iter, BV_ADDRESS, &address,
+				BV_CONDITION, &condition, -1);
+		if(_debugger_offset(debugger, address, &offset) == NULL)
+			continue;
+		if(debugger->ddefinition->remove_breakpoint != NULL)
+			debugger->ddefinition->remove_breakpoint(
+					debugger->debug, address);
+		address += bias - debugger->bias;
+		if(debugger->ddefinition->add_breakpoint(debugger->debug,
+					address, (condition != NULL)
+					? condition_get_code(condition) : NULL)
+				!= 0)
+			continue;
+		snprintf(buf, sizeof(buf), "0x%016" PRIx64, address);
+		gtk_list_store_set(debugger->brk_store, &iter,
+				BV_ADDRESS, address, BV_ADDRESS_DISPLAY, buf,
+				-1);
+	}
+	debugger->bias = bias;
+	/* the agent has yet to patch the tracepoints */
+	_debugger_tracepoints_select(debugger);
+}
+
+
+/* debugger_helper_set_breakpoints */
+static void _debugger_helper_set_breakpoints(Debugger * debugger,
+		DebuggerDebugBreakpoint const * breakpoints,
+		size_t breakpoints_cnt)
+{
+	DebuggerDebugBreakpoint const * breakpoint;
+	size_t i;
+	GtkTreeIter iter;
+	char hbuf[21];
+	char sbuf[21];
+	char tbuf[16];
+	char abuf[16];
+	gchar * evaluation;
+
+	for(i = 0; i < breakpoints_cnt; i++)
+	{
+		breakpoint = &breakpoints[i];
+		if(!_debugger_breakpoints_find(debugger, breakpoint->address,
+					&iter))
+			continue;
+		snprintf(hbuf, sizeof(hbuf), "%" PRIu64, breakpoint->hits);
+		snprintf(sbuf, sizeof(sbuf), "%" PRIu64, breakpoint->stops);
+		/* in total and per hit */
+		_debugger_syscalls_duration(tbuf, sizeof(tbuf),
+				breakpoint->evaluation);
+		_debugger_syscalls_duration(abuf, sizeof(abuf),
+				(breakpoint->hits > 0) ? breakpoint->evaluation
+				/ breakpoint->hits : 0);
+		evaluation = g_strdup_printf("%s (%s)", tbuf, abuf);
+		gtk_list_store_set(debugger->brk_store, &iter,
+				BV_HITS, breakpoint->hits,
+				BV_HITS_DISPLAY, hbuf,
+				BV_STOPS, breakpoint->stops,
+				BV_STOPS_DISPLAY, sbuf,
+				BV_EVALUATION, breakpoint->evaluation,
+				BV_EVALUATION_DISPLAY, evaluation, -1);
+		g_free(evaluation);
+	}
+}
+
+
+/* debugger_helper_set_checkpoint */
+static void _debugger_helper_set_checkpoint(Debugger * debugger,
+		int checkpoint, int result)
+{
+	GArray * checkpoints = debugger->chk_checkpoints;
+	size_t i;
+
+	if(result == 0)
+		return;
+	/* it was never made, there is no going back to it */
+	for(i = 0; i < checkpoints->len; i++)
+		if(g_array_index(checkpoints, Checkpoint, i).id == checkpoint)
+		{
+			g_array_remove_index(checkpoints, i);
+			break;
+		}
+}
+
+
+/* debugger_helper_set_profile */
+static void _debugger_helper_set_profile(Debugger * debugger,
+		DebuggerDebugSample const * samples, size_t samples_cnt,
+		uint64_t duration)
+{
+	GtkListStore * store = debugger->prf_store;
+	const size_t unknown = debugger->functions_cnt;
+	uint64_t * self;
+	uint64_t * total;
+	size_t * seen;
+	size_t i;
+	size_t j;
+	size_t function;
+	size_t hottest = CALLGRAPH_NONE;
+	GtkTreeIter iter;
+	char buf[21];
+	char sbuf[8];
+	char tbuf[8];
+	gchar * status;
+
+	_debugger_profile_close(debugger);
+	/* the samples outside of any function known are counted last */
+	self = g_new0(uint64_t, unknown + 1);
+	total = g_new0(uint64_t, unknown + 1);
+	seen = g_new0(size_t, unknown + 1);
+	for(i = 0; i < samples_cnt; i++)
+	{
+		debugger->prf_samples += samples[i].count;
+		for(j = 0; j <= samples[i].callers_cnt; j++)
+		{
+			/* the calls themselves precede the return addresses */
+			function = _debugger_profile_function(debugger, (j == 0)
+					? samples[i].address
+					: samples[i].callers[j - 1] - 1);
+			if(function == CALLGRAPH_NONE)
+				function = unknown;
+			if(j == 0)
+				self[function] += samples[i].count;
+			/* once per sample, even if recursive */
+			if(seen[function] == i + 1)
+				continue;
+			seen[function] = i + 1;
+			total[function] += samples[i].count;
+		}
+	}
+	for(i = 0; i <= unknown; i++)
+	{
+		if(total[i] == 0)
+			continue;
+		if(i < unknown && (hottest == CALLGRAPH_NONE
+					|| self[i] > self[hottest]))
+			hottest = i;
+		snprintf(buf, sizeof(buf), "%" PRIu64, self[i]);
+		snprintf(sbuf, sizeof(sbuf), "%.2f", self[i] * 100.0
+				/ debugger->prf_samples);
+		snprintf(tbuf, sizeof(tbuf), "%.2f", total[i] * 100.0
+				/ debugger->prf_samples);
+		gtk_list_store_append(store, &iter);
+		gtk_list_store_set(store, &iter,
+				PV_NAME, (i < unknown)
+				? debugger->functions[i].name : _("Unknown"),
+				PV_SAMPLES, self[i], PV_SAMPLES_DISPLAY, buf,
+				PV_SELF_DISPLAY, sbuf,
+				PV_TOTAL, total[i], PV_TOTAL_DISPLAY, tbuf,
+				-1);
+	}
+	g_free(seen);
+	g_free(self);
+	/* kept for the call graph */
+	debugger->prf_total = total;
+	status = g_strdup_printf(_("%lu samples in %.2f s (%.0f per second)"),
+			(unsigned long)debugger->prf_samples,
+			duration / 1000000.0, (duration > 0)
+			? debugger->prf_samples * 1000000.0 / duration : 0.0);
+	_debugger_set_status(debugger, status);
+	g_free(status);
+	/* show where the time was spent */
+	_debugger_call_graph_focus(debugger, hottest);
+	gtk_notebook_set_current_page(GTK_NOTEBOOK(debugger->notebook),
+			NP_PROFILE);
+}
+
+
+/* debugger_helper_set_register */
+static void _debugger_helper_set_register(Debugger * debugger,
+		char const * name, uint64_t value)
+{
+	DebuggerDebugRegister reg;
+
+	reg.name = name;
+	reg.value = value;
+	_debugger_helper_set_registers(debugger, &reg, 1);
+}
+
+
+/* debugger_helper_set_registers */
+static void _debugger_helper_set_registers(Debugger * debugger,
+		DebuggerDebugRegister const * registers, size_t registers_cnt)
+{
+	size_t i;
+	DebuggerRegister * reg;
+	DebuggerRegister const * pc = NULL;
+	DebuggerRegister const * sp = NULL;
+	char buf[33];
+	GArray * deltas = NULL;
+	CheckpointDelta delta;
+
+	/* stopped after a command, kept for going back */
+	if(debugger->chk_pending != CC_NONE)
+		deltas = g_array_new(FALSE, FALSE, sizeof(delta));
+	for(i = 0; i < registers_cnt; i++)
+	{
+		if((reg = g_hash_table_lookup(debugger->reg_index,
+						registers[i].name)) == NULL)
+			continue;
+		if(g_ascii_strcasecmp(registers[i].name, "rip") == 0
+				|| g_ascii_strcasecmp(registers[i].name,
+					"eip") == 0
+				|| g_ascii_strcasecmp(registers[i].name,
+					"pc") == 0)
+			pc = reg;
+		else if(g_ascii_strcasecmp(registers[i].name, "rsp") == 0
+				|| g_ascii_strcasecmp(registers[i].name,
+					"esp") == 0
+				|| g_ascii_strcasecmp(registers[i].name,
+					"sp") == 0)
+			sp = reg;
+		/* only update the rows which changed */
+		if(reg->set && reg->value == registers[i].value)
+			continue;
+		reg->value = registers[i].value;
+		reg->set = TRUE;
+		if(deltas != NULL)
+		{
+			delta.reg = reg;
+			delta.value = reg->value;
+			g_array_append_val(deltas, delta);
+		}
+		if(reg->size <= 16)
+			snprintf(buf, sizeof(buf), "%04" PRIx64, reg->value);
+		else if(reg->size <= 20)
+			snprintf(buf, sizeof(buf), "%05" PRIx64, reg->value);
+		else if(reg->size <= 32)
+			snprintf(buf, sizeof(buf), "%08" PRIx64, reg->value);
+		else if(reg->size <= 64)
+			snprintf(buf, sizeof(buf), "%016" PRIx64, reg->value);
+		else
+			snprintf(buf, sizeof(buf), "%032" PRIx64, reg->value);
+		gtk_list_store_set(debugger->reg_store, &reg->iter,
+				RV_VALUE, reg->value, RV_VALUE_DISPLAY, buf,
+				-1);
+	}
+	/* the stack may have changed even if the pointer did not */
+	if(sp != NULL)
+		_debugger_stack_update(debugger, sp->value, sp->size);
+	/* follow the program counter */
+	if(pc != NULL)
+	{
+		_debugger_disassembly_goto_address(debugger, pc->value);
+		if(debugger->dcg_graph != NULL && debugger->das_pc >= 0)
+			_debugger_call_graph_focus(debugger,
+					callgraph_get_function(
+						debugger->dcg_graph,
+						debugger->das_pc));
+	}
+	_debugger_checkpoints_stopped(debugger, deltas);
+}
+
+
+/* debugger_helper_set_syscalls */
+static void _set_syscalls_percentile(DebuggerDebugSyscall const * syscall,
+		unsigned int percent, char * buf, size_t size);
+
+static void _debugger_helper_set_syscalls(Debugger * debugger,
+		DebuggerDebugSyscall const * syscalls, size_t syscalls_cnt)
+{
+	GtkListStore * store = debugger->sys_store;
+	DebuggerDebugSyscall const * syscall;
+	uint64_t average;
+	size_t i;
+	GtkTreeIter iter;
+	char name[11];
+	char buf[21];
+	char tbuf[16];
+	char abuf[16];
+	char mbuf[16];
+	char median[24];
+	char tail[24];
+	gchar * latency;
+
+	_debugger_syscalls_close(debugger);
+	debugger->sys_syscalls = g_new(DebuggerDebugSyscall, syscalls_cnt);
+	memcpy(debugger->sys_syscalls, syscalls,
+			sizeof(*syscalls) * syscalls_cnt);
+	debugger->sys_syscalls_cnt = syscalls_cnt;
+	for(i = 0; i < syscalls_cnt; i++)
+	{
+		syscall = &syscalls[i];
+		if(syscall->name == NULL)
+			snprintf(name, sizeof(name), "%u", syscall->number);
+		average = (syscall->count > 0)
+			? syscall->total / syscall->count : 0;
+		snprintf(buf, sizeof(buf), "%" PRIu64, syscall->count);
+		_debugger_syscalls_duration(tbuf, sizeof(tbuf), syscall->total);
+		_debugger_syscalls_duration(abuf, sizeof(abuf), average);
+		_debugger_syscalls_duration(mbuf, sizeof(mbuf),
+				syscall->maximum);
+		if(syscall->count > 0)
+		{
+			_set_syscalls_percentile(syscall, 50, median,
+					sizeof(median));
+			_set_syscalls_percentile(syscall, 99, tail,
+					sizeof(tail));
+			latency = g_strdup_printf("%s, %s", median, tail);
+		}
+		else
+			latency = NULL;
+		gtk_list_store_append(store, &iter);
+		gtk_list_store_set(store, &iter,
+				SCV_NAME, (syscall->name != NULL)
+				? syscall->name : name,
+				SCV_CALLS, syscall->count,
+				SCV_CALLS_DISPLAY, buf,
+				SCV_TOTAL, syscall->total,
+				SCV_TOTAL_DISPLAY, tbuf,
+				SCV_AVERAGE, average,
+				SCV_AVERAGE_DISPLAY, abuf,
+				SCV_MAXIMUM, syscall->maximum,
+				SCV_MAXIMUM_DISPLAY, mbuf,
+				SCV_LATENCY_DISPLAY, latency, -1);
+		g_free(latency);
+	}
+}
+
+static void _set_syscalls_percentile(DebuggerDebugSyscall const * syscall,
+		unsigned int percent, char * buf, size_t size)
+{
+	uint64_t calls = 0;
+	size_t i;
+	char duration[16];
+
+	/* the first bucket reaching the percentage of the calls */
+	for(i = 0; i < DEBUGGER_DEBUG_HISTOGRAM - 1; i++)
+		if((calls += syscall->histogram[i]) * 100
+				>= syscall->count * percent)
+			break;
+	if(i < DEBUGGER_DEBUG_HISTOGRAM - 1)
+	{
+		_debugger_syscalls_duration(duration, sizeof(duration),
+				(uint64_t)1 << (i + 1));
+		snprintf(buf, size, "%u%% < %s", percent, duration);
+	}
+	else
+	{
+		_debugger_syscalls_duration(duration, sizeof(duration),
+				(uint64_t)1 << i);
+		snprintf(buf, size, "%u%% >= %s", percent, duration);
+	}
+}
+
+
+/* debugger_helper_set_tracepoints */
+static void _debugger_helper_set_tracepoints(Debugger * debugger,
+		DebuggerDebugTracepoint const * tracepoints,
+		size_t tracepoints_cnt)
+{
+	GtkTreeModel * model = GTK_TREE_MODEL(debugger->trc_store);
+	DebuggerDebugTracepoint const * tracepoint;
+	size_t i;
+	size_t j;
+	GtkTreeIter iter;
+	gboolean valid;
+	uint64_t address;
+	char abuf[19];
+	char ebuf[21];
+	char dbuf[21];
+	char tbuf[21];
+	char const * status;
+	GString * arguments;
+
+	arguments = g_string_new(NULL);
+	for(i = 0; i < tracepoints_cnt; i++)
+	{
+		tracepoint = &tracepoints[i];
+		/* updated in place, as the program keeps running */
+		for(valid = gtk_tree_model_get_iter_first(model, &iter); valid;
+				valid = gtk_tree_model_iter_next(model, &iter))
+		{
+			gtk_tree_model_get(model, &iter, TV_ADDRESS, &address,
+					-1);
+			if(address == tracepoint->address)
+				break;
+		}
+		if(!valid)
+		{
+			snprintf(abuf, sizeof(abuf), "0x%016" PRIx64,
+					tracepoint->address);
+			gtk_list_store_append(debugger->trc_store, &iter);
+			gtk_list_store_set(debugger->trc_store, &iter,
+					TV_ADDRESS, tracepoint->address,
+					TV_ADDRESS_DISPLAY, abuf, -1);
+		}
+		status = ((size_t)tracepoint->status < G_N_ELEMENTS(
+					_debugger_tracepoint_status))
+			? _(_debugger_tracepoint_status[tracepoint->status])
+			: NULL;
+		snprintf(ebuf, sizeof(ebuf), "%" PRIu64, tracepoint->count);
+		snprintf(dbuf, sizeof(dbuf), "%" PRIu64, tracepoint->dropped);
+		snprintf(tbuf, sizeof(tbuf), "%" PRIu64, tracepoint->thread);
+		g_string_truncate(arguments, 0);
+		for(j = 0; tracepoint->count > 0
+				&& j < DEBUGGER_DEBUG_ARGUMENTS; j++)
+			g_string_append_printf(arguments, "%s0x%" PRIx64,
+					(j > 0) ? ", " : "",
+					tracepoint->arguments[j]);
+		gtk_list_store_set(debugger->trc_store, &iter,
+				TV_STATUS, status,
+				TV_EVENTS, tracepoint->count,
+				TV_EVENTS_DISPLAY, ebuf,
+				TV_DROPPED, tracepoint->dropped,
+				TV_DROPPED_DISPLAY, dbuf,
+				TV_THREAD, (tracepoint->count > 0) ? tbuf
+				: NULL,
+				TV_ARGUMENTS, arguments->str, -1);
+	}
+	g_string_free(arguments, TRUE);
+}
+
+
+/* helpers: backend */
+/* debugger_helper_backend_set_call_graph */
+static void _debugger_helper_backend_set_call_graph(Debugger * debugger,
+		CallGraph const * graph)
+{
+	size_t function = debugger->dcg_focus;
+	gchar * status;
+
+	debugger->dcg_graph = graph;
+	debugger->dcg_focus = CALLGRAPH_NONE;
+	debugger->dcg_layout = FALSE;
+	status = g_strdup_printf(_("%lu calls between %lu functions"),
+			(unsigned long)callgraph_get_edges_count(graph),
+			(unsigned long)debugger->functions_cnt);
+	_debugger_set_status(debugger, status);
+	g_free(status);
+	/* keep the focus as the graph grows, or start from the program
+	 * counter or the entry point */
+	if(function == CALLGRAPH_NONE && debugger->das_pc >= 0)
+		function = callgraph_get_function(graph, debugger->das_pc);
+	if(function == CALLGRAPH_NONE)
+		function = callgraph_get_function_by_name(graph, "main");
+	if(function == CALLGRAPH_NONE && debugger->functions_cnt > 0)
+		function = 0;
+	_debugger_call_graph_focus(debugger, function);
+}
+
+
+/* debugger_helper_backend_set_functions */
+static void _debugger_helper_backend_set_functions(Debugger * debugger,
+		AsmFunction const * functions, size_t functions_cnt)
+{
+	gchar * status;
+
+	debugger->functions = functions;
+	debugger->functions_cnt = functions_cnt;
+	status = g_strdup_printf(_("%lu functions in %lu sections"),
+			(unsigned long)functions_cnt,
+			(unsigned long)debugger->sections_cnt);
+	_debugger_set_status(debugger, status);
+	g_free(status);
+	/* only what is displayed gets decoded */
+	disassembly_set_functions(debugger->das, functions, functions_cnt);
+	if(debugger->sections_cnt > 0)
+		_debugger_disassembly_goto(debugger, &debugger->sections[0],
+				debugger->sections[0].offset);
+}
+
+
+/* debugger_helper_backend_set_registers */
+static void _debugger_helper_backend_set_registers(Debugger * debugger,
+		AsmArchRegister const * registers, size_t registers_cnt)
+{
+	GtkTreeModel * model;
+	size_t i;
+	GtkTreeIter iter;
+	DebuggerRegister * reg;
+
+	model = gtk_tree_view_get_model(GTK_TREE_VIEW(debugger->reg_tree));
+	g_hash_table_remove_all(debugger->reg_index);
+	gtk_list_store_clear(GTK_LIST_STORE(model));
+	for(i = 0; i < registers_cnt; i++)
+	{
+		if(registers[i].flags & ARF_ALIAS)
+			continue;
+		gtk_list_store_append(GTK_LIST_STORE(model), &iter);
+		gtk_list_store_set(GTK_LIST_STORE(model), &iter,
+				RV_NAME, registers[i].name,
+				RV_SIZE, registers[i].size, -1);
+		/* the iterators of list stores persist */
+		reg = g_new(DebuggerRegister, 1);
+		reg->iter = iter;
+		reg->size = registers[i].size;
+		reg->value = 0;
+		reg->set = FALSE;
+		g_hash_table_insert(debugger->reg_index,
+				(gpointer)registers[i].name, reg);
+	}
+}
+
+
+/* debugger_helper_backend_set_sections */
+static void _debugger_helper_backend_set_sections(Debugger * debugger,
+		AsmSection const * sections, size_t sections_cnt)
+{
+	debugger->sections = sections;
+	debugger->sections_cnt = sections_cnt;
+}
+
+
+/* debugger_helper_backend_set_threads */
+static void _debugger_helper_backend_set_threads(Debugger * debugger,
+		DebuggerBackendThread const * threads, size_t threads_cnt)
+{
+	size_t i;
+	GtkTreeIter iter;
+	char ibuf[24];
+	gchar * sbuf;
+	gchar * status;
+
+	_debugger_threads_close(debugger);
+	/* kept by the backend until closed */
+	debugger->thr_threads = threads;
+	debugger->thr_threads_cnt = threads_cnt;
+	for(i = 0; i < threads_cnt; i++)
+	{
+		snprintf(ibuf, sizeof(ibuf), "%" PRIu64, threads[i].id);
+		sbuf = (threads[i].signal != 0) ? g_strdup_printf("%u (%s)",
+				threads[i].signal, g_strsignal(
+					threads[i].signal)) : NULL;
+		gtk_list_store_append(debugger->thr_store, &iter);
+		gtk_list_store_set(debugger->thr_store, &iter,
+				THV_ID, threads[i].id, THV_ID_DISPLAY, ibuf,
+				THV_SIGNAL_DISPLAY, sbuf, -1);
+		g_free(sbuf);
+	}
+	status = g_strdup_printf(_("%lu threads"), (unsigned long)threads_cnt);
+	_debugger_set_status(debugger, status);
+	g_free(status);
+	/* the first one was usually stopped by the signal */
+	if(gtk_tree_model_get_iter_first(GTK_TREE_MODEL(debugger->thr_store),
+				&iter))
+		gtk_tree_selection_select_iter(gtk_tree_view_get_selection(
+					GTK_TREE_VIEW(debugger->thr_tree)),
+				&iter);
+}
+
+
+/* callbacks */
+/* debugger_on_about */
+static void _debugger_on_about(gpointer data)
+{
+	Debugger * debugger = data;
+	GtkWidget * dialog;
+
+	dialog = desktop_about_dialog_new();
+	gtk_window_set_transient_for(GTK_WINDOW(dialog), GTK_WINDOW(
+				debugger->window));
+	desktop_about_dialog_set_authors(dialog, _debugger_authors);
+	desktop_about_dialog_set_comments(dialog,
 			_("Debugger for the DeforaOS desktop"));
 	desktop_about_dialog_set_copyright(dialog, _debugger_copyright);
 	desktop_about_dialog_set_logo_icon_name(dialog,
@@ -1059,6 +4214,242 @@ static void _debugger_on_about(gpointer data)
 }
 
 
+/* debugger_on_breakpoint_add */
+static void _debugger_on_breakpoint_add(gpointer data)
+{
+	Debugger * debugger = data;
+
+	debugger_add_breakpoint_dialog(debugger);
+}
+
+
+/* debugger_on_breakpoint_remove */
+static void _debugger_on_breakpoint_remove(gpointer data)
+{
+	Debugger * debugger = data;
+	GtkTreeSelection * selection;
+	GtkTreeModel * model;
+	GtkTreeIter iter;
+	uint64_t address;
+
+	selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(
+				debugger->brk_tree));
+	if(gtk_tree_selection_get_selected(selection, &model, &iter) != TRUE)
+	{
+		gtk_notebook_set_current_page(GTK_NOTEBOOK(debugger->notebook),
+				NP_BREAKPOINTS);
+		_debugger_set_status(debugger,
+				_("Select the breakpoint to remove first"));
+		return;
+	}
+	gtk_tree_model_get(model, &iter, BV_ADDRESS, &address, -1);
+	debugger_remove_breakpoint(debugger, address);
+}
+
+
+/* debugger_on_call_graph_button_press */
+static gboolean _debugger_on_call_graph_button_press(GtkWidget * widget,
+		GdkEventButton * event, gpointer data)
+{
+	Debugger * debugger = data;
+	CallGraphNode * node;
+	AsmFunction const * function;
+	size_t i;
+	(void) widget;
+
+	if(event->type != GDK_BUTTON_PRESS || event->button != 1)
+		return FALSE;
+	for(i = 0; i < debugger->dcg_nodes->len; i++)
+	{
+		node = &g_array_index(debugger->dcg_nodes, CallGraphNode, i);
+		if(event->x < node->area.x || event->y < node->area.y
+				|| event->x >= node->area.x + node->area.width
+				|| event->y >= node->area.y
+				+ node->area.height)
+			continue;
+		if(node->function == CALLGRAPH_NONE)
+			return TRUE;
+		if(node->function != debugger->dcg_focus)
+		{
+			_debugger_call_graph_focus(debugger, node->function);
+			return TRUE;
+		}
+		/* show the function currently selected */
+		function = &debugger->functions[node->function];
+		for(i = 0; i < debugger->sections_cnt; i++)
+			if(function->offset >= debugger->sections[i].offset
+					&& (size_t)(function->offset
+						- debugger->sections[i].offset)
+					< debugger->sections[i].size)
+			{
+				_debugger_disassembly_goto(debugger,
+						&debugger->sections[i],
+						function->offset);
+				_debugger_on_view_disassembly(debugger);
+				break;
+			}
+		return TRUE;
+	}
+	return FALSE;
+}
+
+
+/* debugger_on_call_graph_draw */
+static void _call_graph_draw(Debugger * debugger, GtkWidget * widget,
+		cairo_t * cr);
+static void _call_graph_draw_edge(cairo_t * cr, GdkRectangle * from,
+		GdkRectangle * to);
+
+#if GTK_CHECK_VERSION(3, 0, 0)
+static gboolean _debugger_on_call_graph_draw(GtkWidget * widget, cairo_t * cr,
+		gpointer data)
+{
+	Debugger * debugger = data;
+	GtkStyleContext * style;
+	GdkRGBA color;
+
+	style = gtk_widget_get_style_context(widget);
+	gtk_render_background(style, cr, 0, 0,
+			gtk_widget_get_allocated_width(widget),
+			gtk_widget_get_allocated_height(widget));
+	gtk_style_context_get_color(style, gtk_widget_get_state_flags(widget),
+			&color);
+	gdk_cairo_set_source_rgba(cr, &color);
+	_call_graph_draw(debugger, widget, cr);
+	return TRUE;
+}
+#else
+static gboolean _debugger_on_call_graph_expose(GtkWidget * widget,
+		GdkEventExpose * event, gpointer data)
+{
+	Debugger * debugger = data;
+	cairo_t * cr;
+	(void) event;
+
+	cr = gdk_cairo_create(gtk_widget_get_window(widget));
+	gdk_cairo_set_source_color(cr,
+			&gtk_widget_get_style(widget)->text[GTK_STATE_NORMAL]);
+	_call_graph_draw(debugger, widget, cr);
+	cairo_destroy(cr);
+	return TRUE;
+}
+#endif
+
+static void _call_graph_draw(Debugger * debugger, GtkWidget * widget,
+		cairo_t * cr)
+{
+	GtkAllocation allocation;
+	PangoLayout * layout;
+	CallGraphNode * focus;
+	CallGraphNode * node;
+	size_t i;
+	char const * name;
+	gchar * p;
+
+	gtk_widget_get_allocation(widget, &allocation);
+	if(debugger->dcg_layout == FALSE)
+		_debugger_call_graph_layout(debugger, allocation.width,
+				allocation.height);
+	if(debugger->dcg_nodes->len == 0)
+		return;
+	layout = gtk_widget_create_pango_layout(widget, NULL);
+	pango_layout_set_ellipsize(layout, PANGO_ELLIPSIZE_END);
+	cairo_set_line_width(cr, 1.0);
+	/* the function in focus comes first, then its callers and callees */
+	focus = &g_array_index(debugger->dcg_nodes, CallGraphNode, 0);
+	for(i = 0; i < debugger->dcg_nodes->len; i++)
+	{
+		node = &g_array_index(debugger->dcg_nodes, CallGraphNode, i);
+		if(node->function == CALLGRAPH_NONE)
+		{
+			p = g_strdup_printf(_("%lu more..."),
+					(unsigned long)node->more);
+			pango_layout_set_text(layout, p, -1);
+			g_free(p);
+		}
+		else
+		{
+			name = debugger->functions[node->function].name;
+			/* along with the share of the samples if profiled */
+			if(debugger->prf_total != NULL)
+				name = p = g_strdup_printf("%s (%.1f%%)", name,
+						debugger->prf_total[
+						node->function] * 100.0
+						/ debugger->prf_samples);
+			else
+				p = NULL;
+			if(node->area.x < focus->area.x)
+				_call_graph_draw_edge(cr, &node->area,
+						&focus->area);
+			else if(node->area.x > focus->area.x)
+				_call_graph_draw_edge(cr, &focus->area,
+						&node->area);
+			cairo_rectangle(cr, node->area.x + 0.5,
+					node->area.y + 0.5,
+					node->area.width - 1,
+					node->area.height - 1);
+			cairo_stroke(cr);
+			pango_layout_set_text(layout, name, -1);
+			g_free(p);
+		}
+		pango_layout_set_font_description(layout, (node == focus)
+				? debugger->bold : NULL);
+		pango_layout_set_width(layout, (node->area.width
+					- CALL_GRAPH_MARGIN) * PANGO_SCALE);
+		cairo_move_to(cr, node->area.x + CALL_GRAPH_MARGIN / 2,
+				node->area.y + CALL_GRAPH_MARGIN / 2);
+		pango_cairo_show_layout(cr, layout);
+	}
+	g_object_unref(layout);
+}
+
+static void _call_graph_draw_edge(cairo_t * cr, GdkRectangle * from,
+		GdkRectangle * to)
+{
+	cairo_move_to(cr, from->x + from->width, from->y + from->height / 2);
+	cairo_line_to(cr, to->x, to->y + to->height / 2);
+	cairo_stroke(cr);
+}
+
+
+/* debugger_on_call_graph_size_allocate */
+static void _debugger_on_call_graph_size_allocate(GtkWidget * widget,
+		GtkAllocation * allocation, gpointer data)
+{
+	Debugger * debugger = data;
+	(void) widget;
+	(void) allocation;
+
+	debugger->dcg_layout = FALSE;
+}
+
+
+/* debugger_on_checkpoint */
+static void _debugger_on_checkpoint(gpointer data)
+{
+	Debugger * debugger = data;
+
+	debugger_checkpoint(debugger);
+}
+
+
+/* debugger_on_checkpoints_replay */
+static gboolean _debugger_on_checkpoints_replay(gpointer data)
+{
+	Debugger * debugger = data;
+	CheckpointStop * stop;
+
+	debugger->chk_source = 0;
+	if(debugger->chk_replay == FALSE)
+		return FALSE;
+	stop = &g_array_index(debugger->chk_history, CheckpointStop,
+			debugger->chk_position - debugger->chk_base);
+	if(_debugger_checkpoints_command(debugger, stop->command) != 0)
+		debugger->chk_replay = FALSE;
+	return FALSE;
+}
+
+
 /* debugger_on_close */
 static void _debugger_on_close(gpointer data)
 {
@@ -1089,44 +4480,437 @@ static void _debugger_on_continue(gpointer data)
 }
 
 
-/* debugger_on_idle */
-static gboolean _debugger_on_idle(gpointer data)
+/* debugger_on_disassembly_decode */
+static int _debugger_on_disassembly_decode(void * data, off_t offset,
+		size_t size, off_t base, AsmArchInstructionCall ** calls,
+		size_t * calls_cnt)
+{
+	Debugger * debugger = data;
+
+	if(debugger->bdefinition->decode == NULL)
+		return -error_set_code(1, "%s", _("Disassembly is not"
+					" available for this file"));
+	return debugger->bdefinition->decode(debugger->backend, offset, size,
+			base, calls, calls_cnt);
+}
+
+
+/* debugger_on_disassembly_value_changed */
+static void _debugger_on_disassembly_value_changed(gpointer data)
+{
+	Debugger * debugger = data;
+	GtkAdjustment * adjustment;
+	GdkRectangle rect;
+	GtkTextIter iter;
+	gdouble value;
+	gdouble page;
+	gint line;
+	size_t lines;
+
+	if(debugger->das_section == NULL || debugger->das_busy)
+		return;
+	adjustment = debugger->das_adjustment;
+	value = gtk_adjustment_get_value(adjustment);
+	page = gtk_adjustment_get_page_size(adjustment);
+	debugger->das_busy = TRUE;
+	if(value + page * 2 >= gtk_adjustment_get_upper(adjustment))
+		_debugger_disassembly_append(debugger);
+	else if(value < page)
+	{
+		/* keep the same line at the top of the view */
+		gtk_text_view_get_visible_rect(GTK_TEXT_VIEW(
+					debugger->das_view), &rect);
+		gtk_text_view_get_line_at_y(GTK_TEXT_VIEW(debugger->das_view),
+				&iter, rect.y, NULL);
+		line = gtk_text_iter_get_line(&iter);
+		if(_debugger_disassembly_prepend(debugger) > 0)
+		{
+			lines = g_array_index(debugger->das_ranges,
+					DisassemblyRange, 0).lines;
+			gtk_text_buffer_get_iter_at_line(debugger->das_tbuf,
+					&iter, line + lines);
+			gtk_text_buffer_move_mark(debugger->das_tbuf,
+					debugger->das_top, &iter);
+			gtk_text_view_scroll_to_mark(GTK_TEXT_VIEW(
+						debugger->das_view),
+					debugger->das_top, 0.0, TRUE, 0.0, 0.0);
+		}
+	}
+	debugger->das_busy = FALSE;
+}
+
+
+/* debugger_on_hexdump_draw */
+static void _hexdump_draw(Debugger * debugger, GtkWidget * widget,
+		cairo_t * cr);
+static void _hexdump_draw_hit(Debugger * debugger, PangoLayout * layout,
+		char const * buf, size_t pos, size_t size);
+
+#if GTK_CHECK_VERSION(3, 0, 0)
+static gboolean _debugger_on_hexdump_draw(GtkWidget * widget, cairo_t * cr,
+		gpointer data)
+{
+	Debugger * debugger = data;
+	GtkStyleContext * style;
+	GdkRGBA color;
+
+	style = gtk_widget_get_style_context(widget);
+	gtk_render_background(style, cr, 0, 0,
+			gtk_widget_get_allocated_width(widget),
+			gtk_widget_get_allocated_height(widget));
+	gtk_style_context_get_color(style, gtk_widget_get_state_flags(widget),
+			&color);
+	gdk_cairo_set_source_rgba(cr, &color);
+	_hexdump_draw(debugger, widget, cr);
+	return TRUE;
+}
+#else
+static gboolean _debugger_on_hexdump_expose(GtkWidget * widget,
+		GdkEventExpose * event, gpointer data)
 {
 	Debugger * debugger = data;
-	char buf[16];
+	cairo_t * cr;
+	(void) event;
+
+	cr = gdk_cairo_create(gtk_widget_get_window(widget));
+	gdk_cairo_set_source_color(cr,
+			&gtk_widget_get_style(widget)->text[GTK_STATE_NORMAL]);
+	_hexdump_draw(debugger, widget, cr);
+	cairo_destroy(cr);
+	return TRUE;
+}
+#endif
+
+static void _hexdump_draw(Debugger * debugger, GtkWidget * widget,
+		cairo_t * cr)
+{
+	GtkAllocation allocation;
+	PangoLayout * layout;
+	size_t pos;
 	size_t size;
+	size_t len;
+	char * buf;
+
+	if(debugger->dhx_data == NULL || debugger->dhx_size == 0)
+		return;
+	gtk_widget_get_allocation(widget, &allocation);
+	/* only format the rows visible */
+	pos = gtk_adjustment_get_value(debugger->dhx_adjustment);
+	if((pos *= HEXDUMP_COLUMNS) >= debugger->dhx_size)
+		return;
+	size = (allocation.height / debugger->dhx_height + 1) * HEXDUMP_COLUMNS;
+	if(size > debugger->dhx_size - pos)
+		size = debugger->dhx_size - pos;
+	if((buf = malloc(HEXDUMP_FORMAT_SIZE(size))) == NULL)
+		return;
+	len = hexdump_format(buf, pos, &debugger->dhx_data[pos], size,
+			debugger->prefs.uppercase);
+	layout = gtk_widget_create_pango_layout(widget, NULL);
+	pango_layout_set_font_description(layout, debugger->monospace);
+	pango_layout_set_text(layout, buf, len);
+	if(debugger->dhx_search != NULL
+			&& debugger->dhx_search_hit != HEXDUMP_HIT_NONE)
+		_hexdump_draw_hit(debugger, layout, buf, pos, size);
+	pango_cairo_show_layout(cr, layout);
+	g_object_unref(layout);
+	free(buf);
+}
+
+static void _hexdump_draw_hit(Debugger * debugger, PangoLayout * layout,
+		char const * buf, size_t pos, size_t size)
+{
+	SearchHit const * hits;
+	size_t cnt;
+	size_t i;
+	size_t end;
+	size_t row = 0;
+	char const * p = buf;
+	size_t col;
+	PangoAttrList * attrs;
+	PangoAttribute * attr;
+
+	hits = search_get_hits(debugger->dhx_search, &cnt);
+	if(debugger->dhx_search_hit >= cnt)
+		return;
+	/* highlight the bytes of the current hit which are visible */
+	i = hits[debugger->dhx_search_hit].offset;
+	end = i + hits[debugger->dhx_search_hit].length;
+	if(i < pos)
+		i = pos;
+	if(end > pos + size)
+		end = pos + size;
+	if(i >= end)
+		return;
+	attrs = pango_attr_list_new();
+	for(; i < end; i++)
+	{
+		for(; row < (i - pos) / HEXDUMP_COLUMNS; row++)
+			p = strchr(p, '\n') + 1;
+		/* skip the offset */
+		col = (((uint64_t)i > 0xffffffff) ? 16 : 8) + 2;
+		attr = pango_attr_background_new(0xffff, 0xffff, 0x0000);
+		attr->start_index = (p - buf) + col
+			+ ((i - pos) % HEXDUMP_COLUMNS) * 3;
+		attr->end_index = attr->start_index + 2;
+		pango_attr_list_insert(attrs, attr);
+		attr = pango_attr_background_new(0xffff, 0xffff, 0x0000);
+		attr->start_index = (p - buf) + col + HEXDUMP_COLUMNS * 3 + 1
+			+ ((i - pos) % HEXDUMP_COLUMNS);
+		attr->end_index = attr->start_index + 1;
+		pango_attr_list_insert(attrs, attr);
+	}
+	pango_layout_set_attributes(layout, attrs);
+	pango_attr_list_unref(attrs);
+}
+
 
-	if(debugger->fp == NULL)
+/* debugger_on_hexdump_key_press */
+static gboolean _debugger_on_hexdump_key_press(GtkWidget * widget,
+		GdkEventKey * event, gpointer data)
+{
+	Debugger * debugger = data;
+	GtkAdjustment * adjustment = debugger->dhx_adjustment;
+	gdouble value;
+	gdouble page;
+	(void) widget;
+
+	value = gtk_adjustment_get_value(adjustment);
+	page = gtk_adjustment_get_page_increment(adjustment);
+	switch(event->keyval)
 	{
-		debugger->fp = fopen(debugger->filename, "r");
-		debugger->pos = 0;
+		case GDK_KEY_Up:
+			value -= 1.0;
+			break;
+		case GDK_KEY_Down:
+			value += 1.0;
+			break;
+		case GDK_KEY_Page_Up:
+			value -= page;
+			break;
+		case GDK_KEY_Page_Down:
+			value += page;
+			break;
+		case GDK_KEY_Home:
+			value = gtk_adjustment_get_lower(adjustment);
+			break;
+		case GDK_KEY_End:
+			value = gtk_adjustment_get_upper(adjustment);
+			break;
+		default:
+			return FALSE;
 	}
-	if(debugger->fp != NULL)
+	/* the value is clamped */
+	gtk_adjustment_set_value(adjustment, value);
+	return TRUE;
+}
+
+
+/* debugger_on_hexdump_read */
+static void _read_status(Debugger * debugger);
+
+static gboolean _debugger_on_hexdump_read(GIOChannel * source,
+		GIOCondition condition, gpointer data)
+{
+	Debugger * debugger = data;
+	GByteArray * buffer = debugger->dhx_buffer;
+	int fd = g_io_channel_unix_get_fd(source);
+	gint64 deadline;
+	size_t len;
+	size_t size;
+	ssize_t res;
+	int error = 0;
+	(void) condition;
+
+	/* read as much as available and fits in this slice, in place */
+	deadline = g_get_monotonic_time() + HEXDUMP_LOAD_BUDGET;
+	do
 	{
-		if((size = fread(buf, sizeof(*buf), sizeof(buf), debugger->fp))
-				> 0)
-		{
-			_debugger_hexdump_append(debugger, debugger->pos, buf,
-					size);
-			debugger->pos += size;
-		}
-		else
-		{
-			if(ferror(debugger->fp))
-				debugger_error(debugger, strerror(errno), 1);
-			fclose(debugger->fp);
-			debugger->fp = NULL;
-		}
+		len = buffer->len;
+		size = MIN(HEXDUMP_LOAD_BLOCK, HEXDUMP_LOAD_MAX - len);
+		g_byte_array_set_size(buffer, len + size);
+		res = read(fd, &buffer->data[len], size);
+		error = errno;
+		g_byte_array_set_size(buffer, len + MAX(res, 0));
 	}
-	if(debugger->fp == NULL)
+	while(res > 0 && buffer->len < HEXDUMP_LOAD_MAX
+			&& g_get_monotonic_time() < deadline);
+	/* update the view once per slice */
+	debugger->dhx_data = buffer->data;
+	debugger->dhx_size = buffer->len;
+	_debugger_hexdump_update(debugger);
+	if(buffer->len < HEXDUMP_LOAD_MAX && (res > 0 || (res < 0
+					&& (error == EAGAIN || error == EINTR))))
 	{
-		debugger->source = 0;
-		return FALSE;
+		/* wait for more */
+		_read_status(debugger);
+		return TRUE;
 	}
+	if(res < 0)
+		debugger_error(debugger, strerror(error), 1);
+	g_io_channel_unref(debugger->dhx_channel);
+	debugger->dhx_channel = NULL;
+	debugger->source = 0;
+	_read_status(debugger);
+	return FALSE;
+}
+
+static void _read_status(Debugger * debugger)
+{
+	gchar * status;
+
+	if(debugger->dhx_channel == NULL && debugger->dhx_size
+			>= HEXDUMP_LOAD_MAX)
+		status = g_strdup_printf(_("Loaded the first %lu bytes only"),
+				(unsigned long)debugger->dhx_size);
+	else if(debugger->dhx_channel == NULL)
+		status = g_strdup_printf(_("Loaded %lu bytes"),
+				(unsigned long)debugger->dhx_size);
+	else if(debugger->dhx_total > 0)
+		status = g_strdup_printf(_("Loading... %lu of %lu bytes"
+					" (%u%%)"),
+				(unsigned long)debugger->dhx_size,
+				(unsigned long)debugger->dhx_total,
+				(unsigned int)(MIN(debugger->dhx_size,
+						debugger->dhx_total) * 100
+					/ debugger->dhx_total));
+	else
+		status = g_strdup_printf(_("Loading... %lu bytes"),
+				(unsigned long)debugger->dhx_size);
+	_debugger_set_status(debugger, status);
+	g_free(status);
+}
+
+
+/* debugger_on_hexdump_scroll */
+static gboolean _debugger_on_hexdump_scroll(GtkWidget * widget,
+		GdkEventScroll * event, gpointer data)
+{
+	Debugger * debugger = data;
+	GtkAdjustment * adjustment = debugger->dhx_adjustment;
+	gdouble value;
+	(void) widget;
+
+	value = gtk_adjustment_get_value(adjustment);
+	if(event->direction == GDK_SCROLL_UP)
+		value -= 3.0;
+	else if(event->direction == GDK_SCROLL_DOWN)
+		value += 3.0;
+	else
+		return FALSE;
+	gtk_adjustment_set_value(adjustment, value);
 	return TRUE;
 }
 
 
+/* debugger_on_hexdump_search */
+static void _debugger_on_hexdump_search(gpointer data)
+{
+	Debugger * debugger = data;
+
+	if(debugger->dhx_search != NULL)
+		_debugger_on_hexdump_search_next(debugger);
+	else
+		_debugger_hexdump_search(debugger);
+}
+
+
+/* debugger_on_hexdump_search_changed */
+static void _debugger_on_hexdump_search_changed(gpointer data)
+{
+	Debugger * debugger = data;
+
+	if(debugger->dhx_search == NULL)
+		return;
+	_debugger_hexdump_search_stop(debugger);
+	_debugger_hexdump_search_status(debugger);
+	gtk_widget_queue_draw(debugger->dhx_view);
+}
+
+
+/* debugger_on_hexdump_search_next */
+static void _debugger_on_hexdump_search_next(gpointer data)
+{
+	Debugger * debugger = data;
+	size_t cnt;
+
+	if(debugger->dhx_search == NULL)
+	{
+		_debugger_hexdump_search(debugger);
+		return;
+	}
+	search_get_hits(debugger->dhx_search, &cnt);
+	if(cnt == 0)
+		return;
+	if(debugger->dhx_search_hit >= cnt - 1)
+		_debugger_hexdump_search_goto(debugger, 0);
+	else
+		_debugger_hexdump_search_goto(debugger,
+				debugger->dhx_search_hit + 1);
+}
+
+
+/* debugger_on_hexdump_search_previous */
+static void _debugger_on_hexdump_search_previous(gpointer data)
+{
+	Debugger * debugger = data;
+	size_t cnt;
+
+	if(debugger->dhx_search == NULL)
+	{
+		_debugger_hexdump_search(debugger);
+		return;
+	}
+	search_get_hits(debugger->dhx_search, &cnt);
+	if(cnt == 0)
+		return;
+	if(debugger->dhx_search_hit == 0 || debugger->dhx_search_hit >= cnt)
+		_debugger_hexdump_search_goto(debugger, cnt - 1);
+	else
+		_debugger_hexdump_search_goto(debugger,
+				debugger->dhx_search_hit - 1);
+}
+
+
+/* debugger_on_hexdump_search_timeout */
+static gboolean _debugger_on_hexdump_search_timeout(gpointer data)
+{
+	Debugger * debugger = data;
+	gboolean ret;
+	size_t cnt;
+
+	if((ret = search_poll(debugger->dhx_search) ? TRUE : FALSE) == FALSE)
+		debugger->dhx_search_source = 0;
+	/* go to the first hit as soon as it is known */
+	search_get_hits(debugger->dhx_search, &cnt);
+	if(debugger->dhx_search_hit == HEXDUMP_HIT_NONE && cnt > 0)
+		_debugger_hexdump_search_goto(debugger, 0);
+	else
+		_debugger_hexdump_search_status(debugger);
+	return ret;
+}
+
+
+/* debugger_on_hexdump_size_allocate */
+static void _debugger_on_hexdump_size_allocate(GtkWidget * widget,
+		GtkAllocation * allocation, gpointer data)
+{
+	Debugger * debugger = data;
+	(void) widget;
+	(void) allocation;
+
+	_debugger_hexdump_update(debugger);
+}
+
+
+/* debugger_on_hexdump_value_changed */
+static void _debugger_on_hexdump_value_changed(gpointer data)
+{
+	Debugger * debugger = data;
+
+	gtk_widget_queue_draw(debugger->dhx_view);
+}
+
+
 /* debugger_on_next */
 static void _debugger_on_next(gpointer data)
 {
@@ -1154,6 +4938,15 @@ static void _debugger_on_pause(gpointer data)
 }
 
 
+/* debugger_on_profile */
+static void _debugger_on_profile(gpointer data)
+{
+	Debugger * debugger = data;
+
+	debugger_profile(debugger, 0);
+}
+
+
 /* debugger_on_properties */
 static void _debugger_on_properties(gpointer data)
 {
@@ -1163,6 +4956,44 @@ static void _debugger_on_properties(gpointer data)
 }
 
 
+/* debugger_on_record */
+static void _debugger_on_record(gpointer data)
+{
+	Debugger * debugger = data;
+
+	debugger_record_dialog(debugger);
+}
+
+
+/* debugger_on_register_equal */
+static gboolean _debugger_on_register_equal(gconstpointer a, gconstpointer b)
+{
+	return (g_ascii_strcasecmp(a, b) == 0) ? TRUE : FALSE;
+}
+
+
+/* debugger_on_register_hash */
+static guint _debugger_on_register_hash(gconstpointer key)
+{
+	char const * p;
+	guint hash = 5381;
+
+	/* the register names are not case sensitive */
+	for(p = key; *p != '\0'; p++)
+		hash = (hash << 5) + hash + g_ascii_tolower(*p);
+	return hash;
+}
+
+
+/* debugger_on_reverse_continue */
+static void _debugger_on_reverse_continue(gpointer data)
+{
+	Debugger * debugger = data;
+
+	debugger_reverse_continue(debugger);
+}
+
+
 /* debugger_on_run */
 static void _debugger_on_run(gpointer data)
 {
@@ -1181,6 +5012,15 @@ static void _debugger_on_step(gpointer data)
 }
 
 
+/* debugger_on_step_back */
+static void _debugger_on_step_back(gpointer data)
+{
+	Debugger * debugger = data;
+
+	debugger_step_back(debugger);
+}
+
+
 /* debugger_on_stop */
 static void _debugger_on_stop(gpointer data)
 {
@@ -1190,6 +5030,73 @@ static void _debugger_on_stop(gpointer data)
 }
 
 
+/* debugger_on_syscalls */
+static void _debugger_on_syscalls(gpointer data)
+{
+	Debugger * debugger = data;
+
+	debugger_trace_syscalls_dialog(debugger);
+}
+
+
+/* debugger_on_syscalls_export */
+static void _debugger_on_syscalls_export(gpointer data)
+{
+	Debugger * debugger = data;
+
+	debugger_export_syscalls_dialog(debugger);
+}
+
+
+/* debugger_on_thread_changed */
+static void _debugger_on_thread_changed(gpointer data)
+{
+	Debugger * debugger = data;
+	GtkTreeSelection * selection;
+	GtkTreeModel * model;
+	GtkTreeIter iter;
+	GtkTreePath * path;
+	gint * indices;
+	DebuggerBackendThread const * thread;
+
+	/* the registers of the program running take precedence */
+	if(debugger->debug != NULL)
+		return;
+	selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(
+				debugger->thr_tree));
+	if(gtk_tree_selection_get_selected(selection, &model, &iter) != TRUE)
+		return;
+	path = gtk_tree_model_get_path(model, &iter);
+	indices = gtk_tree_path_get_indices(path);
+	if(indices[0] >= 0 && (size_t)indices[0] < debugger->thr_threads_cnt)
+	{
+		thread = &debugger->thr_threads[indices[0]];
+		_debugger_helper_set_registers(debugger, thread->registers,
+				thread->registers_cnt);
+	}
+	gtk_tree_path_free(path);
+}
+
+
+/* debugger_on_tracepoints */
+static void _debugger_on_tracepoints(gpointer data)
+{
+	Debugger * debugger = data;
+
+	debugger_set_tracepoints_dialog(debugger);
+}
+
+
+/* debugger_on_view_breakpoints */
+static void _debugger_on_view_breakpoints(gpointer data)
+{
+	Debugger * debugger = data;
+
+	gtk_notebook_set_current_page(GTK_NOTEBOOK(debugger->notebook),
+			NP_BREAKPOINTS);
+}
+
+
 /* debugger_on_view_call_graph */
 static void _debugger_on_view_call_graph(gpointer data)
 {
@@ -1210,14 +5117,22 @@ static void _debugger_on_view_changed(gpointer data)
 		case CP_REGISTERS:
 			gtk_widget_show(debugger->reg_view);
 			gtk_widget_hide(debugger->stk_view);
+			gtk_widget_hide(debugger->thr_view);
 			break;
 		case CP_STACK:
 			gtk_widget_hide(debugger->reg_view);
 			gtk_widget_show(debugger->stk_view);
+			gtk_widget_hide(debugger->thr_view);
+			break;
+		case CP_THREADS:
+			gtk_widget_hide(debugger->reg_view);
+			gtk_widget_hide(debugger->stk_view);
+			gtk_widget_show(debugger->thr_view);
 			break;
 		default:
 			gtk_widget_hide(debugger->reg_view);
 			gtk_widget_hide(debugger->stk_view);
+			gtk_widget_hide(debugger->thr_view);
 			break;
 	}
 }
@@ -1241,3 +5156,33 @@ static void _debugger_on_view_hexdump(gpointer data)
 	gtk_notebook_set_current_page(GTK_NOTEBOOK(debugger->notebook),
 			NP_HEXDUMP);
 }
+
+
+/* debugger_on_view_profile */
+static void _debugger_on_view_profile(gpointer data)
+{
+	Debugger * debugger = data;
+
+	gtk_notebook_set_current_page(GTK_NOTEBOOK(debugger->notebook),
+			NP_PROFILE);
+}
+
+
+/* debugger_on_view_syscalls */
+static void _debugger_on_view_syscalls(gpointer data)
+{
+	Debugger * debugger = data;
+
+	gtk_notebook_set_current_page(GTK_NOTEBOOK(debugger->notebook),
+			NP_SYSCALLS);
+}
+
+
+/* debugger_on_view_tracepoints */
+static void _debugger_on_view_tracepoints(gpointer data)
+{
+	Debugger * debugger = data;
+
+	gtk_notebook_set_current_page(GTK_NOTEBOOK(debugger->notebook),
+			NP_TRACEPOINTS);
+}
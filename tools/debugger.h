@@ -29,6 +29,8 @@
 # define CODER_DEBUGGER_H
 
 # include <stdarg.h>
+# include <stddef.h>
+# include <stdint.h>
 # include "common.h"
 
 
@@ -40,6 +42,12 @@ typedef struct _DebuggerPrefs
 	int uppercase;
 	char const * backend;
 	char const * debug;
+	/* bytes of stack displayed above the stack pointer */
+	size_t stack;
+	/* system calls traced, separated by commas */
+	char const * syscalls;
+	/* tracepoints, by address or function and separated by commas */
+	char const * tracepoints;
 } DebuggerPrefs;
 
 
@@ -60,12 +68,31 @@ int debugger_close(Debugger * debugger);
 
 int debugger_error(Debugger * debugger, char const * message, int ret);
 
+int debugger_add_breakpoint(Debugger * debugger, uint64_t address,
+		char const * condition);
+int debugger_add_breakpoint_dialog(Debugger * debugger);
+int debugger_remove_breakpoint(Debugger * debugger, uint64_t address);
+
+int debugger_export_syscalls(Debugger * debugger, char const * filename);
+int debugger_export_syscalls_dialog(Debugger * debugger);
+
+int debugger_checkpoint(Debugger * debugger);
 int debugger_continue(Debugger * debugger);
 int debugger_next(Debugger * debugger);
 int debugger_pause(Debugger * debugger);
+int debugger_profile(Debugger * debugger, unsigned int frequency);
+int debugger_record(Debugger * debugger, char const * filename,
+		int registers);
+int debugger_record_dialog(Debugger * debugger);
+int debugger_reverse_continue(Debugger * debugger);
 int debugger_run(Debugger * debugger, ...);
 int debugger_runv(Debugger * debugger, va_list ap);
+int debugger_set_tracepoints(Debugger * debugger, char const * tracepoints);
+int debugger_set_tracepoints_dialog(Debugger * debugger);
 int debugger_step(Debugger * debugger);
+int debugger_step_back(Debugger * debugger);
 int debugger_stop(Debugger * debugger);
+int debugger_trace_syscalls(Debugger * debugger, char const * syscalls);
+int debugger_trace_syscalls_dialog(Debugger * debugger);
 
 #endif /* !CODER_DEBUGGER_H */
@@ -0,0 +1,432 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <glib.h>
+#include <System.h>
+#include "disassembly.h"
+
+
+/* Disassembly */
+/* private */
+/* types */
+typedef struct _DisassemblyEntry
+{
+	DisassemblyBlock block;
+	size_t size;
+	GString * text;
+	GArray * lines;
+	GList link;
+} DisassemblyEntry;
+
+struct _Disassembly
+{
+	DisassemblyDecode decode;
+	void * data;
+
+	/* cache */
+	GHashTable * entries;
+	GQueue lru;
+	size_t capacity;
+
+	/* labels, sorted by offset */
+	AsmFunction const ** functions;
+	size_t functions_cnt;
+};
+
+
+/* prototypes */
+static off_t _disassembly_closest(AsmSection const * section, off_t from,
+		off_t to, off_t closest, off_t offset);
+static DisassemblyEntry * _disassembly_decode(Disassembly * disassembly,
+		AsmSection const * section, off_t offset, size_t size);
+static void _disassembly_entry_delete(gpointer data);
+static AsmFunction const * _disassembly_function(Disassembly * disassembly,
+		off_t offset);
+static void _disassembly_instruction(GString * text,
+		AsmArchInstructionCall const * call);
+
+/* callbacks */
+static int _disassembly_on_compare_functions(void const * a, void const * b);
+static gboolean _disassembly_on_equal(gconstpointer a, gconstpointer b);
+static guint _disassembly_on_hash(gconstpointer key);
+
+
+/* public */
+/* functions */
+/* disassembly_new */
+Disassembly * disassembly_new(size_t capacity, DisassemblyDecode decode,
+		void * data)
+{
+	Disassembly * disassembly;
+
+	if((disassembly = object_new(sizeof(*disassembly))) == NULL)
+		return NULL;
+	disassembly->decode = decode;
+	disassembly->data = data;
+	/* the entries are owned by the LRU list */
+	disassembly->entries = g_hash_table_new(_disassembly_on_hash,
+			_disassembly_on_equal);
+	g_queue_init(&disassembly->lru);
+	disassembly->capacity = (capacity > 0) ? capacity : 1;
+	disassembly->functions = NULL;
+	disassembly->functions_cnt = 0;
+	return disassembly;
+}
+
+
+/* disassembly_delete */
+void disassembly_delete(Disassembly * disassembly)
+{
+	disassembly_clear(disassembly);
+	g_hash_table_destroy(disassembly->entries);
+	free(disassembly->functions);
+	object_delete(disassembly);
+}
+
+
+/* accessors */
+/* disassembly_get_block */
+DisassemblyBlock const * disassembly_get_block(Disassembly * disassembly,
+		AsmSection const * section, off_t offset, size_t size)
+{
+	DisassemblyEntry key;
+	DisassemblyEntry * entry;
+	GList * tail;
+
+	key.block.section = section;
+	key.block.offset = offset;
+	key.size = size;
+	if((entry = g_hash_table_lookup(disassembly->entries, &key)) != NULL)
+	{
+		/* move it to the front */
+		g_queue_unlink(&disassembly->lru, &entry->link);
+		g_queue_push_head_link(&disassembly->lru, &entry->link);
+		return &entry->block;
+	}
+	if((entry = _disassembly_decode(disassembly, section, offset, size))
+			== NULL)
+		return NULL;
+	/* evict the least recently used blocks */
+	while(disassembly->lru.length >= disassembly->capacity)
+	{
+		tail = g_queue_peek_tail_link(&disassembly->lru);
+		g_queue_unlink(&disassembly->lru, tail);
+		g_hash_table_remove(disassembly->entries, tail->data);
+		_disassembly_entry_delete(tail->data);
+	}
+	g_hash_table_insert(disassembly->entries, entry, entry);
+	g_queue_push_head_link(&disassembly->lru, &entry->link);
+	return &entry->block;
+}
+
+
+/* disassembly_get_boundary */
+off_t disassembly_get_boundary(Disassembly * disassembly,
+		AsmSection const * section, off_t from, off_t to)
+{
+	off_t ret = -1;
+	size_t lo = 0;
+	size_t hi = disassembly->functions_cnt;
+	size_t mid;
+	GList * l;
+	DisassemblyEntry const * entry;
+	size_t i;
+
+	/* the functions start on an instruction */
+	while(lo < hi)
+	{
+		mid = lo + (hi - lo) / 2;
+		if(disassembly->functions[mid]->offset < from)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if(lo < disassembly->functions_cnt)
+		ret = _disassembly_closest(section, from, to, ret,
+				disassembly->functions[lo]->offset);
+	if(lo > 0)
+		ret = _disassembly_closest(section, from, to, ret,
+				disassembly->functions[lo - 1]->offset);
+	/* so does every instruction still decoded */
+	for(l = disassembly->lru.head; l != NULL; l = l->next)
+	{
+		entry = l->data;
+		if(entry->block.section != section)
+			continue;
+		for(i = 0; i < entry->block.lines_cnt; i++)
+			ret = _disassembly_closest(section, from, to, ret,
+					entry->block.lines[i]);
+	}
+	return ret;
+}
+
+
+/* disassembly_set_functions */
+void disassembly_set_functions(Disassembly * disassembly,
+		AsmFunction const * functions, size_t functions_cnt)
+{
+	AsmFunction const ** p;
+	size_t i;
+
+	disassembly_clear(disassembly);
+	free(disassembly->functions);
+	disassembly->functions = NULL;
+	disassembly->functions_cnt = 0;
+	if(functions_cnt == 0 || (p = malloc(sizeof(*p) * functions_cnt))
+			== NULL)
+		return;
+	for(i = 0; i < functions_cnt; i++)
+		p[i] = &functions[i];
+	qsort(p, functions_cnt, sizeof(*p), _disassembly_on_compare_functions);
+	disassembly->functions = p;
+	disassembly->functions_cnt = functions_cnt;
+}
+
+
+/* useful */
+/* disassembly_clear */
+void disassembly_clear(Disassembly * disassembly)
+{
+	GList * l;
+
+	g_hash_table_remove_all(disassembly->entries);
+	while((l = g_queue_peek_head_link(&disassembly->lru)) != NULL)
+	{
+		g_queue_unlink(&disassembly->lru, l);
+		_disassembly_entry_delete(l->data);
+	}
+}
+
+
+/* private */
+/* functions */
+/* disassembly_closest */
+static off_t _disassembly_closest(AsmSection const * section, off_t from,
+		off_t to, off_t closest, off_t offset)
+{
+	/* labels are at -1 */
+	if(offset < section->offset || offset >= to)
+		return closest;
+	if(closest < 0)
+		return offset;
+	/* the first one from the offset requested, or the last one before */
+	if(offset >= from)
+		return (closest < from || offset < closest) ? offset : closest;
+	return (closest < from && offset > closest) ? offset : closest;
+}
+
+
+/* disassembly_decode */
+static DisassemblyEntry * _disassembly_decode(Disassembly * disassembly,
+		AsmSection const * section, off_t offset, size_t size)
+{
+	DisassemblyEntry * entry;
+	AsmArchInstructionCall * calls = NULL;
+	size_t calls_cnt = 0;
+	size_t i;
+	AsmFunction const * function;
+	off_t label = -1;
+
+	if(disassembly->decode(disassembly->data, offset, size,
+				section->base + (offset - section->offset),
+				&calls, &calls_cnt) != 0)
+		return NULL;
+	if((entry = object_new(sizeof(*entry))) == NULL)
+	{
+		free(calls);
+		return NULL;
+	}
+	entry->size = size;
+	entry->text = g_string_sized_new(calls_cnt * 48);
+	entry->lines = g_array_sized_new(FALSE, FALSE, sizeof(off_t),
+			calls_cnt);
+	entry->link.data = entry;
+	entry->link.prev = NULL;
+	entry->link.next = NULL;
+	for(i = 0; i < calls_cnt; i++)
+	{
+		if((function = _disassembly_function(disassembly,
+						calls[i].offset)) != NULL)
+		{
+			g_string_append_printf(entry->text, "%s:\n",
+					function->name);
+			g_array_append_val(entry->lines, label);
+		}
+		_disassembly_instruction(entry->text, &calls[i]);
+		g_array_append_val(entry->lines, calls[i].offset);
+	}
+	entry->block.section = section;
+	entry->block.offset = offset;
+	/* always progress, even if nothing could be decoded */
+	entry->block.end = (calls_cnt > 0) ? (off_t)(calls[calls_cnt - 1].offset
+			+ calls[calls_cnt - 1].size) : (off_t)(offset + size);
+	if(entry->block.end <= offset)
+		entry->block.end = offset + size;
+	entry->block.text = entry->text->str;
+	entry->block.text_len = entry->text->len;
+	entry->block.lines = (off_t const *)entry->lines->data;
+	entry->block.lines_cnt = entry->lines->len;
+	free(calls);
+	return entry;
+}
+
+
+/* disassembly_entry_delete */
+static void _disassembly_entry_delete(gpointer data)
+{
+	DisassemblyEntry * entry = data;
+
+	g_string_free(entry->text, TRUE);
+	g_array_free(entry->lines, TRUE);
+	object_delete(entry);
+}
+
+
+/* disassembly_function */
+static AsmFunction const * _disassembly_function(Disassembly * disassembly,
+		off_t offset)
+{
+	size_t lo = 0;
+	size_t hi = disassembly->functions_cnt;
+	size_t mid;
+
+	while(lo < hi)
+	{
+		mid = lo + (hi - lo) / 2;
+		if(disassembly->functions[mid]->offset < offset)
+			lo = mid + 1;
+		else if(disassembly->functions[mid]->offset > offset)
+			hi = mid;
+		else
+			return disassembly->functions[mid];
+	}
+	return NULL;
+}
+
+
+/* disassembly_instruction */
+static void _disassembly_instruction(GString * text,
+		AsmArchInstructionCall const * call)
+{
+	size_t i;
+	AsmArchOperand const * ao;
+
+	g_string_append_printf(text, "  %08lx  %s%s%-7s",
+			(unsigned long)call->base,
+			(call->prefix != NULL) ? call->prefix : "",
+			(call->prefix != NULL) ? " " : "", call->name);
+	for(i = 0; i < call->operands_cnt; i++)
+	{
+		ao = &call->operands[i];
+		g_string_append(text, (i == 0) ? " " : ", ");
+		switch(AO_GET_TYPE(ao->definition))
+		{
+			case AOT_DREGISTER:
+				if(ao->value.dregister.offset == 0)
+					g_string_append_printf(text, "[%%%s]",
+							ao->value.dregister.name);
+				else
+					g_string_append_printf(text,
+							"[%%%s + $0x%lx]",
+							ao->value.dregister.name,
+							(unsigned long)
+							ao->value.dregister.offset);
+				break;
+			case AOT_DREGISTER2:
+				g_string_append_printf(text, "[%%%s + %%%s]",
+						ao->value.dregister2.name,
+						ao->value.dregister2.name2);
+				break;
+			case AOT_IMMEDIATE:
+				g_string_append_printf(text, "%s$0x%lx",
+						ao->value.immediate.negative
+						? "-" : "", (unsigned long)
+						ao->value.immediate.value);
+				break;
+			case AOT_REGISTER:
+				g_string_append_printf(text, "%%%s",
+						ao->value._register.name);
+				break;
+			default:
+				break;
+		}
+	}
+	/* mention what immediate values refer to */
+	for(i = 0; i < call->operands_cnt; i++)
+	{
+		ao = &call->operands[i];
+		if(AO_GET_TYPE(ao->definition) == AOT_IMMEDIATE
+				&& (AO_GET_VALUE(ao->definition)
+					== AOI_REFERS_STRING
+					|| AO_GET_VALUE(ao->definition)
+					== AOI_REFERS_FUNCTION)
+				&& ao->value.immediate.name != NULL)
+			g_string_append_printf(text, "\t; %s",
+					ao->value.immediate.name);
+	}
+	g_string_append_c(text, '\n');
+}
+
+
+/* callbacks */
+/* disassembly_on_compare_functions */
+static int _disassembly_on_compare_functions(void const * a, void const * b)
+{
+	AsmFunction const * const * fa = a;
+	AsmFunction const * const * fb = b;
+
+	if((*fa)->offset < (*fb)->offset)
+		return -1;
+	return ((*fa)->offset > (*fb)->offset) ? 1 : 0;
+}
+
+
+/* disassembly_on_equal */
+static gboolean _disassembly_on_equal(gconstpointer a, gconstpointer b)
+{
+	DisassemblyEntry const * ea = a;
+	DisassemblyEntry const * eb = b;
+
+	return (ea->block.section == eb->block.section
+			&& ea->block.offset == eb->block.offset
+			&& ea->size == eb->size) ? TRUE : FALSE;
+}
+
+
+/* disassembly_on_hash */
+static guint _disassembly_on_hash(gconstpointer key)
+{
+	DisassemblyEntry const * entry = key;
+
+	uint64_t offset = entry->block.offset;
+
+	return (guint)(offset ^ (offset >> 32)
+			^ ((guint)entry->block.section->id << 24)
+			^ entry->size);
+}
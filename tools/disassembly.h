@@ -0,0 +1,77 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+
+#ifndef CODER_DEBUGGER_DISASSEMBLY_H
+# define CODER_DEBUGGER_DISASSEMBLY_H
+
+# include <sys/types.h>
+# include <Devel/Asm.h>
+
+
+/* Disassembly */
+/* types */
+typedef struct _Disassembly Disassembly;
+
+typedef int (*DisassemblyDecode)(void * data, off_t offset, size_t size,
+		off_t base, AsmArchInstructionCall ** calls,
+		size_t * calls_cnt);
+
+typedef struct _DisassemblyBlock
+{
+	AsmSection const * section;
+	off_t offset;
+	/* where the last instruction decoded ends */
+	off_t end;
+
+	/* one line per label or instruction */
+	char const * text;
+	size_t text_len;
+	/* offset of the instruction on every line, -1 for labels */
+	off_t const * lines;
+	size_t lines_cnt;
+} DisassemblyBlock;
+
+
+/* functions */
+Disassembly * disassembly_new(size_t capacity, DisassemblyDecode decode,
+		void * data);
+void disassembly_delete(Disassembly * disassembly);
+
+/* accessors */
+/* the block remains valid until the next call */
+DisassemblyBlock const * disassembly_get_block(Disassembly * disassembly,
+		AsmSection const * section, off_t offset, size_t size);
+/* the instruction known before to and closest to from, or -1 */
+off_t disassembly_get_boundary(Disassembly * disassembly,
+		AsmSection const * section, off_t from, off_t to);
+void disassembly_set_functions(Disassembly * disassembly,
+		AsmFunction const * functions, size_t functions_cnt);
+
+/* useful */
+void disassembly_clear(Disassembly * disassembly);
+
+#endif /* !CODER_DEBUGGER_DISASSEMBLY_H */
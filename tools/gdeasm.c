@@ -52,6 +52,7 @@ static char const _gdeasm_license[] =
 #include <System.h>
 #include <Devel/Asm.h>
 #include <Desktop.h>
+#include "cache.h"
 #include "gdeasm.h"
 #include "../config.h"
 #define _(string) gettext(string)
@@ -428,16 +429,21 @@ int gdeasm_load_comments_dialog(GDeasm * gdeasm)
 
 
 /* gdeasm_open */
-static int _open_code(GDeasm * gdeasm, AsmCode * af);
+static int _open_cache(GDeasm * gdeasm, Cache * cache);
+static int _open_code(GDeasm * gdeasm, AsmCode * af, CacheWriter * writer);
 static int _open_code_section(GDeasm * gdeasm, AsmCode * code,
-		AsmSection * section);
+		AsmSection * section, CacheWriter * writer);
 static void _open_functions(GDeasm * gdeasm, AsmFunction * af, size_t af_cnt);
 static void _open_instruction(GDeasm * gdeasm, GtkTreeIter * parent,
 		AsmArchInstructionCall * call);
+static void _open_instructions(GDeasm * gdeasm, char const * arch,
+		char const * format, AsmArchInstruction const * ai);
 static void _open_parse_dregister(char * buf, size_t size, AsmArchOperand * ao);
 static void _open_parse_dregister2(char * buf, size_t size,
 		AsmArchOperand * ao);
 static void _open_parse_immediate(char * buf, size_t size, AsmArchOperand * ao);
+static void _open_section(GDeasm * gdeasm, AsmSection * section,
+		AsmArchInstructionCall * calls, size_t calls_cnt);
 static void _open_strings(GDeasm * gdeasm, AsmString * as, size_t as_cnt);
 
 int gdeasm_open(GDeasm * gdeasm, char const * arch, char const * format,
@@ -445,6 +451,9 @@ int gdeasm_open(GDeasm * gdeasm, char const * arch, char const * format,
 {
 	int ret = -1;
 	int res;
+	char * key;
+	Cache * cache;
+	CacheWriter * writer = NULL;
 	Asm * a;
 	AsmCode * code;
 	AsmFunction * af;
@@ -473,29 +482,91 @@ int gdeasm_open(GDeasm * gdeasm, char const * arch, char const * format,
 		else if(res != GTK_RESPONSE_REJECT)
 			return 0;
 	}
+	_gdeasm_set_status(gdeasm, "");
+	/* look for this file in the decode cache first */
+	key = cache_get_key(filename, arch, format);
+	if(key != NULL && (cache = cache_open(key)) != NULL)
+	{
+		g_free(key);
+		gtk_list_store_clear(gdeasm->func_store);
+		gtk_list_store_clear(gdeasm->str_store);
+		gtk_tree_store_clear(gdeasm->asm_store);
+		gdeasm->modified = FALSE;
+		ret = _open_cache(gdeasm, cache);
+		cache_close(cache);
+		if(ret != 0)
+			_gdeasm_error(gdeasm, error_get(NULL), 1);
+		return ret;
+	}
 	if((a = asm_new(arch, format)) == NULL)
+	{
+		g_free(key);
 		return -_gdeasm_error(gdeasm, error_get(NULL), 1);
-	_gdeasm_set_status(gdeasm, "");
+	}
 	if((code = asm_open_deassemble(a, filename, TRUE)) != NULL)
 	{
 		gtk_list_store_clear(gdeasm->func_store);
 		gtk_list_store_clear(gdeasm->str_store);
 		gtk_tree_store_clear(gdeasm->asm_store);
 		gdeasm->modified = FALSE;
-		ret = _open_code(gdeasm, code);
+		if(key != NULL)
+			writer = cache_writer_new(key, code);
+		ret = _open_code(gdeasm, code, writer);
 		asmcode_get_functions(code, &af, &af_cnt);
 		_open_functions(gdeasm, af, af_cnt);
 		asmcode_get_strings(code, &as, &as_cnt);
 		_open_strings(gdeasm, as, as_cnt);
+		/* failing to update the cache is not fatal */
+		if(writer != NULL && ret == 0)
+			cache_writer_save(writer);
+		if(writer != NULL)
+			cache_writer_delete(writer);
 		asm_close(a);
 	}
 	asm_delete(a);
+	g_free(key);
 	if(ret != 0)
 		_gdeasm_error(gdeasm, error_get(NULL), 1);
 	return ret;
 }
 
-static int _open_code(GDeasm * gdeasm, AsmCode * code)
+static int _open_cache(GDeasm * gdeasm, Cache * cache)
+{
+	AsmSection * sections;
+	size_t sections_cnt;
+	AsmArchInstructionCall * calls;
+	size_t calls_cnt;
+	size_t i;
+	char const * arch;
+	char const * format;
+	AsmFunction * af;
+	size_t af_cnt;
+	AsmString * as;
+	size_t as_cnt;
+
+	cache_get_sections(cache, &sections, &sections_cnt);
+	for(i = 0; i < sections_cnt; i++)
+	{
+		if(cache_decode_section(cache, &sections[i], &calls, &calls_cnt)
+				!= 0)
+			return -1;
+		_open_section(gdeasm, &sections[i], calls, calls_cnt);
+		free(calls);
+	}
+	if((arch = cache_get_arch_description(cache)) == NULL)
+		arch = cache_get_arch(cache);
+	if((format = cache_get_format_description(cache)) == NULL)
+		format = cache_get_format(cache);
+	_open_instructions(gdeasm, arch, format,
+			cache_get_arch_instructions(cache));
+	cache_get_functions(cache, &af, &af_cnt);
+	_open_functions(gdeasm, af, af_cnt);
+	cache_get_strings(cache, &as, &as_cnt);
+	_open_strings(gdeasm, as, as_cnt);
+	return 0;
+}
+
+static int _open_code(GDeasm * gdeasm, AsmCode * code, CacheWriter * writer)
 {
 	int ret = 0;
 	AsmSection * sections;
@@ -503,67 +574,39 @@ static int _open_code(GDeasm * gdeasm, AsmCode * code)
 	size_t i;
 	char const * arch;
 	char const * format;
-	gchar * buf;
-	AsmArchInstruction const * ai;
-	GtkTreeIter iter;
-	char const * p;
 
 	asmcode_get_sections(code, &sections, &sections_cnt);
 	for(i = 0; i < sections_cnt; i++)
-		if((ret = _open_code_section(gdeasm, code, &sections[i])) != 0)
+		if((ret = _open_code_section(gdeasm, code, &sections[i],
+						writer)) != 0)
 			break;
 	gtk_list_store_clear(gdeasm->ins_store);
 	if(ret == 0)
 	{
-		/* update the status */
 		if((arch = asmcode_get_arch_description(code)) == NULL)
 			arch = asmcode_get_arch(code);
 		if((format = asmcode_get_format_description(code)) == NULL)
 			format = asmcode_get_format(code);
-		buf = g_strdup_printf("%s%s | %s%s", _("Architecture: "),
-				arch, _("Format: "), format);
-		_gdeasm_set_status(gdeasm, buf);
-		g_free(buf);
-		p = NULL;
-		/* update the instructions list */
-		for(ai = asmcode_get_arch_instructions(code);
-				ai != NULL && ai->name != NULL; ai++)
-		{
-			if(p != NULL && strcmp(p, ai->name) == 0)
-				continue;
-#if GTK_CHECK_VERSION(2, 6, 0)
-			gtk_list_store_insert_with_values(gdeasm->ins_store,
-					&iter, -1,
-#else
-			gtk_list_store_append(gdeasm->ins_store, &iter);
-			gtk_list_store_set(gdeasm->ins_store, &iter,
-#endif
-					0, ai->name, -1);
-			p = ai->name;
-		}
+		_open_instructions(gdeasm, arch, format,
+				asmcode_get_arch_instructions(code));
 	}
 	return ret;
 }
 
 static int _open_code_section(GDeasm * gdeasm, AsmCode * code,
-		AsmSection * section)
+		AsmSection * section, CacheWriter * writer)
 {
-	GtkTreeIter iter;
 	AsmArchInstructionCall * calls = NULL;
 	size_t calls_cnt = 0;
-	size_t i;
 
-#if GTK_CHECK_VERSION(2, 10, 0)
-	gtk_tree_store_insert_with_values(gdeasm->asm_store, &iter, NULL, -1,
-#else
-	gtk_tree_store_append(gdeasm->asm_store, &iter, NULL);
-	gtk_tree_store_set(gdeasm->asm_store, &iter,
-#endif
-			1, section->name, -1);
 	if(asmcode_decode_section(code, section, &calls, &calls_cnt) != 0)
+	{
+		_open_section(gdeasm, section, NULL, 0);
 		return -1;
-	for(i = 0; i < calls_cnt; i++)
-		_open_instruction(gdeasm, &iter, &calls[i]);
+	}
+	_open_section(gdeasm, section, calls, calls_cnt);
+	if(writer != NULL)
+		cache_writer_append(writer, section, calls, calls_cnt);
 	free(calls);
 	return 0;
 }
@@ -644,6 +687,35 @@ static void _open_instruction(GDeasm * gdeasm, GtkTreeIter * parent,
 	}
 }
 
+static void _open_instructions(GDeasm * gdeasm, char const * arch,
+		char const * format, AsmArchInstruction const * ai)
+{
+	gchar * buf;
+	GtkTreeIter iter;
+	char const * p = NULL;
+
+	/* update the status */
+	buf = g_strdup_printf("%s%s | %s%s", _("Architecture: "), arch,
+			_("Format: "), format);
+	_gdeasm_set_status(gdeasm, buf);
+	g_free(buf);
+	/* update the instructions list */
+	gtk_list_store_clear(gdeasm->ins_store);
+	for(; ai != NULL && ai->name != NULL; ai++)
+	{
+		if(p != NULL && strcmp(p, ai->name) == 0)
+			continue;
+#if GTK_CHECK_VERSION(2, 6, 0)
+		gtk_list_store_insert_with_values(gdeasm->ins_store, &iter, -1,
+#else
+		gtk_list_store_append(gdeasm->ins_store, &iter);
+		gtk_list_store_set(gdeasm->ins_store, &iter,
+#endif
+				0, ai->name, -1);
+		p = ai->name;
+	}
+}
+
 static void _open_parse_dregister(char * buf, size_t size, AsmArchOperand * ao)
 {
 	char const * name;
@@ -668,6 +740,23 @@ static void _open_parse_immediate(char * buf, size_t size, AsmArchOperand * ao)
 			? "-" : "", (unsigned long)ao->value.immediate.value);
 }
 
+static void _open_section(GDeasm * gdeasm, AsmSection * section,
+		AsmArchInstructionCall * calls, size_t calls_cnt)
+{
+	GtkTreeIter iter;
+	size_t i;
+
+#if GTK_CHECK_VERSION(2, 10, 0)
+	gtk_tree_store_insert_with_values(gdeasm->asm_store, &iter, NULL, -1,
+#else
+	gtk_tree_store_append(gdeasm->asm_store, &iter, NULL);
+	gtk_tree_store_set(gdeasm->asm_store, &iter,
+#endif
+			1, section->name, -1);
+	for(i = 0; i < calls_cnt; i++)
+		_open_instruction(gdeasm, &iter, &calls[i]);
+}
+
 static void _open_strings(GDeasm * gdeasm, AsmString * as, size_t as_cnt)
 {
 	size_t i;
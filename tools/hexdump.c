@@ -0,0 +1,233 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+
+#include <stdint.h>
+#include <string.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__amd64__))
+# include <tmmintrin.h>
+# define HEXDUMP_SSSE3
+#endif
+#include "hexdump.h"
+
+
+/* Hexdump */
+/* private */
+/* constants */
+/* hexadecimal representation of every byte value */
+static char const _hexdump_lower[513] =
+	"000102030405060708090a0b0c0d0e0f"
+	"101112131415161718191a1b1c1d1e1f"
+	"202122232425262728292a2b2c2d2e2f"
+	"303132333435363738393a3b3c3d3e3f"
+	"404142434445464748494a4b4c4d4e4f"
+	"505152535455565758595a5b5c5d5e5f"
+	"606162636465666768696a6b6c6d6e6f"
+	"707172737475767778797a7b7c7d7e7f"
+	"808182838485868788898a8b8c8d8e8f"
+	"909192939495969798999a9b9c9d9e9f"
+	"a0a1a2a3a4a5a6a7a8a9aaabacadaeaf"
+	"b0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+	"c0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+	"d0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+	"e0e1e2e3e4e5e6e7e8e9eaebecedeeef"
+	"f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+static char const _hexdump_upper[513] =
+	"000102030405060708090A0B0C0D0E0F"
+	"101112131415161718191A1B1C1D1E1F"
+	"202122232425262728292A2B2C2D2E2F"
+	"303132333435363738393A3B3C3D3E3F"
+	"404142434445464748494A4B4C4D4E4F"
+	"505152535455565758595A5B5C5D5E5F"
+	"606162636465666768696A6B6C6D6E6F"
+	"707172737475767778797A7B7C7D7E7F"
+	"808182838485868788898A8B8C8D8E8F"
+	"909192939495969798999A9B9C9D9E9F"
+	"A0A1A2A3A4A5A6A7A8A9AAABACADAEAF"
+	"B0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+	"C0C1C2C3C4C5C6C7C8C9CACBCCCDCECF"
+	"D0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+	"E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEF"
+	"F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+static char const _hexdump_ascii[257] =
+	"................................"
+	" !\"#$%&'()*+,-./0123456789:;<=>?"
+	"@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_"
+	"`abcdefghijklmnopqrstuvwxyz{|}~."
+	"................................"
+	"................................"
+	"................................"
+	"................................";
+
+
+/* prototypes */
+static char * _hexdump_offset(char * buf, size_t offset, char const * hex);
+static char * _hexdump_row(char * buf, unsigned char const * data,
+		size_t size, char const * hex);
+#ifdef HEXDUMP_SSSE3
+static char * _hexdump_row_ssse3(char * buf, unsigned char const * data,
+		int uppercase);
+#endif
+
+
+/* public */
+/* functions */
+/* hexdump_format */
+size_t hexdump_format(char * buf, size_t offset, unsigned char const * data,
+		size_t size, int uppercase)
+{
+	char const * hex = uppercase ? _hexdump_upper : _hexdump_lower;
+	char * p = buf;
+	size_t i;
+#ifdef HEXDUMP_SSSE3
+	const int ssse3 = __builtin_cpu_supports("ssse3");
+#endif
+
+	for(i = 0; i < size; i += HEXDUMP_COLUMNS)
+	{
+		p = _hexdump_offset(p, offset + i, hex);
+#ifdef HEXDUMP_SSSE3
+		if(ssse3 && size - i >= HEXDUMP_COLUMNS)
+		{
+			p = _hexdump_row_ssse3(p, &data[i], uppercase);
+			continue;
+		}
+#endif
+		p = _hexdump_row(p, &data[i], (size - i < HEXDUMP_COLUMNS)
+				? size - i : HEXDUMP_COLUMNS, hex);
+	}
+	return p - buf;
+}
+
+
+/* private */
+/* functions */
+/* hexdump_offset */
+static char * _hexdump_offset(char * buf, size_t offset, char const * hex)
+{
+	uint64_t o = offset;
+	unsigned int i;
+	unsigned int c;
+
+	/* use 64-bit offsets only when necessary */
+	for(i = (o > 0xffffffff) ? 8 : 4; i > 0; i--)
+	{
+		c = (o >> ((i - 1) * 8)) & 0xff;
+		*(buf++) = hex[c * 2];
+		*(buf++) = hex[c * 2 + 1];
+	}
+	*(buf++) = ' ';
+	*(buf++) = ' ';
+	return buf;
+}
+
+
+/* hexdump_row */
+static char * _hexdump_row(char * buf, unsigned char const * data,
+		size_t size, char const * hex)
+{
+	size_t i;
+
+	/* hexadecimal values, padded for short rows */
+	for(i = 0; i < HEXDUMP_COLUMNS; i++, buf += 3)
+	{
+		if(i < size)
+		{
+			buf[0] = hex[data[i] * 2];
+			buf[1] = hex[data[i] * 2 + 1];
+		}
+		else
+			buf[0] = buf[1] = ' ';
+		buf[2] = ' ';
+	}
+	*(buf++) = ' ';
+	/* ASCII values */
+	for(i = 0; i < size; i++)
+		*(buf++) = _hexdump_ascii[data[i]];
+	*(buf++) = '\n';
+	return buf;
+}
+
+
+#ifdef HEXDUMP_SSSE3
+/* hexdump_row_ssse3 */
+__attribute__((target("ssse3")))
+static char * _hexdump_row_ssse3(char * buf, unsigned char const * data,
+		int uppercase)
+{
+	const __m128i digits = uppercase
+		? _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+				'8', '9', 'A', 'B', 'C', 'D', 'E', 'F')
+		: _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+				'8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+	const __m128i nibble = _mm_set1_epi8(0x0f);
+	/* spread the hexadecimal digits over three rows, spaced out */
+	const __m128i m0 = _mm_setr_epi8(0, 1, -1, 2, 3, -1, 4, 5, -1, 6, 7,
+			-1, 8, 9, -1, 10);
+	const __m128i m1a = _mm_setr_epi8(11, -1, 12, 13, -1, 14, 15, -1, -1,
+			-1, -1, -1, -1, -1, -1, -1);
+	const __m128i m1b = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 0,
+			1, -1, 2, 3, -1, 4, 5);
+	const __m128i m2 = _mm_setr_epi8(-1, 6, 7, -1, 8, 9, -1, 10, 11, -1,
+			12, 13, -1, 14, 15, -1);
+	const __m128i s0 = _mm_setr_epi8(0, 0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0,
+			' ', 0, 0, ' ', 0);
+	const __m128i s1 = _mm_setr_epi8(0, ' ', 0, 0, ' ', 0, 0, ' ', 0, 0,
+			' ', 0, 0, ' ', 0, 0);
+	const __m128i s2 = _mm_setr_epi8(' ', 0, 0, ' ', 0, 0, ' ', 0, 0, ' ',
+			0, 0, ' ', 0, 0, ' ');
+	__m128i v;
+	__m128i hi;
+	__m128i lo;
+	__m128i a;
+	__m128i b;
+	__m128i mask;
+
+	v = _mm_loadu_si128((__m128i const *)data);
+	/* hexadecimal values */
+	hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(v, 4),
+				nibble));
+	lo = _mm_shuffle_epi8(digits, _mm_and_si128(v, nibble));
+	a = _mm_unpacklo_epi8(hi, lo);
+	b = _mm_unpackhi_epi8(hi, lo);
+	_mm_storeu_si128((__m128i *)&buf[0], _mm_or_si128(
+				_mm_shuffle_epi8(a, m0), s0));
+	_mm_storeu_si128((__m128i *)&buf[16], _mm_or_si128(_mm_or_si128(
+					_mm_shuffle_epi8(a, m1a),
+					_mm_shuffle_epi8(b, m1b)), s1));
+	_mm_storeu_si128((__m128i *)&buf[32], _mm_or_si128(
+				_mm_shuffle_epi8(b, m2), s2));
+	buf[48] = ' ';
+	/* ASCII values (printable between 0x20 and 0x7e) */
+	mask = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(0x1f)),
+			_mm_cmplt_epi8(v, _mm_set1_epi8(0x7f)));
+	_mm_storeu_si128((__m128i *)&buf[49], _mm_or_si128(
+				_mm_and_si128(mask, v),
+				_mm_andnot_si128(mask, _mm_set1_epi8('.'))));
+	buf[65] = '\n';
+	return &buf[66];
+}
+#endif
@@ -0,0 +1,54 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+
+#ifndef CODER_DEBUGGER_HEXDUMP_H
+# define CODER_DEBUGGER_HEXDUMP_H
+
+# include <stddef.h>
+
+
+/* Hexdump */
+/* constants */
+/* bytes per row */
+# define HEXDUMP_COLUMNS	16
+/* characters per row (offset, hexadecimal values, ASCII values, newline) */
+# define HEXDUMP_ROW		(HEXDUMP_COLUMNS * 4 + 12)
+/* characters per row with 64-bit offsets */
+# define HEXDUMP_ROW_MAX	(HEXDUMP_ROW + 8)
+
+
+/* macros */
+/* space required to format size bytes */
+# define HEXDUMP_FORMAT_SIZE(size) \
+	((((size) + HEXDUMP_COLUMNS - 1) / HEXDUMP_COLUMNS) * HEXDUMP_ROW_MAX)
+
+
+/* functions */
+size_t hexdump_format(char * buf, size_t offset, unsigned char const * data,
+		size_t size, int uppercase);
+
+#endif /* !CODER_DEBUGGER_HEXDUMP_H */
@@ -0,0 +1,593 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <libintl.h>
+#include <glib.h>
+#include <System.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__amd64__))
+# include <emmintrin.h>
+# define SEARCH_SSE2
+#endif
+#include "search.h"
+#define _(string) gettext(string)
+
+
+/* Search */
+/* private */
+/* types */
+typedef struct _SearchChunk
+{
+	GArray * hits;
+	gboolean done;
+} SearchChunk;
+
+struct _Search
+{
+	SearchType type;
+
+	/* pattern */
+	unsigned char * bytes;
+	unsigned char * mask;
+	size_t length;
+	size_t first;
+	size_t last;
+	GRegex * regex;
+
+	/* data */
+	unsigned char const * data;
+	size_t size;
+
+	/* workers */
+	GThread ** threads;
+	size_t threads_cnt;
+	GMutex mutex;
+	SearchChunk * chunks;
+	size_t chunks_cnt;
+	size_t chunks_collected;
+	gint chunks_next;
+	gint cancel;
+	gint truncated;
+
+	/* results */
+	GArray * hits;
+};
+
+
+/* constants */
+/* amount of data scanned at once by a worker */
+#define SEARCH_CHUNK		(4 * 1024 * 1024)
+/* how far regular expressions may match past the end of a chunk */
+#define SEARCH_OVERLAP		4096
+#define SEARCH_HITS_MAX		(1024 * 1024)
+
+
+/* prototypes */
+static int _search_hit(GArray * hits, size_t offset, size_t length);
+static void _search_join(Search * search);
+static int _search_match(Search * search, unsigned char const * data);
+static void _search_scan_bytes(Search * search, size_t start, size_t end,
+		GArray * hits);
+static void _search_scan_regex(Search * search, size_t start, size_t end,
+		GArray * hits);
+
+/* callbacks */
+static gpointer _search_on_thread(gpointer data);
+
+
+/* public */
+/* functions */
+/* search_new */
+static int _new_ascii(Search * search, char const * pattern);
+static int _new_hexadecimal(Search * search, char const * pattern);
+static int _new_hexadecimal_digit(int c);
+static int _new_regex(Search * search, char const * pattern);
+static int _new_utf16(Search * search, char const * pattern);
+
+Search * search_new(SearchType type, char const * pattern)
+{
+	Search * search;
+	int res;
+
+	if(pattern == NULL || pattern[0] == '\0')
+	{
+		error_set_code(-EINVAL, "%s", strerror(EINVAL));
+		return NULL;
+	}
+	if((search = object_new(sizeof(*search))) == NULL)
+		return NULL;
+	search->type = type;
+	search->bytes = NULL;
+	search->mask = NULL;
+	search->length = 0;
+	search->first = 0;
+	search->last = 0;
+	search->regex = NULL;
+	search->data = NULL;
+	search->size = 0;
+	search->threads = NULL;
+	search->threads_cnt = 0;
+	g_mutex_init(&search->mutex);
+	search->chunks = NULL;
+	search->chunks_cnt = 0;
+	search->chunks_collected = 0;
+	search->chunks_next = 0;
+	search->cancel = 0;
+	search->truncated = 0;
+	search->hits = g_array_new(FALSE, FALSE, sizeof(SearchHit));
+	switch(type)
+	{
+		case ST_HEXADECIMAL:
+			res = _new_hexadecimal(search, pattern);
+			break;
+		case ST_ASCII:
+			res = _new_ascii(search, pattern);
+			break;
+		case ST_UTF16:
+			res = _new_utf16(search, pattern);
+			break;
+		case ST_REGEX:
+			res = _new_regex(search, pattern);
+			break;
+		default:
+			res = -error_set_code(-EINVAL, "%s", strerror(EINVAL));
+			break;
+	}
+	if(res != 0)
+	{
+		search_delete(search);
+		return NULL;
+	}
+	return search;
+}
+
+static int _new_ascii(Search * search, char const * pattern)
+{
+	search->length = strlen(pattern);
+	if((search->bytes = malloc(search->length)) == NULL)
+		return -error_set_code(-errno, "%s", strerror(errno));
+	memcpy(search->bytes, pattern, search->length);
+	search->last = search->length - 1;
+	return 0;
+}
+
+static int _new_hexadecimal(Search * search, char const * pattern)
+{
+	size_t len = strlen(pattern);
+	int wildcards = 0;
+	int hi;
+	int lo;
+
+	/* at most one byte every two characters */
+	if((search->bytes = malloc(len / 2 + 1)) == NULL
+			|| (search->mask = malloc(len / 2 + 1)) == NULL)
+		return -error_set_code(-errno, "%s", strerror(errno));
+	while(*pattern != '\0')
+	{
+		if(isspace((unsigned char)*pattern))
+		{
+			pattern++;
+			continue;
+		}
+		if(pattern[0] == '?' && pattern[1] == '?')
+		{
+			/* wildcard */
+			search->bytes[search->length] = 0x00;
+			search->mask[search->length++] = 0x00;
+			wildcards = 1;
+			pattern += 2;
+			continue;
+		}
+		if((hi = _new_hexadecimal_digit(pattern[0])) < 0
+				|| (lo = _new_hexadecimal_digit(pattern[1]))
+				< 0)
+			return -error_set_code(1, "%s: %s", pattern,
+					_("Invalid hexadecimal value"));
+		search->bytes[search->length] = (hi << 4) | lo;
+		search->mask[search->length++] = 0xff;
+		pattern += 2;
+	}
+	/* the first and last bytes known are used to filter candidates */
+	for(search->first = 0; search->first < search->length
+			&& search->mask[search->first] == 0x00;
+			search->first++);
+	if(search->first == search->length)
+		return -error_set_code(1, "%s",
+				_("The pattern must contain at least one byte"));
+	for(search->last = search->length - 1;
+			search->mask[search->last] == 0x00; search->last--);
+	if(wildcards == 0)
+	{
+		free(search->mask);
+		search->mask = NULL;
+	}
+	return 0;
+}
+
+static int _new_hexadecimal_digit(int c)
+{
+	if(c >= '0' && c <= '9')
+		return c - '0';
+	if(c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if(c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+static int _new_regex(Search * search, char const * pattern)
+{
+	GError * error = NULL;
+
+	/* the data is binary */
+	if((search->regex = g_regex_new(pattern, G_REGEX_RAW
+					| G_REGEX_OPTIMIZE, 0, &error)) == NULL)
+	{
+		error_set_code(1, "%s", error->message);
+		g_error_free(error);
+		return -1;
+	}
+	return 0;
+}
+
+static int _new_utf16(Search * search, char const * pattern)
+{
+	gunichar2 * utf16;
+	glong cnt;
+	glong i;
+	GError * error = NULL;
+
+	if((utf16 = g_utf8_to_utf16(pattern, -1, NULL, &cnt, &error)) == NULL)
+	{
+		error_set_code(1, "%s", error->message);
+		g_error_free(error);
+		return -1;
+	}
+	/* XXX only look for little-endian strings */
+	search->length = cnt * 2;
+	if((search->bytes = malloc(search->length)) == NULL)
+	{
+		g_free(utf16);
+		return -error_set_code(-errno, "%s", strerror(errno));
+	}
+	for(i = 0; i < cnt; i++)
+	{
+		search->bytes[i * 2] = utf16[i] & 0xff;
+		search->bytes[i * 2 + 1] = utf16[i] >> 8;
+	}
+	g_free(utf16);
+	search->last = search->length - 1;
+	return 0;
+}
+
+
+/* search_delete */
+void search_delete(Search * search)
+{
+	search_cancel(search);
+	g_array_free(search->hits, TRUE);
+	if(search->regex != NULL)
+		g_regex_unref(search->regex);
+	free(search->mask);
+	free(search->bytes);
+	g_mutex_clear(&search->mutex);
+	object_delete(search);
+}
+
+
+/* accessors */
+/* search_get_hits */
+SearchHit const * search_get_hits(Search * search, size_t * cnt)
+{
+	*cnt = search->hits->len;
+	return (SearchHit const *)search->hits->data;
+}
+
+
+/* search_is_running */
+int search_is_running(Search * search)
+{
+	return (search->threads != NULL) ? 1 : 0;
+}
+
+
+/* search_is_truncated */
+int search_is_truncated(Search * search)
+{
+	return g_atomic_int_get(&search->truncated) ? 1 : 0;
+}
+
+
+/* useful */
+/* search_cancel */
+void search_cancel(Search * search)
+{
+	g_atomic_int_set(&search->cancel, 1);
+	_search_join(search);
+}
+
+
+/* search_poll */
+int search_poll(Search * search)
+{
+	SearchChunk * chunk;
+	size_t cnt;
+
+	if(search->threads == NULL)
+		return 0;
+	/* collect the hits in order, as the chunks are completed */
+	g_mutex_lock(&search->mutex);
+	for(; search->chunks_collected < search->chunks_cnt;
+			search->chunks_collected++)
+	{
+		chunk = &search->chunks[search->chunks_collected];
+		if(chunk->done == FALSE)
+			break;
+		if(chunk->hits == NULL)
+			continue;
+		/* only the first hits in the file are kept */
+		cnt = SEARCH_HITS_MAX - search->hits->len;
+		if(chunk->hits->len > cnt)
+			g_atomic_int_set(&search->truncated, 1);
+		else
+			cnt = chunk->hits->len;
+		g_array_append_vals(search->hits, chunk->hits->data, cnt);
+		g_array_free(chunk->hits, TRUE);
+		chunk->hits = NULL;
+	}
+	g_mutex_unlock(&search->mutex);
+	if(search->chunks_collected < search->chunks_cnt)
+		return 1;
+	_search_join(search);
+	return 0;
+}
+
+
+/* search_start */
+int search_start(Search * search, unsigned char const * data, size_t size)
+{
+	size_t i;
+	size_t cnt;
+	GError * error = NULL;
+
+	search_cancel(search);
+	g_array_set_size(search->hits, 0);
+	search->data = data;
+	search->size = size;
+	search->chunks_collected = 0;
+	search->chunks_next = 0;
+	search->cancel = 0;
+	search->truncated = 0;
+	if((search->chunks_cnt = (size + SEARCH_CHUNK - 1) / SEARCH_CHUNK)
+			== 0)
+		return 0;
+	if((search->chunks = calloc(search->chunks_cnt,
+					sizeof(*search->chunks))) == NULL)
+		return -error_set_code(-errno, "%s", strerror(errno));
+	/* one worker per processor */
+	if((cnt = g_get_num_processors()) > search->chunks_cnt)
+		cnt = search->chunks_cnt;
+	if((search->threads = malloc(sizeof(*search->threads) * cnt)) == NULL)
+	{
+		search_cancel(search);
+		return -error_set_code(-errno, "%s", strerror(errno));
+	}
+	for(i = 0; i < cnt; i++)
+		if((search->threads[i] = g_thread_try_new("search",
+						_search_on_thread, search,
+						&error)) == NULL)
+		{
+			error_set_code(1, "%s", error->message);
+			g_error_free(error);
+			break;
+		}
+	if((search->threads_cnt = i) == 0)
+	{
+		search_cancel(search);
+		return -1;
+	}
+	return 0;
+}
+
+
+/* private */
+/* functions */
+/* search_hit */
+static int _search_hit(GArray * hits, size_t offset, size_t length)
+{
+	SearchHit hit;
+
+	/* one hit more than kept tells if the results are truncated */
+	if(hits->len > SEARCH_HITS_MAX)
+		return -1;
+	hit.offset = offset;
+	hit.length = length;
+	g_array_append_val(hits, hit);
+	return 0;
+}
+
+
+/* search_join */
+static void _search_join(Search * search)
+{
+	size_t i;
+
+	for(i = 0; i < search->threads_cnt; i++)
+		g_thread_join(search->threads[i]);
+	free(search->threads);
+	search->threads = NULL;
+	search->threads_cnt = 0;
+	for(i = 0; i < search->chunks_cnt; i++)
+		if(search->chunks[i].hits != NULL)
+			g_array_free(search->chunks[i].hits, TRUE);
+	free(search->chunks);
+	search->chunks = NULL;
+	search->chunks_cnt = 0;
+	search->chunks_collected = 0;
+}
+
+
+/* search_match */
+static int _search_match(Search * search, unsigned char const * data)
+{
+	size_t i;
+
+	if(search->mask == NULL)
+		return (memcmp(data, search->bytes, search->length) == 0)
+			? 1 : 0;
+	for(i = 0; i < search->length; i++)
+		if((data[i] & search->mask[i]) != search->bytes[i])
+			return 0;
+	return 1;
+}
+
+
+/* search_scan_bytes */
+static void _search_scan_bytes(Search * search, size_t start, size_t end,
+		GArray * hits)
+{
+	unsigned char const * data = search->data;
+	size_t const first = search->first;
+	size_t i = start;
+	unsigned char const * p;
+#ifdef SEARCH_SSE2
+	const __m128i f = _mm_set1_epi8(search->bytes[search->first]);
+	const __m128i l = _mm_set1_epi8(search->bytes[search->last]);
+	unsigned int mask;
+	unsigned int j;
+#endif
+
+	if(search->size < search->length)
+		return;
+	/* matches start within the chunk and end within the data */
+	if(end > search->size - search->length + 1)
+		end = search->size - search->length + 1;
+#ifdef SEARCH_SSE2
+	/* compare the first and last bytes known for 16 candidates at once */
+	for(; i + 16 <= end; i += 16)
+	{
+		if((i & 0xffff) == 0 && g_atomic_int_get(&search->cancel))
+			return;
+		mask = _mm_movemask_epi8(_mm_and_si128(
+					_mm_cmpeq_epi8(f, _mm_loadu_si128(
+							(__m128i const *)
+							&data[i + first])),
+					_mm_cmpeq_epi8(l, _mm_loadu_si128(
+							(__m128i const *)
+							&data[i + search->last]))));
+		for(; mask != 0; mask &= mask - 1)
+		{
+			j = __builtin_ctz(mask);
+			if(_search_match(search, &data[i + j])
+					&& _search_hit(hits, i + j,
+						search->length) != 0)
+				return;
+		}
+	}
+#endif
+	/* look for the first byte known */
+	for(; i < end && (p = memchr(&data[i + first],
+					search->bytes[first], end - i)) != NULL;
+			i++)
+	{
+		i = p - &data[first];
+		if(_search_match(search, &data[i])
+				&& _search_hit(hits, i, search->length) != 0)
+			return;
+	}
+}
+
+
+/* search_scan_regex */
+static void _search_scan_regex(Search * search, size_t start, size_t end,
+		GArray * hits)
+{
+	gchar const * string = (gchar const *)&search->data[start];
+	size_t len;
+	GMatchInfo * info = NULL;
+	gint s;
+	gint e;
+
+	/* matches start within the chunk but may end past it */
+	len = (search->size - end > SEARCH_OVERLAP)
+		? end - start + SEARCH_OVERLAP : search->size - start;
+	if(g_regex_match_full(search->regex, string, len, 0,
+				G_REGEX_MATCH_NOTEMPTY, &info, NULL) == TRUE)
+		do
+		{
+			if(g_atomic_int_get(&search->cancel)
+					|| g_match_info_fetch_pos(info, 0, &s,
+						&e) != TRUE
+					|| start + s >= end)
+				break;
+			if(_search_hit(hits, start + s, e - s) != 0)
+				break;
+		}
+		while(g_match_info_next(info, NULL) == TRUE);
+	g_match_info_free(info);
+}
+
+
+/* callbacks */
+/* search_on_thread */
+static gpointer _search_on_thread(gpointer data)
+{
+	Search * search = data;
+	size_t i;
+	size_t start;
+	size_t end;
+	GArray * hits;
+
+	while(g_atomic_int_get(&search->cancel) == 0)
+	{
+		if((i = g_atomic_int_add(&search->chunks_next, 1))
+				>= search->chunks_cnt)
+			break;
+		hits = NULL;
+		/* skip the remaining chunks once enough hits were collected */
+		if(g_atomic_int_get(&search->truncated) == 0)
+		{
+			hits = g_array_new(FALSE, FALSE, sizeof(SearchHit));
+			start = i * SEARCH_CHUNK;
+			end = (search->size - start > SEARCH_CHUNK)
+				? start + SEARCH_CHUNK : search->size;
+			if(search->regex != NULL)
+				_search_scan_regex(search, start, end, hits);
+			else
+				_search_scan_bytes(search, start, end, hits);
+		}
+		g_mutex_lock(&search->mutex);
+		search->chunks[i].hits = hits;
+		search->chunks[i].done = TRUE;
+		g_mutex_unlock(&search->mutex);
+	}
+	return NULL;
+}
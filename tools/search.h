@@ -0,0 +1,66 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+
+#ifndef CODER_DEBUGGER_SEARCH_H
+# define CODER_DEBUGGER_SEARCH_H
+
+# include <stddef.h>
+
+
+/* Search */
+/* types */
+typedef struct _Search Search;
+
+typedef struct _SearchHit
+{
+	size_t offset;
+	size_t length;
+} SearchHit;
+
+typedef enum _SearchType
+{
+	ST_HEXADECIMAL = 0, ST_ASCII, ST_UTF16, ST_REGEX
+} SearchType;
+# define ST_LAST ST_REGEX
+# define ST_COUNT (ST_LAST + 1)
+
+
+/* functions */
+Search * search_new(SearchType type, char const * pattern);
+void search_delete(Search * search);
+
+/* accessors */
+SearchHit const * search_get_hits(Search * search, size_t * cnt);
+int search_is_running(Search * search);
+int search_is_truncated(Search * search);
+
+/* useful */
+int search_start(Search * search, unsigned char const * data, size_t size);
+void search_cancel(Search * search);
+int search_poll(Search * search);
+
+#endif /* !CODER_DEBUGGER_SEARCH_H */
@@ -0,0 +1,214 @@
+/* $Id$ */
+/* Copyright (c) 2024 Pierre Pronchery <khorben@defora.org> */
+/* Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the authors nor the names of the contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ * THIS SOFTWARE IS PROVIDED BY ITS AUTHORS AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE. */
+
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <libintl.h>
+#include <glib.h>
+#include <System.h>
+#include "trace.h"
+#define _(string) gettext(string)
+
+
+/* TraceWriter */
+/* private */
+/* types */
+/* on-disk format:
+ * - the header, "CTRC" followed by the version and number of registers
+ * - for every step, the difference with the previous program counter
+ * - then if registers are recorded, a mask of the registers changed
+ *   and the difference with their previous value
+ * each as a variable-length integer, the differences being zigzag-encoded */
+struct _TraceWriter
+{
+	FILE * fp;
+	size_t registers_cnt;
+
+	/* ring buffer of steps, encoded when full */
+	uint64_t * ring;
+	size_t ring_cnt;
+
+	/* the last values encoded */
+	uint64_t pc;
+	uint64_t registers[TRACE_REGISTERS_MAX];
+
+	/* encoding buffer */
+	unsigned char * buf;
+	size_t buf_size;
+};
+
+
+/* constants */
+#define TRACE_MAGIC		"CTRC"
+#define TRACE_VERSION		1
+/* steps buffered before encoding */
+#define TRACE_RING		8192
+/* bytes needed to encode a 64-bit integer */
+#define TRACE_VARINT_MAX	10
+
+
+/* prototypes */
+static size_t _trace_encode(unsigned char * buf, uint64_t value);
+static size_t _trace_encode_delta(unsigned char * buf, uint64_t value,
+		uint64_t previous);
+
+
+/* public */
+/* functions */
+/* trace_writer_new */
+TraceWriter * trace_writer_new(char const * filename, size_t registers_cnt)
+{
+	TraceWriter * writer;
+	unsigned char header[6];
+
+	if(registers_cnt > TRACE_REGISTERS_MAX)
+	{
+		error_set_code(1, "%s", _("Too many registers"));
+		return NULL;
+	}
+	if((writer = object_new(sizeof(*writer))) == NULL)
+		return NULL;
+	writer->registers_cnt = registers_cnt;
+	writer->ring = g_new(uint64_t, TRACE_RING * (1 + registers_cnt));
+	writer->ring_cnt = 0;
+	writer->pc = 0;
+	memset(writer->registers, 0, sizeof(writer->registers));
+	writer->buf_size = TRACE_RING * (1 + registers_cnt + 1)
+		* TRACE_VARINT_MAX;
+	writer->buf = g_malloc(writer->buf_size);
+	memcpy(header, TRACE_MAGIC, 4);
+	header[4] = TRACE_VERSION;
+	header[5] = registers_cnt;
+	if((writer->fp = fopen(filename, "wb")) == NULL
+			|| fwrite(header, sizeof(header), 1, writer->fp) != 1)
+	{
+		error_set_code(-errno, "%s: %s", filename, strerror(errno));
+		trace_writer_delete(writer);
+		return NULL;
+	}
+	return writer;
+}
+
+
+/* trace_writer_delete */
+int trace_writer_delete(TraceWriter * writer)
+{
+	int ret = 0;
+
+	if(writer->fp != NULL)
+	{
+		ret = trace_writer_flush(writer);
+		if(fclose(writer->fp) != 0 && ret == 0)
+			ret = -error_set_code(-errno, "%s", strerror(errno));
+	}
+	g_free(writer->buf);
+	g_free(writer->ring);
+	object_delete(writer);
+	return ret;
+}
+
+
+/* useful */
+/* trace_writer_append */
+int trace_writer_append(TraceWriter * writer, uint64_t pc,
+		uint64_t const * registers)
+{
+	uint64_t * p;
+
+	if(writer->ring_cnt == TRACE_RING && trace_writer_flush(writer) != 0)
+		return -1;
+	p = &writer->ring[writer->ring_cnt++ * (1 + writer->registers_cnt)];
+	p[0] = pc;
+	if(writer->registers_cnt > 0)
+		memcpy(&p[1], registers, sizeof(*registers)
+				* writer->registers_cnt);
+	return 0;
+}
+
+
+/* trace_writer_flush */
+int trace_writer_flush(TraceWriter * writer)
+{
+	size_t i;
+	size_t j;
+	uint64_t const * p;
+	uint64_t mask;
+	size_t pos = 0;
+
+	for(i = 0; i < writer->ring_cnt; i++)
+	{
+		p = &writer->ring[i * (1 + writer->registers_cnt)];
+		pos += _trace_encode_delta(&writer->buf[pos], p[0], writer->pc);
+		writer->pc = p[0];
+		if(writer->registers_cnt == 0)
+			continue;
+		/* only the registers changed are recorded */
+		for(j = 0, mask = 0; j < writer->registers_cnt; j++)
+			if(p[1 + j] != writer->registers[j])
+				mask |= (uint64_t)1 << j;
+		pos += _trace_encode(&writer->buf[pos], mask);
+		for(j = 0; j < writer->registers_cnt; j++)
+			if(mask & ((uint64_t)1 << j))
+			{
+				pos += _trace_encode_delta(&writer->buf[pos],
+						p[1 + j], writer->registers[j]);
+				writer->registers[j] = p[1 + j];
+			}
+	}
+	writer->ring_cnt = 0;
+	if(pos > 0 && fwrite(writer->buf, 1, pos, writer->fp) != pos)
+		return -error_set_code(-errno, "%s", strerror(errno));
+	return 0;
+}
+
+
+/* private */
+/* functions */
+/* trace_encode */
+static size_t _trace_encode(unsigned char * buf, uint64_t value)
+{
+	size_t i;
+
+	/* seven bits at a time, the eighth tells if more follow */
+	for(i = 0; value >= 0x80; i++, value >>= 7)
+		buf[i] = (value & 0x7f) | 0x80;
+	buf[i++] = value;
+	return i;
+}
+
+
+/* trace_encode_delta */
+static size_t _trace_encode_delta(unsigned char * buf, uint64_t value,
+		uint64_t previous)
+{
+	int64_t delta = value - previous;
+
+	/* small differences are encoded on few bytes either way */
+	return _trace_encode(buf, ((uint64_t)delta << 1)
+			^ (uint64_t)(delta >> 63));
+}